@@ -470,6 +470,18 @@ typedef enum {
 #define ucp_dt_make_iov() (UCP_DATATYPE_IOV)
 
 
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief Number of bits of a strided data type identifier used for each field.
+ *
+ * The element size, stride and count of a strided datatype are encoded in the
+ * identifier itself, and each must fit in the corresponding number of bits.
+ */
+#define UCP_DT_STRIDED_ELEM_SIZE_BITS  20
+#define UCP_DT_STRIDED_STRIDE_BITS     29
+#define UCP_DT_STRIDED_COUNT_BITS      12
+
+
 /**
  * @ingroup UCP_DATATYPE
  * @brief Structure for scatter-gather I/O.
@@ -2853,6 +2865,40 @@ ucs_status_t ucp_dt_create_generic(const ucp_generic_dt_ops_t *ops, void *contex
                                    ucp_datatype_t *datatype_p);
 
 
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief Create a strided datatype.
+ *
+ * This routine creates an identifier for a datatype made of @a count blocks of
+ * @a elem_size bytes each, whose start addresses are @a stride bytes apart,
+ * for example a column of a row-major matrix. Sending or receiving N items of
+ * this datatype accesses N * @a count blocks, all @a stride bytes apart.
+ * The parameters are encoded in the identifier itself, so it does not have to
+ * be destroyed.
+ *
+ * @param [in]  elem_size    Size of a contiguous block, in bytes. Must be
+ *                           positive and less than
+ *                           2^@ref UCP_DT_STRIDED_ELEM_SIZE_BITS.
+ * @param [in]  stride       Distance between the starts of two consecutive
+ *                           blocks, in bytes. Must not be smaller than
+ *                           @a elem_size, and must be less than
+ *                           2^@ref UCP_DT_STRIDED_STRIDE_BITS.
+ * @param [in]  count        Number of blocks in the datatype. Must be
+ *                           positive and less than
+ *                           2^@ref UCP_DT_STRIDED_COUNT_BITS.
+ * @param [out] datatype_p   Filled with the datatype identifier.
+ *
+ * @return UCS_ERR_INVALID_PARAM if the parameters are out of range, otherwise
+ *         UCS_OK.
+ *
+ * @note Only host memory buffers are supported.
+ * @note In case of partial receive, the blocks are filled in order and the
+ *       last one may be filled partially.
+ */
+ucs_status_t ucp_dt_make_strided(size_t elem_size, size_t stride, size_t count,
+                                 ucp_datatype_t *datatype_p);
+
+
 /**
  * @ingroup UCP_DATATYPE
  * @brief Destroy a datatype and release its resources.
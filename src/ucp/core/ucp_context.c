@@ -148,6 +148,24 @@ static ucs_config_field_t ucp_config_table[] = {
    " auto      - runtime automatically chooses optimal scheme to use.\n",
    ucs_offsetof(ucp_config_t, ctx.rndv_mode), UCS_CONFIG_TYPE_ENUM(ucp_rndv_modes)},
 
+  {"RNDV_RKEY_PTR", "y",
+   "Receive rendezvous data by copying it directly from the sender's buffer,\n"
+   "when the buffer can be mapped to the receiver's address space by a memory\n"
+   "domain of the endpoint (for example, xpmem). The mapped data is copied\n"
+   "instead of being read by get_zcopy operations.",
+   ucs_offsetof(ucp_config_t, ctx.rndv_rkey_ptr), UCS_CONFIG_TYPE_BOOL},
+
+  {"RNDV_COPY_THREADS", "1",
+   "Maximal number of threads which copy the data of a rendezvous message from\n"
+   "a mapped sender's buffer. The helper threads are created once, together\n"
+   "with the worker.",
+   ucs_offsetof(ucp_config_t, ctx.rndv_copy_threads), UCS_CONFIG_TYPE_UINT},
+
+  {"RNDV_COPY_THREAD_SIZE", "2m",
+   "Minimal amount of data for each of the threads which copy a rendezvous\n"
+   "message from a mapped sender's buffer.",
+   ucs_offsetof(ucp_config_t, ctx.rndv_copy_thread_size), UCS_CONFIG_TYPE_MEMUNITS},
+
   {"ZCOPY_THRESH", "auto",
    "Threshold for switching from buffer copy to zero copy protocol",
    ucs_offsetof(ucp_config_t, ctx.zcopy_thresh), UCS_CONFIG_TYPE_MEMUNITS},
@@ -255,6 +273,7 @@ static ucp_tl_alias_t ucp_tl_aliases[] = {
   { "dc",    { "dc_mlx5", "rdmacm", NULL } },
   { "dc_x",  { "dc_mlx5", "rdmacm", NULL } },
   { "ugni",  { "ugni_smsg", "ugni_udt:aux", "ugni_rdma", NULL } },
+  { "tcp",   { "tcp", "sockcm", NULL } },
   { NULL }
 };
 
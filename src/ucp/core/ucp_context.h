@@ -44,6 +44,12 @@ typedef struct ucp_context_config {
     /** The percentage allowed for performance difference between rendezvous
      *  and the eager_zcopy protocol */
     double                                 rndv_perf_diff;
+    /** Copy rendezvous data from a mapped sender's buffer */
+    int                                    rndv_rkey_ptr;
+    /** Maximal number of threads which copy a mapped rendezvous buffer */
+    unsigned                               rndv_copy_threads;
+    /** Minimal amount of data per rendezvous copy thread */
+    size_t                                 rndv_copy_thread_size;
     /** Threshold for switching UCP to zero copy protocol */
     size_t                                 zcopy_thresh;
     /** Communication scheme in RNDV protocol */
@@ -1095,6 +1095,7 @@ void ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config)
     uct_md_attr_t *md_attr;
     uct_memory_type_t mem_type;
     ucp_rsc_index_t rsc_index;
+    ucp_md_index_t md_index;
     ucp_lane_index_t lane;
     size_t it;
     size_t max_rndv_thresh;
@@ -1128,8 +1129,6 @@ void ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config)
     config->tag.rndv.am_thresh          = SIZE_MAX;
     config->tag.rndv_send_nbr.am_thresh = SIZE_MAX;
     config->tag.rndv_send_nbr.rma_thresh = SIZE_MAX;
-    config->tag.rndv.rkey_size          = ucp_rkey_packed_size(context,
-                                                               config->key.rma_bw_md_map);
     config->stream.proto                = &ucp_stream_am_proto;
     config->tag.offload.max_eager_short = -1;
     config->tag.max_eager_short         = -1;
@@ -1148,6 +1147,24 @@ void ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config)
         }
     }
 
+    /* rendezvous receivers may map the registered send buffer, instead of
+     * reading it with get_zcopy */
+    config->tag.rndv.rkey_ptr_md_map = 0;
+    if (context->config.ext.rndv_rkey_ptr) {
+        for (lane = 0; lane < config->key.num_lanes; ++lane) {
+            md_index = config->md_index[lane];
+            if ((md_index != UCP_NULL_RESOURCE) &&
+                ucs_test_all_flags(context->tl_mds[md_index].attr.cap.flags,
+                                   UCT_MD_FLAG_RKEY_PTR | UCT_MD_FLAG_REG)) {
+                config->tag.rndv.rkey_ptr_md_map |= UCS_BIT(md_index);
+            }
+        }
+    }
+
+    config->tag.rndv.rkey_size = ucp_rkey_packed_size(context,
+                                                      config->key.rma_bw_md_map |
+                                                      config->tag.rndv.rkey_ptr_md_map);
+
     /* configuration for rndv */
     config->tag.rndv.min_get_zcopy = 0;
     rndv_max_bw = 0;
@@ -221,7 +221,11 @@ typedef struct ucp_ep_config {
             size_t          rma_thresh;
             /* Threshold for switching from eager to AM based rendezvous */
             size_t          am_thresh;
-            /* Total size of packed rkey, according to high-bw md_map */
+            /* MDs of the lanes which can map a registered buffer to the
+             * peer's address space */
+            ucp_md_map_t    rkey_ptr_md_map;
+            /* Total size of packed rkey, according to high-bw and rkey_ptr
+             * md_maps */
             size_t          rkey_size;
             /* BW based scale factor */
             double          scale[UCP_MAX_LANES];
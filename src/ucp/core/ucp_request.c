@@ -222,6 +222,16 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_request_memory_reg,
         ucp_trace_req(req_dbg, "mem reg md_map 0x%"PRIx64"/0x%"PRIx64,
                       state->dt.contig.md_map, md_map);
         break;
+    case UCP_DATATYPE_STRIDED:
+        /* register the whole span once, the blocks are sent from it */
+        ucs_assert(ucs_popcount(md_map) <= UCP_MAX_OP_MDS);
+        status = ucp_mem_rereg_mds(context, md_map, buffer,
+                                   ucp_dt_strided_span(datatype, length), flags,
+                                   NULL, mem_type, NULL, state->dt.contig.memh,
+                                   &state->dt.contig.md_map);
+        ucp_trace_req(req_dbg, "mem reg strided md_map 0x%"PRIx64"/0x%"PRIx64,
+                      state->dt.contig.md_map, md_map);
+        break;
     case UCP_DATATYPE_IOV:
         iovcnt = state->dt.iov.iovcnt;
         iov    = buffer;
@@ -275,6 +285,7 @@ UCS_PROFILE_FUNC_VOID(ucp_request_memory_dereg, (context, datatype, state, req_d
 
     switch (datatype & UCP_DATATYPE_CLASS_MASK) {
     case UCP_DATATYPE_CONTIG:
+    case UCP_DATATYPE_STRIDED:
         ucp_request_dt_dereg(context, &state->dt.contig, 1, req_dbg);
         break;
     case UCP_DATATYPE_IOV:
@@ -352,6 +363,10 @@ ucp_request_send_start(ucp_request_t *req, ssize_t max_short,
                 multi = ucp_dt_iov_count_nonempty(req->send.buffer, dt_count) >
                         msg_config->max_iov;
             }
+        } else if (ucs_unlikely(UCP_DT_IS_STRIDED(req->send.datatype))) {
+            /* every block takes an iov entry */
+            multi = ucp_dt_strided_block_count(req->send.datatype, 0, length) >
+                    msg_config->max_iov;
         } else {
             multi = 0;
         }
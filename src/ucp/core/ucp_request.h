@@ -141,6 +141,11 @@ struct ucp_request {
                     ucp_rkey_h           rkey;           /* key for remote send buffer */
                     ucp_lane_map_t       lanes_map;      /* used lanes map */
                     ucp_lane_index_t     lane_count;     /* number of lanes used in transaction */
+                    ucp_rndv_get_iov_t   *iov;           /* entries of the sender's IOV buffer,
+                                                            or NULL if it is contiguous */
+                    size_t               iovcnt;         /* number of entries in iov */
+                    size_t               iov_index;      /* entry of the current offset */
+                    size_t               iov_offset;     /* offset where the entry starts */
                 } rndv_get;
 
                 struct {
@@ -287,6 +292,8 @@ struct ucp_recv_desc {
                                                space needed for ucp_recv_desc itself.
                                                It is used for releasing descriptor
                                                back to UCT only */
+    uint32_t                tag_index;      /* Index in the array of unexpected
+                                               tags */
 };
 
 
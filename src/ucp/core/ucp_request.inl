@@ -243,6 +243,7 @@ ucp_request_send_state_init(ucp_request_t *req, ucp_datatype_t datatype,
 
     switch (datatype & UCP_DATATYPE_CLASS_MASK) {
     case UCP_DATATYPE_CONTIG:
+    case UCP_DATATYPE_STRIDED:
         req->send.state.dt.dt.contig.md_map     = 0;
         return;
     case UCP_DATATYPE_IOV:
@@ -441,6 +442,11 @@ ucp_request_recv_data_unpack(ucp_request_t *req, const void *data,
         }
         return UCS_OK;;
 
+    case UCP_DATATYPE_STRIDED:
+        UCS_PROFILE_CALL_VOID(ucp_dt_strided_scatter, req->recv.buffer,
+                              req->recv.datatype, data, offset, length);
+        return UCS_OK;
+
     case UCP_DATATYPE_IOV:
         if (offset != req->recv.state.offset) {
             ucp_dt_iov_seek(req->recv.buffer, req->recv.state.dt.iov.iovcnt,
@@ -50,6 +50,7 @@ typedef struct ucp_proto                ucp_proto_t;
 typedef struct ucp_worker_iface         ucp_worker_iface_t;
 typedef struct ucp_rma_proto            ucp_rma_proto_t;
 typedef struct ucp_amo_proto            ucp_amo_proto_t;
+typedef struct ucp_rndv_get_iov         ucp_rndv_get_iov_t;
 
 
 /**
@@ -1361,6 +1361,13 @@ out:
     return config_idx;
 }
 
+static void ucp_worker_destroy_copy_pool(ucp_worker_h worker)
+{
+    if (worker->rndv_copy_pool != NULL) {
+        ucs_sys_thread_pool_destroy(worker->rndv_copy_pool);
+    }
+}
+
 ucs_status_t ucp_worker_create(ucp_context_h context,
                                const ucp_worker_params_t *params,
                                ucp_worker_h *worker_p)
@@ -1488,10 +1495,22 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
         UCS_CPU_ZERO(&worker->cpu_mask);
     }
 
+    /* Create helper threads for rendezvous copy from a mapped remote buffer */
+    worker->rndv_copy_pool = NULL;
+    if (context->config.ext.rndv_rkey_ptr &&
+        (context->config.ext.rndv_copy_threads > 1)) {
+        status = ucs_sys_thread_pool_create(context->config.ext.rndv_copy_threads - 1,
+                                            "rndv copy", &worker->rndv_copy_pool);
+        if (status != UCS_OK) {
+            goto err_wakeup_cleanup;
+        }
+    }
+
     /* Initialize tag matching */
-    status = ucp_tag_match_init(&worker->tm);
+    status = ucp_tag_match_init(&worker->tm, context->config.tag_sender_mask
+                                UCS_STATS_ARG(worker->stats));
     if (status != UCS_OK) {
-        goto err_wakeup_cleanup;
+        goto err_destroy_copy_pool;
     }
 
     /* Open all resources as interfaces on this worker */
@@ -1526,6 +1545,8 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
 err_close_ifaces:
     ucp_worker_close_ifaces(worker);
     ucp_tag_match_cleanup(&worker->tm);
+err_destroy_copy_pool:
+    ucp_worker_destroy_copy_pool(worker);
 err_wakeup_cleanup:
     ucp_worker_wakeup_cleanup(worker);
 err_req_mp_cleanup:
@@ -1561,6 +1582,7 @@ void ucp_worker_destroy(ucp_worker_h worker)
     UCS_ASYNC_BLOCK(&worker->async);
     ucp_worker_destroy_eps(worker);
     ucp_worker_remove_am_handlers(worker);
+    ucp_tag_match_purge(&worker->tm);
     UCS_ASYNC_UNBLOCK(&worker->async);
 
     ucs_mpool_cleanup(&worker->am_mp, 1);
@@ -1568,6 +1590,7 @@ void ucp_worker_destroy(ucp_worker_h worker)
     ucs_mpool_cleanup(&worker->rndv_frag_mp, 1);
     ucp_worker_close_ifaces(worker);
     ucp_tag_match_cleanup(&worker->tm);
+    ucp_worker_destroy_copy_pool(worker);
     ucp_worker_wakeup_cleanup(worker);
     ucs_mpool_cleanup(&worker->req_mp, 1);
     uct_worker_destroy(worker->uct);
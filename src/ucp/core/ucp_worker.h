@@ -19,6 +19,7 @@
 #include <ucs/datastruct/queue_types.h>
 #include <ucs/datastruct/strided_alloc.h>
 #include <ucs/arch/bitops.h>
+#include <ucs/sys/sys.h>
 
 
 /* The size of the private buffer in UCT descriptor headroom, which UCP may
@@ -214,6 +215,7 @@ typedef struct ucp_worker {
     ucs_mpool_t                   reg_mp;        /* Registered memory pool */
     ucs_mpool_t                   rndv_frag_mp;  /* Memory pool for RNDV fragments */
     ucp_tag_match_t               tm;            /* Tag-matching queues and offload info */
+    ucs_sys_thread_pool_t         *rndv_copy_pool; /* Helper threads for rkey_ptr copy, or NULL */
     ucp_ep_h                      mem_type_ep[UCT_MD_MEM_TYPE_LAST];/* memory type eps */
 
     UCS_STATS_NODE_DECLARE(stats);
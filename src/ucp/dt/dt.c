@@ -91,7 +91,7 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_mem_type_pack,
 
 size_t ucp_dt_pack(ucp_worker_h worker, ucp_datatype_t datatype,
                    uct_memory_type_t mem_type, void *dest, const void *src,
-                   ucp_dt_state_t *state, size_t length)
+                   ucp_dt_state_t *state, size_t length, size_t total_length)
 {
     size_t result_len = 0;
     ucp_dt_generic_t *dt;
@@ -104,13 +104,20 @@ size_t ucp_dt_pack(ucp_worker_h worker, ucp_datatype_t datatype,
     case UCP_DATATYPE_CONTIG:
         if ((ucs_likely(UCP_MEM_IS_HOST(mem_type))) ||
             (ucs_likely(UCP_MEM_IS_CUDA_MANAGED(mem_type)))) {
-            UCS_PROFILE_CALL(memcpy, dest, src + state->offset, length);
+            UCS_PROFILE_CALL_VOID(ucs_memcpy_relaxed_part, dest,
+                                  src + state->offset, length, total_length);
         } else {
             ucp_mem_type_pack(worker, dest, src + state->offset, length, mem_type);
         }
         result_len = length;
         break;
 
+    case UCP_DATATYPE_STRIDED:
+        UCS_PROFILE_CALL_VOID(ucp_dt_strided_gather, dest, src, datatype,
+                              state->offset, length);
+        result_len = length;
+        break;
+
     case UCP_DATATYPE_IOV:
         UCS_PROFILE_CALL_VOID(ucp_dt_iov_gather, dest, src, length,
                               &state->dt.iov.iov_offset,
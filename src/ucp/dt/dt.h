@@ -11,6 +11,7 @@
 #include "dt_contig.h"
 #include "dt_iov.h"
 #include "dt_generic.h"
+#include "dt_strided.h"
 
 #include <ucp/core/ucp_types.h>
 #include <uct/api/uct.h>
@@ -32,7 +33,8 @@ typedef struct ucp_dt_reg {
 typedef struct ucp_dt_state {
     size_t                        offset;  /* Total offset in overall payload. */
     union {
-        ucp_dt_reg_t              contig;
+        ucp_dt_reg_t              contig;  /* Also registration of the
+                                              strided datatype span */
         struct {
             size_t                iov_offset;     /* Offset in the IOV item */
             size_t                iovcnt_offset;  /* The IOV item to start copy */
@@ -48,7 +50,7 @@ typedef struct ucp_dt_state {
 
 size_t ucp_dt_pack(ucp_worker_h worker, ucp_datatype_t datatype,
                    uct_memory_type_t mem_type, void *dest, const void *src,
-                   ucp_dt_state_t *state, size_t length);
+                   ucp_dt_state_t *state, size_t length, size_t total_length);
 
 ucs_status_t ucp_mem_type_unpack(ucp_worker_h worker, void *buffer,
                                  const void *recv_data, size_t recv_length,
@@ -22,6 +22,9 @@ size_t ucp_dt_length(ucp_datatype_t datatype, size_t count,
     case UCP_DATATYPE_CONTIG:
         return ucp_contig_dt_length(datatype, count);
 
+    case UCP_DATATYPE_STRIDED:
+        return ucp_dt_strided_length(datatype, count);
+
     case UCP_DATATYPE_IOV:
         ucs_assert(NULL != iov);
         return ucp_dt_iov_length(iov, count);
@@ -64,6 +67,15 @@ ucp_dt_unpack_only(ucp_worker_h worker, void *buffer, size_t count,
         }
         return UCS_OK;
 
+    case UCP_DATATYPE_STRIDED:
+        if (truncation &&
+            ucs_unlikely(length > (buffer_size = ucp_dt_strided_length(datatype, count)))) {
+            goto err_truncated;
+        }
+        UCS_PROFILE_CALL_VOID(ucp_dt_strided_scatter, buffer, datatype, data,
+                              0, length);
+        return UCS_OK;
+
     case UCP_DATATYPE_IOV:
         if (truncation &&
             ucs_unlikely(length > (buffer_size = ucp_dt_iov_length(buffer, count)))) {
@@ -106,6 +118,7 @@ ucp_dt_recv_state_init(ucp_dt_state_t *dt_state, void *buffer,
 
     switch (dt & UCP_DATATYPE_CLASS_MASK) {
     case UCP_DATATYPE_CONTIG:
+    case UCP_DATATYPE_STRIDED:
         dt_state->dt.contig.md_map     = 0;
         break;
    case UCP_DATATYPE_IOV:
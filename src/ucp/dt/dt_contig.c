@@ -6,6 +6,7 @@
 
 #include "dt_contig.h"
 
+#include <ucs/arch/cpu.h>
 #include <ucs/profile/profile.h>
 #include <string.h>
 
@@ -14,6 +15,7 @@ size_t ucp_memcpy_pack(void *dest, void *arg)
 {
     ucp_memcpy_pack_context_t *ctx = arg;
     size_t length = ctx->length;
-    UCS_PROFILE_CALL(memcpy, dest, ctx->src, length);
+    UCS_PROFILE_CALL_VOID(ucs_memcpy_relaxed_part, dest, ctx->src, length,
+                          ctx->total_length);
     return length;
 }
@@ -18,6 +18,7 @@
 typedef struct {
     const void                    *src;
     size_t                        length;
+    size_t                        total_length; /* Of the whole message */
 } ucp_memcpy_pack_context_t;
 
 
@@ -0,0 +1,129 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2019.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "dt_strided.h"
+
+#include <ucs/debug/log.h>
+#include <ucs/sys/compiler_def.h>
+
+#include <string.h>
+
+
+ucs_status_t ucp_dt_make_strided(size_t elem_size, size_t stride, size_t count,
+                                 ucp_datatype_t *datatype_p)
+{
+    if ((elem_size == 0) || (stride < elem_size) || (count == 0) ||
+        (elem_size > UCS_MASK(UCP_DT_STRIDED_ELEM_SIZE_BITS)) ||
+        (stride > UCS_MASK(UCP_DT_STRIDED_STRIDE_BITS)) ||
+        (count > UCS_MASK(UCP_DT_STRIDED_COUNT_BITS))) {
+        ucs_error("invalid strided datatype: elem_size %zu stride %zu "
+                  "count %zu", elem_size, stride, count);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    *datatype_p = ((ucp_datatype_t)elem_size << UCP_DATATYPE_SHIFT) |
+                  ((ucp_datatype_t)stride << UCP_DT_STRIDED_STRIDE_SHIFT) |
+                  ((ucp_datatype_t)count << UCP_DT_STRIDED_COUNT_SHIFT) |
+                  UCP_DATATYPE_STRIDED;
+    return UCS_OK;
+}
+
+/* Copy blocks with a fixed element size, so the compiler can replace memcpy
+ * with plain loads and stores, and unroll and vectorize the loop */
+#define UCP_DT_STRIDED_COPY_CASE(_elem_size, _dst, _dst_step, _src, _src_step, \
+                                 _count) \
+    case _elem_size: \
+        for (i = 0; i < (_count); ++i) { \
+            memcpy(UCS_PTR_BYTE_OFFSET(_dst, i * (_dst_step)), \
+                   UCS_PTR_BYTE_OFFSET(_src, i * (_src_step)), _elem_size); \
+        } \
+        break;
+
+
+static void ucp_dt_strided_copy_blocks(void *dst, size_t dst_step,
+                                       const void *src, size_t src_step,
+                                       size_t elem_size, size_t count)
+{
+    size_t i;
+
+    switch (elem_size) {
+    UCP_DT_STRIDED_COPY_CASE(1,  dst, dst_step, src, src_step, count)
+    UCP_DT_STRIDED_COPY_CASE(2,  dst, dst_step, src, src_step, count)
+    UCP_DT_STRIDED_COPY_CASE(4,  dst, dst_step, src, src_step, count)
+    UCP_DT_STRIDED_COPY_CASE(8,  dst, dst_step, src, src_step, count)
+    UCP_DT_STRIDED_COPY_CASE(16, dst, dst_step, src, src_step, count)
+    UCP_DT_STRIDED_COPY_CASE(32, dst, dst_step, src, src_step, count)
+    default:
+        for (i = 0; i < count; ++i) {
+            memcpy(UCS_PTR_BYTE_OFFSET(dst, i * dst_step),
+                   UCS_PTR_BYTE_OFFSET(src, i * src_step), elem_size);
+        }
+        break;
+    }
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_dt_strided_copy(void *strided, ucp_datatype_t datatype, void *contig,
+                    size_t offset, size_t length, int pack)
+{
+    size_t elem_size    = ucp_dt_strided_elem_size(datatype);
+    size_t stride       = ucp_dt_strided_stride(datatype);
+    size_t block_offset = offset % elem_size;
+    void *block         = UCS_PTR_BYTE_OFFSET(strided,
+                                              (offset / elem_size) * stride);
+    size_t copy_length, count;
+
+    ucs_assert(stride >= elem_size);
+
+    /* head: the remainder of a partially copied block */
+    if (block_offset != 0) {
+        copy_length = ucs_min(elem_size - block_offset, length);
+        if (pack) {
+            memcpy(contig, UCS_PTR_BYTE_OFFSET(block, block_offset),
+                   copy_length);
+        } else {
+            memcpy(UCS_PTR_BYTE_OFFSET(block, block_offset), contig,
+                   copy_length);
+        }
+        contig  = UCS_PTR_BYTE_OFFSET(contig, copy_length);
+        block   = UCS_PTR_BYTE_OFFSET(block, stride);
+        length -= copy_length;
+    }
+
+    /* full blocks */
+    count = length / elem_size;
+    if (pack) {
+        ucp_dt_strided_copy_blocks(contig, elem_size, block, stride, elem_size,
+                                   count);
+    } else {
+        ucp_dt_strided_copy_blocks(block, stride, contig, elem_size, elem_size,
+                                   count);
+    }
+    contig  = UCS_PTR_BYTE_OFFSET(contig, count * elem_size);
+    block   = UCS_PTR_BYTE_OFFSET(block, count * stride);
+    length -= count * elem_size;
+
+    /* tail: the beginning of a block */
+    if (length != 0) {
+        if (pack) {
+            memcpy(contig, block, length);
+        } else {
+            memcpy(block, contig, length);
+        }
+    }
+}
+
+void ucp_dt_strided_gather(void *dest, const void *src, ucp_datatype_t datatype,
+                           size_t offset, size_t length)
+{
+    ucp_dt_strided_copy((void*)src, datatype, dest, offset, length, 1);
+}
+
+void ucp_dt_strided_scatter(void *dest, ucp_datatype_t datatype,
+                            const void *src, size_t offset, size_t length)
+{
+    ucp_dt_strided_copy(dest, datatype, (void*)src, offset, length, 0);
+}
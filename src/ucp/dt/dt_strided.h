@@ -0,0 +1,117 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2019.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+
+#ifndef UCP_DT_STRIDED_H_
+#define UCP_DT_STRIDED_H_
+
+#include <ucp/api/ucp.h>
+#include <ucs/debug/assert.h>
+#include <ucs/sys/math.h>
+
+
+#define UCP_DT_IS_STRIDED(_datatype) \
+    (((_datatype) & UCP_DATATYPE_CLASS_MASK) == UCP_DATATYPE_STRIDED)
+
+#define UCP_DT_STRIDED_STRIDE_SHIFT \
+    (UCP_DATATYPE_SHIFT + UCP_DT_STRIDED_ELEM_SIZE_BITS)
+
+#define UCP_DT_STRIDED_COUNT_SHIFT \
+    (UCP_DT_STRIDED_STRIDE_SHIFT + UCP_DT_STRIDED_STRIDE_BITS)
+
+
+static inline size_t ucp_dt_strided_elem_size(ucp_datatype_t datatype)
+{
+    return (datatype >> UCP_DATATYPE_SHIFT) &
+           UCS_MASK(UCP_DT_STRIDED_ELEM_SIZE_BITS);
+}
+
+static inline size_t ucp_dt_strided_stride(ucp_datatype_t datatype)
+{
+    return (datatype >> UCP_DT_STRIDED_STRIDE_SHIFT) &
+           UCS_MASK(UCP_DT_STRIDED_STRIDE_BITS);
+}
+
+static inline size_t ucp_dt_strided_count(ucp_datatype_t datatype)
+{
+    return (datatype >> UCP_DT_STRIDED_COUNT_SHIFT) &
+           UCS_MASK(UCP_DT_STRIDED_COUNT_BITS);
+}
+
+/**
+ * Get the total length of the data in @a count items of a strided datatype
+ */
+static inline size_t ucp_dt_strided_length(ucp_datatype_t datatype,
+                                           size_t count)
+{
+    ucs_assert(UCP_DT_IS_STRIDED(datatype));
+    ucs_assert(ucp_dt_strided_stride(datatype) >=
+               ucp_dt_strided_elem_size(datatype));
+    return count * ucp_dt_strided_count(datatype) *
+           ucp_dt_strided_elem_size(datatype);
+}
+
+/**
+ * Get the size of the memory region which holds the first @a length bytes of
+ * a strided buffer, from the start of the first block to the end of the last
+ * one.
+ */
+static inline size_t ucp_dt_strided_span(ucp_datatype_t datatype,
+                                         size_t length)
+{
+    size_t elem_size = ucp_dt_strided_elem_size(datatype);
+    size_t last_elem = (length - 1) / elem_size;
+
+    ucs_assert(length > 0);
+    return (last_elem * ucp_dt_strided_stride(datatype)) +
+           (length - (last_elem * elem_size));
+}
+
+/**
+ * Get the number of blocks, fully or partially, covered by @a length bytes
+ * starting at @a offset of the packed data.
+ */
+static inline size_t ucp_dt_strided_block_count(ucp_datatype_t datatype,
+                                                size_t offset, size_t length)
+{
+    size_t elem_size = ucp_dt_strided_elem_size(datatype);
+
+    if (length == 0) {
+        return 0;
+    }
+
+    return ((offset + length - 1) / elem_size) - (offset / elem_size) + 1;
+}
+
+
+/**
+ * Copy the blocks of a strided buffer @a src to contiguous buffer @a dest.
+ *
+ * @param [in]  dest      Destination contiguous buffer.
+ * @param [in]  src       Source strided buffer, starts at the first block.
+ * @param [in]  datatype  Strided datatype of @a src.
+ * @param [in]  offset    Offset in the packed data to start copying from. It
+ *                        does not have to be aligned to the block size.
+ * @param [in]  length    Total data length to copy in bytes.
+ */
+void ucp_dt_strided_gather(void *dest, const void *src, ucp_datatype_t datatype,
+                           size_t offset, size_t length);
+
+
+/**
+ * Copy contiguous buffer @a src into the blocks of a strided buffer @a dest.
+ *
+ * @param [in]  dest      Destination strided buffer, starts at the first block.
+ * @param [in]  datatype  Strided datatype of @a dest.
+ * @param [in]  src       Source contiguous buffer.
+ * @param [in]  offset    Offset in the packed data to start copying to. It
+ *                        does not have to be aligned to the block size.
+ * @param [in]  length    Total data length to copy in bytes.
+ */
+void ucp_dt_strided_scatter(void *dest, ucp_datatype_t datatype,
+                            const void *src, size_t offset, size_t length);
+
+#endif
@@ -110,8 +110,11 @@ void ucp_dt_iov_copy_uct(ucp_context_h context, uct_iov_t *iov, size_t *iovcnt,
                          ucp_mem_desc_t *mdesc)
 {
     size_t iov_offset, max_src_iov, src_it, dst_it;
+    size_t elem_size, stride, block_offset;
     size_t length_it = 0;
     ucp_md_index_t memh_index;
+    uct_mem_h memh;
+    void *block;
 
     switch (datatype & UCP_DATATYPE_CLASS_MASK) {
     case UCP_DATATYPE_CONTIG:
@@ -134,6 +137,33 @@ void ucp_dt_iov_copy_uct(ucp_context_h context, uct_iov_t *iov, size_t *iovcnt,
         *iovcnt   = 1;
         length_it = iov[0].length;
         break;
+    case UCP_DATATYPE_STRIDED:
+        if (context->tl_mds[md_index].attr.cap.flags & UCT_MD_FLAG_REG) {
+            memh_index = ucs_bitmap2idx(state->dt.contig.md_map, md_index);
+            memh       = state->dt.contig.memh[memh_index];
+        } else {
+            memh       = UCT_MEM_HANDLE_NULL;
+        }
+        elem_size    = ucp_dt_strided_elem_size(datatype);
+        stride       = ucp_dt_strided_stride(datatype);
+        block_offset = state->offset % elem_size;
+        block        = (void*)src_iov + ((state->offset / elem_size) * stride);
+        dst_it       = 0;
+        while ((dst_it < max_dst_iov) && (length_it < length_max)) {
+            iov[dst_it].buffer  = block + block_offset;
+            iov[dst_it].length  = ucs_min(elem_size - block_offset,
+                                          length_max - length_it);
+            iov[dst_it].memh    = memh;
+            iov[dst_it].stride  = 0;
+            iov[dst_it].count   = 1;
+            length_it          += iov[dst_it].length;
+            block_offset        = 0;
+            block              += stride;
+            ++dst_it;
+        }
+
+        *iovcnt = dst_it;
+        break;
     case UCP_DATATYPE_IOV:
         iov_offset                  = state->dt.iov.iov_offset;
         max_src_iov                 = state->dt.iov.iovcnt;
@@ -193,12 +223,12 @@ ucs_status_t ucp_do_am_zcopy_single(uct_pending_req_t *self, uint8_t am_id,
     status = uct_ep_am_zcopy(ep->uct_eps[req->send.lane], am_id, (void*)hdr,
                              hdr_size, iov, iovcnt, 0,
                              &req->send.state.uct_comp);
+    ucp_request_send_state_advance(req, &state,
+                                   UCP_REQUEST_SEND_PROTO_ZCOPY_AM,
+                                   status);
     if (status == UCS_OK) {
+        /* The transport has completed the send immediately */
         complete(req, UCS_OK);
-    } else {
-        ucp_request_send_state_advance(req, &state,
-                                       UCP_REQUEST_SEND_PROTO_ZCOPY_AM,
-                                       status);
     }
     return UCS_STATUS_IS_ERR(status) ? status : UCS_OK;
 }
@@ -232,8 +262,9 @@ ucs_status_t ucp_do_am_zcopy_multi(uct_pending_req_t *self, uint8_t am_id_first,
             req->send.lane = ucp_ep_get_am_lane(ep);
         }
     } else {
-        ucs_assert(UCP_DT_IS_IOV(req->send.datatype));
-        /* disable multilane for IOV datatype.
+        ucs_assert(UCP_DT_IS_IOV(req->send.datatype) ||
+                   UCP_DT_IS_STRIDED(req->send.datatype));
+        /* disable multilane for IOV and strided datatypes.
          * TODO: add IOV processing for multilane */
         req->send.lane = ucp_ep_get_am_lane(ep);
     }
@@ -252,6 +283,12 @@ ucs_status_t ucp_do_am_zcopy_multi(uct_pending_req_t *self, uint8_t am_id_first,
             /* This flag should guarantee middle stage usage if iovcnt exceeded */
             flag_iov_mid = ((state.dt.iov.iovcnt_offset + max_iov) <
                             state.dt.iov.iovcnt);
+        } else if (UCP_DT_IS_STRIDED(req->send.datatype)) {
+            /* Same for the blocks of a strided datatype */
+            flag_iov_mid = ucp_dt_strided_block_count(req->send.datatype,
+                                                      offset,
+                                                      req->send.length -
+                                                      offset) > max_iov;
         } else {
             ucs_assert(UCP_DT_IS_CONTIG(req->send.datatype));
         }
@@ -302,13 +339,15 @@ ucs_status_t ucp_do_am_zcopy_multi(uct_pending_req_t *self, uint8_t am_id_first,
 
             if (!flag_iov_mid && (offset + mid_len == req->send.length)) {
                 /* Last stage */
-                if (status == UCS_OK) {
-                    complete(req, UCS_OK);
-                    return UCS_OK;
-                }
                 ucp_request_send_state_advance(req, &state,
                                                UCP_REQUEST_SEND_PROTO_ZCOPY_AM,
                                                status);
+                if ((status == UCS_OK) &&
+                    (req->send.state.uct_comp.count == 0)) {
+                    /* All fragments were completed by the transport, otherwise
+                     * the request is completed by the last zcopy completion */
+                    complete(req, UCS_OK);
+                }
                 if (!UCS_STATUS_IS_ERR(status)) {
                     return UCS_OK;
                 }
@@ -376,6 +415,22 @@ ucp_proto_get_zcopy_threshold(const ucp_request_t *req,
                               ucp_worker_iface_get_attr(worker, rsc_index)->bandwidth);
         }
         return ucs_min(max_zcopy, zcopy_thresh);
+    } else if (UCP_DT_IS_STRIDED(req->send.datatype)) {
+        /* The span is registered once. Beyond max_iov, small blocks make
+         * fragments too short for zcopy to beat packing them with bcopy. */
+        if ((0 == count) || (0 == req->send.length)) {
+            zcopy_thresh = max_zcopy;
+        } else if (!msg_config->zcopy_auto_thresh ||
+                   (ucp_dt_strided_block_count(req->send.datatype, 0,
+                                               req->send.length) <=
+                    msg_config->max_iov) ||
+                   (ucp_dt_strided_elem_size(req->send.datatype) >=
+                    msg_config->zcopy_thresh[0])) {
+            zcopy_thresh = msg_config->zcopy_thresh[0];
+        } else {
+            zcopy_thresh = max_zcopy;
+        }
+        return ucs_min(max_zcopy, zcopy_thresh);
     } else if (UCP_DT_IS_GENERIC(req->send.datatype)) {
         return max_zcopy;
     }
@@ -36,8 +36,10 @@ static ucs_status_t ucp_rma_basic_progress_put(uct_pending_req_t *self)
                                   rkey->cache.rma_rkey);
     } else if (ucs_likely(req->send.length < rma_config->put_zcopy_thresh)) {
         ucp_memcpy_pack_context_t pack_ctx;
-        pack_ctx.src    = req->send.buffer;
-        pack_ctx.length = ucs_min(req->send.length, rma_config->max_put_bcopy);
+        pack_ctx.src          = req->send.buffer;
+        pack_ctx.length       = ucs_min(req->send.length,
+                                        rma_config->max_put_bcopy);
+        pack_ctx.total_length = req->send.length;
         packed_len = UCS_PROFILE_CALL(uct_ep_put_bcopy,
                                       ep->uct_eps[lane],
                                       ucp_memcpy_pack,
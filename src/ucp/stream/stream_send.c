@@ -157,7 +157,8 @@ static size_t ucp_stream_pack_am_single_dt(void *dest, void *arg)
 
     length = ucp_dt_pack(req->send.ep->worker, req->send.datatype,
                          req->send.mem_type, hdr + 1, req->send.buffer,
-                         &req->send.state.dt, req->send.length);
+                         &req->send.state.dt, req->send.length,
+                         req->send.length);
     ucs_assert(length == req->send.length);
     return sizeof(*hdr) + length;
 }
@@ -189,7 +190,8 @@ static size_t ucp_stream_pack_am_first_dt(void *dest, void *arg)
     ucs_assert(req->send.length > length);
     return sizeof(*hdr) + ucp_dt_pack(req->send.ep->worker, req->send.datatype,
                                       req->send.mem_type, hdr + 1, req->send.buffer,
-                                      &req->send.state.dt, length);
+                                      &req->send.state.dt, length,
+                                      req->send.length);
 }
 
 static size_t ucp_stream_pack_am_middle_dt(void *dest, void *arg)
@@ -203,7 +205,8 @@ static size_t ucp_stream_pack_am_middle_dt(void *dest, void *arg)
                           req->send.length - req->send.state.dt.offset);
     return sizeof(*hdr) + ucp_dt_pack(req->send.ep->worker, req->send.datatype,
                                       req->send.mem_type, hdr + 1, req->send.buffer,
-                                      &req->send.state.dt, length);
+                                      &req->send.state.dt, length,
+                                      req->send.length);
 }
 
 static ucs_status_t ucp_stream_bcopy_multi(uct_pending_req_t *self)
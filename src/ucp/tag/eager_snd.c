@@ -25,7 +25,8 @@ static size_t ucp_tag_pack_eager_only_dt(void *dest, void *arg)
     ucs_assert(req->send.state.dt.offset == 0);
     length = ucp_dt_pack(req->send.ep->worker, req->send.datatype,
                          req->send.mem_type, hdr + 1, req->send.buffer,
-                         &req->send.state.dt, req->send.length);
+                         &req->send.state.dt, req->send.length,
+                         req->send.length);
     ucs_assert(length == req->send.length);
     return sizeof(*hdr) + length;
 }
@@ -43,7 +44,8 @@ static size_t ucp_tag_pack_eager_sync_only_dt(void *dest, void *arg)
     ucs_assert(req->send.state.dt.offset == 0);
     length = ucp_dt_pack(req->send.ep->worker, req->send.datatype,
                          req->send.mem_type, hdr + 1, req->send.buffer,
-                         &req->send.state.dt, req->send.length);
+                         &req->send.state.dt, req->send.length,
+                         req->send.length);
     ucs_assert(length == req->send.length);
     return sizeof(*hdr) + length;
 }
@@ -66,7 +68,8 @@ static size_t ucp_tag_pack_eager_first_dt(void *dest, void *arg)
     ucs_assert(req->send.length > length);
     return sizeof(*hdr) + ucp_dt_pack(req->send.ep->worker, req->send.datatype,
                                       req->send.mem_type, hdr + 1, req->send.buffer,
-                                      &req->send.state.dt, length);
+                                      &req->send.state.dt, length,
+                                      req->send.length);
 }
 
 static size_t ucp_tag_pack_eager_sync_first_dt(void *dest, void *arg)
@@ -89,7 +92,8 @@ static size_t ucp_tag_pack_eager_sync_first_dt(void *dest, void *arg)
     ucs_assert(req->send.length > length);
     return sizeof(*hdr) + ucp_dt_pack(req->send.ep->worker, req->send.datatype,
                                       req->send.mem_type, hdr + 1, req->send.buffer,
-                                      &req->send.state.dt, length);
+                                      &req->send.state.dt, length,
+                                      req->send.length);
 }
 
 static size_t ucp_tag_pack_eager_middle_dt(void *dest, void *arg)
@@ -105,7 +109,8 @@ static size_t ucp_tag_pack_eager_middle_dt(void *dest, void *arg)
     hdr->offset     = req->send.state.dt.offset;
     return sizeof(*hdr) + ucp_dt_pack(req->send.ep->worker, req->send.datatype,
                                       req->send.mem_type, hdr + 1, req->send.buffer,
-                                      &req->send.state.dt, length);
+                                      &req->send.state.dt, length,
+                                      req->send.length);
 }
 
 /* eager */
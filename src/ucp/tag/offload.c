@@ -78,11 +78,16 @@ ucp_tag_offload_release_buf(ucp_request_t *req, int dereg)
 UCS_PROFILE_FUNC_VOID(ucp_tag_offload_tag_consumed, (self),
                       uct_tag_context_t *self)
 {
-    ucp_request_t *req = ucs_container_of(self, ucp_request_t, recv.uct_ctx);
+    ucp_request_t *req       = ucs_container_of(self, ucp_request_t, recv.uct_ctx);
+    ucp_tag_match_t *tm      = &req->recv.worker->tm;
+    ucp_tag_exp_hash_t *hash = ucp_tag_exp_get_req_hash(tm, req);
     ucs_queue_head_t *queue;
 
-    queue = &ucp_tag_exp_get_req_queue(&req->recv.worker->tm, req)->queue;
+    queue = &ucp_tag_exp_get_req_queue(tm, req)->queue;
     ucs_queue_remove(queue, &req->recv.queue);
+    if (hash != NULL) {
+        ucp_tag_exp_hash_del(tm, hash);
+    }
 }
 
 /* Message is scattered to user buffer by the transport, complete the request */
@@ -185,6 +190,7 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_tag_offload_unexp_rndv,
         dummy_rts->sreq.reqptr      = rndv_hdr->reqptr;
         dummy_rts->address          = remote_addr;
         dummy_rts->size             = length;
+        dummy_rts->iovcnt           = 0;
 
         ucp_rkey_packed_copy(worker->context, UCS_BIT(md_index),
                              UCT_MD_MEM_TYPE_HOST, dummy_rts + 1, uct_rkeys);
@@ -406,6 +412,7 @@ UCS_PROFILE_FUNC(int, ucp_tag_offload_post, (req, req_queue),
             return 0;
         }
     } else if (worker->tm.expected.wildcard.sw_count ||
+               worker->tm.expected.src_sw_count ||
                (req_queue->sw_count && !ucp_tag_offload_post_sw_reqs(req, req_queue))) {
         /* There are some requests which must be completed in SW */
         UCP_WORKER_STAT_TAG_OFFLOAD(worker, BLOCK_SW_PEND);
@@ -426,7 +433,8 @@ static size_t ucp_tag_offload_pack_eager(void *dest, void *arg)
 
     length = ucp_dt_pack(req->send.ep->worker, req->send.datatype,
                          req->send.mem_type, dest, req->send.buffer,
-                         &req->send.state.dt, req->send.length);
+                         &req->send.state.dt, req->send.length,
+                         req->send.length);
     ucs_assert(length == req->send.length);
     return length;
 }
@@ -11,6 +11,18 @@
 #include <ucp/proto/proto.h>
 #include <ucp/proto/proto_am.inl>
 #include <ucs/datastruct/queue.h>
+#include <ucs/sys/sys.h>
+
+
+/* Copy of rendezvous data from a mapped sender's buffer, split between
+ * several threads */
+typedef struct {
+    void                      *dest;
+    const void                *src;
+    size_t                    length;
+    unsigned                  count;    /* number of copy threads */
+} ucp_rndv_copy_t;
+
 
 static int ucp_rndv_is_get_zcopy(ucp_request_t *sreq, ucp_rndv_mode_t rndv_mode)
 {
@@ -39,6 +51,39 @@ static int ucp_rndv_is_pipeline_needed(ucp_request_t *sreq) {
     return md_attr->cap.reg_mem_types & UCS_BIT(UCT_MD_MEM_TYPE_HOST);
 }
 
+static size_t ucp_tag_rndv_rts_pack_iov(ucp_request_t *sreq,
+                                        ucp_rndv_rts_hdr_t *rndv_rts_hdr)
+{
+    const ucp_dt_iov_t *iov  = sreq->send.buffer;
+    ucp_dt_reg_t *dt_reg     = sreq->send.state.dt.dt.iov.dt_reg;
+    ucp_rndv_rts_iov_t *rts_iov = (ucp_rndv_rts_iov_t*)(rndv_rts_hdr + 1);
+    ssize_t packed_rkey_size;
+    size_t iov_it;
+
+    for (iov_it = 0; iov_it < sreq->send.state.dt.dt.iov.iovcnt; ++iov_it) {
+        if (iov[iov_it].length == 0) {
+            continue;
+        }
+
+        rts_iov->address = (uintptr_t)iov[iov_it].buffer;
+        rts_iov->length  = iov[iov_it].length;
+        packed_rkey_size = ucp_rkey_pack_uct(sreq->send.ep->worker->context,
+                                             dt_reg[iov_it].md_map,
+                                             dt_reg[iov_it].memh,
+                                             sreq->send.mem_type, rts_iov + 1);
+        if (packed_rkey_size < 0) {
+            ucs_fatal("failed to pack rendezvous remote key: %s",
+                      ucs_status_string(packed_rkey_size));
+        }
+
+        rts_iov->rkey_size = packed_rkey_size;
+        rts_iov            = (void*)(rts_iov + 1) + packed_rkey_size;
+        ++rndv_rts_hdr->iovcnt;
+    }
+
+    return (void*)rts_iov - (void*)(rndv_rts_hdr + 1);
+}
+
 size_t ucp_tag_rndv_rts_pack(void *dest, void *arg)
 {
     ucp_request_t *sreq              = arg;   /* send request */
@@ -50,6 +95,7 @@ size_t ucp_tag_rndv_rts_pack(void *dest, void *arg)
     rndv_rts_hdr->sreq.reqptr      = (uintptr_t)sreq;
     rndv_rts_hdr->sreq.ep_ptr      = ucp_request_get_dest_ep_ptr(sreq);
     rndv_rts_hdr->size             = sreq->send.length;
+    rndv_rts_hdr->iovcnt           = 0;
 
     /* Pack remote keys (which can be empty list) */
     if (UCP_DT_IS_CONTIG(sreq->send.datatype) &&
@@ -65,6 +111,12 @@ size_t ucp_tag_rndv_rts_pack(void *dest, void *arg)
             ucs_fatal("failed to pack rendezvous remote key: %s",
                       ucs_status_string(packed_rkey_size));
         }
+    } else if (UCP_DT_IS_IOV(sreq->send.datatype) &&
+               (sreq->send.state.dt.dt.iov.dt_reg != NULL)) {
+        /* pack the registered IOV entries, ask target to do get_zcopy */
+        rndv_rts_hdr->address = 0;
+        packed_rkey_size      = ucp_tag_rndv_rts_pack_iov(sreq,
+                                                          rndv_rts_hdr);
     } else {
         rndv_rts_hdr->address = 0;
         packed_rkey_size      = 0;
@@ -124,6 +176,41 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_proto_progress_rndv_rtr, (self),
     return status;
 }
 
+/* Register the entries of an IOV buffer, to let the receiver read them with
+ * get_zcopy. If registration fails, or the keys of all entries would not fit
+ * in the RTS, the data is sent with active messages. */
+static void ucp_tag_rndv_reg_iov(ucp_request_t *sreq)
+{
+    ucp_ep_h ep             = sreq->send.ep;
+    ucp_context_h context   = ep->worker->context;
+    ucp_md_map_t md_map     = ucp_ep_config(ep)->key.rma_bw_md_map;
+    ucs_status_t status;
+    size_t iovcnt;
+
+    if ((md_map == 0) || !UCP_MEM_IS_HOST(sreq->send.mem_type)) {
+        return;
+    }
+
+    iovcnt = ucp_dt_iov_count_nonempty(sreq->send.buffer,
+                                       sreq->send.state.dt.dt.iov.iovcnt);
+    if ((iovcnt == 0) || (iovcnt > UINT16_MAX) ||
+        ((sizeof(ucp_rndv_rts_hdr_t) +
+          (iovcnt * (sizeof(ucp_rndv_rts_iov_t) +
+                     ucp_rkey_packed_size(context, md_map)))) >
+         ucp_ep_config(ep)->am.max_bcopy)) {
+        return;
+    }
+
+    status = ucp_request_memory_reg(context, md_map, sreq->send.buffer,
+                                    sreq->send.length, sreq->send.datatype,
+                                    &sreq->send.state.dt, sreq->send.mem_type,
+                                    sreq, UCT_MD_MEM_FLAG_HIDE_ERRORS);
+    if (status != UCS_OK) {
+        ucp_trace_req(sreq, "failed to register iov for rndv get: %s",
+                      ucs_status_string(status));
+    }
+}
+
 ucs_status_t ucp_tag_send_start_rndv(ucp_request_t *sreq)
 {
     ucp_ep_h ep = sreq->send.ep;
@@ -148,12 +235,17 @@ ucs_status_t ucp_tag_send_start_rndv(ucp_request_t *sreq)
     } else {
         if (UCP_DT_IS_CONTIG(sreq->send.datatype) &&
             ucp_rndv_is_get_zcopy(sreq, ep->worker->context->config.ext.rndv_mode)) {
-            /* register a contiguous buffer for rma_get */
-            md_map = ucp_ep_config(ep)->key.rma_bw_md_map;
+            /* register a contiguous buffer for rma_get, or for mapping it to
+             * the receiver's address space */
+            md_map = ucp_ep_config(ep)->key.rma_bw_md_map |
+                     ucp_ep_config(ep)->tag.rndv.rkey_ptr_md_map;
             status = ucp_request_send_buffer_reg(sreq, md_map);
             if (status != UCS_OK) {
                 return status;
             }
+        } else if (UCP_DT_IS_IOV(sreq->send.datatype) &&
+                   ucp_rndv_is_get_zcopy(sreq, ep->worker->context->config.ext.rndv_mode)) {
+            ucp_tag_rndv_reg_iov(sreq);
         }
 
         ucs_assert(sreq->send.lane == ucp_ep_get_am_lane(ep));
@@ -224,6 +316,22 @@ static void ucp_rndv_zcopy_recv_req_complete(ucp_request_t *req, ucs_status_t st
     ucp_request_complete_tag_recv(req, status);
 }
 
+static void ucp_rndv_get_rkeys_destroy(ucp_request_t *rndv_req)
+{
+    size_t iov_it;
+
+    if (rndv_req->send.rndv_get.iov == NULL) {
+        ucp_rkey_destroy(rndv_req->send.rndv_get.rkey);
+        return;
+    }
+
+    for (iov_it = 0; iov_it < rndv_req->send.rndv_get.iovcnt; ++iov_it) {
+        ucp_rkey_destroy(rndv_req->send.rndv_get.iov[iov_it].rkey);
+    }
+    ucs_free(rndv_req->send.rndv_get.iov);
+    rndv_req->send.rndv_get.iov = NULL;
+}
+
 static void ucp_rndv_complete_rma_get_zcopy(ucp_request_t *rndv_req)
 {
     ucp_request_t *rreq = rndv_req->send.rndv_get.rreq;
@@ -235,7 +343,7 @@ static void ucp_rndv_complete_rma_get_zcopy(ucp_request_t *rndv_req)
     ucp_trace_req(rndv_req, "rndv_get completed");
     UCS_PROFILE_REQUEST_EVENT(rreq, "complete_rndv_get", 0);
 
-    ucp_rkey_destroy(rndv_req->send.rndv_get.rkey);
+    ucp_rndv_get_rkeys_destroy(rndv_req);
     ucp_request_send_buffer_dereg(rndv_req);
 
     ucp_rndv_req_send_ats(rndv_req, rreq, rndv_req->send.rndv_get.remote_request);
@@ -320,31 +428,102 @@ static ucp_lane_index_t ucp_rndv_get_next_lane(ucp_request_t *rndv_req, uct_rkey
     return lane;
 }
 
+/* Select the lane of the next get_zcopy operation, and register the local
+ * buffer on it. Returns UCP_NULL_LANE if the remote key is not reachable. */
+static ucp_lane_index_t ucp_rndv_get_zcopy_lane(ucp_request_t *rndv_req,
+                                                uct_rkey_t *uct_rkey)
+{
+    ucs_status_t status;
+    ucp_lane_index_t lane;
+
+    ucp_rndv_get_lanes_count(rndv_req);
+
+    rndv_req->send.lane = lane = ucp_rndv_get_next_lane(rndv_req, uct_rkey);
+    if ((lane != UCP_NULL_LANE) && !rndv_req->send.mdesc) {
+        status = ucp_send_request_add_reg_lane(rndv_req, lane);
+        ucs_assert_always(status == UCS_OK);
+    }
+
+    return lane;
+}
+
+/* Read the next part of the data, which starts at the current offset of the
+ * request, and complete the request when all the data has arrived */
+static ucs_status_t ucp_rndv_get_zcopy_post(ucp_request_t *rndv_req,
+                                            ucp_lane_index_t lane,
+                                            uint64_t remote_address,
+                                            uct_rkey_t uct_rkey, size_t length)
+{
+    ucp_ep_h ep             = rndv_req->send.ep;
+    const size_t max_iovcnt = 1;
+    uct_iov_t iov[max_iovcnt];
+    size_t iovcnt;
+    ucp_dt_state_t state;
+    ucs_status_t status;
+    int pending_add_res;
+
+    state = rndv_req->send.state.dt;
+    /* TODO: is this correct? memh array may skip MD's where
+     * registration is not supported. for now SHM may avoid registration,
+     * but it will work on single lane */
+    ucp_dt_iov_copy_uct(ep->worker->context, iov, &iovcnt, max_iovcnt, &state,
+                        rndv_req->send.buffer, ucp_dt_make_contig(1), length,
+                        ucp_ep_md_index(ep, lane),
+                        rndv_req->send.mdesc);
+
+    for (;;) {
+        status = uct_ep_get_zcopy(ep->uct_eps[lane],
+                                  iov, iovcnt,
+                                  remote_address,
+                                  uct_rkey,
+                                  &rndv_req->send.state.uct_comp);
+        ucp_request_send_state_advance(rndv_req, &state,
+                                       UCP_REQUEST_SEND_PROTO_RNDV_GET,
+                                       status);
+        if (rndv_req->send.state.dt.offset == rndv_req->send.length) {
+            if (rndv_req->send.state.uct_comp.count == 0) {
+                ucp_rndv_complete_rma_get_zcopy(rndv_req);
+            }
+            return UCS_OK;
+        } else if (!UCS_STATUS_IS_ERR(status)) {
+            /* in case if not all chunks are transmitted - return in_progress
+             * status */
+            return UCS_INPROGRESS;
+        } else {
+            if (status == UCS_ERR_NO_RESOURCE) {
+                if (lane != rndv_req->send.pending_lane) {
+                    /* switch to new pending lane */
+                    pending_add_res = ucp_request_pending_add(rndv_req, &status, 0);
+                    if (!pending_add_res) {
+                        /* failed to switch req to pending queue, try again */
+                        continue;
+                    }
+                    ucs_assert(status == UCS_INPROGRESS);
+                    return UCS_OK;
+                }
+            }
+            return status;
+        }
+    }
+}
+
 UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_progress_rma_get_zcopy, (self),
                  uct_pending_req_t *self)
 {
     ucp_request_t *rndv_req = ucs_container_of(self, ucp_request_t, send.uct);
     ucp_ep_h ep             = rndv_req->send.ep;
     ucp_ep_config_t *config = ucp_ep_config(ep);
-    const size_t max_iovcnt = 1;
     uct_iface_attr_t* attrs;
-    ucs_status_t status;
     size_t offset, length, ucp_mtu, remainder, align, chunk;
-    uct_iov_t iov[max_iovcnt];
-    size_t iovcnt;
     ucp_rsc_index_t rsc_index;
-    ucp_dt_state_t state;
     uct_rkey_t uct_rkey;
     size_t min_zcopy;
     size_t max_zcopy;
     size_t tail;
-    int pending_add_res;
     ucp_lane_index_t lane;
 
-    ucp_rndv_get_lanes_count(rndv_req);
-
     /* Figure out which lane to use for get operation */
-    rndv_req->send.lane = lane = ucp_rndv_get_next_lane(rndv_req, &uct_rkey);
+    lane = ucp_rndv_get_zcopy_lane(rndv_req, &uct_rkey);
 
     if (lane == UCP_NULL_LANE) {
         /* If can't perform get_zcopy - switch to active-message.
@@ -358,11 +537,6 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_progress_rma_get_zcopy, (self),
         return UCS_OK;
     }
 
-    if (!rndv_req->send.mdesc) {
-        status = ucp_send_request_add_reg_lane(rndv_req, lane);
-        ucs_assert_always(status == UCS_OK);
-    }
-
     rsc_index = ucp_ep_get_rsc_index(ep, lane);
     attrs     = ucp_worker_iface_get_attr(ep->worker, rsc_index);
     align     = attrs->cap.get.opt_zcopy_align;
@@ -410,49 +584,56 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_progress_rma_get_zcopy, (self),
                    rndv_req, offset, remainder, rndv_req->send.buffer + offset,
                    length, lane);
 
-    state = rndv_req->send.state.dt;
-    /* TODO: is this correct? memh array may skip MD's where
-     * registration is not supported. for now SHM may avoid registration,
-     * but it will work on single lane */
-    ucp_dt_iov_copy_uct(ep->worker->context, iov, &iovcnt, max_iovcnt, &state,
-                        rndv_req->send.buffer, ucp_dt_make_contig(1), length,
-                        ucp_ep_md_index(ep, lane),
-                        rndv_req->send.mdesc);
+    return ucp_rndv_get_zcopy_post(rndv_req, lane,
+                                   rndv_req->send.rndv_get.remote_address + offset,
+                                   uct_rkey, length);
+}
 
-    for (;;) {
-        status = uct_ep_get_zcopy(ep->uct_eps[lane],
-                                  iov, iovcnt,
-                                  rndv_req->send.rndv_get.remote_address + offset,
-                                  uct_rkey,
-                                  &rndv_req->send.state.uct_comp);
-        ucp_request_send_state_advance(rndv_req, &state,
-                                       UCP_REQUEST_SEND_PROTO_RNDV_GET,
-                                       status);
-        if (rndv_req->send.state.dt.offset == rndv_req->send.length) {
-            if (rndv_req->send.state.uct_comp.count == 0) {
-                ucp_rndv_complete_rma_get_zcopy(rndv_req);
-            }
-            return UCS_OK;
-        } else if (!UCS_STATUS_IS_ERR(status)) {
-            /* in case if not all chunks are transmitted - return in_progress
-             * status */
-            return UCS_INPROGRESS;
-        } else {
-            if (status == UCS_ERR_NO_RESOURCE) {
-                if (lane != rndv_req->send.pending_lane) {
-                    /* switch to new pending lane */
-                    pending_add_res = ucp_request_pending_add(rndv_req, &status, 0);
-                    if (!pending_add_res) {
-                        /* failed to switch req to pending queue, try again */
-                        continue;
-                    }
-                    ucs_assert(status == UCS_INPROGRESS);
-                    return UCS_OK;
-                }
-            }
-            return status;
-        }
+/* Read the next part of the sender's IOV buffer. Every remote entry has its own
+ * key, so each get_zcopy operation reads from a single entry. */
+UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_progress_rma_get_zcopy_iov, (self),
+                 uct_pending_req_t *self)
+{
+    ucp_request_t *rndv_req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_ep_config_t *config = ucp_ep_config(rndv_req->send.ep);
+    const ucp_rndv_get_iov_t *remote_iov;
+    size_t offset, remote_offset, length, tail;
+    uct_rkey_t uct_rkey;
+    ucp_lane_index_t lane;
+
+    /* find the remote entry of the current offset, starting from the entry
+     * of the previous call, since the offset only grows */
+    offset     = rndv_req->send.state.dt.offset;
+    remote_iov = &rndv_req->send.rndv_get.iov[rndv_req->send.rndv_get.iov_index];
+    while ((offset - rndv_req->send.rndv_get.iov_offset) >= remote_iov->length) {
+        rndv_req->send.rndv_get.iov_offset += remote_iov->length;
+        ++rndv_req->send.rndv_get.iov_index;
+        ++remote_iov;
     }
+    ucs_assert(rndv_req->send.rndv_get.iov_index <
+               rndv_req->send.rndv_get.iovcnt);
+    remote_offset = offset - rndv_req->send.rndv_get.iov_offset;
+
+    /* the lanes of all entries were checked when the RTS was matched */
+    rndv_req->send.rndv_get.rkey = remote_iov->rkey;
+    lane = ucp_rndv_get_zcopy_lane(rndv_req, &uct_rkey);
+    ucs_assert_always(lane != UCP_NULL_LANE);
+
+    /* keep the rest of the entry over min_zcopy */
+    length = ucs_min(remote_iov->length - remote_offset,
+                     config->tag.rndv.max_get_zcopy);
+    tail   = remote_iov->length - (remote_offset + length);
+    if (ucs_unlikely(tail && (tail < config->tag.rndv.min_get_zcopy))) {
+        length -= config->tag.rndv.min_get_zcopy;
+    }
+
+    ucs_trace_data("req %p: offset %zu rma-get to %p len %zu from 0x%"PRIx64
+                   " lane %d", rndv_req, offset, rndv_req->send.buffer + offset,
+                   length, remote_iov->address + remote_offset, lane);
+
+    return ucp_rndv_get_zcopy_post(rndv_req, lane,
+                                   remote_iov->address + remote_offset,
+                                   uct_rkey, length);
 }
 
 UCS_PROFILE_FUNC_VOID(ucp_rndv_get_completion, (self, status),
@@ -476,8 +657,88 @@ static void ucp_rndv_put_completion(uct_completion_t *self, ucs_status_t status)
     }
 }
 
-static void ucp_rndv_req_send_rma_get(ucp_request_t *rndv_req, ucp_request_t *rreq,
-                                      const ucp_rndv_rts_hdr_t *rndv_rts_hdr)
+static void ucp_rndv_copy_part(void *arg, unsigned index)
+{
+    ucp_rndv_copy_t *copy = arg;
+    size_t part_length, offset;
+
+    part_length = ucs_align_up(ucs_div_round_up(copy->length, copy->count),
+                               UCS_SYS_CACHE_LINE_SIZE);
+    offset      = index * part_length;
+    if (offset < copy->length) {
+        ucs_memcpy_relaxed_part(copy->dest + offset, copy->src + offset,
+                                ucs_min(part_length, copy->length - offset),
+                                copy->length);
+    }
+}
+
+/* Check whether the data can be copied directly from the sender's buffer,
+ * which is mapped to the local address space, and fill the copy descriptor.
+ * Returns 0 if the data should be read with get_zcopy. */
+static int ucp_rndv_rkey_ptr_copy_init(ucp_request_t *rndv_req,
+                                       ucp_request_t *rreq,
+                                       const ucp_rndv_rts_hdr_t *rndv_rts_hdr,
+                                       ucp_rndv_copy_t *copy)
+{
+    ucp_context_h context = rndv_req->send.ep->worker->context;
+    ucp_rkey_h rkey       = rndv_req->send.rndv_get.rkey;
+    void *src, *src_end;
+    ucs_status_t status;
+
+    if (!ucp_ep_config(rndv_req->send.ep)->tag.rndv.rkey_ptr_md_map ||
+        !UCP_MEM_IS_HOST(rreq->recv.mem_type) ||
+        !UCP_MEM_IS_HOST(rkey->mem_type) || (rndv_rts_hdr->size == 0)) {
+        return 0;
+    }
+
+    /* both ends of the buffer must be in the same mapped segment */
+    status = ucp_rkey_ptr(rkey, rndv_rts_hdr->address, &src);
+    if (status != UCS_OK) {
+        return 0;
+    }
+
+    status = ucp_rkey_ptr(rkey, rndv_rts_hdr->address + rndv_rts_hdr->size - 1,
+                          &src_end);
+    if ((status != UCS_OK) || (src_end != src + rndv_rts_hdr->size - 1)) {
+        return 0;
+    }
+
+    copy->dest   = rreq->recv.buffer;
+    copy->src    = src;
+    copy->length = rndv_rts_hdr->size;
+    copy->count  = ucs_max(1, ucs_min(context->config.ext.rndv_copy_threads,
+                                      copy->length /
+                                      ucs_max(context->config.ext.rndv_copy_thread_size, 1)));
+    return 1;
+}
+
+/* Copy the data from the mapped sender's buffer and complete the receive.
+ * Called without the async lock, so the copy does not hold back the async
+ * progress of the worker. */
+static void ucp_rndv_rkey_ptr_copy(ucp_request_t *rndv_req, ucp_request_t *rreq,
+                                   uintptr_t remote_request,
+                                   ucp_rndv_copy_t *copy)
+{
+    ucp_worker_h worker = rndv_req->send.ep->worker;
+
+    ucp_trace_req(rndv_req, "rkey_ptr copy from %p length %zu with %u threads",
+                  copy->src, copy->length, copy->count);
+    UCS_PROFILE_CALL_VOID(ucs_sys_thread_pool_run, worker->rndv_copy_pool,
+                          ucp_rndv_copy_part, copy, copy->count);
+
+    UCS_ASYNC_BLOCK(&worker->async);
+    UCS_PROFILE_REQUEST_EVENT(rreq, "complete_rndv_rkey_ptr", 0);
+    ucp_rkey_destroy(rndv_req->send.rndv_get.rkey);
+    ucp_rndv_req_send_ats(rndv_req, rreq, remote_request);
+    ucp_rndv_zcopy_recv_req_complete(rreq, UCS_OK);
+    UCS_ASYNC_UNBLOCK(&worker->async);
+}
+
+/* Start reading the data with get_zcopy. Returns 1 if the data should be
+ * copied from the mapped sender's buffer instead, as described by copy. */
+static int ucp_rndv_req_send_rma_get(ucp_request_t *rndv_req, ucp_request_t *rreq,
+                                     const ucp_rndv_rts_hdr_t *rndv_rts_hdr,
+                                     ucp_rndv_copy_t *copy)
 {
     ucs_status_t status;
 
@@ -493,6 +754,8 @@ static void ucp_rndv_req_send_rma_get(ucp_request_t *rndv_req, ucp_request_t *rr
     rndv_req->send.rndv_get.rreq           = rreq;
     rndv_req->send.rndv_get.lanes_map      = 0;
     rndv_req->send.rndv_get.lane_count     = 0;
+    rndv_req->send.rndv_get.iov            = NULL;
+    rndv_req->send.rndv_get.iovcnt         = 0;
     rndv_req->send.datatype                = rreq->recv.datatype;
 
     status = ucp_ep_rkey_unpack(rndv_req->send.ep, rndv_rts_hdr + 1,
@@ -502,19 +765,104 @@ static void ucp_rndv_req_send_rma_get(ucp_request_t *rndv_req, ucp_request_t *rr
                   ucp_ep_peer_name(rndv_req->send.ep), ucs_status_string(status));
     }
 
+    if (ucp_rndv_rkey_ptr_copy_init(rndv_req, rreq, rndv_rts_hdr, copy)) {
+        return 1;
+    }
+
+    ucp_request_send_state_init(rndv_req, ucp_dt_make_contig(1), 0);
+    ucp_request_send_state_reset(rndv_req, ucp_rndv_get_completion,
+                                 UCP_REQUEST_SEND_PROTO_RNDV_GET);
+
+    ucp_request_send(rndv_req, 0);
+    return 0;
+}
+
+/* Read the data of an IOV buffer of the sender with get_zcopy of each entry.
+ * Returns 0 if the data should be requested with RTR instead. */
+static int ucp_rndv_req_send_rma_get_iov(ucp_request_t *rndv_req,
+                                         ucp_request_t *rreq,
+                                         const ucp_rndv_rts_hdr_t *rndv_rts_hdr)
+{
+    ucp_ep_h ep                       = rndv_req->send.ep;
+    const ucp_rndv_rts_iov_t *rts_iov = (const void*)(rndv_rts_hdr + 1);
+    ucp_rndv_get_iov_t *iov;
+    uct_rkey_t uct_rkey;
+    ucs_status_t status;
+    size_t iov_it;
+
+    if (!UCP_MEM_IS_HOST(rreq->recv.mem_type)) {
+        return 0;
+    }
+
+    iov = ucs_malloc(sizeof(*iov) * rndv_rts_hdr->iovcnt, "rndv_get_iov");
+    if (iov == NULL) {
+        return 0;
+    }
+
+    for (iov_it = 0; iov_it < rndv_rts_hdr->iovcnt; ++iov_it) {
+        iov[iov_it].address = rts_iov->address;
+        iov[iov_it].length  = rts_iov->length;
+
+        status = ucp_ep_rkey_unpack(ep, rts_iov + 1, &iov[iov_it].rkey);
+        if (status != UCS_OK) {
+            ucs_fatal("failed to unpack rendezvous remote key received from %s: %s",
+                      ucp_ep_peer_name(ep), ucs_status_string(status));
+        }
+
+        /* every entry must be readable by itself */
+        if ((iov[iov_it].length < ucp_ep_config(ep)->tag.rndv.min_get_zcopy) ||
+            (ucp_rkey_get_rma_bw_lane(iov[iov_it].rkey, ep, rreq->recv.mem_type,
+                                      &uct_rkey, 0) == UCP_NULL_LANE)) {
+            ucp_trace_req(rndv_req, "cannot get remote iov entry %zu", iov_it);
+            ++iov_it;
+            goto err_destroy_rkeys;
+        }
+
+        rts_iov = (const void*)(rts_iov + 1) + rts_iov->rkey_size;
+    }
+
+    ucp_trace_req(rndv_req, "start rma_get of %u iov entries rreq %p",
+                  rndv_rts_hdr->iovcnt, rreq);
+
+    rndv_req->send.uct.func                = ucp_rndv_progress_rma_get_zcopy_iov;
+    rndv_req->send.buffer                  = rreq->recv.buffer;
+    rndv_req->send.mem_type                = rreq->recv.mem_type;
+    rndv_req->send.datatype                = rreq->recv.datatype;
+    rndv_req->send.length                  = rndv_rts_hdr->size;
+    rndv_req->send.rndv_get.remote_request = rndv_rts_hdr->sreq.reqptr;
+    rndv_req->send.rndv_get.remote_address = 0;
+    rndv_req->send.rndv_get.rreq           = rreq;
+    rndv_req->send.rndv_get.rkey           = iov[0].rkey;
+    rndv_req->send.rndv_get.lanes_map      = 0;
+    rndv_req->send.rndv_get.lane_count     = 0;
+    rndv_req->send.rndv_get.iov            = iov;
+    rndv_req->send.rndv_get.iovcnt         = rndv_rts_hdr->iovcnt;
+    rndv_req->send.rndv_get.iov_index      = 0;
+    rndv_req->send.rndv_get.iov_offset     = 0;
+
     ucp_request_send_state_init(rndv_req, ucp_dt_make_contig(1), 0);
     ucp_request_send_state_reset(rndv_req, ucp_rndv_get_completion,
                                  UCP_REQUEST_SEND_PROTO_RNDV_GET);
 
     ucp_request_send(rndv_req, 0);
+    return 1;
+
+err_destroy_rkeys:
+    while (iov_it-- > 0) {
+        ucp_rkey_destroy(iov[iov_it].rkey);
+    }
+    ucs_free(iov);
+    return 0;
 }
 
 UCS_PROFILE_FUNC_VOID(ucp_rndv_matched, (worker, rreq, rndv_rts_hdr),
                       ucp_worker_h worker, ucp_request_t *rreq,
                       const ucp_rndv_rts_hdr_t *rndv_rts_hdr)
 {
+    ucp_request_t *rndv_req = NULL;
+    int rkey_ptr_copy       = 0;
     ucp_rndv_mode_t rndv_mode;
-    ucp_request_t *rndv_req;
+    ucp_rndv_copy_t copy;
     ucp_ep_h ep;
 
     UCS_ASYNC_BLOCK(&worker->async);
@@ -562,7 +910,12 @@ UCS_PROFILE_FUNC_VOID(ucp_rndv_matched, (worker, rreq, rndv_rts_hdr),
     if (UCP_DT_IS_CONTIG(rreq->recv.datatype)) {
         if (rndv_rts_hdr->address && (rndv_mode != UCP_RNDV_MODE_PUT_ZCOPY)) {
             /* try to fetch the data with a get_zcopy operation */
-            ucp_rndv_req_send_rma_get(rndv_req, rreq, rndv_rts_hdr);
+            rkey_ptr_copy = ucp_rndv_req_send_rma_get(rndv_req, rreq,
+                                                      rndv_rts_hdr, &copy);
+            goto out;
+        } else if (rndv_rts_hdr->iovcnt && (rndv_mode != UCP_RNDV_MODE_PUT_ZCOPY) &&
+                   ucp_rndv_req_send_rma_get_iov(rndv_req, rreq, rndv_rts_hdr)) {
+            /* fetch every entry of the sender's iov with get_zcopy */
             goto out;
         } else if (rndv_mode != UCP_RNDV_MODE_GET_ZCOPY) {
             /* put protocol is allowed - register receive buffer memory for rma */
@@ -579,6 +932,10 @@ UCS_PROFILE_FUNC_VOID(ucp_rndv_matched, (worker, rreq, rndv_rts_hdr),
 
 out:
     UCS_ASYNC_UNBLOCK(&worker->async);
+
+    if (rkey_ptr_copy) {
+        ucp_rndv_rkey_ptr_copy(rndv_req, rreq, rndv_rts_hdr->sreq.reqptr, &copy);
+    }
 }
 
 ucs_status_t ucp_rndv_process_rts(void *arg, void *data, size_t length,
@@ -662,7 +1019,8 @@ static size_t ucp_rndv_pack_data(void *dest, void *arg)
 
     return sizeof(*hdr) + ucp_dt_pack(sreq->send.ep->worker, sreq->send.datatype,
                                       sreq->send.mem_type, hdr + 1, sreq->send.buffer,
-                                      &sreq->send.state.dt, length);
+                                      &sreq->send.state.dt, length,
+                                      sreq->send.length);
 }
 
 UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_progress_am_bcopy, (self),
@@ -889,6 +1247,8 @@ static ucs_status_t ucp_rndv_pipeline(ucp_request_t *sreq, ucp_rndv_rtr_hdr_t *r
         frag_req->send.rndv_get.remote_address   = (uint64_t)(sreq->send.buffer + offset);
         frag_req->send.rndv_get.lanes_map        = 0;
         frag_req->send.rndv_get.lane_count       = 0;
+        frag_req->send.rndv_get.iov              = NULL;
+        frag_req->send.rndv_get.iovcnt           = 0;
         frag_req->send.rndv_get.rreq             = sreq;
         frag_req->send.mdesc                     = mdesc;
 
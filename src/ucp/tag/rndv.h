@@ -23,9 +23,21 @@ typedef struct {
     ucp_request_hdr_t         sreq;     /* send request on the rndv initiator side */
     uint64_t                  address;  /* holds the address of the data buffer on the sender's side */
     size_t                    size;     /* size of the data for sending */
-    /* packed rkeys follow */
+    uint16_t                  iovcnt;   /* number of IOV entries which follow
+                                           instead of the packed rkeys */
+    /* packed rkeys, or iovcnt entries of ucp_rndv_rts_iov_t, follow */
 } UCS_S_PACKED ucp_rndv_rts_hdr_t;
 
+/*
+ * Entry of the sender's IOV buffer in the rendezvous RTS
+ */
+typedef struct {
+    uint64_t                  address;   /* address of the entry data */
+    uint64_t                  length;    /* length of the entry data */
+    uint16_t                  rkey_size; /* size of the packed rkey */
+    /* packed rkey follows */
+} UCS_S_PACKED ucp_rndv_rts_iov_t;
+
 /*
  * Rendezvous RTR
  */
@@ -36,6 +48,15 @@ typedef struct {
     /* packed rkeys follow */
 } UCS_S_PACKED ucp_rndv_rtr_hdr_t;
 
+/*
+ * Entry of the sender's IOV buffer, read by the receiver with get_zcopy
+ */
+struct ucp_rndv_get_iov {
+    uint64_t                  address;  /* address of the entry on the sender */
+    size_t                    length;   /* length of the entry */
+    ucp_rkey_h                rkey;     /* key for the entry */
+};
+
 /*
  * RNDV_DATA
  */
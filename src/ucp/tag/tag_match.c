@@ -8,37 +8,131 @@
 #include <ucp/tag/offload.h>
 
 
-ucs_status_t ucp_tag_match_init(ucp_tag_match_t *tm)
+#if ENABLE_STATS
+static ucs_stats_class_t ucp_tag_match_stats_class = {
+    .name           = "tag_match",
+    .num_counters   = UCP_TAG_MATCH_STAT_LAST,
+    .counter_names  = {
+        [UCP_TAG_MATCH_STAT_EXP_HASH_RESIZE]      = "exp_hash_resize",
+        [UCP_TAG_MATCH_STAT_EXP_BUCKET_SEARCH]    = "exp_bucket_search",
+        [UCP_TAG_MATCH_STAT_EXP_BUCKET_STEPS]     = "exp_bucket_steps",
+        [UCP_TAG_MATCH_STAT_EXP_BUCKET_MAX]       = "exp_bucket_max",
+        [UCP_TAG_MATCH_STAT_UNEXP_HASH_RESIZE]    = "unexp_hash_resize",
+        [UCP_TAG_MATCH_STAT_UNEXP_BUCKET_SEARCH]  = "unexp_bucket_search",
+        [UCP_TAG_MATCH_STAT_UNEXP_BUCKET_STEPS]   = "unexp_bucket_steps",
+        [UCP_TAG_MATCH_STAT_UNEXP_BUCKET_MAX]     = "unexp_bucket_max"
+    }
+};
+#endif
+
+
+static ucp_request_queue_t *ucp_tag_exp_hash_alloc_buckets(unsigned size_log)
 {
-    size_t hash_size, bucket;
+    size_t hash_size = UCS_BIT(size_log);
+    ucp_request_queue_t *buckets;
+    size_t bucket;
 
-    hash_size = ucs_roundup_pow2(UCP_TAG_MATCH_HASH_SIZE);
+    buckets = ucs_malloc(sizeof(*buckets) * hash_size, "ucp_tm_exp_hash");
+    if (buckets == NULL) {
+        return NULL;
+    }
+
+    for (bucket = 0; bucket < hash_size; ++bucket) {
+        buckets[bucket].sw_count    = 0;
+        buckets[bucket].block_count = 0;
+        ucs_queue_head_init(&buckets[bucket].queue);
+    }
+    return buckets;
+}
+
+static ucs_list_link_t *ucp_tag_unexp_hash_alloc_buckets(unsigned size_log)
+{
+    size_t hash_size = UCS_BIT(size_log);
+    ucs_list_link_t *buckets;
+    size_t bucket;
+
+    buckets = ucs_malloc(sizeof(*buckets) * hash_size, "ucp_tm_unexp_hash");
+    if (buckets == NULL) {
+        return NULL;
+    }
+
+    for (bucket = 0; bucket < hash_size; ++bucket) {
+        ucs_list_head_init(&buckets[bucket]);
+    }
+    return buckets;
+}
+
+static ucs_status_t ucp_tag_exp_hash_init(ucp_tag_exp_hash_t *hash,
+                                          uint64_t key_mask)
+{
+    hash->buckets = ucp_tag_exp_hash_alloc_buckets(UCP_TAG_MATCH_HASH_MIN_LOG);
+    if (hash->buckets == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    hash->key_mask = key_mask;
+    hash->size_log = UCP_TAG_MATCH_HASH_MIN_LOG;
+    hash->count    = 0;
+    return UCS_OK;
+}
+
+ucs_status_t ucp_tag_match_init(ucp_tag_match_t *tm, uint64_t sender_mask
+                                UCS_STATS_ARG(ucs_stats_node_t *stats_parent))
+{
+    ucs_status_t status;
 
     tm->expected.sn           = 0;
     tm->expected.sw_all_count = 0;
+    tm->expected.sender_mask  = sender_mask;
+    tm->expected.src_sw_count = 0;
     ucs_queue_head_init(&tm->expected.wildcard.queue);
     ucs_list_head_init(&tm->unexpected.all);
 
-    tm->expected.hash = ucs_malloc(sizeof(*tm->expected.hash) * hash_size,
-                                   "ucp_tm_exp_hash");
-    if (tm->expected.hash == NULL) {
-        return UCS_ERR_NO_MEMORY;
+    status = UCS_STATS_NODE_ALLOC(&tm->stats, &ucp_tag_match_stats_class,
+                                  stats_parent);
+    if (status != UCS_OK) {
+        goto err;
+    }
+
+    status = ucp_tag_exp_hash_init(&tm->expected.hash, UCP_TAG_MASK_FULL);
+    if (status != UCS_OK) {
+        goto err_free_stats;
+    }
+
+    status = ucp_tag_exp_hash_init(&tm->expected.src_hash, sender_mask);
+    if (status != UCS_OK) {
+        goto err_free_exp_hash;
     }
 
-    tm->unexpected.hash = ucs_malloc(sizeof(*tm->unexpected.hash) * hash_size,
-                                     "ucp_tm_unexp_hash");
+    tm->unexpected.hash = ucp_tag_unexp_hash_alloc_buckets(UCP_TAG_MATCH_HASH_MIN_LOG);
     if (tm->unexpected.hash == NULL) {
-        ucs_free(tm->expected.hash);
-        return UCS_ERR_NO_MEMORY;
+        status = UCS_ERR_NO_MEMORY;
+        goto err_free_src_hash;
     }
 
-    for (bucket = 0; bucket < hash_size; ++bucket) {
-        tm->expected.hash[bucket].sw_count    = 0;
-        tm->expected.hash[bucket].block_count = 0;
-        ucs_queue_head_init(&tm->expected.hash[bucket].queue);
-        ucs_list_head_init(&tm->unexpected.hash[bucket]);
+    tm->unexpected.hash_size_log = UCP_TAG_MATCH_HASH_MIN_LOG;
+    tm->unexpected.hash_count    = 0;
+
+    tm->unexpected.tags = ucs_malloc(sizeof(*tm->unexpected.tags) *
+                                     UCP_TAG_MATCH_UNEXP_TAGS_MIN,
+                                     "ucp_tm_unexp_tags");
+    if (tm->unexpected.tags == NULL) {
+        status = UCS_ERR_NO_MEMORY;
+        goto err_free_unexp_hash;
     }
 
+    tm->unexpected.rdescs = ucs_malloc(sizeof(*tm->unexpected.rdescs) *
+                                       UCP_TAG_MATCH_UNEXP_TAGS_MIN,
+                                       "ucp_tm_unexp_rdescs");
+    if (tm->unexpected.rdescs == NULL) {
+        status = UCS_ERR_NO_MEMORY;
+        goto err_free_unexp_tags;
+    }
+
+    tm->unexpected.tags_first = 0;
+    tm->unexpected.tags_last  = 0;
+    tm->unexpected.tags_size  = UCP_TAG_MATCH_UNEXP_TAGS_MIN;
+
     kh_init_inplace(ucp_tag_frag_hash, &tm->frag_hash);
     ucs_queue_head_init(&tm->offload.sync_reqs);
     kh_init_inplace(ucp_tag_offload_hash, &tm->offload.tag_hash);
@@ -47,14 +141,220 @@ ucs_status_t ucp_tag_match_init(ucp_tag_match_t *tm)
     tm->offload.iface        = NULL;
     tm->am.message_id        = ucs_generate_uuid(0);
     return UCS_OK;
+
+err_free_unexp_tags:
+    ucs_free(tm->unexpected.tags);
+err_free_unexp_hash:
+    ucs_free(tm->unexpected.hash);
+err_free_src_hash:
+    ucs_free(tm->expected.src_hash.buckets);
+err_free_exp_hash:
+    ucs_free(tm->expected.hash.buckets);
+err_free_stats:
+    UCS_STATS_NODE_FREE(tm->stats);
+err:
+    return status;
 }
 
 void ucp_tag_match_cleanup(ucp_tag_match_t *tm)
 {
     kh_destroy_inplace(ucp_tag_offload_hash, &tm->offload.tag_hash);
     kh_destroy_inplace(ucp_tag_frag_hash, &tm->frag_hash);
+    ucs_free(tm->unexpected.rdescs);
+    ucs_free(tm->unexpected.tags);
+    ucs_free(tm->unexpected.hash);
+    ucs_free(tm->expected.src_hash.buckets);
+    ucs_free(tm->expected.hash.buckets);
+    UCS_STATS_NODE_FREE(tm->stats);
+}
+
+static void ucp_tag_exp_hash_bucket_push(ucp_request_queue_t *bucket,
+                                         ucp_request_t *req)
+{
+    ucs_queue_push(&bucket->queue, &req->recv.queue);
+    if (!(req->flags & UCP_REQUEST_FLAG_OFFLOADED)) {
+        ++bucket->sw_count;
+        bucket->block_count += !!(req->flags & UCP_REQUEST_FLAG_BLOCK_OFFLOAD);
+    }
+}
+
+void ucp_tag_exp_hash_resize(ucp_tag_match_t *tm, ucp_tag_exp_hash_t *hash,
+                             unsigned size_log)
+{
+    size_t hash_size = UCS_BIT(size_log);
+    ucp_request_queue_t *buckets, *old_bucket;
+    ucs_queue_head_t *queue0, *queue1, *queue;
+    ucp_request_t *req0, *req1, *req;
+    size_t bucket;
+
+    buckets = ucp_tag_exp_hash_alloc_buckets(size_log);
+    if (buckets == NULL) {
+        ucs_debug("failed to resize tag hash to %zu buckets", hash_size);
+        return;
+    }
+
+    ucs_trace("resizing tag hash %p from %zu to %zu buckets, %u requests",
+              hash, (size_t)UCS_BIT(hash->size_log), hash_size, hash->count);
+
+    /* Bucket i of the larger table takes the requests of bucket i/2 of the
+     * smaller one. Requests of every bucket have to stay ordered by sequence
+     * number, as ucp_tag_exp_search_all() relies on it */
+    if (size_log > hash->size_log) {
+        for (bucket = 0; bucket < UCS_BIT(hash->size_log); ++bucket) {
+            old_bucket = &hash->buckets[bucket];
+            while (!ucs_queue_is_empty(&old_bucket->queue)) {
+                req = ucs_queue_pull_elem_non_empty(&old_bucket->queue,
+                                                    ucp_request_t, recv.queue);
+                ucp_tag_exp_hash_bucket_push(
+                        &buckets[ucp_tag_match_calc_hash(req->recv.tag.tag &
+                                                         hash->key_mask,
+                                                         size_log)],
+                        req);
+            }
+        }
+    } else {
+        for (bucket = 0; bucket < hash_size; ++bucket) {
+            queue0 = &hash->buckets[2 * bucket].queue;
+            queue1 = &hash->buckets[2 * bucket + 1].queue;
+            while (!ucs_queue_is_empty(queue0) || !ucs_queue_is_empty(queue1)) {
+                if (ucs_queue_is_empty(queue1)) {
+                    queue = queue0;
+                } else if (ucs_queue_is_empty(queue0)) {
+                    queue = queue1;
+                } else {
+                    req0  = ucs_queue_head_elem_non_empty(queue0, ucp_request_t,
+                                                          recv.queue);
+                    req1  = ucs_queue_head_elem_non_empty(queue1, ucp_request_t,
+                                                          recv.queue);
+                    queue = (req0->recv.tag.sn < req1->recv.tag.sn) ? queue0 :
+                            queue1;
+                }
+                req = ucs_queue_pull_elem_non_empty(queue, ucp_request_t,
+                                                    recv.queue);
+                ucp_tag_exp_hash_bucket_push(&buckets[bucket], req);
+            }
+        }
+    }
+
+    ucs_free(hash->buckets);
+    hash->buckets  = buckets;
+    hash->size_log = size_log;
+    UCS_STATS_UPDATE_COUNTER(tm->stats, UCP_TAG_MATCH_STAT_EXP_HASH_RESIZE, 1);
+}
+
+void ucp_tag_unexp_hash_resize(ucp_tag_match_t *tm, unsigned size_log)
+{
+    size_t old_size = UCS_BIT(tm->unexpected.hash_size_log);
+    ucs_list_link_t *buckets, *hash_list;
+    ucp_recv_desc_t *rdesc, *tmp;
+    size_t bucket;
+
+    buckets = ucp_tag_unexp_hash_alloc_buckets(size_log);
+    if (buckets == NULL) {
+        ucs_debug("failed to resize unexpected tag hash to %lu buckets",
+                  UCS_BIT(size_log));
+        return;
+    }
+
+    ucs_trace("resizing unexpected tag hash from %zu to %lu buckets, %u descs",
+              old_size, UCS_BIT(size_log), tm->unexpected.hash_count);
+
+    /* Descriptors with the same tag are in the same bucket, so moving every
+     * bucket in order keeps their arrival order */
+    for (bucket = 0; bucket < old_size; ++bucket) {
+        ucs_list_for_each_safe(rdesc, tmp, &tm->unexpected.hash[bucket],
+                               tag_list[UCP_RDESC_HASH_LIST]) {
+            hash_list = &buckets[ucp_tag_match_calc_hash(ucp_rdesc_get_tag(rdesc),
+                                                         size_log)];
+            ucs_list_add_tail(hash_list, &rdesc->tag_list[UCP_RDESC_HASH_LIST]);
+        }
+    }
+
     ucs_free(tm->unexpected.hash);
-    ucs_free(tm->expected.hash);
+    tm->unexpected.hash          = buckets;
+    tm->unexpected.hash_size_log = size_log;
+    UCS_STATS_UPDATE_COUNTER(tm->stats, UCP_TAG_MATCH_STAT_UNEXP_HASH_RESIZE, 1);
+}
+
+void ucp_tag_unexp_tags_compact(ucp_tag_match_t *tm)
+{
+    unsigned count = 0;
+    ucp_recv_desc_t *rdesc;
+    unsigned index, size;
+    void *ptr;
+
+    /* move the valid entries to the beginning of the arrays */
+    for (index = tm->unexpected.tags_first; index < tm->unexpected.tags_last;
+         ++index) {
+        rdesc = tm->unexpected.rdescs[index];
+        if (rdesc != NULL) {
+            tm->unexpected.tags[count]   = tm->unexpected.tags[index];
+            tm->unexpected.rdescs[count] = rdesc;
+            rdesc->tag_index             = count;
+            ++count;
+        }
+    }
+
+    ucs_assert(count == tm->unexpected.hash_count);
+    tm->unexpected.tags_first = 0;
+    tm->unexpected.tags_last  = count;
+
+    /* grow if the arrays are more than half full, so it's not compacted again
+     * soon */
+    if (count <= (tm->unexpected.tags_size / 2)) {
+        return;
+    }
+
+    size = tm->unexpected.tags_size * 2;
+    ptr  = ucs_realloc(tm->unexpected.tags, sizeof(*tm->unexpected.tags) * size,
+                       "ucp_tm_unexp_tags");
+    if (ptr == NULL) {
+        ucs_fatal("failed to grow unexpected tags array to %u entries", size);
+    }
+    tm->unexpected.tags = ptr;
+
+    ptr = ucs_realloc(tm->unexpected.rdescs, sizeof(*tm->unexpected.rdescs) * size,
+                      "ucp_tm_unexp_rdescs");
+    if (ptr == NULL) {
+        ucs_fatal("failed to grow unexpected tags array to %u entries", size);
+    }
+    tm->unexpected.rdescs    = ptr;
+    tm->unexpected.tags_size = size;
+}
+
+void ucp_tag_match_purge(ucp_tag_match_t *tm)
+{
+    ucp_tag_frag_match_t *matchq;
+    ucp_recv_desc_t *rdesc, *tmp;
+    khiter_t iter;
+
+    ucs_list_for_each_safe(rdesc, tmp, &tm->unexpected.all,
+                           tag_list[UCP_RDESC_ALL_LIST]) {
+        ucs_debug("purging unexpected "UCP_RECV_DESC_FMT,
+                  UCP_RECV_DESC_ARG(rdesc));
+        ucp_tag_unexp_remove(tm, rdesc);
+        ucp_recv_desc_release(rdesc);
+    }
+
+    for (iter = kh_begin(&tm->frag_hash); iter != kh_end(&tm->frag_hash);
+         ++iter) {
+        if (!kh_exist(&tm->frag_hash, iter)) {
+            continue;
+        }
+
+        matchq = &kh_value(&tm->frag_hash, iter);
+        if (!ucp_tag_frag_match_is_unexp(matchq)) {
+            continue;
+        }
+
+        while (!ucs_queue_is_empty(&matchq->unexp_q)) {
+            rdesc = ucs_queue_pull_elem_non_empty(&matchq->unexp_q,
+                                                  ucp_recv_desc_t,
+                                                  tag_frag_queue);
+            ucp_recv_desc_release(rdesc);
+        }
+    }
+    kh_clear(ucp_tag_frag_hash, &tm->frag_hash);
 }
 
 int ucp_tag_unexp_is_empty(ucp_tag_match_t *tm)
@@ -89,47 +389,56 @@ ucp_request_t*
 ucp_tag_exp_search_all(ucp_tag_match_t *tm, ucp_request_queue_t *req_queue,
                        ucp_tag_t tag)
 {
-    ucs_queue_head_t *hash_queue = &req_queue->queue;
-    ucp_request_queue_t *queue;
-    ucs_queue_iter_t hash_iter, wild_iter, *iter;
-    uint64_t hash_sn, wild_sn, *sn_p;
+    ucp_request_queue_t *queues[3];
+    ucs_queue_iter_t iters[3];
+    uint64_t sns[3];
+    unsigned i, num_queues, min;
     ucp_request_t *req;
 
-    *hash_queue->ptail                 = NULL;
-    *tm->expected.wildcard.queue.ptail = NULL;
+    /* requests which can match the tag are in its specific queue, in the
+     * queue of its sender, and in the wildcard queue */
+    num_queues           = 0;
+    queues[num_queues++] = req_queue;
+    if (tm->expected.src_hash.count > 0) {
+        queues[num_queues++] = ucp_tag_exp_get_src_queue(tm, tag);
+    }
+    if (!ucs_queue_is_empty(&tm->expected.wildcard.queue)) {
+        queues[num_queues++] = &tm->expected.wildcard;
+    }
 
-    hash_iter = ucs_queue_iter_begin(hash_queue);
-    wild_iter = ucs_queue_iter_begin(&tm->expected.wildcard.queue);
+    for (i = 0; i < num_queues; ++i) {
+        *queues[i]->queue.ptail = NULL;
+        iters[i]                = ucs_queue_iter_begin(&queues[i]->queue);
+        sns[i]                  = ucp_tag_exp_req_seq(iters[i]);
+    }
 
-    hash_sn = ucp_tag_exp_req_seq(hash_iter);
-    wild_sn = ucp_tag_exp_req_seq(wild_iter);
+    /* check the requests of all the queues by the order they were posted */
+    for (;;) {
+        min = 0;
+        for (i = 1; i < num_queues; ++i) {
+            if (sns[i] < sns[min]) {
+                min = i;
+            }
+        }
 
-    while (hash_sn != wild_sn) {
-        if (hash_sn < wild_sn) {
-            iter  = &hash_iter;
-            sn_p  = &hash_sn;
-            queue = req_queue;
-        } else {
-            iter  = &wild_iter;
-            sn_p  = &wild_sn;
-            queue = &tm->expected.wildcard;
+        if (sns[min] == ULONG_MAX) {
+            break;
         }
 
-        req = ucs_container_of(**iter, ucp_request_t, recv.queue);
+        req = ucs_container_of(*iters[min], ucp_request_t, recv.queue);
         if (ucp_tag_is_match(tag, req->recv.tag.tag, req->recv.tag.tag_mask)) {
             ucs_trace_req("matched received tag %"PRIx64" to req %p", tag, req);
-            ucp_tag_exp_delete(req, tm, queue, *iter);
+            ucp_tag_exp_delete(req, tm, queues[min], iters[min]);
             return req;
         }
 
-        *iter = ucs_queue_iter_next(*iter);
-        *sn_p = ucp_tag_exp_req_seq(*iter);
+        iters[min] = ucs_queue_iter_next(iters[min]);
+        sns[min]   = ucp_tag_exp_req_seq(iters[min]);
     }
 
-    ucs_assertv((hash_sn == ULONG_MAX) && (wild_sn == ULONG_MAX),
-                "hash_seq=%lu wild_seq=%lu", hash_sn, wild_sn);
-    ucs_assert(ucs_queue_iter_end(hash_queue, hash_iter));
-    ucs_assert(ucs_queue_iter_end(&tm->expected.wildcard.queue, wild_iter));
+    for (i = 0; i < num_queues; ++i) {
+        ucs_assert(ucs_queue_iter_end(&queues[i]->queue, iters[i]));
+    }
     return NULL;
 }
 
@@ -18,6 +18,45 @@
 #define UCP_TAG_MASK_FULL     0xffffffffffffffffUL  /* All 1-s */
 
 
+/* Tag hash tables hold between 2^MIN_LOG and 2^MAX_LOG buckets, and are resized
+ * to keep the average number of entries per bucket between 1/8 and 2 */
+#define UCP_TAG_MATCH_HASH_MIN_LOG    8
+#define UCP_TAG_MATCH_HASH_MAX_LOG    20
+
+/* Initial size of the unexpected tags array, and the number of removed entries
+ * it may hold beyond twice the number of valid ones before it is compacted */
+#define UCP_TAG_MATCH_UNEXP_TAGS_MIN  256
+
+
+/**
+ * Tag matching statistics counters
+ */
+enum {
+    UCP_TAG_MATCH_STAT_EXP_HASH_RESIZE,
+    UCP_TAG_MATCH_STAT_EXP_BUCKET_SEARCH,
+    UCP_TAG_MATCH_STAT_EXP_BUCKET_STEPS,
+    UCP_TAG_MATCH_STAT_EXP_BUCKET_MAX,
+    UCP_TAG_MATCH_STAT_UNEXP_HASH_RESIZE,
+    UCP_TAG_MATCH_STAT_UNEXP_BUCKET_SEARCH,
+    UCP_TAG_MATCH_STAT_UNEXP_BUCKET_STEPS,
+    UCP_TAG_MATCH_STAT_UNEXP_BUCKET_MAX,
+    UCP_TAG_MATCH_STAT_LAST
+};
+
+
+/* Account a search which walked _length entries of a hash bucket */
+#define UCP_TAG_MATCH_STAT_BUCKET(_tm, _name, _length) \
+    do { \
+        UCS_STATS_UPDATE_COUNTER((_tm)->stats, \
+                                 UCP_TAG_MATCH_STAT_##_name##_BUCKET_SEARCH, 1); \
+        UCS_STATS_UPDATE_COUNTER((_tm)->stats, \
+                                 UCP_TAG_MATCH_STAT_##_name##_BUCKET_STEPS, \
+                                 _length); \
+        UCS_STATS_UPDATE_MAX((_tm)->stats, \
+                             UCP_TAG_MATCH_STAT_##_name##_BUCKET_MAX, _length); \
+    } while (0)
+
+
 KHASH_INIT(ucp_tag_offload_hash, ucp_tag_t, ucp_worker_iface_t *, 1,
            kh_int64_hash_func, kh_int64_hash_equal);
 
@@ -42,6 +81,17 @@ typedef struct {
 } ucp_request_queue_t;
 
 
+/**
+ * Resizable hash table of expected requests
+ */
+typedef struct {
+    ucp_request_queue_t   *buckets;    /* Array of 2^size_log buckets */
+    uint64_t              key_mask;    /* Part of the tag used as hash key */
+    unsigned              size_log;    /* Log2 of the number of buckets */
+    unsigned              count;       /* Number of requests in the table */
+} ucp_tag_exp_hash_t;
+
+
 /**
  * Hash table entry for tag message fragments
  */
@@ -63,7 +113,13 @@ typedef struct ucp_tag_match {
     /* Expected queue */
     struct {
         ucp_request_queue_t   wildcard;   /* Expected wildcard requests */
-        ucp_request_queue_t   *hash;      /* Hash table of expected non-wild tags */
+        ucp_tag_exp_hash_t    hash;       /* Hash table of expected non-wild tags */
+        ucp_tag_exp_hash_t    src_hash;   /* Hash table of expected wildcard tags
+                                             of a specific sender, by the sender
+                                             part of the tag */
+        uint64_t              sender_mask; /* Sender part of the tag */
+        unsigned              src_sw_count; /* Number of requests in src_hash
+                                               which are not posted to offload */
         uint64_t              sn;
         unsigned              sw_all_count; /* Number of all expected requests which
                                                are not posted to offload */
@@ -73,6 +129,16 @@ typedef struct ucp_tag_match {
     struct {
         ucs_list_link_t       all;        /* Linked list of all tags */
         ucs_list_link_t       *hash;      /* Hash table of unexpected tags */
+        unsigned              hash_size_log; /* Log2 of the number of buckets */
+        unsigned              hash_count; /* Number of descriptors in the hash */
+        ucp_tag_t             *tags;      /* Tags of the unexpected descriptors
+                                             by arrival order, for searching
+                                             with a wildcard mask */
+        ucp_recv_desc_t       **rdescs;   /* Descriptors of the tags array,
+                                             NULL for removed ones */
+        unsigned              tags_first; /* First valid entry of the arrays */
+        unsigned              tags_last;  /* End of the used entries */
+        unsigned              tags_size;  /* Size of the arrays */
     } unexpected;
 
     /* Hash for fragment assembly, the key is a globally unique tag message id */
@@ -102,17 +168,30 @@ typedef struct ucp_tag_match {
         uint64_t              message_id;       /* Unique ID for active messages */
     } am;
 
+    UCS_STATS_NODE_DECLARE(stats);
+
 } ucp_tag_match_t;
 
 
-ucs_status_t ucp_tag_match_init(ucp_tag_match_t *tm);
+ucs_status_t ucp_tag_match_init(ucp_tag_match_t *tm, uint64_t sender_mask
+                                UCS_STATS_ARG(ucs_stats_node_t *stats_parent));
 
 void ucp_tag_match_cleanup(ucp_tag_match_t *tm);
 
+/* Release all unexpected descriptors, which were never matched */
+void ucp_tag_match_purge(ucp_tag_match_t *tm);
+
 void ucp_tag_exp_remove(ucp_tag_match_t *tm, ucp_request_t *req);
 
 int ucp_tag_unexp_is_empty(ucp_tag_match_t *tm);
 
+void ucp_tag_exp_hash_resize(ucp_tag_match_t *tm, ucp_tag_exp_hash_t *hash,
+                             unsigned size_log);
+
+void ucp_tag_unexp_hash_resize(ucp_tag_match_t *tm, unsigned size_log);
+
+void ucp_tag_unexp_tags_compact(ucp_tag_match_t *tm);
+
 ucp_request_t*
 ucp_tag_exp_search_all(ucp_tag_match_t *tm, ucp_request_queue_t *req_queue,
                        ucp_tag_t tag);
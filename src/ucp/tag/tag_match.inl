@@ -13,15 +13,15 @@
 #include <ucp/core/ucp_request.h>
 #include <ucp/core/ucp_request.inl>
 #include <ucp/dt/dt.h>
+#include <ucs/arch/cpu.h>
 #include <ucs/debug/log.h>
 #include <ucs/datastruct/queue.h>
 #include <ucs/datastruct/mpool.inl>
 #include <inttypes.h>
 
 
-/* Hash size is a prime number just below 1024. Prime number for even distribution,
- * and small enough to fit L1 cache. */
-#define UCP_TAG_MATCH_HASH_SIZE     1021
+/* Multiplier for Fibonacci hashing: 2^64 divided by the golden ratio */
+#define UCP_TAG_MATCH_HASH_MULT     0x9e3779b97f4a7c15ul
 
 
 static UCS_F_ALWAYS_INLINE
@@ -41,17 +41,57 @@ int ucp_tag_is_match(ucp_tag_t tag, ucp_tag_t exp_tag, ucp_tag_t tag_mask)
 }
 
 static UCS_F_ALWAYS_INLINE size_t
-ucp_tag_match_calc_hash(ucp_tag_t tag)
+ucp_tag_match_calc_hash(ucp_tag_t tag, unsigned size_log)
 {
-    /* Compute two 32-bit modulo and combine their result */
-    return ((uint32_t)tag % UCP_TAG_MATCH_HASH_SIZE) ^
-           ((uint32_t)(tag >> 32) % UCP_TAG_MATCH_HASH_SIZE);
+    /* Multiply-shift: the top bits of the product depend on all bits of the
+     * tag, so take them as the index of the bucket */
+    return (tag * UCP_TAG_MATCH_HASH_MULT) >> (64 - size_log);
+}
+
+static UCS_F_ALWAYS_INLINE ucp_request_queue_t*
+ucp_tag_exp_hash_get_bucket(ucp_tag_exp_hash_t *hash, ucp_tag_t tag)
+{
+    return &hash->buckets[ucp_tag_match_calc_hash(tag & hash->key_mask,
+                                                  hash->size_log)];
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_tag_exp_hash_add(ucp_tag_match_t *tm, ucp_tag_exp_hash_t *hash)
+{
+    if (ucs_unlikely((++hash->count > (2u << hash->size_log)) &&
+                     (hash->size_log < UCP_TAG_MATCH_HASH_MAX_LOG))) {
+        ucp_tag_exp_hash_resize(tm, hash, hash->size_log + 1);
+    }
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_tag_exp_hash_del(ucp_tag_match_t *tm, ucp_tag_exp_hash_t *hash)
+{
+    if (ucs_unlikely((--hash->count < (1u << (hash->size_log - 3))) &&
+                     (hash->size_log > UCP_TAG_MATCH_HASH_MIN_LOG))) {
+        ucp_tag_exp_hash_resize(tm, hash, hash->size_log - 1);
+    }
 }
 
 static UCS_F_ALWAYS_INLINE ucp_request_queue_t*
 ucp_tag_exp_get_queue_for_tag(ucp_tag_match_t *tm, ucp_tag_t tag)
 {
-    return &tm->expected.hash[ucp_tag_match_calc_hash(tag)];
+    return ucp_tag_exp_hash_get_bucket(&tm->expected.hash, tag);
+}
+
+/* Whether a wildcard tag mask selects a specific sender, so requests with it
+ * are kept in the hash table of the sender */
+static UCS_F_ALWAYS_INLINE int
+ucp_tag_exp_is_src_wildcard(ucp_tag_match_t *tm, ucp_tag_t tag_mask)
+{
+    return (tm->expected.sender_mask != 0) &&
+           ((tm->expected.sender_mask & tag_mask) == tm->expected.sender_mask);
+}
+
+static UCS_F_ALWAYS_INLINE ucp_request_queue_t*
+ucp_tag_exp_get_src_queue(ucp_tag_match_t *tm, ucp_tag_t tag)
+{
+    return ucp_tag_exp_hash_get_bucket(&tm->expected.src_hash, tag);
 }
 
 static UCS_F_ALWAYS_INLINE ucp_request_queue_t*
@@ -59,11 +99,26 @@ ucp_tag_exp_get_queue(ucp_tag_match_t *tm, ucp_tag_t tag, ucp_tag_t tag_mask)
 {
     if (tag_mask == UCP_TAG_MASK_FULL) {
         return ucp_tag_exp_get_queue_for_tag(tm, tag);
+    } else if (ucp_tag_exp_is_src_wildcard(tm, tag_mask)) {
+        return ucp_tag_exp_get_src_queue(tm, tag);
     } else {
         return &tm->expected.wildcard;
     }
 }
 
+/* Hash table which holds the request, or NULL if it's in the wildcard queue */
+static UCS_F_ALWAYS_INLINE ucp_tag_exp_hash_t*
+ucp_tag_exp_get_req_hash(ucp_tag_match_t *tm, ucp_request_t *req)
+{
+    if (req->recv.tag.tag_mask == UCP_TAG_MASK_FULL) {
+        return &tm->expected.hash;
+    } else if (ucp_tag_exp_is_src_wildcard(tm, req->recv.tag.tag_mask)) {
+        return &tm->expected.src_hash;
+    } else {
+        return NULL;
+    }
+}
+
 static UCS_F_ALWAYS_INLINE ucp_request_queue_t*
 ucp_tag_exp_get_req_queue(ucp_tag_match_t *tm, ucp_request_t *req)
 {
@@ -74,8 +129,17 @@ static UCS_F_ALWAYS_INLINE void
 ucp_tag_exp_push(ucp_tag_match_t *tm, ucp_request_queue_t *req_queue,
                  ucp_request_t *req)
 {
+    ucp_tag_exp_hash_t *hash = ucp_tag_exp_get_req_hash(tm, req);
+
     req->recv.tag.sn = tm->expected.sn++;
     ucs_queue_push(&req_queue->queue, &req->recv.queue);
+
+    if (hash == &tm->expected.src_hash) {
+        tm->expected.src_sw_count += !(req->flags & UCP_REQUEST_FLAG_OFFLOADED);
+    }
+    if (hash != NULL) {
+        ucp_tag_exp_hash_add(tm, hash);
+    }
 }
 
 static UCS_F_ALWAYS_INLINE void
@@ -88,40 +152,53 @@ static UCS_F_ALWAYS_INLINE void
 ucp_tag_exp_delete(ucp_request_t *req, ucp_tag_match_t *tm,
                    ucp_request_queue_t *req_queue, ucs_queue_iter_t iter)
 {
+    ucp_tag_exp_hash_t *hash = ucp_tag_exp_get_req_hash(tm, req);
+
     if (!(req->flags & UCP_REQUEST_FLAG_OFFLOADED)) {
         --tm->expected.sw_all_count;
         --req_queue->sw_count;
+        tm->expected.src_sw_count -= (hash == &tm->expected.src_hash);
         if (req->flags & UCP_REQUEST_FLAG_BLOCK_OFFLOAD) {
             --req_queue->block_count;
         }
     }
     ucs_queue_del_iter(&req_queue->queue, iter);
+
+    /* may resize the hash table, so must be the last access to req_queue */
+    if (hash != NULL) {
+        ucp_tag_exp_hash_del(tm, hash);
+    }
 }
 
 static UCS_F_ALWAYS_INLINE ucp_request_t *
 ucp_tag_exp_search(ucp_tag_match_t *tm, ucp_tag_t tag)
 {
+    UCS_V_UNUSED unsigned steps = 0;
     ucp_request_queue_t *req_queue;
     ucs_queue_iter_t iter;
     ucp_request_t *req;
 
-    if (ucs_unlikely(!ucs_queue_is_empty(&tm->expected.wildcard.queue))) {
+    if (ucs_unlikely(!ucs_queue_is_empty(&tm->expected.wildcard.queue) ||
+                     (tm->expected.src_hash.count > 0))) {
         req_queue = ucp_tag_exp_get_queue_for_tag(tm, tag);
         return ucp_tag_exp_search_all(tm, req_queue, tag);
     }
 
-    /* fast path - wildcard queue is empty, search only the specific queue */
+    /* fast path - no wildcard requests, search only the specific queue */
     req_queue = ucp_tag_exp_get_queue_for_tag(tm, tag);
     ucs_queue_for_each_safe(req, iter, &req_queue->queue, recv.queue) {
         req = ucs_container_of(*iter, ucp_request_t, recv.queue);
         ucs_trace_data("checking req %p tag %"PRIx64"/%"PRIx64" with tag %"PRIx64,
                        req, req->recv.tag.tag, req->recv.tag.tag_mask, tag);
+        ++steps;
         if (ucp_tag_is_match(tag, req->recv.tag.tag, req->recv.tag.tag_mask)) {
             ucs_trace_req("matched received tag %"PRIx64" to req %p", tag, req);
+            UCP_TAG_MATCH_STAT_BUCKET(tm, EXP, steps);
             ucp_tag_exp_delete(req, tm, req_queue, iter);
             return req;
         }
     }
+    UCP_TAG_MATCH_STAT_BUCKET(tm, EXP, steps);
     return NULL;
 }
 
@@ -133,34 +210,117 @@ static UCS_F_ALWAYS_INLINE ucp_tag_t ucp_rdesc_get_tag(ucp_recv_desc_t *rdesc)
 static UCS_F_ALWAYS_INLINE ucs_list_link_t*
 ucp_tag_unexp_get_list_for_tag(ucp_tag_match_t *tm, ucp_tag_t tag)
 {
-    return &tm->unexpected.hash[ucp_tag_match_calc_hash(tag)];
+    return &tm->unexpected.hash[ucp_tag_match_calc_hash(tag,
+                                                        tm->unexpected.hash_size_log)];
 }
 
 static UCS_F_ALWAYS_INLINE void
-ucp_tag_unexp_remove(ucp_recv_desc_t *rdesc)
+ucp_tag_unexp_remove(ucp_tag_match_t *tm, ucp_recv_desc_t *rdesc)
 {
     ucs_list_del(&rdesc->tag_list[UCP_RDESC_HASH_LIST]);
     ucs_list_del(&rdesc->tag_list[UCP_RDESC_ALL_LIST] );
+    tm->unexpected.rdescs[rdesc->tag_index] = NULL;
+
+    if (--tm->unexpected.hash_count == 0) {
+        tm->unexpected.tags_first = 0;
+        tm->unexpected.tags_last  = 0;
+    } else {
+        /* skip removed entries at the head, usually the oldest descriptor is
+         * the one which was removed */
+        while (tm->unexpected.rdescs[tm->unexpected.tags_first] == NULL) {
+            ++tm->unexpected.tags_first;
+        }
+        if (ucs_unlikely((tm->unexpected.tags_last - tm->unexpected.tags_first) >
+                         ((2 * tm->unexpected.hash_count) +
+                          UCP_TAG_MATCH_UNEXP_TAGS_MIN))) {
+            ucp_tag_unexp_tags_compact(tm);
+        }
+    }
+
+    if (ucs_unlikely((tm->unexpected.hash_count <
+                      (1u << (tm->unexpected.hash_size_log - 3))) &&
+                     (tm->unexpected.hash_size_log > UCP_TAG_MATCH_HASH_MIN_LOG))) {
+        ucp_tag_unexp_hash_resize(tm, tm->unexpected.hash_size_log - 1);
+    }
 }
 
 static UCS_F_ALWAYS_INLINE void
 ucp_tag_unexp_recv(ucp_tag_match_t *tm, ucp_recv_desc_t *rdesc, ucp_tag_t tag)
 {
     ucs_list_link_t *hash_list;
+    unsigned index;
 
     hash_list = ucp_tag_unexp_get_list_for_tag(tm, tag);
     ucs_list_add_tail(hash_list,           &rdesc->tag_list[UCP_RDESC_HASH_LIST]);
     ucs_list_add_tail(&tm->unexpected.all, &rdesc->tag_list[UCP_RDESC_ALL_LIST]);
 
+    if (ucs_unlikely(tm->unexpected.tags_last == tm->unexpected.tags_size)) {
+        ucp_tag_unexp_tags_compact(tm);
+    }
+    index                        = tm->unexpected.tags_last++;
+    tm->unexpected.tags[index]   = tag;
+    tm->unexpected.rdescs[index] = rdesc;
+    rdesc->tag_index             = index;
+
+    if (ucs_unlikely((++tm->unexpected.hash_count >
+                      (2u << tm->unexpected.hash_size_log)) &&
+                     (tm->unexpected.hash_size_log < UCP_TAG_MATCH_HASH_MAX_LOG))) {
+        ucp_tag_unexp_hash_resize(tm, tm->unexpected.hash_size_log + 1);
+    }
+
     ucs_trace_req("unexp "UCP_RECV_DESC_FMT" tag %"PRIx64,
                   UCP_RECV_DESC_ARG(rdesc), tag);
 }
 
+/* search the hash bucket of the tag, for a full mask */
 static UCS_F_ALWAYS_INLINE ucp_recv_desc_t*
-ucp_tag_unexp_list_next(ucp_recv_desc_t *rdesc, int i_list)
+ucp_tag_unexp_search_hash(ucp_tag_match_t *tm, ucp_tag_t tag)
 {
-    return ucs_list_next(&rdesc->tag_list[i_list], ucp_recv_desc_t,
-                         tag_list[i_list]);
+    UCS_V_UNUSED unsigned steps = 0;
+    ucp_recv_desc_t *rdesc;
+    ucs_list_link_t *list;
+
+    list = ucp_tag_unexp_get_list_for_tag(tm, tag);
+    ucs_list_for_each(rdesc, list, tag_list[UCP_RDESC_HASH_LIST]) {
+        ucs_trace_req("searching for tag %"PRIx64" checking "UCP_RECV_DESC_FMT
+                      " tag %"PRIx64, tag, UCP_RECV_DESC_ARG(rdesc),
+                      ucp_rdesc_get_tag(rdesc));
+        ++steps;
+        if (ucp_rdesc_get_tag(rdesc) == tag) {
+            UCP_TAG_MATCH_STAT_BUCKET(tm, UNEXP, steps);
+            return rdesc;
+        }
+    }
+
+    UCP_TAG_MATCH_STAT_BUCKET(tm, UNEXP, steps);
+    return NULL;
+}
+
+/* search the tags array by arrival order, so only the matching descriptor is
+ * accessed */
+static UCS_F_ALWAYS_INLINE ucp_recv_desc_t*
+ucp_tag_unexp_search_tags(ucp_tag_match_t *tm, ucp_tag_t tag, uint64_t tag_mask)
+{
+    unsigned index = tm->unexpected.tags_first;
+    ucp_recv_desc_t *rdesc;
+
+    for (;;) {
+        index += ucs_arch_search_u64_masked(tm->unexpected.tags + index,
+                                            tm->unexpected.tags_last - index,
+                                            tag, tag_mask);
+        if (index == tm->unexpected.tags_last) {
+            return NULL;
+        }
+
+        /* the entry could be left from a removed descriptor */
+        rdesc = tm->unexpected.rdescs[index];
+        if (rdesc != NULL) {
+            ucs_assert(ucp_tag_is_match(ucp_rdesc_get_tag(rdesc), tag, tag_mask));
+            return rdesc;
+        }
+
+        ++index;
+    }
 }
 
 /* search unexpected queue for tag/mask, if found return the received desc,
@@ -171,8 +331,6 @@ ucp_tag_unexp_search(ucp_tag_match_t *tm, ucp_tag_t tag, uint64_t tag_mask,
                      int remove, const char *title)
 {
     ucp_recv_desc_t *rdesc;
-    ucs_list_link_t *list;
-    int i_list;
 
     /* fast check of global unexpected queue */
     if (ucs_list_is_empty(&tm->unexpected.all)) {
@@ -180,36 +338,22 @@ ucp_tag_unexp_search(ucp_tag_match_t *tm, ucp_tag_t tag, uint64_t tag_mask,
     }
 
     if (tag_mask == UCP_TAG_MASK_FULL) {
-        list = ucp_tag_unexp_get_list_for_tag(tm, tag);
-        if (ucs_list_is_empty(list)) {
-            return NULL;
-        }
-        i_list = UCP_RDESC_HASH_LIST;
+        rdesc = ucp_tag_unexp_search_hash(tm, tag);
     } else {
-        list   = &tm->unexpected.all;
-        i_list = UCP_RDESC_ALL_LIST;
+        rdesc = ucp_tag_unexp_search_tags(tm, tag, tag_mask);
     }
 
-    rdesc = ucs_list_head(list, ucp_recv_desc_t, tag_list[i_list]);
-    do {
-        ucs_trace_req("searching for tag %"PRIx64"/%"PRIx64" "
-                      "checking "UCP_RECV_DESC_FMT" tag %"PRIx64,
-                      tag, tag_mask, UCP_RECV_DESC_ARG(rdesc),
-                      ucp_rdesc_get_tag(rdesc));
-        if (ucp_tag_is_match(ucp_rdesc_get_tag(rdesc), tag, tag_mask)) {
-            ucs_trace_req("matched unexp rdesc " UCP_RECV_DESC_FMT " to "
-                          "%s tag %"PRIx64"/%"PRIx64, UCP_RECV_DESC_ARG(rdesc),
-                          title, tag, tag_mask);
-            if (remove) {
-                ucp_tag_unexp_remove(rdesc);
-            }
-            return rdesc;
-        }
-
-        rdesc = ucp_tag_unexp_list_next(rdesc, i_list);
-    } while (&rdesc->tag_list[i_list] != list);
+    if (rdesc == NULL) {
+        return NULL;
+    }
 
-    return NULL;
+    ucs_trace_req("matched unexp rdesc " UCP_RECV_DESC_FMT " to "
+                  "%s tag %"PRIx64"/%"PRIx64, UCP_RECV_DESC_ARG(rdesc),
+                  title, tag, tag_mask);
+    if (remove) {
+        ucp_tag_unexp_remove(tm, rdesc);
+    }
+    return rdesc;
 }
 
 /*
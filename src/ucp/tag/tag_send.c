@@ -32,6 +32,14 @@ ucp_tag_get_rndv_threshold(const ucp_request_t *req, size_t count,
         /* Fall through */
     case UCP_DATATYPE_CONTIG:
         return ucs_min(rndv_rma_thresh, rndv_am_thresh);
+    case UCP_DATATYPE_STRIDED:
+        if ((ucp_dt_strided_block_count(req->send.datatype, 0,
+                                        req->send.length) > max_iov) &&
+            ucp_ep_is_tag_offload_enabled(ucp_ep_config(req->send.ep))) {
+            /* Same as IOV, every block takes an iov entry */
+            return 1;
+        }
+        return rndv_am_thresh;
     case UCP_DATATYPE_GENERIC:
         return rndv_am_thresh;
     default:
@@ -7,7 +7,11 @@
 #if defined(__aarch64__)
 
 #include <ucs/arch/cpu.h>
+#include <ucs/sys/math.h>
 #include <stdio.h>
+#if __ARM_NEON
+#include <arm_neon.h>
+#endif
 
 
 static void ucs_aarch64_cpuid_from_proc(ucs_aarch64_cpuid_t *cpuid)
@@ -64,4 +68,73 @@ void ucs_aarch64_cpuid(ucs_aarch64_cpuid_t *cpuid)
     *cpuid = cached_cpuid;
 }
 
+void ucs_arch_memcpy_nt(void *dst, const void *src, size_t len)
+{
+#if __ARM_NEON
+    size_t head, body;
+
+    /* copy up to the first cache line of the destination, so the streaming
+     * stores write full cache lines */
+    head = -(uintptr_t)dst & (UCS_ARCH_CACHE_LINE_SIZE - 1);
+    if (len < (head + UCS_ARCH_CACHE_LINE_SIZE)) {
+        memcpy(dst, src, len);
+        return;
+    }
+
+    memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    len -= head;
+
+    for (body = ucs_align_down(len, UCS_ARCH_CACHE_LINE_SIZE); body > 0;
+         body -= 64, dst += 64, src += 64, len -= 64) {
+        /* load 64 bytes to NEON registers, and store them with a hint that
+         * they are not going to be read soon */
+        asm volatile ("ldp  q0, q1, [%1]      \n"
+                      "ldp  q2, q3, [%1, #32] \n"
+                      "stnp q0, q1, [%0]      \n"
+                      "stnp q2, q3, [%0, #32] \n"
+                      :
+                      : "r" (dst), "r" (src)
+                      : "v0", "v1", "v2", "v3", "memory");
+    }
+
+    ucs_memory_cpu_store_fence();
+    memcpy(dst, src, len);
+#else
+    memcpy(dst, src, len);
+#endif
+}
+
+size_t ucs_arch_search_u64_masked(const uint64_t *array, size_t length,
+                                  uint64_t value, uint64_t mask)
+{
+    size_t index = 0;
+#if __ARM_NEON
+    uint64x2_t vvalue = vdupq_n_u64(value);
+    uint64x2_t vmask  = vdupq_n_u64(mask);
+    uint64x2_t zero   = vdupq_n_u64(0);
+    uint64x2_t x0, x1;
+    uint32x4_t eq;
+
+    for (; index + 4 <= length; index += 4) {
+        x0 = vandq_u64(veorq_u64(vld1q_u64(array + index), vvalue), vmask);
+        x1 = vandq_u64(veorq_u64(vld1q_u64(array + index + 2), vvalue), vmask);
+        /* narrow the 64-bit compare results, to test all 4 at once */
+        eq = vcombine_u32(vmovn_u64(vceqq_u64(x0, zero)),
+                          vmovn_u64(vceqq_u64(x1, zero)));
+        if (vmaxvq_u32(eq) != 0) {
+            break;
+        }
+    }
+#endif
+
+    for (; index < length; ++index) {
+        if (((array[index] ^ value) & mask) == 0) {
+            break;
+        }
+    }
+    return index;
+}
+
 #endif
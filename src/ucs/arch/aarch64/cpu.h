@@ -87,6 +87,17 @@ static inline int ucs_arch_get_cpu_flag()
     return UCS_CPU_FLAG_UNKNOWN;
 }
 
+static inline size_t ucs_arch_get_memcpy_nt_thresh()
+{
+    /* the benefit of non-temporal stores depends on the implementation */
+    return SIZE_MAX;
+}
+
+void ucs_arch_memcpy_nt(void *dst, const void *src, size_t len);
+
+size_t ucs_arch_search_u64_masked(const uint64_t *array, size_t length,
+                                  uint64_t value, uint64_t mask);
+
 static inline void ucs_arch_wait_mem(void *address)
 {
     unsigned long tmp;
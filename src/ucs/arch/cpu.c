@@ -0,0 +1,23 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2019.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include <ucs/arch/cpu.h>
+#include <ucs/config/global_opts.h>
+#include <ucs/debug/log.h>
+
+
+size_t ucs_memcpy_nt_thresh = SIZE_MAX;
+
+void ucs_cpu_memcpy_init()
+{
+    if (ucs_global_opts.memcpy_nt_thresh == UCS_CONFIG_MEMUNITS_AUTO) {
+        ucs_memcpy_nt_thresh = ucs_arch_get_memcpy_nt_thresh();
+    } else {
+        ucs_memcpy_nt_thresh = ucs_global_opts.memcpy_nt_thresh;
+    }
+
+    ucs_debug("non-temporal memcpy threshold: %zu", ucs_memcpy_nt_thresh);
+}
@@ -13,6 +13,7 @@
 #endif
 
 #include <ucs/sys/compiler_def.h>
+#include <string.h>
 
 
 /* CPU models */
@@ -43,7 +44,8 @@ typedef enum ucs_cpu_flag {
     UCS_CPU_FLAG_SSE41      = UCS_BIT(7),
     UCS_CPU_FLAG_SSE42      = UCS_BIT(8),
     UCS_CPU_FLAG_AVX        = UCS_BIT(9),
-    UCS_CPU_FLAG_AVX2       = UCS_BIT(10)
+    UCS_CPU_FLAG_AVX2       = UCS_BIT(10),
+    UCS_CPU_FLAG_AVX512F    = UCS_BIT(11)
 } ucs_cpu_flag_t;
 
 
@@ -69,6 +71,48 @@ typedef enum ucs_cpu_flag {
 #define UCS_SYS_CACHE_LINE_SIZE    UCS_ARCH_CACHE_LINE_SIZE
 #endif
 
+BEGIN_C_DECLS
+
+/* Minimal length of a copy which bypasses the cache, see ucs_memcpy_relaxed() */
+extern size_t ucs_memcpy_nt_thresh;
+
+
+/**
+ * Set the threshold of non-temporal copies from the global configuration.
+ */
+void ucs_cpu_memcpy_init();
+
+
+/**
+ * Copy @a len bytes which are a part of a transfer of @a total_len bytes, and
+ * are not going to be read soon by the current CPU. The cache is bypassed
+ * according to the total length, so all fragments of a large message are
+ * copied the same way.
+ */
+static inline void ucs_memcpy_relaxed_part(void *dst, const void *src,
+                                           size_t len, size_t total_len)
+{
+    if (ucs_unlikely(total_len >= ucs_memcpy_nt_thresh)) {
+        ucs_arch_memcpy_nt(dst, src, len);
+    } else {
+        memcpy(dst, src, len);
+    }
+}
+
+
+/**
+ * Copy memory which is not going to be read soon by the current CPU, such as
+ * data sent to another process. Copies of at least @ref ucs_memcpy_nt_thresh
+ * bytes use non-temporal stores, so they don't evict the working set of the
+ * process from the cache.
+ */
+static inline void ucs_memcpy_relaxed(void *dst, const void *src, size_t len)
+{
+    ucs_memcpy_relaxed_part(dst, src, len, len);
+}
+
+END_C_DECLS
+
 /**
  * Clear processor data and instruction caches, intended for
  * self-modifying code.
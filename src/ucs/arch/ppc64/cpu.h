@@ -16,6 +16,7 @@
 #include <ucs/sys/compiler_def.h>
 #include <ucs/arch/generic/cpu.h>
 #include <stdint.h>
+#include <string.h>
 
 BEGIN_C_DECLS
 
@@ -58,6 +59,30 @@ static inline int ucs_arch_get_cpu_flag()
 
 double ucs_arch_get_clocks_per_sec();
 
+static inline size_t ucs_arch_get_memcpy_nt_thresh()
+{
+    return SIZE_MAX;
+}
+
+static inline void ucs_arch_memcpy_nt(void *dst, const void *src, size_t len)
+{
+    memcpy(dst, src, len);
+}
+
+static inline size_t ucs_arch_search_u64_masked(const uint64_t *array,
+                                                size_t length, uint64_t value,
+                                                uint64_t mask)
+{
+    size_t index;
+
+    for (index = 0; index < length; ++index) {
+        if (((array[index] ^ value) & mask) == 0) {
+            break;
+        }
+    }
+    return index;
+}
+
 #define ucs_arch_wait_mem ucs_arch_generic_wait_mem
 
 #if !HAVE___CLEAR_CACHE
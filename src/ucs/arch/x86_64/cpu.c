@@ -6,10 +6,14 @@
 
 #if defined(__x86_64__)
 
+#include <ucs/arch/bitops.h>
 #include <ucs/arch/cpu.h>
 #include <ucs/debug/log.h>
 #include <ucs/sys/math.h>
 #include <ucs/sys/sys.h>
+#include <emmintrin.h>
+#include <immintrin.h>
+#include <unistd.h>
 
 #define X86_CPUID_GET_MODEL       0x00000001u
 #define X86_CPUID_GET_BASE_VALUE  0x00000000u
@@ -17,6 +21,14 @@
 #define X86_CPUID_GET_MAX_VALUE   0x80000000u
 #define X86_CPUID_INVARIANT_TSC   0x80000007u
 
+/* Compilers which can build AVX code in a function with a target attribute,
+ * when the library is not compiled for AVX */
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ >= 5))
+#  define X86_TARGET_ATTR_AVX     1
+#else
+#  define X86_TARGET_ATTR_AVX     0
+#endif
+
 
 ucs_ternary_value_t ucs_arch_x86_enable_rdtsc = UCS_TRY;
 
@@ -259,6 +271,13 @@ int ucs_arch_get_cpu_flag()
             if ((result & UCS_CPU_FLAG_AVX) && (_ebx & (1 << 5))) {
                 result |= UCS_CPU_FLAG_AVX2;
             }
+            if ((result & UCS_CPU_FLAG_AVX) && (_ebx & (1 << 16))) {
+                /* the OS must save the opmask and upper ZMM registers */
+                ucs_x86_xgetbv(0, _eax, _edx);
+                if ((_eax & 0xe6) == 0xe6) {
+                    result |= UCS_CPU_FLAG_AVX512F;
+                }
+            }
         }
         cpu_flag = result;
     }
@@ -266,4 +285,199 @@ int ucs_arch_get_cpu_flag()
     return cpu_flag;
 }
 
+size_t ucs_arch_get_memcpy_nt_thresh()
+{
+    long llc_size;
+
+    switch (ucs_arch_get_cpu_model()) {
+    case UCS_CPU_MODEL_INTEL_SANDYBRIDGE:
+    case UCS_CPU_MODEL_INTEL_IVYBRIDGE:
+    case UCS_CPU_MODEL_INTEL_HASWELL:
+    case UCS_CPU_MODEL_INTEL_BROADWELL:
+    case UCS_CPU_MODEL_INTEL_SKYLAKE:
+        /* a copy which is larger than the last level cache would evict all
+         * of it, and the data is read from memory by the receiver anyway */
+        llc_size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        return (llc_size > 0) ? llc_size : SIZE_MAX;
+    default:
+        return SIZE_MAX;
+    }
+}
+
+static void ucs_x86_memcpy_nt_sse2(void *dst, const void *src, size_t len)
+{
+    __m128i a, b, c, d;
+
+    for (; len > 0; len -= 64, dst += 64, src += 64) {
+        a = _mm_loadu_si128((const __m128i*)src);
+        b = _mm_loadu_si128((const __m128i*)src + 1);
+        c = _mm_loadu_si128((const __m128i*)src + 2);
+        d = _mm_loadu_si128((const __m128i*)src + 3);
+        _mm_stream_si128((__m128i*)dst,     a);
+        _mm_stream_si128((__m128i*)dst + 1, b);
+        _mm_stream_si128((__m128i*)dst + 2, c);
+        _mm_stream_si128((__m128i*)dst + 3, d);
+    }
+}
+
+#if X86_TARGET_ATTR_AVX
+static __attribute__((target("avx"))) void
+ucs_x86_memcpy_nt_avx(void *dst, const void *src, size_t len)
+{
+    __m256i a, b;
+
+    for (; len > 0; len -= 64, dst += 64, src += 64) {
+        a = _mm256_loadu_si256((const __m256i*)src);
+        b = _mm256_loadu_si256((const __m256i*)src + 1);
+        _mm256_stream_si256((__m256i*)dst,     a);
+        _mm256_stream_si256((__m256i*)dst + 1, b);
+    }
+}
+
+static __attribute__((target("avx512f"))) void
+ucs_x86_memcpy_nt_avx512(void *dst, const void *src, size_t len)
+{
+    for (; len > 0; len -= 64, dst += 64, src += 64) {
+        _mm512_stream_si512((__m512i*)dst, _mm512_loadu_si512(src));
+    }
+}
+#endif
+
+void ucs_arch_memcpy_nt(void *dst, const void *src, size_t len)
+{
+    size_t head, body;
+    int cpu_flag;
+
+    /* copy up to the first cache line of the destination, so the streaming
+     * stores write full cache lines */
+    head = -(uintptr_t)dst & (UCS_ARCH_CACHE_LINE_SIZE - 1);
+    if (len < (head + UCS_ARCH_CACHE_LINE_SIZE)) {
+        memcpy(dst, src, len);
+        return;
+    }
+
+    memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    len -= head;
+    body = ucs_align_down(len, UCS_ARCH_CACHE_LINE_SIZE);
+
+    cpu_flag = ucs_arch_get_cpu_flag();
+#if X86_TARGET_ATTR_AVX
+    if (cpu_flag & UCS_CPU_FLAG_AVX512F) {
+        ucs_x86_memcpy_nt_avx512(dst, src, body);
+    } else if (cpu_flag & UCS_CPU_FLAG_AVX) {
+        ucs_x86_memcpy_nt_avx(dst, src, body);
+    } else
+#endif
+    {
+        ucs_x86_memcpy_nt_sse2(dst, src, body);
+    }
+
+    /* streaming stores are weakly ordered, so order them before the stores
+     * which follow the copy, such as a flag which tells the data is ready */
+    ucs_memory_bus_store_fence();
+
+    memcpy(dst + body, src + body, len - body);
+}
+
+static size_t ucs_x86_search_u64_masked_sse2(const uint64_t *array, size_t length,
+                                             uint64_t value, uint64_t mask)
+{
+    __m128i vvalue = _mm_set1_epi64x(value);
+    __m128i vmask  = _mm_set1_epi64x(mask);
+    __m128i zero   = _mm_setzero_si128();
+    size_t index;
+    __m128i x;
+    int bits;
+
+    for (index = 0; index + 2 <= length; index += 2) {
+        x    = _mm_loadu_si128((const __m128i*)(array + index));
+        x    = _mm_and_si128(_mm_xor_si128(x, vvalue), vmask);
+        /* SSE2 has no 64-bit compare, so both halves of an element must be 0 */
+        bits = _mm_movemask_epi8(_mm_cmpeq_epi32(x, zero));
+        if ((bits & 0xff) == 0xff) {
+            return index;
+        } else if ((bits & 0xff00) == 0xff00) {
+            return index + 1;
+        }
+    }
+
+    return index;
+}
+
+#if X86_TARGET_ATTR_AVX
+static __attribute__((target("avx2"))) size_t
+ucs_x86_search_u64_masked_avx2(const uint64_t *array, size_t length,
+                               uint64_t value, uint64_t mask)
+{
+    __m256i vvalue = _mm256_set1_epi64x(value);
+    __m256i vmask  = _mm256_set1_epi64x(mask);
+    __m256i zero   = _mm256_setzero_si256();
+    size_t index;
+    __m256i x;
+    int bits;
+
+    for (index = 0; index + 4 <= length; index += 4) {
+        x    = _mm256_loadu_si256((const __m256i*)(array + index));
+        x    = _mm256_and_si256(_mm256_xor_si256(x, vvalue), vmask);
+        bits = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(x,
+                                                                         zero)));
+        if (bits != 0) {
+            return index + ucs_ffs64(bits);
+        }
+    }
+
+    return index;
+}
+
+static __attribute__((target("avx512f"))) size_t
+ucs_x86_search_u64_masked_avx512(const uint64_t *array, size_t length,
+                                 uint64_t value, uint64_t mask)
+{
+    __m512i vvalue = _mm512_set1_epi64(value);
+    __m512i vmask  = _mm512_set1_epi64(mask);
+    size_t index;
+    __mmask8 bits;
+
+    for (index = 0; index + 8 <= length; index += 8) {
+        bits = _mm512_testn_epi64_mask(
+                   _mm512_xor_si512(_mm512_loadu_si512(array + index), vvalue),
+                   vmask);
+        if (bits != 0) {
+            return index + ucs_ffs64(bits);
+        }
+    }
+
+    return index;
+}
+#endif
+
+size_t ucs_arch_search_u64_masked(const uint64_t *array, size_t length,
+                                  uint64_t value, uint64_t mask)
+{
+    size_t index;
+    int cpu_flag;
+
+    cpu_flag = ucs_arch_get_cpu_flag();
+#if X86_TARGET_ATTR_AVX
+    if (cpu_flag & UCS_CPU_FLAG_AVX512F) {
+        index = ucs_x86_search_u64_masked_avx512(array, length, value, mask);
+    } else if (cpu_flag & UCS_CPU_FLAG_AVX2) {
+        index = ucs_x86_search_u64_masked_avx2(array, length, value, mask);
+    } else
+#endif
+    {
+        index = ucs_x86_search_u64_masked_sse2(array, length, value, mask);
+    }
+
+    /* the vector loops stop on a match, or before a partial vector */
+    for (; index < length; ++index) {
+        if (((array[index] ^ value) & mask) == 0) {
+            break;
+        }
+    }
+    return index;
+}
+
 #endif
@@ -45,6 +45,10 @@ double ucs_x86_init_tsc_freq();
 
 ucs_cpu_model_t ucs_arch_get_cpu_model() UCS_F_NOOPTIMIZE;
 ucs_cpu_flag_t ucs_arch_get_cpu_flag() UCS_F_NOOPTIMIZE;
+size_t ucs_arch_get_memcpy_nt_thresh();
+void ucs_arch_memcpy_nt(void *dst, const void *src, size_t len);
+size_t ucs_arch_search_u64_masked(const uint64_t *array, size_t length,
+                                  uint64_t value, uint64_t mask);
 
 static inline int ucs_arch_x86_rdtsc_enabled()
 {
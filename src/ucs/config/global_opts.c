@@ -40,6 +40,7 @@ ucs_global_opts_t ucs_global_opts = {
     .stats_filter          = { NULL, 0 },
     .stats_format          = UCS_STATS_FULL,
     .rcache_check_pfn      = 0,
+    .memcpy_nt_thresh      = UCS_CONFIG_MEMUNITS_AUTO,
     .module_dir            = UCX_MODULE_DIR /* defined in Makefile.am */
 };
 
@@ -206,6 +207,13 @@ static ucs_config_field_t ucs_global_opts_table[] = {
    "memory region was not changed since the time the region was registered.\n",
    ucs_offsetof(ucs_global_opts_t, rcache_check_pfn), UCS_CONFIG_TYPE_BOOL},
 
+  {"MEMCPY_NT_THRESH", "auto",
+   "Minimal size of a copy to another process which bypasses the cache, by\n"
+   "using non-temporal stores. Such copies don't evict the working set of the\n"
+   "sender. \"auto\" selects the size of the last level cache on CPU models\n"
+   "which are known to benefit from it, and disables it otherwise.",
+   ucs_offsetof(ucs_global_opts_t, memcpy_nt_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
   {"MODULE_DIR", UCX_MODULE_DIR,
    "Directory to search for loadable modules",
    ucs_offsetof(ucs_global_opts_t, module_dir), UCS_CONFIG_TYPE_STRING},
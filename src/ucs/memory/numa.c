@@ -8,6 +8,9 @@
 
 #include <ucs/debug/assert.h>
 #include <ucs/debug/log.h>
+#include <ucs/profile/profile.h>
+#include <ucs/sys/math.h>
+#include <ucs/sys/sys.h>
 #include <stdint.h>
 #include <sched.h>
 
@@ -67,4 +70,25 @@ int ucs_numa_node_of_cpu(int cpu)
     return cpu_numa_nodes[cpu] - 1;
 }
 
+ucs_status_t ucs_numa_mbind(void *address, size_t length, int policy,
+                            struct bitmask *nodemask, unsigned flags)
+{
+    uintptr_t start, end;
+    int ret;
+
+    start = ucs_align_down_pow2((uintptr_t)address, ucs_get_page_size());
+    end   = ucs_align_up_pow2((uintptr_t)address + length, ucs_get_page_size());
+    ucs_trace("0x%lx..0x%lx: setting numa policy %d, nodemask[0]=0x%lx", start,
+              end, policy, numa_nodemask_p(nodemask)[0]);
+
+    ret = UCS_PROFILE_CALL(mbind, (void*)start, end - start, policy,
+                           numa_nodemask_p(nodemask),
+                           numa_nodemask_size(nodemask), flags);
+    if (ret < 0) {
+        return UCS_ERR_IO_ERROR;
+    }
+
+    return UCS_OK;
+}
+
 #endif
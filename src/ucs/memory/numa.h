@@ -12,6 +12,7 @@
 #endif
 
 #include <ucs/debug/memtrack.h>
+#include <ucs/type/status.h>
 
 #if HAVE_NUMA
 #include <numaif.h>
@@ -62,4 +63,22 @@ extern const char *ucs_numa_policy_names[];
 int ucs_numa_node_of_cpu(int cpu);
 
 
+#if HAVE_NUMA
+/**
+ * Set the memory policy of the pages which contain a memory range.
+ *
+ * @param [in]  address   Start of the memory range.
+ * @param [in]  length    Length of the memory range.
+ * @param [in]  policy    MPOL_xx policy to set.
+ * @param [in]  nodemask  Nodes of the policy.
+ * @param [in]  flags     MPOL_MF_xx flags to pass to mbind().
+ *
+ * @return UCS_OK, or UCS_ERR_IO_ERROR if mbind() failed, in which case errno
+ *         is set.
+ */
+ucs_status_t ucs_numa_mbind(void *address, size_t length, int policy,
+                            struct bitmask *nodemask, unsigned flags);
+#endif
+
+
 #endif
@@ -38,6 +38,7 @@ static UCS_F_NOOPTIMIZE void ucs_check_cpu_flags(void)
         { "sse42", UCS_CPU_FLAG_SSE42 },
         { "avx", UCS_CPU_FLAG_AVX },
         { "avx2", UCS_CPU_FLAG_AVX2 },
+        { "avx512f", UCS_CPU_FLAG_AVX512F },
         { NULL, UCS_CPU_FLAG_UNKNOWN },
     };
 
@@ -78,6 +79,7 @@ static void UCS_F_CTOR ucs_init()
     ucs_log_early_init(); /* Must be called before all others */
     ucs_global_opts_init();
     ucs_log_init();
+    ucs_cpu_memcpy_init();
 #if ENABLE_STATS
     ucs_stats_init();
 #endif
@@ -889,6 +889,44 @@ const char* ucs_get_process_cmdline()
     return cmdline;
 }
 
+unsigned long ucs_sys_get_proc_start_time(pid_t pid)
+{
+    unsigned long long start_time;
+    char buf[1024], *p;
+    ssize_t len;
+    char state;
+
+    len = ucs_read_file(buf, sizeof(buf) - 1, 1, "/proc/%d/stat", pid);
+    if (len < 0) {
+        return 0;
+    }
+
+    /* the command name may contain spaces and parentheses, so the fields are
+     * parsed after its closing parenthesis */
+    buf[len] = '\0';
+    p        = strrchr(buf, ')');
+    if ((p == NULL) ||
+        (sscanf(p + 1, " %c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u "
+                "%*d %*d %*d %*d %*d %*d %llu", &state, &start_time) != 2)) {
+        ucs_debug("failed to parse /proc/%d/stat", pid);
+        return 0;
+    }
+
+    /* a zombie process has exited, even though it was not reaped yet */
+    return ((state == 'Z') || (state == 'X')) ? 0 : start_time;
+}
+
+uint64_t ucs_sys_get_pid_ns()
+{
+    struct stat st;
+
+    if (stat("/proc/self/ns/pid", &st) < 0) {
+        return 0;
+    }
+
+    return st.st_ino;
+}
+
 unsigned long ucs_sys_get_pfn(uintptr_t address)
 {
     static const char *pagemap_file = "/proc/self/pagemap";
@@ -1038,6 +1076,144 @@ void ucs_sys_free(void *ptr, size_t length)
     }
 }
 
+struct ucs_sys_thread_pool {
+    pthread_mutex_t         lock;
+    pthread_cond_t          work_cond;   /* signaled when a run starts or the
+                                            pool is destroyed */
+    pthread_cond_t          done_cond;   /* signaled when the last part of a
+                                            run completes */
+    ucs_sys_parallel_func_t func;
+    void                    *arg;
+    unsigned                count;       /* number of parts in the current run */
+    unsigned                next_index;  /* next part to take */
+    unsigned                pending;     /* parts which did not complete yet */
+    unsigned                generation;  /* incremented on every run */
+    int                     stop;
+    unsigned                num_threads; /* number of started threads */
+    pthread_t               threads[0];
+};
+
+/* Run the parts of the current operation, must be called with the lock held */
+static void ucs_sys_thread_pool_work(ucs_sys_thread_pool_t *pool)
+{
+    unsigned index;
+
+    while (pool->next_index < pool->count) {
+        index = pool->next_index++;
+        pthread_mutex_unlock(&pool->lock);
+        pool->func(pool->arg, index);
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) {
+            pthread_cond_signal(&pool->done_cond);
+        }
+    }
+}
+
+static void *ucs_sys_thread_pool_func(void *arg)
+{
+    ucs_sys_thread_pool_t *pool = arg;
+    unsigned generation;
+
+    pthread_mutex_lock(&pool->lock);
+    generation = pool->generation;
+    for (;;) {
+        while (!pool->stop && (pool->generation == generation)) {
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        }
+        if (pool->stop) {
+            break;
+        }
+        generation = pool->generation;
+        ucs_sys_thread_pool_work(pool);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+ucs_status_t ucs_sys_thread_pool_create(unsigned num_threads, const char *name,
+                                        ucs_sys_thread_pool_t **pool_p)
+{
+    ucs_sys_thread_pool_t *pool;
+    int ret;
+
+    pool = ucs_calloc(1, sizeof(*pool) + num_threads * sizeof(*pool->threads),
+                      "thread_pool");
+    if (pool == NULL) {
+        ucs_error("failed to allocate %s thread pool", name);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    for (pool->num_threads = 0; pool->num_threads < num_threads;
+         ++pool->num_threads) {
+        ret = pthread_create(&pool->threads[pool->num_threads], NULL,
+                             ucs_sys_thread_pool_func, pool);
+        if (ret != 0) {
+            ucs_error("failed to create %s thread %u: %s", name,
+                      pool->num_threads, strerror(ret));
+            ucs_sys_thread_pool_destroy(pool);
+            return UCS_ERR_IO_ERROR;
+        }
+    }
+
+    ucs_debug("created %s thread pool %p with %u threads", name, pool,
+              num_threads);
+    *pool_p = pool;
+    return UCS_OK;
+}
+
+void ucs_sys_thread_pool_destroy(ucs_sys_thread_pool_t *pool)
+{
+    unsigned i;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->num_threads; ++i) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->lock);
+    ucs_free(pool);
+}
+
+void ucs_sys_thread_pool_run(ucs_sys_thread_pool_t *pool,
+                             ucs_sys_parallel_func_t func, void *arg,
+                             unsigned count)
+{
+    unsigned i;
+
+    if ((pool == NULL) || (pool->num_threads == 0) || (count <= 1)) {
+        for (i = 0; i < count; ++i) {
+            func(arg, i);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    ucs_assert(pool->pending == 0);
+    pool->func       = func;
+    pool->arg        = arg;
+    pool->count      = count;
+    pool->next_index = 0;
+    pool->pending    = count;
+    ++pool->generation;
+    pthread_cond_broadcast(&pool->work_cond);
+
+    ucs_sys_thread_pool_work(pool);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
 void ucs_empty_function()
 {
 }
@@ -267,6 +267,25 @@ ucs_status_t ucs_sys_fcntl_modfl(int fd, int add, int remove);
 const char* ucs_get_process_cmdline();
 
 
+/**
+ * Get the start time of a process.
+ *
+ * @param pid    Process id, in the PID namespace of the current process.
+ *
+ * @return Start time of the process in clock ticks after boot, or 0 if the
+ *         process does not exist or already exited.
+ */
+unsigned long ucs_sys_get_proc_start_time(pid_t pid);
+
+
+/**
+ * Get the PID namespace of the current process.
+ *
+ * @return Identifier of the namespace, or 0 if it is unknown.
+ */
+uint64_t ucs_sys_get_pid_ns();
+
+
 /**
  * Get current thread (LWP) id.
  */
@@ -336,6 +355,61 @@ void *ucs_sys_realloc(void *old_ptr, size_t old_length, size_t new_length);
 void ucs_sys_free(void *ptr, size_t length);
 
 
+/**
+ * Function which performs one part of a parallel operation.
+ *
+ * @param [in]  arg         User-defined argument.
+ * @param [in]  index       Index of the part, from 0 to the number of parts - 1.
+ */
+typedef void (*ucs_sys_parallel_func_t)(void *arg, unsigned index);
+
+
+/**
+ * Pool of helper threads which run the parts of a parallel operation.
+ */
+typedef struct ucs_sys_thread_pool ucs_sys_thread_pool_t;
+
+
+/**
+ * Create a pool of helper threads. The threads are started once, and wait
+ * for work between the calls to @ref ucs_sys_thread_pool_run().
+ *
+ * @param [in]  num_threads Number of helper threads, not including the thread
+ *                          which runs the operations.
+ * @param [in]  name        Name of the pool, for debugging.
+ * @param [out] pool_p      Filled with the new pool.
+ *
+ * @return UCS_OK if the pool was created, error otherwise.
+ */
+ucs_status_t ucs_sys_thread_pool_create(unsigned num_threads, const char *name,
+                                        ucs_sys_thread_pool_t **pool_p);
+
+
+/**
+ * Stop the helper threads and release the pool.
+ *
+ * @param [in]  pool        Pool to destroy.
+ */
+void ucs_sys_thread_pool_destroy(ucs_sys_thread_pool_t *pool);
+
+
+/**
+ * Run a function on the calling thread and the helper threads of the pool, and
+ * wait until all parts complete. The calling thread takes parts as well, so
+ * the number of parts may exceed the number of threads. The pool may be used
+ * by one caller at a time.
+ *
+ * @param [in]  pool        Pool to use. If NULL, all parts run on the calling
+ *                          thread.
+ * @param [in]  func        Function to run.
+ * @param [in]  arg         Argument to pass to the function.
+ * @param [in]  count       Number of parts.
+ */
+void ucs_sys_thread_pool_run(ucs_sys_thread_pool_t *pool,
+                             ucs_sys_parallel_func_t func, void *arg,
+                             unsigned count);
+
+
 /**
  * Perform an ioctl call on the given interface with the given request.
  * Set the result in the ifreq struct.
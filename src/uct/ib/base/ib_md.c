@@ -685,7 +685,6 @@ static ucs_status_t uct_ib_mem_set_numa_policy(uct_ib_md_t *md, uct_ib_mem_t *me
 {
     int ret, old_policy, new_policy;
     struct bitmask *nodemask;
-    uintptr_t start, end;
     ucs_status_t status;
 
     if (!(memh->flags & UCT_IB_MEM_FLAG_ODP) ||
@@ -739,20 +738,11 @@ static ucs_status_t uct_ib_mem_set_numa_policy(uct_ib_md_t *md, uct_ib_mem_t *me
     }
 
     if (new_policy != old_policy) {
-        start = ucs_align_down_pow2((uintptr_t)memh->mr->addr, ucs_get_page_size());
-        end   = ucs_align_up_pow2((uintptr_t)memh->mr->addr + memh->mr->length,
-                                  ucs_get_page_size());
-        ucs_trace("0x%lx..0x%lx: changing numa policy from %d to %d, "
-                  "nodemask[0]=0x%lx", start, end, old_policy, new_policy,
-                  numa_nodemask_p(nodemask)[0]);
-
-        ret = UCS_PROFILE_CALL(mbind, (void*)start, end - start, new_policy,
-                               numa_nodemask_p(nodemask),
-                               numa_nodemask_size(nodemask), 0);
-        if (ret < 0) {
-            ucs_warn("mbind(addr=0x%lx length=%ld policy=%d) failed: %m",
-                     start, end - start, new_policy);
-            status = UCS_ERR_IO_ERROR;
+        status = ucs_numa_mbind(memh->mr->addr, memh->mr->length, new_policy,
+                                nodemask, 0);
+        if (status != UCS_OK) {
+            ucs_warn("mbind(addr=%p length=%zu policy=%d) failed: %m",
+                     memh->mr->addr, memh->mr->length, new_policy);
             goto out_free;
         }
     }
@@ -41,90 +41,153 @@ UCS_CLASS_DEFINE_DELETE_FUNC(uct_cma_ep_t, uct_ep_t);
      ucs_trace_data(_fmt " to %"PRIx64"(%+ld)", ## __VA_ARGS__, (_remote_addr), \
                     (_rkey))
 
-static UCS_F_ALWAYS_INLINE
-ucs_status_t uct_cma_ep_common_zcopy(uct_ep_h tl_ep,
-                                     const uct_iov_t *iov,
-                                     size_t iovcnt,
-                                     uint64_t remote_addr,
-                                     uct_completion_t *comp,
-                                     ssize_t (*fn_p)(pid_t,
-                                                     const struct iovec *,
-                                                     unsigned long,
-                                                     const struct iovec *,
-                                                     unsigned long,
-                                                     unsigned long),
-                                     char *fn_name)
+typedef ssize_t (*uct_cma_ep_tx_func_t)(pid_t, const struct iovec *,
+                                        unsigned long, const struct iovec *,
+                                        unsigned long, unsigned long);
+
+
+/* A zcopy operation which is split to parts, which are copied in parallel */
+typedef struct uct_cma_ep_tx_op {
+    uct_cma_ep_t          *ep;
+    const uct_iov_t       *iov;
+    size_t                iovcnt;
+    uint64_t              remote_addr;
+    size_t                length;      /* total length of the operation */
+    size_t                part_length; /* length of every part but the last */
+    uct_cma_ep_tx_func_t  fn_p;
+    const char            *fn_name;
+    volatile ucs_status_t status;      /* set by the parts which fail */
+} uct_cma_ep_tx_op_t;
+
+
+/* Transfer 'length' bytes starting from 'offset' of the local iov. The remote
+ * buffer is contiguous, and starts at the same offset from 'remote_addr'. */
+static ucs_status_t uct_cma_ep_tx_range(uct_cma_ep_t *ep, const uct_iov_t *iov,
+                                        size_t iovcnt, uint64_t remote_addr,
+                                        size_t offset, size_t length,
+                                        uct_cma_ep_tx_func_t fn_p,
+                                        const char *fn_name)
 {
-    ssize_t ret;
-    ssize_t delivered = 0;
-    size_t iov_it;
-    size_t iov_it_length;
-    size_t iov_slice_length;
-    size_t iov_slice_delivered;
-    size_t local_iov_it;
-    size_t length = 0;
-    struct iovec local_iov[UCT_SM_MAX_IOV];
+    /* every copy thread has its own array, iovcnt was checked against
+     * ucs_get_max_iov() */
+    struct iovec local_iov[iovcnt];
     struct iovec remote_iov;
-    uct_cma_ep_t *ep = ucs_derived_of(tl_ep, uct_cma_ep_t);
-
-    do {
-        iov_it_length = 0;
-        local_iov_it = 0;
-        for (iov_it = 0; iov_it < ucs_min(UCT_SM_MAX_IOV, iovcnt); ++iov_it) {
-            iov_slice_delivered = 0;
+    size_t iov_it, local_iov_it;
+    size_t iov_start, iov_offset, iov_length, skip, remaining;
+    size_t delivered = 0;
+    ssize_t ret;
 
-            /* Get length of the particular iov element */
-            iov_slice_length = uct_iov_get_length(iov + iov_it);
+    ucs_assert(iovcnt <= ucs_get_max_iov());
 
-            /* Skip the iov element if no data */
-            if (!iov_slice_length) {
-                continue;
-            }
-            iov_it_length += iov_slice_length;
-
-            if (iov_it_length <= delivered) {
+    while (length > 0) {
+        /* batch all the local buffers of the remaining data to one call */
+        local_iov_it = 0;
+        iov_offset   = 0;
+        remaining    = length;
+        for (iov_it = 0; (iov_it < iovcnt) && (remaining > 0); ++iov_it) {
+            iov_length  = uct_iov_get_length(iov + iov_it);
+            iov_start   = iov_offset;
+            iov_offset += iov_length;
+            if (iov_offset <= offset) {
                 continue; /* Skip the iov element if transferred already */
-            } else {
-                /* Let's assume the iov element buffer can be delivered partially */
-                if ((iov_it_length - delivered) < iov_slice_length) {
-                    iov_slice_delivered = iov_slice_length - (iov_it_length - delivered);
-                }
             }
 
-            local_iov[local_iov_it].iov_base = (void *)((char *)iov[iov_it].buffer +
-                                                        iov_slice_delivered);
-            local_iov[local_iov_it].iov_len  = iov_slice_length - iov_slice_delivered;
-            ++local_iov_it;
-        }
-        if (!delivered) {
-            length = iov_it_length; /* Keep total length of the iov buffers */
-        }
+            /* the iov element buffer can be delivered partially */
+            skip = (offset > iov_start) ? (offset - iov_start) : 0;
 
-        if(!length) {
-            return UCS_OK; /* Nothing to deliver */
+            local_iov[local_iov_it].iov_base = UCS_PTR_BYTE_OFFSET(iov[iov_it].buffer,
+                                                                   skip);
+            local_iov[local_iov_it].iov_len  = ucs_min(iov_length - skip,
+                                                       remaining);
+            remaining -= local_iov[local_iov_it].iov_len;
+            ++local_iov_it;
         }
 
-        remote_iov.iov_base = (void *)(remote_addr + delivered);
-        remote_iov.iov_len  = length - delivered;
+        remote_iov.iov_base = (void *)(remote_addr + offset);
+        remote_iov.iov_len  = length - remaining;
 
         ret = fn_p(ep->remote_pid, local_iov, local_iov_it, &remote_iov, 1, 0);
         if (ret < 0) {
             ucs_error("%s delivered %zu instead of %zu, error message %s",
-                      fn_name, delivered, length, strerror(errno));
+                      fn_name, delivered, delivered + length, strerror(errno));
             return UCS_ERR_IO_ERROR;
         }
 
+        offset    += ret;
+        length    -= ret;
         delivered += ret;
-    } while (delivered < length);
+    }
 
     return UCS_OK;
 }
 
+static void uct_cma_ep_tx_part(void *arg, unsigned index)
+{
+    uct_cma_ep_tx_op_t *op = arg;
+    size_t offset          = index * op->part_length;
+    ucs_status_t status;
+
+    if (offset >= op->length) {
+        return;
+    }
+
+    status = uct_cma_ep_tx_range(op->ep, op->iov, op->iovcnt, op->remote_addr,
+                                 offset, ucs_min(op->part_length,
+                                                 op->length - offset),
+                                 op->fn_p, op->fn_name);
+    if (status != UCS_OK) {
+        op->status = status;
+    }
+}
+
+static UCS_F_ALWAYS_INLINE
+ucs_status_t uct_cma_ep_common_zcopy(uct_ep_h tl_ep,
+                                     const uct_iov_t *iov,
+                                     size_t iovcnt,
+                                     uint64_t remote_addr,
+                                     uct_completion_t *comp,
+                                     uct_cma_ep_tx_func_t fn_p,
+                                     char *fn_name)
+{
+    uct_cma_ep_t *ep       = ucs_derived_of(tl_ep, uct_cma_ep_t);
+    uct_cma_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_cma_iface_t);
+    size_t length          = uct_iov_total_length(iov, iovcnt);
+    uct_cma_ep_tx_op_t op;
+    unsigned num_parts;
+
+    if (!length) {
+        return UCS_OK; /* Nothing to deliver */
+    }
+
+    num_parts = ucs_min(iface->config.copy_threads,
+                        length / iface->config.copy_thread_size);
+    if (ucs_likely(num_parts <= 1)) {
+        return uct_cma_ep_tx_range(ep, iov, iovcnt, remote_addr, 0, length,
+                                   fn_p, fn_name);
+    }
+
+    /* split the data to page-aligned parts, so the threads don't fault on
+     * the same pages */
+    op.ep          = ep;
+    op.iov         = iov;
+    op.iovcnt      = iovcnt;
+    op.remote_addr = remote_addr;
+    op.length      = length;
+    op.part_length = ucs_align_up(ucs_div_round_up(length, num_parts),
+                                  ucs_get_page_size());
+    op.fn_p        = fn_p;
+    op.fn_name     = fn_name;
+    op.status      = UCS_OK;
+
+    ucs_sys_thread_pool_run(iface->copy_pool, uct_cma_ep_tx_part, &op,
+                            num_parts);
+    return op.status;
+}
 ucs_status_t uct_cma_ep_put_zcopy(uct_ep_h tl_ep, const uct_iov_t *iov, size_t iovcnt,
                                   uint64_t remote_addr, uct_rkey_t rkey,
                                   uct_completion_t *comp)
 {
-    UCT_CHECK_IOV_SIZE(iovcnt, uct_sm_get_max_iov(), "uct_cma_ep_put_zcopy");
+    UCT_CHECK_IOV_SIZE(iovcnt, ucs_get_max_iov(), "uct_cma_ep_put_zcopy");
 
     int ret = uct_cma_ep_common_zcopy(tl_ep,
                                       iov,
@@ -145,7 +208,7 @@ ucs_status_t uct_cma_ep_get_zcopy(uct_ep_h tl_ep, const uct_iov_t *iov, size_t i
                                   uint64_t remote_addr, uct_rkey_t rkey,
                                   uct_completion_t *comp)
 {
-    UCT_CHECK_IOV_SIZE(iovcnt, uct_sm_get_max_iov(), "uct_cma_ep_get_zcopy");
+    UCT_CHECK_IOV_SIZE(iovcnt, ucs_get_max_iov(), "uct_cma_ep_get_zcopy");
 
     int ret = uct_cma_ep_common_zcopy(tl_ep,
                                       iov,
@@ -19,6 +19,19 @@ static ucs_config_field_t uct_cma_iface_config_table[] = {
     {"", "ALLOC=huge,thp,mmap,heap", NULL,
     ucs_offsetof(uct_cma_iface_config_t, super),
     UCS_CONFIG_TYPE_TABLE(uct_iface_config_table)},
+
+    {"CMA_COPY_THREADS", "1",
+     "Maximal number of threads which copy the data of a single zcopy\n"
+     "operation. A large operation is split to parts which are copied by\n"
+     "helper threads in parallel, so it is not limited by the bandwidth of\n"
+     "a single core.",
+     ucs_offsetof(uct_cma_iface_config_t, copy_threads), UCS_CONFIG_TYPE_UINT},
+
+    {"CMA_COPY_THREAD_SIZE", "4m",
+     "Minimal amount of data to copy by each thread.",
+     ucs_offsetof(uct_cma_iface_config_t, copy_thread_size),
+     UCS_CONFIG_TYPE_MEMUNITS},
+
     {NULL}
 };
 
@@ -39,13 +52,13 @@ static ucs_status_t uct_cma_iface_query(uct_iface_h tl_iface,
     iface_attr->cap.put.max_zcopy       = SIZE_MAX;
     iface_attr->cap.put.opt_zcopy_align = 1;
     iface_attr->cap.put.align_mtu       = iface_attr->cap.put.opt_zcopy_align;
-    iface_attr->cap.put.max_iov         = uct_sm_get_max_iov();
+    iface_attr->cap.put.max_iov         = ucs_get_max_iov();
 
     iface_attr->cap.get.min_zcopy       = 0;
     iface_attr->cap.get.max_zcopy       = SIZE_MAX;
     iface_attr->cap.get.opt_zcopy_align = 1;
     iface_attr->cap.get.align_mtu       = iface_attr->cap.get.opt_zcopy_align;
-    iface_attr->cap.get.max_iov         = uct_sm_get_max_iov();
+    iface_attr->cap.get.max_iov         = ucs_get_max_iov();
 
     iface_attr->cap.am.max_iov          = 1;
     iface_attr->cap.am.opt_zcopy_align  = 1;
@@ -93,6 +106,10 @@ static UCS_CLASS_INIT_FUNC(uct_cma_iface_t, uct_md_h md, uct_worker_h worker,
                            const uct_iface_params_t *params,
                            const uct_iface_config_t *tl_config)
 {
+    const uct_cma_iface_config_t *cma_config = ucs_derived_of(tl_config,
+                                                              uct_cma_iface_config_t);
+    ucs_status_t status;
+
     UCT_CHECK_PARAM(params->field_mask & UCT_IFACE_PARAM_FIELD_OPEN_MODE,
                     "UCT_IFACE_PARAM_FIELD_OPEN_MODE is not defined");
     if (!(params->open_mode & UCT_IFACE_OPEN_MODE_DEVICE)) {
@@ -106,13 +123,34 @@ static UCS_CLASS_INIT_FUNC(uct_cma_iface_t, uct_md_h md, uct_worker_h worker,
                                              UCT_IFACE_PARAM_FIELD_STATS_ROOT) ?
                                             params->stats_root : NULL)
                               UCS_STATS_ARG(UCT_CMA_TL_NAME));
-    uct_sm_get_max_iov(); /* to initialize ucs_get_max_iov static variable */
+    ucs_get_max_iov(); /* to initialize ucs_get_max_iov static variable */
+
+    if (cma_config->copy_threads == 0) {
+        ucs_error("CMA_COPY_THREADS must be at least 1");
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    self->config.copy_threads     = cma_config->copy_threads;
+    self->config.copy_thread_size = ucs_max(cma_config->copy_thread_size,
+                                            ucs_get_page_size());
+
+    self->copy_pool = NULL;
+    if (self->config.copy_threads > 1) {
+        status = ucs_sys_thread_pool_create(self->config.copy_threads - 1,
+                                            "cma copy", &self->copy_pool);
+        if (status != UCS_OK) {
+            return status;
+        }
+    }
 
     return UCS_OK;
 }
 
 static UCS_CLASS_CLEANUP_FUNC(uct_cma_iface_t)
 {
+    if (self->copy_pool != NULL) {
+        ucs_sys_thread_pool_destroy(self->copy_pool);
+    }
 }
 
 UCS_CLASS_DEFINE(uct_cma_iface_t, uct_base_iface_t);
@@ -8,17 +8,25 @@
 #define UCT_CMA_IFACE_H
 
 #include <uct/base/uct_iface.h>
+#include <ucs/sys/sys.h>
 
 #define UCT_CMA_TL_NAME "cma"
 
 
 typedef struct uct_cma_iface_config {
     uct_iface_config_t      super;
+    unsigned                copy_threads;     /* Max. threads for a single copy */
+    size_t                  copy_thread_size; /* Min. data size per thread */
 } uct_cma_iface_config_t;
 
 
 typedef struct uct_cma_iface {
     uct_base_iface_t        super;
+    ucs_sys_thread_pool_t   *copy_pool;       /* Helper copy threads, or NULL */
+    struct {
+        unsigned            copy_threads;
+        size_t              copy_thread_size;
+    } config;
 } uct_cma_iface_t;
 
 
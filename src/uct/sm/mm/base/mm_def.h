@@ -15,15 +15,18 @@
 typedef struct uct_mm_ep                uct_mm_ep_t;
 typedef struct uct_mm_iface             uct_mm_iface_t;
 typedef struct uct_mm_fifo_ctl          uct_mm_fifo_ctl_t;
+typedef struct uct_mm_ring_ctl          uct_mm_ring_ctl_t;
 typedef struct uct_mm_fifo_element      uct_mm_fifo_element_t;
+typedef struct uct_mm_fifo_desc         uct_mm_fifo_desc_t;
 typedef struct uct_mm_recv_desc         uct_mm_recv_desc_t;
 typedef struct uct_mm_remote_seg        uct_mm_remote_seg_t;
+typedef struct uct_mm_zcopy_desc        uct_mm_zcopy_desc_t;
 
-#define UCT_MM_BASE_ADDRESS_HASH_SIZE    64
 
 enum {
     UCT_MM_FIFO_ELEM_FLAG_OWNER  = UCS_BIT(0), /* new/old info */
     UCT_MM_FIFO_ELEM_FLAG_INLINE = UCS_BIT(1), /* if inline or not */
+    UCT_MM_FIFO_ELEM_FLAG_ZCOPY  = UCS_BIT(2), /* data is in the sender's memory */
 };
 
 enum {
@@ -35,9 +38,15 @@ enum {
           (uct_mm_fifo_element_t*) ((char*)(_fifo) + ((_index) * \
           (_iface)->config.fifo_elem_size));
 
-#define UCT_MM_IFACE_GET_DESC_START(_iface, _fifo_elem_p) \
-          (uct_mm_recv_desc_t *) ((_fifo_elem_p)->desc_chunk_base_addr +  \
-          (_fifo_elem_p)->desc_offset - (_iface)->rx_headroom) - 1;
+/* The receive descriptors of the FIFO elements follow the elements */
+#define UCT_MM_IFACE_GET_FIFO_DESCS(_iface, _fifo, _fifo_size) \
+          (uct_mm_fifo_desc_t*) ((char*)(_fifo) + \
+          ucs_align_up((_fifo_size) * (_iface)->config.fifo_elem_size, \
+                       UCS_SYS_CACHE_LINE_SIZE))
+
+#define UCT_MM_IFACE_GET_DESC_START(_iface, _fifo_desc_p) \
+          (uct_mm_recv_desc_t *) ((_fifo_desc_p)->chunk_base_addr +  \
+          (_fifo_desc_p)->offset - (_iface)->rx_headroom) - 1;
 
 
 /* Check if the resources on the remote peer are available for sending to it.
@@ -49,8 +58,10 @@ enum {
           ucs_likely(((_head) - (_tail)) < (_fifo_size))
 
 typedef struct uct_mm_md_config {
-    uct_md_config_t      super;
-    ucs_ternary_value_t  hugetlb_mode;     /* Enable using huge pages */
+    uct_md_config_t        super;
+    ucs_ternary_value_t    hugetlb_mode;     /* Enable using huge pages */
+    ucs_ternary_value_t    rcache_enable;    /* Enable registration cache */
+    uct_md_rcache_config_t rcache;           /* Registration cache config */
 } uct_mm_md_config_t;
 
 
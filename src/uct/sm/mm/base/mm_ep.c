@@ -9,19 +9,24 @@
 
 #include <ucs/arch/atomic.h>
 
-SGLIB_DEFINE_LIST_FUNCTIONS(uct_mm_remote_seg_t, uct_mm_remote_seg_compare, next)
-SGLIB_DEFINE_HASHED_CONTAINER_FUNCTIONS(uct_mm_remote_seg_t,
-                                        UCT_MM_BASE_ADDRESS_HASH_SIZE,
-                                        uct_mm_remote_seg_hash)
 
-
-/* send a signal to remote interface using Unix-domain socket */
-static void uct_mm_ep_signal_remote(uct_mm_ep_t *ep)
+/* send a signal to remote interface using Unix-domain socket, if it waits for
+ * one. only the sender which clears the armed flag sends the signal */
+static UCS_F_NOINLINE void uct_mm_ep_signal_remote(uct_mm_ep_t *ep)
 {
     uct_mm_iface_t *iface = ucs_derived_of(ep->super.super.iface, uct_mm_iface_t);
     char dummy = 0;
     int ret;
 
+    /* the posted element must be visible before the armed flag is read, since
+     * the receiver checks the FIFO after setting the flag */
+    ucs_memory_bus_fence();
+    if (!ep->fifo_ctl->armed ||
+        (ucs_atomic_cswap64(&ep->fifo_ctl->armed, 1, 0) != 1)) {
+        ucs_trace_poll("remote interface is not armed, not sending a signal");
+        return;
+    }
+
     for (;;) {
         ret = sendto(iface->signal_fd, &dummy, sizeof(dummy), 0,
                      (const struct sockaddr*)&ep->signal.sockaddr,
@@ -50,6 +55,133 @@ static void uct_mm_ep_signal_remote(uct_mm_ep_t *ep)
     }
 }
 
+static void uct_mm_ep_set_ring(uct_mm_ep_t *ep, uct_mm_iface_t *iface,
+                               unsigned index, uct_mm_ring_ctl_t *ring_ctl,
+                               void *ring_elems)
+{
+    ep->ring_ctl   = ring_ctl;
+    ep->ring_bit   = UCS_BIT(index);
+    ep->fifo       = ring_elems;
+    ep->fifo_descs = UCT_MM_IFACE_GET_FIFO_DESCS(iface, ring_elems,
+                                                 iface->config.ring_size);
+    ep->fifo_head  = &ring_ctl->head;
+    ep->fifo_tail  = &ring_ctl->tail;
+    ep->fifo_size  = iface->config.ring_size;
+}
+
+/* Take over the ring of a sender process which exited without releasing it.
+ * The sender may have exited after it claimed the last element and before it
+ * posted it, so the receiver would never read past it - give it back */
+static void uct_mm_ep_recover_ring(uct_mm_ep_t *ep, uct_mm_iface_t *iface)
+{
+    uint64_t head = *ep->fifo_head;
+    uct_mm_fifo_element_t *elem;
+    uint64_t owner_bit;
+
+    if (head == *ep->fifo_tail) {
+        return;
+    }
+
+    elem      = UCT_MM_IFACE_GET_FIFO_ELEM(iface, ep->fifo,
+                                           (head - 1) & (ep->fifo_size - 1));
+    owner_bit = ((head - 1) & ep->fifo_size) ? UCT_MM_FIFO_ELEM_FLAG_OWNER : 0;
+    if ((elem->flags & UCT_MM_FIFO_ELEM_FLAG_OWNER) != owner_bit) {
+        *ep->fifo_head = head - 1;
+    }
+}
+
+/* A sender ring is owned by a process, which is identified by its pid and its
+ * start time, so a process which got the pid of an exited owner is not taken
+ * for the owner */
+static uint64_t uct_mm_ep_ring_owner_id(pid_t pid, unsigned long start_time)
+{
+    return ((uint64_t)pid << 32) | (uint32_t)start_time;
+}
+
+static int uct_mm_ep_ring_owner_exited(uct_mm_ring_ctl_t *ring_ctl,
+                                       uint64_t owner, uint64_t pid_ns)
+{
+    unsigned long start_time;
+
+    /* the pid of the owner can be checked only in its own PID namespace */
+    if ((pid_ns == 0) || (ring_ctl->owner_pid_ns != pid_ns)) {
+        return 0;
+    }
+
+    start_time = ucs_sys_get_proc_start_time(owner >> 32);
+    return (start_time == 0) || ((uint32_t)start_time != (uint32_t)owner);
+}
+
+/* Take a free sender ring in the remote FIFO, if there is one */
+static void uct_mm_ep_claim_ring(uct_mm_ep_t *ep, uct_mm_iface_t *iface)
+{
+    pid_t pid       = getpid();
+    uint64_t pid_ns = ucs_sys_get_pid_ns();
+    uct_mm_ring_ctl_t *ring_ctl;
+    uint64_t self_id, owner;
+    void *ring_elems;
+    unsigned i;
+
+    self_id = uct_mm_ep_ring_owner_id(pid, ucs_sys_get_proc_start_time(pid));
+
+    for (i = 0; i < iface->config.sender_rings; i++) {
+        ring_ctl = uct_mm_iface_get_ring(iface, ep->fifo_ctl, i, &ring_elems);
+        if ((ring_ctl->owner != 0) ||
+            (ucs_atomic_cswap64(&ring_ctl->owner, 0, self_id) != 0)) {
+            continue;
+        }
+
+        ring_ctl->owner_pid_ns = pid_ns;
+        uct_mm_ep_set_ring(ep, iface, i, ring_ctl, ring_elems);
+        ucs_debug("mm: ep %p claimed sender ring %u", ep, i);
+        return;
+    }
+
+    /* all rings are taken. the endpoints of a failed sender process could not
+     * release their rings, so take a ring whose owner does not exist */
+    for (i = 0; i < iface->config.sender_rings; i++) {
+        ring_ctl = uct_mm_iface_get_ring(iface, ep->fifo_ctl, i, &ring_elems);
+        owner    = ring_ctl->owner;
+        if ((owner == 0) ||
+            !uct_mm_ep_ring_owner_exited(ring_ctl, owner, pid_ns) ||
+            (ucs_atomic_cswap64(&ring_ctl->owner, owner, self_id) != owner)) {
+            continue;
+        }
+
+        uct_mm_ep_set_ring(ep, iface, i, ring_ctl, ring_elems);
+        uct_mm_ep_recover_ring(ep, iface);
+        ucs_debug("mm: ep %p took over sender ring %u of exited process %"PRIu64,
+                  ep, i, owner >> 32);
+        return;
+    }
+
+    ucs_debug("mm: ep %p: all sender rings are taken, using the shared FIFO", ep);
+}
+
+/* The senders find the elements and the rings of the remote FIFO by their
+ * own configuration, so it must match the one of the receiver */
+static ucs_status_t uct_mm_ep_check_fifo_layout(uct_mm_ep_t *ep,
+                                                uct_mm_iface_t *iface)
+{
+    uct_mm_fifo_ctl_t *fifo_ctl = ep->fifo_ctl;
+
+    if ((fifo_ctl->fifo_size      == iface->config.fifo_size)      &&
+        (fifo_ctl->fifo_elem_size == iface->config.fifo_elem_size) &&
+        (fifo_ctl->sender_rings   == iface->config.sender_rings)   &&
+        (fifo_ctl->ring_size      == iface->config.ring_size)) {
+        return UCS_OK;
+    }
+
+    ucs_error("mm: remote FIFO (fifo_size %u elem_size %u sender_rings %u "
+              "ring_size %u) does not match the local configuration "
+              "(fifo_size %u elem_size %u sender_rings %u ring_size %u)",
+              fifo_ctl->fifo_size, fifo_ctl->fifo_elem_size,
+              fifo_ctl->sender_rings, fifo_ctl->ring_size,
+              iface->config.fifo_size, iface->config.fifo_elem_size,
+              iface->config.sender_rings, iface->config.ring_size);
+    return UCS_ERR_UNREACHABLE;
+}
+
 static UCS_CLASS_INIT_FUNC(uct_mm_ep_t, const uct_ep_params_t *params)
 {
     uct_mm_iface_t *iface = ucs_derived_of(params->iface, uct_mm_iface_t);
@@ -83,45 +215,74 @@ static UCS_CLASS_INIT_FUNC(uct_mm_ep_t, const uct_ep_params_t *params)
     /* point the ep->fifo_ctl to the remote fifo.
       * it's an aligned pointer to the beginning of the ctl struct in the remote FIFO */
     self->fifo_ctl        = uct_mm_set_fifo_ctl(self->mapped_desc.address);
-    self->cached_tail     = self->fifo_ctl->tail;
     self->signal.addrlen  = self->fifo_ctl->signal_addrlen;
     self->signal.sockaddr = self->fifo_ctl->signal_sockaddr;
 
     /* Make sure the fifo ctrl is aligned */
     ucs_assert_always(((uintptr_t)self->fifo_ctl % UCS_SYS_CACHE_LINE_SIZE) == 0);
 
+    status = uct_mm_ep_check_fifo_layout(self, iface);
+    if (status != UCS_OK) {
+        goto err_detach;
+    }
+
     /* set the ep->fifo ptr to point to the beginning of the fifo elements at
      * the remote peer */
     uct_mm_set_fifo_elems_ptr(self->mapped_desc.address, &self->fifo);
+    self->fifo_descs = UCT_MM_IFACE_GET_FIFO_DESCS(iface, self->fifo,
+                                                   iface->config.fifo_size);
+    self->fifo_head  = &self->fifo_ctl->head;
+    self->fifo_tail  = &self->fifo_ctl->tail;
+    self->fifo_size  = iface->config.fifo_size;
+    self->ring_ctl   = NULL;
+    self->ring_bit   = 0;
+
+    /* prefer a sender ring of our own over the shared FIFO */
+    if (iface->config.sender_rings > 0) {
+        uct_mm_ep_claim_ring(self, iface);
+    }
 
-    /* Initiate the hash which will keep the base_adresses of remote memory
-     * chunks that hold the descriptors for bcopy. */
-    sglib_hashed_uct_mm_remote_seg_t_init(self->remote_segments_hash);
+    self->cached_tail = *self->fifo_tail;
 
     ucs_arbiter_group_init(&self->arb_group);
+    ucs_queue_head_init(&self->zcopy_q);
+    self->slow_prog_id = UCS_CALLBACKQ_ID_NULL;
 
     ucs_debug("mm: ep connected: %p, to remote_shmid: %zu", self, addr->id);
 
     return UCS_OK;
+
+err_detach:
+    uct_mm_md_mapper_ops(iface->super.md)->detach(&self->mapped_desc);
+    return status;
 }
 
 static UCS_CLASS_CLEANUP_FUNC(uct_mm_ep_t)
 {
     uct_mm_iface_t *iface = ucs_derived_of(self->super.super.iface, uct_mm_iface_t);
     ucs_status_t status;
-    uct_mm_remote_seg_t *remote_seg;
-    struct sglib_hashed_uct_mm_remote_seg_t_iterator iter;
-
-    for (remote_seg = sglib_hashed_uct_mm_remote_seg_t_it_init(&iter, self->remote_segments_hash);
-         remote_seg != NULL; remote_seg = sglib_hashed_uct_mm_remote_seg_t_it_next(&iter)) {
-            sglib_hashed_uct_mm_remote_seg_t_delete(self->remote_segments_hash, remote_seg);
-            /* detach the remote proceess's descriptors segment */
-            status = uct_mm_md_mapper_ops(iface->super.md)->detach(remote_seg);
-            if (status != UCS_OK) {
-                ucs_warn("Unable to detach shared memory segment of descriptors: %s",
-                         ucs_status_string(status));
+    uct_mm_zcopy_op_t *op;
+
+    uct_worker_progress_unregister_safe(&iface->super.worker->super,
+                                        &self->slow_prog_id);
+
+    /* cancel the zcopy operations which were not completed */
+    if (!ucs_queue_is_empty(&self->zcopy_q)) {
+        ucs_list_del(&self->zcopy_list);
+        ucs_queue_for_each_extract(op, &self->zcopy_q, queue, 1) {
+            if (op->comp != NULL) {
+                uct_invoke_completion(op->comp, UCS_ERR_CANCELED);
             }
-            ucs_free(remote_seg);
+            ucs_mpool_put(op);
+        }
+    }
+
+    /* release the sender ring. the receiver reads the remaining elements of
+     * the ring and the next owner continues from its head */
+    if (self->ring_ctl != NULL) {
+        self->ring_ctl->owner_pid_ns = 0;
+        ucs_memory_cpu_store_fence();
+        self->ring_ctl->owner = 0;
     }
 
     /* detach the remote proceess's shared memory segment (remote recv FIFO) */
@@ -137,45 +298,18 @@ UCS_CLASS_DEFINE(uct_mm_ep_t, uct_base_ep_t)
 UCS_CLASS_DEFINE_NEW_FUNC(uct_mm_ep_t, uct_ep_t, const uct_ep_params_t *);
 UCS_CLASS_DEFINE_DELETE_FUNC(uct_mm_ep_t, uct_ep_t);
 
-void *uct_mm_ep_attach_remote_seg(uct_mm_ep_t *ep, uct_mm_iface_t *iface, uct_mm_fifo_element_t *elem)
+static ucs_status_t
+uct_mm_ep_attach_remote_seg(uct_mm_ep_t *ep, uct_mm_iface_t *iface,
+                            uct_mm_fifo_desc_t *fifo_desc, void **address_p)
 {
-    uct_mm_remote_seg_t *remote_seg, search;
-    ucs_status_t status;
-
-    /* take the mmid of the chunk that the desc belongs to, (the desc that the fifo_elem
-     * is 'assigned' to), and check if the ep has already attached to it.
-     */
-    search.mmid = elem->desc_mmid;
-    remote_seg = sglib_hashed_uct_mm_remote_seg_t_find_member(ep->remote_segments_hash, &search);
-    if (remote_seg == NULL) {
-        /* not in the hash. attach to the memory the mmid refers to. the attach call
-         * will return the base address of the mmid's chunk -
-         * save this base address in a hash table (which maps mmid to base address). */
-        remote_seg = ucs_malloc(sizeof(*remote_seg), "mm_desc");
-        if (remote_seg == NULL) {
-            ucs_fatal("Failed to allocated memory for a remote segment identifier. %m");
-        }
-
-        status = uct_mm_md_mapper_ops(iface->super.md)->attach(elem->desc_mmid,
-                                                               elem->desc_mpool_size,
-                                                               elem->desc_chunk_base_addr,
-                                                               &remote_seg->address,
-                                                               &remote_seg->cookie,
-                                                               iface->path);
-        if (status != UCS_OK) {
-            ucs_fatal("Failed to attach to remote mmid:%zu. %s ",
-                      elem->desc_mmid, ucs_status_string(status));
-        }
-
-        remote_seg->mmid   = elem->desc_mmid;
-        remote_seg->length = elem->desc_mpool_size;
-
-        /* put the base address into the ep's hash table */
-        sglib_hashed_uct_mm_remote_seg_t_add(ep->remote_segments_hash, remote_seg);
-    }
-
-    return remote_seg->address;
-
+    /* take the mmid of the chunk that the desc belongs to, (the desc that the
+     * fifo_elem is 'assigned' to), and attach to it if the iface didn't yet.
+     * the attached chunks are shared by all the endpoints of the iface */
+    return uct_mm_iface_attach_remote_seg(iface, fifo_desc->mmid,
+                                          fifo_desc->serial,
+                                          fifo_desc->mpool_size,
+                                          fifo_desc->chunk_base_addr,
+                                          address_p);
 }
 
 static inline ucs_status_t uct_mm_ep_get_remote_elem(uct_mm_ep_t *ep, uint64_t head,
@@ -186,11 +320,17 @@ static inline ucs_status_t uct_mm_ep_get_remote_elem(uct_mm_ep_t *ep, uint64_t h
                                /* must be smaller than fifo size */
     uint64_t returned_val;
 
-    elem_index = ep->fifo_ctl->head & iface->fifo_mask;
+    elem_index = head & (ep->fifo_size - 1);
     *elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, ep->fifo, elem_index);
 
+    if (ep->ring_ctl != NULL) {
+        /* the ep is the only writer to its sender ring */
+        *ep->fifo_head = head + 1;
+        return UCS_OK;
+    }
+
     /* try to get ownership of the head element */
-    returned_val = ucs_atomic_cswap64(&ep->fifo_ctl->head, head, head+1);
+    returned_val = ucs_atomic_cswap64(ep->fifo_head, head, head+1);
     if (returned_val != head) {
         return UCS_ERR_NO_RESOURCE;
     }
@@ -201,31 +341,29 @@ static inline ucs_status_t uct_mm_ep_get_remote_elem(uct_mm_ep_t *ep, uint64_t h
 static inline void uct_mm_ep_update_cached_tail(uct_mm_ep_t *ep)
 {
     ucs_memory_cpu_load_fence();
-    ep->cached_tail = ep->fifo_ctl->tail;
+    ep->cached_tail = *ep->fifo_tail;
 }
 
-/* A common mm active message sending function.
- * The first parameter indicates the origin of the call.
- * is_short = 1 - perform AM short sending
- * is_short = 0 - perform AM bcopy sending
+/* Claim the next element in the remote receive FIFO.
+ * Returns UCS_ERR_NO_RESOURCE if the FIFO is full.
+ * If desc_data_p is not NULL, returns the data of the element's receive
+ * descriptor. The descriptor is attached before the element is taken, so a
+ * failure to attach it leaves the FIFO intact.
  */
-static UCS_F_ALWAYS_INLINE ssize_t
-uct_mm_ep_am_common_send(unsigned is_short, uct_mm_ep_t *ep, uct_mm_iface_t *iface,
-                         uint8_t am_id, size_t length, uint64_t header,
-                         const void *payload, uct_pack_callback_t pack_cb, void *arg,
-                         unsigned flags)
+static UCS_F_ALWAYS_INLINE ucs_status_t
+uct_mm_ep_claim_remote_elem(uct_mm_ep_t *ep, uct_mm_iface_t *iface,
+                            uint64_t *head_p, uct_mm_fifo_element_t **elem_p,
+                            void **desc_data_p)
 {
-    uct_mm_fifo_element_t *elem;
+    uct_mm_fifo_desc_t *fifo_desc;
     ucs_status_t status;
     void *base_address;
     uint64_t head;
 
-    UCT_CHECK_AM_ID(am_id);
-
 retry:
-    head = ep->fifo_ctl->head;
+    head = *ep->fifo_head;
     /* check if there is room in the remote process's receive FIFO to write */
-    if (!UCT_MM_EP_IS_ABLE_TO_SEND(head, ep->cached_tail, iface->config.fifo_size)) {
+    if (!UCT_MM_EP_IS_ABLE_TO_SEND(head, ep->cached_tail, ep->fifo_size)) {
         if (!ucs_arbiter_group_is_empty(&ep->arb_group)) {
             /* pending isn't empty. don't send now to prevent out-of-order sending */
             UCS_STATS_UPDATE_COUNTER(ep->super.stats, UCT_EP_STAT_NO_RES, 1);
@@ -234,20 +372,95 @@ retry:
             /* pending is empty */
             /* update the local copy of the tail to its actual value on the remote peer */
             uct_mm_ep_update_cached_tail(ep);
-            if (!UCT_MM_EP_IS_ABLE_TO_SEND(head, ep->cached_tail, iface->config.fifo_size)) {
+            if (!UCT_MM_EP_IS_ABLE_TO_SEND(head, ep->cached_tail, ep->fifo_size)) {
                 UCS_STATS_UPDATE_COUNTER(ep->super.stats, UCT_EP_STAT_NO_RES, 1);
                 return UCS_ERR_NO_RESOURCE;
             }
         }
     }
 
-    status = uct_mm_ep_get_remote_elem(ep, head, &elem);
+    if (desc_data_p != NULL) {
+        /* the receiver doesn't change the descriptor of a released element */
+        fifo_desc = &ep->fifo_descs[head & (ep->fifo_size - 1)];
+        status    = uct_mm_ep_attach_remote_seg(ep, iface, fifo_desc,
+                                                &base_address);
+        if (ucs_unlikely(status != UCS_OK)) {
+            return status;
+        }
+
+        *desc_data_p = base_address + fifo_desc->offset;
+    }
+
+    status = uct_mm_ep_get_remote_elem(ep, head, elem_p);
     if (status != UCS_OK) {
         ucs_assert(status == UCS_ERR_NO_RESOURCE);
         ucs_trace_poll("couldn't get an available FIFO element. retrying");
         goto retry;
     }
 
+    *head_p = head;
+    return UCS_OK;
+}
+
+/* Pass a claimed FIFO element, whose data was written, to the receiver */
+static UCS_F_ALWAYS_INLINE void
+uct_mm_ep_post_remote_elem(uct_mm_ep_t *ep, uct_mm_iface_t *iface,
+                           uct_mm_fifo_element_t *elem, uint64_t head,
+                           uint8_t am_id, unsigned flags)
+{
+    elem->am_id = am_id;
+
+    /* memory barrier - make sure that the memory is flushed before setting the
+     * 'writing is complete' flag which the reader checks */
+    ucs_memory_cpu_store_fence();
+
+    /* change the owner bit to indicate that the writing is complete.
+     * the owner bit flips after every FIFO wraparound */
+    if (head & ep->fifo_size) {
+        elem->flags |= UCT_MM_FIFO_ELEM_FLAG_OWNER;
+    } else {
+        elem->flags &= ~UCT_MM_FIFO_ELEM_FLAG_OWNER;
+    }
+
+    if (ep->ring_ctl != NULL) {
+        /* the receiver clears the doorbell before reading the ring, so the
+         * element must be visible before the doorbell is checked */
+        ucs_memory_bus_fence();
+        if (!(ep->fifo_ctl->ring_doorbell & ep->ring_bit)) {
+            ucs_atomic_or64(&ep->fifo_ctl->ring_doorbell, ep->ring_bit);
+        }
+    }
+
+    if (ucs_unlikely(flags & UCT_SEND_FLAG_SIGNALED)) {
+        uct_mm_ep_signal_remote(ep);
+    }
+}
+
+/* A common mm active message sending function.
+ * The first parameter indicates the origin of the call.
+ * is_short = 1 - perform AM short sending
+ * is_short = 0 - perform AM bcopy sending
+ */
+static UCS_F_ALWAYS_INLINE ssize_t
+uct_mm_ep_am_common_send(unsigned is_short, uct_mm_ep_t *ep, uct_mm_iface_t *iface,
+                         uint8_t am_id, size_t length, uint64_t header,
+                         const void *payload, uct_pack_callback_t pack_cb, void *arg,
+                         unsigned flags)
+{
+    uct_mm_fifo_element_t *elem;
+    ucs_status_t status;
+    void *desc_data;
+    uint64_t head;
+
+    UCT_CHECK_AM_ID(am_id);
+
+    /* bcopy data is written to the remote descriptor of the element */
+    status = uct_mm_ep_claim_remote_elem(ep, iface, &head, &elem,
+                                         is_short ? NULL : &desc_data);
+    if (status != UCS_OK) {
+        return status;
+    }
+
     if (is_short) {
         /* AM_SHORT */
         /* write to the remote FIFO */
@@ -263,36 +476,18 @@ retry:
     } else {
         /* AM_BCOPY */
         /* write to the remote descriptor */
-        /* get the base_address: local ptr to remote memory chunk after attaching to it */
-        base_address = uct_mm_ep_attach_remote_seg(ep, iface, elem);
-        length = pack_cb(base_address + elem->desc_offset, arg);
+        length = pack_cb(desc_data, arg);
 
-        elem->flags &= ~UCT_MM_FIFO_ELEM_FLAG_INLINE;
+        elem->flags &= ~(UCT_MM_FIFO_ELEM_FLAG_INLINE | UCT_MM_FIFO_ELEM_FLAG_ZCOPY);
         elem->length = length;
 
         uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, am_id,
-                           base_address + elem->desc_offset, length, "TX: AM_BCOPY");
+                           desc_data, length, "TX: AM_BCOPY");
 
         UCT_TL_EP_STAT_OP(&ep->super, AM, BCOPY, length);
     }
 
-    elem->am_id = am_id;
-
-    /* memory barrier - make sure that the memory is flushed before setting the
-     * 'writing is complete' flag which the reader checks */
-    ucs_memory_cpu_store_fence();
-
-    /* change the owner bit to indicate that the writing is complete.
-     * the owner bit flips after every FIFO wraparound */
-    if (head & iface->config.fifo_size) {
-        elem->flags |= UCT_MM_FIFO_ELEM_FLAG_OWNER;
-    } else {
-        elem->flags &= ~UCT_MM_FIFO_ELEM_FLAG_OWNER;
-    }
-
-    if (ucs_unlikely(flags & UCT_SEND_FLAG_SIGNALED)) {
-        uct_mm_ep_signal_remote(ep);
-    }
+    uct_mm_ep_post_remote_elem(ep, iface, elem, head, am_id, flags);
 
     if (is_short) {
         return UCS_OK;
@@ -325,11 +520,176 @@ ssize_t uct_mm_ep_am_bcopy(uct_ep_h tl_ep, uint8_t id, uct_pack_callback_t pack_
                                     pack_cb, arg, flags);
 }
 
+typedef struct {
+    const void *header;
+    unsigned   header_length;
+    const void *buffer;
+    size_t     length;
+} uct_mm_ep_zcopy_pack_arg_t;
+
+static size_t uct_mm_ep_zcopy_pack(void *dest, void *arg)
+{
+    uct_mm_ep_zcopy_pack_arg_t *pack_arg = arg;
+
+    memcpy(dest, pack_arg->header, pack_arg->header_length);
+    memcpy(dest + pack_arg->header_length, pack_arg->buffer, pack_arg->length);
+    return pack_arg->header_length + pack_arg->length;
+}
+
+ucs_status_t uct_mm_ep_am_zcopy(uct_ep_h tl_ep, uint8_t id, const void *header,
+                                unsigned header_length, const uct_iov_t *iov,
+                                size_t iovcnt, unsigned flags,
+                                uct_completion_t *comp)
+{
+    uct_mm_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_mm_iface_t);
+    uct_mm_ep_t *ep = ucs_derived_of(tl_ep, uct_mm_ep_t);
+    size_t length = uct_iov_total_length(iov, iovcnt);
+    uct_mm_zcopy_desc_t *zcopy_desc;
+    uct_mm_fifo_element_t *elem;
+    uct_mm_ep_zcopy_pack_arg_t pack_arg;
+    uct_mm_zcopy_op_t *op;
+    ucs_status_t status;
+    uct_mm_seg_t *seg;
+    uint64_t head;
+    ssize_t packed;
+
+    UCT_CHECK_AM_ID(id);
+    UCT_CHECK_IOV_SIZE(iovcnt, 1ul, "uct_mm_ep_am_zcopy");
+    UCT_CHECK_LENGTH(header_length, 0,
+                     iface->config.fifo_elem_size - sizeof(uct_mm_fifo_element_t) -
+                     sizeof(uct_mm_zcopy_desc_t), "am_zcopy header");
+    UCT_CHECK_LENGTH(header_length + length, 0, iface->config.seg_size,
+                     "am_zcopy");
+
+    /* the receiver reads the data from the memory chunk it was allocated or
+     * registered on */
+    seg = (length > 0) ? iov[0].memh : NULL;
+    if ((length > 0) && (seg == UCT_MEM_HANDLE_NULL)) {
+        /* the receiver can't map the buffer, e.g the mapper does not support
+         * registration, so copy the data to the FIFO descriptor */
+        pack_arg.header        = header;
+        pack_arg.header_length = header_length;
+        pack_arg.buffer        = iov[0].buffer;
+        pack_arg.length        = length;
+        packed = uct_mm_ep_am_common_send(UCT_MM_AM_BCOPY, ep, iface, id, 0, 0,
+                                          NULL, uct_mm_ep_zcopy_pack, &pack_arg,
+                                          flags);
+        return (packed < 0) ? (ucs_status_t)packed : UCS_OK;
+    }
+
+    op = ucs_mpool_get_inline(&iface->zcopy_mp);
+    if (ucs_unlikely(op == NULL)) {
+        ucs_error("failed to allocate mm zcopy operation");
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    status = uct_mm_ep_claim_remote_elem(ep, iface, &head, &elem, NULL);
+    if (status != UCS_OK) {
+        ucs_mpool_put_inline(op);
+        return status;
+    }
+
+    zcopy_desc = (uct_mm_zcopy_desc_t*)(elem + 1);
+    if (length > 0) {
+        zcopy_desc->mmid        = seg->mmid;
+        zcopy_desc->serial      = seg->serial;
+        zcopy_desc->seg_address = (uintptr_t)seg->address;
+        zcopy_desc->seg_length  = seg->length;
+        zcopy_desc->offset      = iov[0].buffer - seg->address;
+    } else {
+        zcopy_desc->offset      = 0;
+    }
+
+    if ((length > 0) && (header_length > 0) &&
+        (header + header_length == iov[0].buffer) &&
+        (header >= seg->address)) {
+        /* the header precedes the data in the same chunk, so the receiver can
+         * pass both of them to the user without copying */
+        zcopy_desc->offset -= header_length;
+        zcopy_desc->length  = header_length + length;
+        elem->length        = 0;
+    } else {
+        memcpy(zcopy_desc + 1, header, header_length);
+        zcopy_desc->length  = length;
+        elem->length        = header_length;
+    }
+
+    elem->flags &= ~UCT_MM_FIFO_ELEM_FLAG_INLINE;
+    elem->flags |= UCT_MM_FIFO_ELEM_FLAG_ZCOPY;
+
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, id, header,
+                       header_length, "TX: AM_ZCOPY");
+    UCT_TL_EP_STAT_OP(&ep->super, AM, ZCOPY, header_length + length);
+
+    uct_mm_ep_post_remote_elem(ep, iface, elem, head, id, flags);
+
+    /* the data may be reused after the receiver releases the FIFO element */
+    op->fifo_index = head;
+    op->comp       = comp;
+    if (ucs_queue_is_empty(&ep->zcopy_q)) {
+        ucs_list_add_tail(&iface->zcopy_eps, &ep->zcopy_list);
+    }
+    ucs_queue_push(&ep->zcopy_q, &op->queue);
+    return UCS_INPROGRESS;
+}
+
+static unsigned uct_mm_ep_failed_progress(void *arg)
+{
+    uct_mm_ep_t *ep = arg;
+
+    ep->slow_prog_id = UCS_CALLBACKQ_ID_NULL;
+    uct_set_ep_failed(&UCS_CLASS_NAME(uct_mm_ep_t), &ep->super.super,
+                      ep->super.super.iface, UCS_ERR_IO_ERROR);
+    return 1;
+}
+
+unsigned uct_mm_ep_progress_zcopy(uct_mm_ep_t *ep)
+{
+    uct_mm_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                           uct_mm_iface_t);
+    unsigned count = 0;
+    uct_mm_zcopy_op_t *op;
+    ucs_status_t status;
+
+    uct_mm_ep_update_cached_tail(ep);
+
+    ucs_queue_for_each_extract(op, &ep->zcopy_q, queue,
+                               op->fifo_index < ep->cached_tail) {
+        /* the receiver marks the element of a message whose data it could
+         * not read before releasing it */
+        ucs_memory_cpu_load_fence();
+        if (ucs_unlikely(ep->fifo_descs[op->fifo_index &
+                                        (ep->fifo_size - 1)].failed_index ==
+                         op->fifo_index)) {
+            ucs_debug("mm_ep %p: receiver failed to read zcopy message %"PRIu64,
+                      ep, op->fifo_index);
+            status = UCS_ERR_IO_ERROR;
+            uct_worker_progress_register_safe(&iface->super.worker->super,
+                                              uct_mm_ep_failed_progress, ep,
+                                              UCS_CALLBACKQ_FLAG_ONESHOT,
+                                              &ep->slow_prog_id);
+        } else {
+            status = UCS_OK;
+        }
+
+        if (op->comp != NULL) {
+            uct_invoke_completion(op->comp, status);
+        }
+        ucs_mpool_put_inline(op);
+        ++count;
+    }
+
+    if (ucs_queue_is_empty(&ep->zcopy_q)) {
+        ucs_list_del(&ep->zcopy_list);
+    }
+
+    return count;
+}
+
 static inline int uct_mm_ep_has_tx_resources(uct_mm_ep_t *ep)
 {
-    uct_mm_iface_t *iface = ucs_derived_of(ep->super.super.iface, uct_mm_iface_t);
-    return UCT_MM_EP_IS_ABLE_TO_SEND(ep->fifo_ctl->head, ep->cached_tail,
-                                     iface->config.fifo_size);
+    return UCT_MM_EP_IS_ABLE_TO_SEND(*ep->fifo_head, ep->cached_tail,
+                                     ep->fifo_size);
 }
 
 ucs_status_t uct_mm_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *n,
@@ -418,7 +778,9 @@ void uct_mm_ep_pending_purge(uct_ep_h tl_ep, uct_pending_purge_callback_t cb,
 ucs_status_t uct_mm_ep_flush(uct_ep_h tl_ep, unsigned flags,
                              uct_completion_t *comp)
 {
+    uct_mm_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_mm_iface_t);
     uct_mm_ep_t *ep = ucs_derived_of(tl_ep, uct_mm_ep_t);
+    uct_mm_zcopy_op_t *op;
 
     if (!uct_mm_ep_has_tx_resources(ep)) {
         if (!ucs_arbiter_group_is_empty(&ep->arb_group)) {
@@ -431,6 +793,29 @@ ucs_status_t uct_mm_ep_flush(uct_ep_h tl_ep, unsigned flags,
         }
     }
 
+    if (!ucs_queue_is_empty(&ep->zcopy_q)) {
+        uct_mm_ep_progress_zcopy(ep);
+    }
+
+    if (!ucs_queue_is_empty(&ep->zcopy_q)) {
+        /* wait for the receiver to read the data of all zcopy operations */
+        if (comp != NULL) {
+            op = ucs_mpool_get_inline(&iface->zcopy_mp);
+            if (ucs_unlikely(op == NULL)) {
+                ucs_error("failed to allocate mm zcopy operation");
+                return UCS_ERR_NO_MEMORY;
+            }
+
+            op->fifo_index = ucs_queue_tail_elem_non_empty(&ep->zcopy_q,
+                                                           uct_mm_zcopy_op_t,
+                                                           queue)->fifo_index;
+            op->comp       = comp;
+            ucs_queue_push(&ep->zcopy_q, &op->queue);
+        }
+        UCT_TL_EP_STAT_FLUSH_WAIT(&ep->super);
+        return UCS_INPROGRESS;
+    }
+
     ucs_memory_cpu_store_fence();
     UCT_TL_EP_STAT_FLUSH(&ep->super);
     return UCS_OK;
@@ -10,8 +10,17 @@
 
 #include "mm_iface.h"
 
-#include <ucs/datastruct/sglib.h>
-#include <ucs/datastruct/sglib_wrapper.h>
+
+
+/**
+ * zcopy operation, which completes when the receiver releases the FIFO element
+ * that refers to its data
+ */
+typedef struct uct_mm_zcopy_op {
+    ucs_queue_elem_t     queue;       /* element in the ep's zcopy queue */
+    uint64_t             fifo_index;  /* index of the FIFO element to wait for */
+    uct_completion_t     *comp;       /* user completion */
+} uct_mm_zcopy_op_t;
 
 
 struct uct_mm_ep {
@@ -19,17 +28,30 @@ struct uct_mm_ep {
 
     /* Remote peer */
     uct_mm_fifo_ctl_t    *fifo_ctl;   /* pointer to the destination's ctl struct in the receive fifo */
-    void                 *fifo;       /* fifo elements (destination's receive fifo) */
+    void                 *fifo;       /* fifo elements which the ep writes to: the
+                                         destination's shared receive fifo or the
+                                         sender ring of the ep */
+    uct_mm_fifo_desc_t   *fifo_descs; /* receive descriptors of the fifo elements */
+    volatile uint64_t    *fifo_head;  /* head and tail of the fifo the ep writes to */
+    volatile uint64_t    *fifo_tail;
+    unsigned             fifo_size;   /* number of elements in that fifo: the
+                                         SENDER_RING_SIZE of the receiver if the
+                                         ep owns a sender ring, otherwise its
+                                         FIFO_SIZE */
+    uct_mm_ring_ctl_t    *ring_ctl;   /* the sender ring of the ep, or NULL if the
+                                         ep writes to the shared fifo */
+    uint64_t             ring_bit;    /* doorbell bit of the sender ring */
 
     uint64_t             cached_tail; /* the sender's own copy of the remote FIFO's tail.
                                          it is not always updated with the actual remote tail value */
 
-    /* mapped remote memory chunks to which remote descriptors belong to.
-     * (after attaching to them) */
-    uct_mm_remote_seg_t  *remote_segments_hash[UCT_MM_BASE_ADDRESS_HASH_SIZE];
-
     ucs_arbiter_group_t  arb_group;   /* the group that holds this ep's pending operations */
 
+    ucs_queue_head_t     zcopy_q;     /* zcopy operations waiting for the receiver */
+    ucs_list_link_t      zcopy_list;  /* element in the iface's list of eps with */
+                                      /* outstanding zcopy operations */
+    uct_worker_cb_id_t   slow_prog_id; /* reports a failure to the user */
+
     /* Used for signaling remote side wakeup */
     struct {
         struct sockaddr_un  sockaddr;  /* address of signaling socket */
@@ -47,6 +69,12 @@ ucs_status_t uct_mm_ep_am_short(uct_ep_h tl_ep, uint8_t id, uint64_t header,
                                 const void *payload, unsigned length);
 ssize_t uct_mm_ep_am_bcopy(uct_ep_h tl_ep, uint8_t id, uct_pack_callback_t pack_cb,
                            void *arg, unsigned flags);
+ucs_status_t uct_mm_ep_am_zcopy(uct_ep_h tl_ep, uint8_t id, const void *header,
+                                unsigned header_length, const uct_iov_t *iov,
+                                size_t iovcnt, unsigned flags,
+                                uct_completion_t *comp);
+
+unsigned uct_mm_ep_progress_zcopy(uct_mm_ep_t *ep);
 
 ucs_status_t uct_mm_ep_flush(uct_ep_h tl_ep, unsigned flags,
                              uct_completion_t *comp);
@@ -61,17 +89,4 @@ ucs_arbiter_cb_result_t uct_mm_ep_process_pending(ucs_arbiter_t *arbiter,
                                                   ucs_arbiter_elem_t *elem,
                                                   void *arg);
 
-static inline uint64_t uct_mm_remote_seg_hash(uct_mm_remote_seg_t *seg)
-{
-    return seg->mmid % UCT_MM_BASE_ADDRESS_HASH_SIZE;
-}
-
-static inline int64_t uct_mm_remote_seg_compare(uct_mm_remote_seg_t *seg1, uct_mm_remote_seg_t *seg2)
-{
-    return  seg1->mmid - seg2->mmid;
-}
-
-SGLIB_DEFINE_LIST_PROTOTYPES(uct_mm_remote_seg_t, uct_mm_remote_seg_compare, next)
-SGLIB_DEFINE_HASHED_CONTAINER_PROTOTYPES(uct_mm_remote_seg_t, UCT_MM_BASE_ADDRESS_HASH_SIZE, uct_mm_remote_seg_hash)
-
 #endif
@@ -4,6 +4,8 @@
  * See file LICENSE for terms.
  */
 
+#define _GNU_SOURCE /* for sched_getcpu(3) */
+
 #include "mm_iface.h"
 #include "mm_ep.h"
 
@@ -15,6 +17,7 @@
 #include <ucs/async/async.h>
 #include <ucs/sys/string.h>
 #include <sys/poll.h>
+#include <sched.h>
 
 
 /* Maximal number of events to clear from the signaling pipe in single call */
@@ -35,6 +38,27 @@ static ucs_config_field_t uct_mm_iface_config_table[] = {
      "This value refers to the percentage of the FIFO size. (must be >= 0 and < 1)",
      ucs_offsetof(uct_mm_iface_config_t, release_fifo_factor), UCS_CONFIG_TYPE_DOUBLE},
 
+    {"RX_MAX_POLL", "16",
+     "Maximal number of receive FIFO elements to read in a single call to\n"
+     "the progress function. Reading several elements drains a burst of\n"
+     "messages from many senders without going through the whole worker\n"
+     "progress for each one of them.",
+     ucs_offsetof(uct_mm_iface_config_t, rx_max_poll), UCS_CONFIG_TYPE_UINT},
+
+    {"SENDER_RINGS", "0",
+     "Number of single-producer rings in the receive FIFO. A sender takes a free\n"
+     "ring when it connects, and writes to it without atomic operations, instead\n"
+     "of contending with other senders on the head of the shared FIFO. The\n"
+     "receiver finds the rings with new messages through a doorbell bitmap.\n"
+     "Senders which connect when all the rings are taken use the shared FIFO.\n"
+     "0 disables the rings. Must be the same for all the processes (max: 64).",
+     ucs_offsetof(uct_mm_iface_config_t, sender_rings), UCS_CONFIG_TYPE_UINT},
+
+    {"SENDER_RING_SIZE", "16",
+     "Size of each sender ring. Every element of a ring holds a receive\n"
+     "descriptor, like the elements of the shared FIFO.",
+     ucs_offsetof(uct_mm_iface_config_t, ring_size), UCS_CONFIG_TYPE_UINT},
+
     UCT_IFACE_MPOOL_CONFIG_FIELDS("RX_", -1, 512, "receive",
                                   ucs_offsetof(uct_mm_iface_config_t, mp), ""),
 
@@ -46,9 +70,44 @@ static ucs_config_field_t uct_mm_iface_config_table[] = {
      " try - Try to allocate memory using huge pages and if it fails, allocate regular pages.\n",
      ucs_offsetof(uct_mm_iface_config_t, hugetlb_mode), UCS_CONFIG_TYPE_TERNARY},
 
+    {"NUMA_POLICY", "default",
+     "NUMA policy of the receive FIFO and the receive descriptors, which are\n"
+     "written by the senders and read by the receiver.\n"
+     " - default: Do not change existing policy.\n"
+     " - preferred/bind:\n"
+     "     Unless the memory policy of the current thread is MPOL_BIND, set the\n"
+     "     policy of the receive memory to MPOL_PREFERRED/MPOL_BIND, respectively,\n"
+     "     on the numa node of the cpu which creates the interface.",
+     ucs_offsetof(uct_mm_iface_config_t, numa_policy),
+     UCS_CONFIG_TYPE_ENUM(ucs_numa_policy_names)},
+
+    {"ATTACH_CACHE_SIZE", "1024",
+     "Maximal number of remote memory chunks which are kept attached by the\n"
+     "interface. The chunks are shared by all the endpoints of the interface,\n"
+     "so every chunk of a peer process is attached once. When the limit is\n"
+     "reached, the least recently used chunk is detached.",
+     ucs_offsetof(uct_mm_iface_config_t, attach_cache_size), UCS_CONFIG_TYPE_UINT},
+
     {NULL}
 };
 
+static UCS_F_ALWAYS_INLINE
+khint32_t uct_mm_remote_seg_hash_func(uct_mm_remote_seg_key_t key)
+{
+    return kh_int64_hash_func(key.mmid ^ (key.owner << 32));
+}
+
+static UCS_F_ALWAYS_INLINE
+int uct_mm_remote_seg_hash_equal(uct_mm_remote_seg_key_t a,
+                                 uct_mm_remote_seg_key_t b)
+{
+    return (a.mmid == b.mmid) && (a.owner == b.owner);
+}
+
+__KHASH_IMPL(uct_mm_remote_seg, static UCS_F_MAYBE_UNUSED inline,
+             uct_mm_remote_seg_key_t, uct_mm_remote_seg_t*, 1,
+             uct_mm_remote_seg_hash_func, uct_mm_remote_seg_hash_equal)
+
 static ucs_status_t uct_mm_iface_get_address(uct_iface_t *tl_iface,
                                              uct_iface_addr_t *addr)
 {
@@ -71,12 +130,19 @@ void uct_mm_iface_release_desc(uct_recv_desc_t *self, void *desc)
 ucs_status_t uct_mm_iface_flush(uct_iface_h tl_iface, unsigned flags,
                                 uct_completion_t *comp)
 {
+    uct_mm_iface_t *iface = ucs_derived_of(tl_iface, uct_mm_iface_t);
+
     if (comp != NULL) {
         return UCS_ERR_UNSUPPORTED;
     }
 
+    if (!ucs_list_is_empty(&iface->zcopy_eps)) {
+        UCT_TL_IFACE_STAT_FLUSH_WAIT(&iface->super);
+        return UCS_INPROGRESS;
+    }
+
     ucs_memory_cpu_store_fence();
-    UCT_TL_IFACE_STAT_FLUSH(ucs_derived_of(tl_iface, uct_base_iface_t));
+    UCT_TL_IFACE_STAT_FLUSH(&iface->super);
     return UCS_OK;
 }
 
@@ -110,6 +176,7 @@ static ucs_status_t uct_mm_iface_query(uct_iface_h tl_iface,
     iface_attr->cap.am.opt_zcopy_align  = UCS_SYS_CACHE_LINE_SIZE;
     iface_attr->cap.am.align_mtu        = iface_attr->cap.am.opt_zcopy_align;
     iface_attr->cap.am.max_iov          = 1;
+    iface_attr->cap.am.max_hdr          = 0;
 
     iface_attr->iface_addr_len          = sizeof(uct_mm_iface_addr_t);
     iface_attr->device_addr_len         = UCT_SM_IFACE_DEVICE_ADDR_LEN;
@@ -140,6 +207,17 @@ static ucs_status_t uct_mm_iface_query(uct_iface_h tl_iface,
                                           UCS_BIT(UCT_ATOMIC_OP_SWAP)        |
                                           UCS_BIT(UCT_ATOMIC_OP_CSWAP);
 
+    /* zcopy messages are described in the FIFO element, and the AM header
+     * follows the description */
+    if (iface->config.fifo_elem_size >= (sizeof(uct_mm_fifo_element_t) +
+                                         sizeof(uct_mm_zcopy_desc_t))) {
+        iface_attr->cap.am.max_zcopy    = iface->config.seg_size;
+        iface_attr->cap.am.max_hdr      = iface->config.fifo_elem_size -
+                                          sizeof(uct_mm_fifo_element_t) -
+                                          sizeof(uct_mm_zcopy_desc_t);
+        iface_attr->cap.flags          |= UCT_IFACE_FLAG_AM_ZCOPY;
+    }
+
     iface_attr->latency.overhead        = 80e-9; /* 80 ns */
     iface_attr->latency.growth          = 0;
     iface_attr->bandwidth               = 12179 * 1024.0 * 1024.0;
@@ -148,18 +226,20 @@ static ucs_status_t uct_mm_iface_query(uct_iface_h tl_iface,
     return UCS_OK;
 }
 
-static inline void uct_mm_progress_fifo_tail(uct_mm_iface_t *iface)
+static inline void uct_mm_progress_fifo_tail(uint64_t read_index,
+                                             volatile uint64_t *tail,
+                                             uint64_t release_factor_mask)
 {
     /* don't progress the tail every time - release in batches. improves performance */
-    if (iface->read_index & iface->fifo_release_factor_mask) {
+    if (read_index & release_factor_mask) {
         return;
     }
 
-    iface->recv_fifo_ctl->tail = iface->read_index;
+    *tail = read_index;
 }
 
 ucs_status_t uct_mm_assign_desc_to_fifo_elem(uct_mm_iface_t *iface,
-                                             uct_mm_fifo_element_t *fifo_elem_p,
+                                             uct_mm_fifo_desc_t *fifo_desc,
                                              unsigned need_new_desc)
 {
     uct_mm_recv_desc_t *desc;
@@ -171,17 +251,247 @@ ucs_status_t uct_mm_assign_desc_to_fifo_elem(uct_mm_iface_t *iface,
                                  return UCS_ERR_NO_RESOURCE);
     }
 
-    fifo_elem_p->desc_mmid   = desc->key;
-    fifo_elem_p->desc_offset = iface->rx_headroom +
-                               (ptrdiff_t) ((void*) (desc + 1) - desc->base_address);
-    fifo_elem_p->desc_chunk_base_addr = desc->base_address;
-    fifo_elem_p->desc_mpool_size      = desc->mpool_length;
+    fifo_desc->mmid            = desc->key;
+    fifo_desc->serial          = desc->serial;
+    fifo_desc->offset          = iface->rx_headroom +
+                                 (ptrdiff_t) ((void*) (desc + 1) - desc->base_address);
+    fifo_desc->chunk_base_addr = desc->base_address;
+    fifo_desc->mpool_size      = desc->mpool_length;
+
+    return UCS_OK;
+}
+
+static inline uct_mm_remote_seg_key_t
+uct_mm_iface_remote_seg_key(uct_mm_id_t mmid, uint64_t serial)
+{
+    uct_mm_remote_seg_key_t key;
+
+    key.owner = UCT_MM_SEG_SERIAL_OWNER(serial);
+    key.mmid  = mmid;
+    return key;
+}
+
+static void uct_mm_iface_detach_remote_seg(uct_mm_iface_t *iface,
+                                           uct_mm_remote_seg_t *remote_seg)
+{
+    ucs_status_t status;
+    khiter_t iter;
+
+    iter = kh_get(uct_mm_remote_seg, &iface->remote_segs.hash,
+                  uct_mm_iface_remote_seg_key(remote_seg->mmid,
+                                              remote_seg->serial));
+    ucs_assert(iter != kh_end(&iface->remote_segs.hash));
+    kh_del(uct_mm_remote_seg, &iface->remote_segs.hash, iter);
+    ucs_assert(remote_seg->pin_count == 0);
+    ucs_list_del(&remote_seg->list);
+    --iface->remote_segs.count;
+
+    status = uct_mm_md_mapper_ops(iface->super.md)->detach(remote_seg);
+    if (status != UCS_OK) {
+        ucs_warn("Unable to detach remote shared memory segment: %s",
+                 ucs_status_string(status));
+    }
+    ucs_free(remote_seg);
+}
+
+static void uct_mm_iface_detach_all_remote_segs(uct_mm_iface_t *iface)
+{
+    while (!ucs_list_is_empty(&iface->remote_segs.lru)) {
+        uct_mm_iface_detach_remote_seg(iface,
+                                       ucs_list_tail(&iface->remote_segs.lru,
+                                                     uct_mm_remote_seg_t, list));
+    }
+    kh_destroy_inplace(uct_mm_remote_seg, &iface->remote_segs.hash);
+}
+
+/* Least recently used segment which may be detached, or NULL if all attached
+ * segments are pinned */
+static uct_mm_remote_seg_t *uct_mm_iface_remote_seg_victim(uct_mm_iface_t *iface)
+{
+    uct_mm_remote_seg_t *remote_seg;
+    ucs_list_link_t *link;
+
+    for (link = iface->remote_segs.lru.prev; link != &iface->remote_segs.lru;
+         link = link->prev) {
+        remote_seg = ucs_container_of(link, uct_mm_remote_seg_t, list);
+        if (remote_seg->pin_count == 0) {
+            return remote_seg;
+        }
+    }
+
+    return NULL;
+}
+
+static ucs_status_t
+uct_mm_iface_get_remote_seg(uct_mm_iface_t *iface, uct_mm_id_t mmid,
+                            uint64_t serial, size_t length, void *address,
+                            uct_mm_remote_seg_t **remote_seg_p)
+{
+    uct_mm_remote_seg_key_t key = uct_mm_iface_remote_seg_key(mmid, serial);
+    uct_mm_remote_seg_t *remote_seg, *victim;
+    ucs_status_t status;
+    khiter_t iter;
+    int ret;
+
+    /* check if the memory chunk with this mmid was already attached */
+    iter = kh_get(uct_mm_remote_seg, &iface->remote_segs.hash, key);
+    if (ucs_likely(iter != kh_end(&iface->remote_segs.hash))) {
+        remote_seg = kh_value(&iface->remote_segs.hash, iter);
+        if (ucs_likely(remote_seg->serial == serial)) {
+            if (iface->remote_segs.lru.next != &remote_seg->list) {
+                ucs_list_del(&remote_seg->list);
+                ucs_list_add_head(&iface->remote_segs.lru, &remote_seg->list);
+            }
+            *remote_seg_p = remote_seg;
+            return UCS_OK;
+        }
+
+        /* the mmid was reused by the remote process for another chunk */
+        uct_mm_iface_detach_remote_seg(iface, remote_seg);
+    }
+
+    /* the cache may exceed its size while the segments are pinned */
+    if (iface->remote_segs.count >= iface->config.attach_cache_size) {
+        victim = uct_mm_iface_remote_seg_victim(iface);
+        if (victim != NULL) {
+            uct_mm_iface_detach_remote_seg(iface, victim);
+        }
+    }
+
+    /* attach to the memory the mmid refers to, and keep its local address */
+    remote_seg = ucs_malloc(sizeof(*remote_seg), "mm_desc");
+    if (remote_seg == NULL) {
+        ucs_error("failed to allocate memory for a remote segment identifier");
+        return UCS_ERR_NO_MEMORY;
+    }
 
+    status = uct_mm_md_mapper_ops(iface->super.md)->attach(mmid, length, address,
+                                                           &remote_seg->address,
+                                                           &remote_seg->cookie,
+                                                           iface->path);
+    if (status != UCS_OK) {
+        ucs_error("failed to attach to remote mmid:%zu: %s", mmid,
+                  ucs_status_string(status));
+        ucs_free(remote_seg);
+        return status;
+    }
+
+    remote_seg->mmid      = mmid;
+    remote_seg->serial    = serial;
+    remote_seg->length    = length;
+    remote_seg->pin_count = 0;
+
+    iter = kh_put(uct_mm_remote_seg, &iface->remote_segs.hash, key, &ret);
+    if (ret == -1) {
+        ucs_error("failed to add remote mmid:%zu to the attach cache", mmid);
+        uct_mm_md_mapper_ops(iface->super.md)->detach(remote_seg);
+        ucs_free(remote_seg);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    kh_value(&iface->remote_segs.hash, iter) = remote_seg;
+    ucs_list_add_head(&iface->remote_segs.lru, &remote_seg->list);
+    ++iface->remote_segs.count;
+
+    ucs_trace("mm_iface %p: attached remote mmid %zu serial %"PRIu64
+              " at %p, %u attached", iface, mmid, serial, remote_seg->address,
+              iface->remote_segs.count);
+    *remote_seg_p = remote_seg;
     return UCS_OK;
 }
 
+ucs_status_t uct_mm_iface_attach_remote_seg(uct_mm_iface_t *iface,
+                                            uct_mm_id_t mmid, uint64_t serial,
+                                            size_t length, void *address,
+                                            void **address_p)
+{
+    uct_mm_remote_seg_t *remote_seg;
+    ucs_status_t status;
+
+    status = uct_mm_iface_get_remote_seg(iface, mmid, serial, length, address,
+                                         &remote_seg);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    *address_p = remote_seg->address;
+    return UCS_OK;
+}
+
+/* Read zcopy messages from the sender's memory chunk, which is attached on the
+ * first message from it */
+static ucs_status_t uct_mm_iface_process_recv_zcopy(uct_mm_iface_t *iface,
+                                                    uct_mm_fifo_element_t *elem,
+                                                    uct_mm_fifo_desc_t *fifo_desc,
+                                                    uint64_t fifo_index)
+{
+    uct_mm_zcopy_desc_t *zcopy_desc = (uct_mm_zcopy_desc_t*)(elem + 1);
+    uct_mm_remote_seg_t *remote_seg;
+    ucs_status_t status;
+    void *src, *data;
+
+    if (zcopy_desc->length > 0) {
+        status = uct_mm_iface_get_remote_seg(iface, zcopy_desc->mmid,
+                                             zcopy_desc->serial,
+                                             zcopy_desc->seg_length,
+                                             (void*)zcopy_desc->seg_address,
+                                             &remote_seg);
+        if (status != UCS_OK) {
+            /* the sender's data can't be read, drop the message and let the
+             * sender fail the operation when the element is released */
+            ucs_error("mm_iface %p: dropped am_zcopy message %d of %zu bytes",
+                      iface, elem->am_id, zcopy_desc->length);
+            fifo_desc->failed_index = fifo_index;
+            return UCS_OK;
+        }
+
+        src = remote_seg->address + zcopy_desc->offset;
+    } else {
+        remote_seg = NULL;
+        src        = NULL;
+    }
+
+    if (elem->length == 0) {
+        /* pass the data to the user in place. the sender may reuse it after
+         * the FIFO element is released, so the user can't keep it. the
+         * callback may send to other peers, so the segment is pinned to
+         * keep it attached */
+        uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_RECV, elem->am_id,
+                           src, zcopy_desc->length, "RX: AM_ZCOPY");
+        if (remote_seg == NULL) {
+            return uct_iface_invoke_am(&iface->super, elem->am_id, src, 0, 0);
+        }
+
+        ++remote_seg->pin_count;
+        status = uct_iface_invoke_am(&iface->super, elem->am_id, src,
+                                     zcopy_desc->length, 0);
+        --remote_seg->pin_count;
+        return status;
+    }
+
+    /* the header is not contiguous with the data - read both of them to the
+     * receive descriptor of the FIFO element */
+    data = fifo_desc->chunk_base_addr + fifo_desc->offset;
+    memcpy(data, zcopy_desc + 1, elem->length);
+    memcpy(data + elem->length, src, zcopy_desc->length);
+
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_RECV, elem->am_id,
+                       data, elem->length + zcopy_desc->length, "RX: AM_ZCOPY");
+
+    status = uct_mm_iface_invoke_am(iface, elem->am_id, data,
+                                    elem->length + zcopy_desc->length,
+                                    UCT_CB_PARAM_FLAG_DESC);
+    if (status != UCS_OK) {
+        /* assign a new receive descriptor to this FIFO element.*/
+        uct_mm_assign_desc_to_fifo_elem(iface, fifo_desc, 0);
+    }
+    return status;
+}
+
 static inline ucs_status_t uct_mm_iface_process_recv(uct_mm_iface_t *iface,
-                                                     uct_mm_fifo_element_t* elem)
+                                                     uct_mm_fifo_element_t* elem,
+                                                     uct_mm_fifo_desc_t *fifo_desc,
+                                                     uint64_t fifo_index)
 {
     ucs_status_t status;
     void         *data;
@@ -192,12 +502,15 @@ static inline ucs_status_t uct_mm_iface_process_recv(uct_mm_iface_t *iface,
                            elem + 1, elem->length, "RX: AM_SHORT");
         status = uct_mm_iface_invoke_am(iface, elem->am_id, elem + 1,
                                         elem->length, 0);
+    } else if (elem->flags & UCT_MM_FIFO_ELEM_FLAG_ZCOPY) {
+        status = uct_mm_iface_process_recv_zcopy(iface, elem, fifo_desc,
+                                                  fifo_index);
     } else {
         /* read bcopy messages from the receive descriptors */
-        VALGRIND_MAKE_MEM_DEFINED(elem->desc_chunk_base_addr + elem->desc_offset,
+        VALGRIND_MAKE_MEM_DEFINED(fifo_desc->chunk_base_addr + fifo_desc->offset,
                                   elem->length);
 
-        data = elem->desc_chunk_base_addr + elem->desc_offset;
+        data = fifo_desc->chunk_base_addr + fifo_desc->offset;
 
         uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_RECV, elem->am_id,
                            data, elem->length, "RX: AM_BCOPY");
@@ -206,13 +519,18 @@ static inline ucs_status_t uct_mm_iface_process_recv(uct_mm_iface_t *iface,
                                         UCT_CB_PARAM_FLAG_DESC);
         if (status != UCS_OK) {
             /* assign a new receive descriptor to this FIFO element.*/
-            uct_mm_assign_desc_to_fifo_elem(iface, elem, 0);
+            uct_mm_assign_desc_to_fifo_elem(iface, fifo_desc, 0);
         }
     }
     return status;
 }
 
-static inline unsigned uct_mm_iface_poll_fifo(uct_mm_iface_t *iface)
+/* Read the next element of the shared FIFO or of a sender ring */
+static UCS_F_ALWAYS_INLINE unsigned
+uct_mm_iface_poll_fifo_common(uct_mm_iface_t *iface, void *fifo_elements,
+                              uct_mm_fifo_desc_t *fifo_descs, uint64_t *read_index_p, volatile uint64_t *head,
+                              volatile uint64_t *tail, uint8_t fifo_shift,
+                              uint64_t release_factor_mask)
 {
     uint64_t read_index_loc, read_index;
     uct_mm_fifo_element_t* read_index_elem;
@@ -224,19 +542,21 @@ static inline unsigned uct_mm_iface_poll_fifo(uct_mm_iface_t *iface)
                                  iface->last_recv_desc, return 0);
     }
 
-    read_index = iface->read_index;
-    read_index_loc = (read_index & iface->fifo_mask);
+    read_index = *read_index_p;
+    read_index_loc = (read_index & UCS_MASK(fifo_shift));
     /* the fifo_element which the read_index points to */
-    read_index_elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, iface->recv_fifo_elements ,read_index_loc);
+    read_index_elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, fifo_elements, read_index_loc);
 
     /* check the read_index to see if there is a new item to read (checking the owner bit) */
-    if (((read_index >> iface->fifo_shift) & 1) == ((read_index_elem->flags) & 1)) {
+    if (((read_index >> fifo_shift) & 1) == ((read_index_elem->flags) & 1)) {
 
         /* read from read_index_elem */
         ucs_memory_cpu_load_fence();
-        ucs_assert(iface->read_index <= iface->recv_fifo_ctl->head);
+        ucs_assert(read_index <= *head);
 
-        status = uct_mm_iface_process_recv(iface, read_index_elem);
+        status = uct_mm_iface_process_recv(iface, read_index_elem,
+                                           &fifo_descs[read_index_loc],
+                                           read_index);
         if (status != UCS_OK) {
             /* the last_recv_desc is in use. get a new descriptor for it */
             UCT_TL_IFACE_GET_RX_DESC(&iface->super, &iface->recv_desc_mp,
@@ -244,9 +564,16 @@ static inline unsigned uct_mm_iface_poll_fifo(uct_mm_iface_t *iface)
         }
 
         /* raise the read_index. */
-        iface->read_index++;
+        *read_index_p = ++read_index;
 
-        uct_mm_progress_fifo_tail(iface);
+        if (ucs_unlikely(read_index_elem->flags & UCT_MM_FIFO_ELEM_FLAG_ZCOPY)) {
+            /* release the element right away, since the sender waits for it
+             * to complete the zcopy operation */
+            ucs_memory_cpu_fence();
+            *tail = read_index;
+        } else {
+            uct_mm_progress_fifo_tail(read_index, tail, release_factor_mask);
+        }
 
         return 1;
     } else {
@@ -254,13 +581,116 @@ static inline unsigned uct_mm_iface_poll_fifo(uct_mm_iface_t *iface)
     }
 }
 
+static inline unsigned uct_mm_iface_poll_fifo(uct_mm_iface_t *iface)
+{
+    return uct_mm_iface_poll_fifo_common(iface, iface->recv_fifo_elements,
+                                         iface->recv_fifo_descs,
+                                         &iface->read_index,
+                                         &iface->recv_fifo_ctl->head,
+                                         &iface->recv_fifo_ctl->tail,
+                                         iface->fifo_shift,
+                                         iface->fifo_release_factor_mask);
+}
+
+static void uct_mm_iface_free_rx_descs(uct_mm_iface_t *iface,
+                                       uct_mm_fifo_desc_t *fifo_descs,
+                                       unsigned num_elems)
+{
+    uct_mm_recv_desc_t *desc;
+    unsigned i;
+
+    for (i = 0; i < num_elems; i++) {
+        desc = UCT_MM_IFACE_GET_DESC_START(iface, &fifo_descs[i]);
+        ucs_mpool_put(desc);
+    }
+}
+
+static UCS_F_ALWAYS_INLINE unsigned
+uct_mm_iface_poll_ring(uct_mm_iface_t *iface, uct_mm_rx_ring_t *ring)
+{
+    return uct_mm_iface_poll_fifo_common(iface, ring->elements, ring->descs,
+                                         &ring->read_index, &ring->ctl->head,
+                                         &ring->ctl->tail, iface->ring_shift,
+                                         iface->ring_release_factor_mask);
+}
+
+/* Read the sender rings whose doorbell is set, up to max_count elements */
+static unsigned uct_mm_iface_poll_rings(uct_mm_iface_t *iface, unsigned max_count)
+{
+    volatile uint64_t *doorbell_p = &iface->recv_fifo_ctl->ring_doorbell;
+    uint64_t doorbell, ring_bit;
+    unsigned count, bit, index;
+    uct_mm_rx_ring_t *ring;
+
+    doorbell = *doorbell_p;
+    if (ucs_likely(doorbell == 0)) {
+        return 0;
+    }
+
+    /* start from the ring which follows the last one which ran out of budget,
+     * so a busy sender would not starve the others */
+    doorbell = (doorbell >> iface->next_ring) |
+               (doorbell << ((UCT_MM_MAX_SENDER_RINGS - iface->next_ring) %
+                             UCT_MM_MAX_SENDER_RINGS));
+
+    count = 0;
+    ucs_for_each_bit(bit, doorbell) {
+        index    = (bit + iface->next_ring) % UCT_MM_MAX_SENDER_RINGS;
+        ring_bit = UCS_BIT(index);
+        ring     = &iface->rx_rings[index];
+
+        /* clear the doorbell before reading the ring, so the elements which
+         * the sender writes from now on would set it again */
+        ucs_atomic_and64(doorbell_p, ~ring_bit);
+
+        while ((count < max_count) && uct_mm_iface_poll_ring(iface, ring)) {
+            ++count;
+        }
+
+        if (count == max_count) {
+            /* the ring may have more elements */
+            ucs_atomic_or64(doorbell_p, ring_bit);
+            iface->next_ring = (index + 1) % UCT_MM_MAX_SENDER_RINGS;
+            break;
+        }
+    }
+
+    return count;
+}
+
+static unsigned uct_mm_iface_progress_zcopy(uct_mm_iface_t *iface)
+{
+    uct_mm_ep_t *ep, *tmp;
+    unsigned count = 0;
+
+    ucs_list_for_each_safe(ep, tmp, &iface->zcopy_eps, zcopy_list) {
+        count += uct_mm_ep_progress_zcopy(ep);
+    }
+
+    return count;
+}
+
 unsigned uct_mm_iface_progress(void *arg)
 {
     uct_mm_iface_t *iface = arg;
-    unsigned count;
+    unsigned count = 0;
 
-    /* progress receive */
-    count = uct_mm_iface_poll_fifo(iface);
+    /* progress receive - read the ready FIFO elements, up to the limit */
+    while ((count < iface->config.rx_max_poll) &&
+           uct_mm_iface_poll_fifo(iface)) {
+        ++count;
+    }
+
+    if ((iface->config.sender_rings > 0) &&
+        (count < iface->config.rx_max_poll)) {
+        count += uct_mm_iface_poll_rings(iface,
+                                         iface->config.rx_max_poll - count);
+    }
+
+    /* complete the zcopy sends which the receivers have read */
+    if (ucs_unlikely(!ucs_list_is_empty(&iface->zcopy_eps))) {
+        count += uct_mm_iface_progress_zcopy(iface);
+    }
 
     /* progress the pending sends (if there are any) */
     ucs_arbiter_dispatch(&iface->arbiter, 1, uct_mm_ep_process_pending, NULL);
@@ -274,6 +704,17 @@ static ucs_status_t uct_mm_iface_event_fd_get(uct_iface_h tl_iface, int *fd_p)
     return UCS_OK;
 }
 
+/* Check if the shared FIFO or one of the sender rings has new elements */
+static int uct_mm_iface_has_new_elems(uct_mm_iface_t *iface)
+{
+    uct_mm_fifo_element_t *elem;
+
+    elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, iface->recv_fifo_elements,
+                                      iface->read_index & iface->fifo_mask);
+    return (((iface->read_index >> iface->fifo_shift) & 1) == (elem->flags & 1)) ||
+           (iface->recv_fifo_ctl->ring_doorbell != 0);
+}
+
 static ucs_status_t uct_mm_iface_event_fd_arm(uct_iface_h tl_iface,
                                               unsigned events)
 {
@@ -285,18 +726,29 @@ static ucs_status_t uct_mm_iface_event_fd_arm(uct_iface_h tl_iface,
     if (ret > 0) {
         return UCS_ERR_BUSY;
     } else if (ret == -1) {
-        if (errno == EAGAIN) {
-            return UCS_OK;
-        } else if (errno == EINTR) {
+        if (errno == EINTR) {
             return UCS_ERR_BUSY;
-        } else {
+        } else if (errno != EAGAIN) {
             ucs_error("failed to retrieve message from signal pipe: %m");
             return UCS_ERR_IO_ERROR;
         }
     } else {
         ucs_assert(ret == 0);
-        return UCS_OK;
     }
+
+    /* let the senders know that a signal is needed, and then check for
+     * elements which were posted before they could see it. the senders post
+     * the element before checking the armed flag, so either they signal, or
+     * the element is found here */
+    iface->recv_fifo_ctl->armed = 1;
+    ucs_memory_bus_fence();
+    if (uct_mm_iface_has_new_elems(iface)) {
+        /* save the senders the signal while the receiver is busy */
+        iface->recv_fifo_ctl->armed = 0;
+        return UCS_ERR_BUSY;
+    }
+
+    return UCS_OK;
 }
 
 static UCS_CLASS_DECLARE_DELETE_FUNC(uct_mm_iface_t, uct_iface_t);
@@ -307,6 +759,7 @@ static uct_iface_ops_t uct_mm_iface_ops = {
     .ep_get_bcopy             = uct_sm_ep_get_bcopy,
     .ep_am_short              = uct_mm_ep_am_short,
     .ep_am_bcopy              = uct_mm_ep_am_bcopy,
+    .ep_am_zcopy              = uct_mm_ep_am_zcopy,
     .ep_atomic_cswap64        = uct_sm_ep_atomic_cswap64,
     .ep_atomic64_post         = uct_sm_ep_atomic64_post,
     .ep_atomic64_fetch        = uct_sm_ep_atomic64_fetch,
@@ -333,31 +786,103 @@ static uct_iface_ops_t uct_mm_iface_ops = {
     .iface_is_reachable       = uct_sm_iface_is_reachable
 };
 
-void uct_mm_iface_recv_desc_init(uct_iface_h tl_iface, void *obj, uct_mem_h memh)
+#if HAVE_NUMA
+static int uct_mm_iface_get_numa_node(ucs_numa_policy_t numa_policy)
 {
+    int ret, policy, cpu;
+
+    if ((numa_policy == UCS_NUMA_POLICY_DEFAULT) || (numa_available() < 0) ||
+        (numa_max_node() == 0)) {
+        return -1;
+    }
+
+    ret = get_mempolicy(&policy, NULL, 0, NULL, 0);
+    if (ret < 0) {
+        ucs_debug("get_mempolicy() failed: %m");
+        return -1;
+    }
+
+    /* if the current policy is BIND, keep it as-is */
+    if (policy == MPOL_BIND) {
+        return -1;
+    }
+
+    cpu = sched_getcpu();
+    if (cpu < 0) {
+        ucs_debug("sched_getcpu() failed: %m");
+        return -1;
+    }
+
+    return ucs_numa_node_of_cpu(cpu);
+}
+
+static void uct_mm_iface_mem_set_numa_policy(uct_mm_iface_t *iface,
+                                             void *address, size_t length)
+{
+    struct bitmask *nodemask;
+    ucs_status_t status;
+    int policy;
+
+    if (iface->config.numa_node < 0) {
+        return;
+    }
+
+    nodemask = numa_allocate_nodemask();
+    if (nodemask == NULL) {
+        ucs_warn("Failed to allocate numa node mask");
+        return;
+    }
+
+    numa_bitmask_clearall(nodemask);
+    numa_bitmask_setbit(nodemask, iface->config.numa_node);
+
+    policy = (iface->config.numa_policy == UCS_NUMA_POLICY_BIND) ?
+             MPOL_BIND : MPOL_PREFERRED;
+
+    /* pages which were already touched are moved to the node, the rest will be
+     * allocated there, also when a sender is the first to write to them */
+    status = ucs_numa_mbind(address, length, policy, nodemask, MPOL_MF_MOVE);
+    if (status != UCS_OK) {
+        ucs_debug("mbind(addr=%p length=%zu policy=%d node=%d) failed: %m",
+                  address, length, policy, iface->config.numa_node);
+    }
+
+    numa_free_nodemask(nodemask);
+}
+#else
+static int uct_mm_iface_get_numa_node(ucs_numa_policy_t numa_policy)
+{
+    return -1;
+}
+
+static void uct_mm_iface_mem_set_numa_policy(uct_mm_iface_t *iface,
+                                             void *address, size_t length)
+{
+}
+#endif
+
+static void uct_mm_iface_recv_desc_init(uct_iface_h tl_iface, void *obj,
+                                        uct_mem_h memh)
+{
+    uct_mm_iface_t *iface    = ucs_derived_of(tl_iface, uct_mm_iface_t);
     uct_mm_recv_desc_t *desc = obj;
-    uct_mm_seg_t *seg = memh;
+    uct_mm_seg_t *seg        = memh;
+
+    /* the descriptors of a new chunk are initialized one after another, so
+     * the chunk is bound once, when its first descriptor is initialized */
+    if (seg->serial != iface->recv_desc_numa_serial) {
+        uct_mm_iface_mem_set_numa_policy(iface, seg->address, seg->length);
+        iface->recv_desc_numa_serial = seg->serial;
+    }
 
     /* every desc in the memory pool, holds the mm_id(key) and address of the
      * mem pool it belongs to */
     desc->key          = seg->mmid;
+    desc->serial       = seg->serial;
     desc->base_address = seg->address;
     desc->mpool_length = seg->length;
 }
 
-static void uct_mm_iface_free_rx_descs(uct_mm_iface_t *iface, unsigned num_elems)
-{
-    uct_mm_fifo_element_t* fifo_elem_p;
-    uct_mm_recv_desc_t *desc;
-    unsigned i;
-
-    for (i = 0; i < num_elems; i++) {
-        fifo_elem_p = UCT_MM_IFACE_GET_FIFO_ELEM(iface, iface->recv_fifo_elements, i);
-        desc = UCT_MM_IFACE_GET_DESC_START(iface, fifo_elem_p);
-        ucs_mpool_put(desc);
-    }
-}
-
 ucs_status_t uct_mm_allocate_fifo_mem(uct_mm_iface_t *iface,
                                       uct_mm_iface_config_t *config, uct_md_h md)
 {
@@ -377,8 +902,13 @@ ucs_status_t uct_mm_allocate_fifo_mem(uct_mm_iface_t *iface,
         return status;
     }
 
+    uct_mm_iface_mem_set_numa_policy(iface, iface->shared_mem, size_to_alloc);
+
     ctl = uct_mm_set_fifo_ctl(iface->shared_mem);
     uct_mm_set_fifo_elems_ptr(iface->shared_mem, &iface->recv_fifo_elements);
+    iface->recv_fifo_descs = UCT_MM_IFACE_GET_FIFO_DESCS(iface,
+                                                         iface->recv_fifo_elements,
+                                                         iface->config.fifo_size);
 
     /* Make sure head and tail are cache-aligned, and not on same cacheline, to
      * avoid false-sharing.
@@ -393,6 +923,82 @@ ucs_status_t uct_mm_allocate_fifo_mem(uct_mm_iface_t *iface,
     return UCS_OK;
 }
 
+static ucs_status_t uct_mm_iface_init_rings(uct_mm_iface_t *iface)
+{
+    uct_mm_rx_ring_t *ring;
+    unsigned i;
+
+    iface->recv_fifo_ctl->ring_doorbell = 0;
+    iface->next_ring                    = 0;
+    iface->rx_rings                     = NULL;
+
+    if (iface->config.sender_rings == 0) {
+        return UCS_OK;
+    }
+
+    iface->rx_rings = ucs_calloc(iface->config.sender_rings,
+                                 sizeof(*iface->rx_rings), "mm_rx_rings");
+    if (iface->rx_rings == NULL) {
+        ucs_error("Failed to allocate the MM sender rings");
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    for (i = 0; i < iface->config.sender_rings; i++) {
+        ring                    = &iface->rx_rings[i];
+        ring->ctl               = uct_mm_iface_get_ring(iface,
+                                                        iface->recv_fifo_ctl,
+                                                        i, &ring->elements);
+        ring->descs             = UCT_MM_IFACE_GET_FIFO_DESCS(
+                                      iface, ring->elements,
+                                      iface->config.ring_size);
+        ring->read_index        = 0;
+        ring->ctl->head         = 0;
+        ring->ctl->owner        = 0;
+        ring->ctl->owner_pid_ns = 0;
+        ring->ctl->tail         = 0;
+    }
+
+    return UCS_OK;
+}
+
+static void uct_mm_iface_free_rings_rx_descs(uct_mm_iface_t *iface,
+                                             unsigned num_rings)
+{
+    unsigned i;
+
+    for (i = 0; i < num_rings; i++) {
+        uct_mm_iface_free_rx_descs(iface, iface->rx_rings[i].descs,
+                                   iface->config.ring_size);
+    }
+}
+
+/* Initiate the owner bit in all the FIFO elements and assign a receive
+ * descriptor per every FIFO element */
+static ucs_status_t uct_mm_iface_init_fifo_elems(uct_mm_iface_t *iface,
+                                                 void *fifo_elements,
+                                                 uct_mm_fifo_desc_t *fifo_descs,
+                                                 unsigned fifo_size)
+{
+    uct_mm_fifo_element_t* fifo_elem_p;
+    ucs_status_t status;
+    unsigned i;
+
+    for (i = 0; i < fifo_size; i++) {
+        fifo_elem_p = UCT_MM_IFACE_GET_FIFO_ELEM(iface, fifo_elements, i);
+        fifo_elem_p->flags = UCT_MM_FIFO_ELEM_FLAG_OWNER;
+        fifo_descs[i].failed_index = UINT64_MAX;
+
+        status = uct_mm_assign_desc_to_fifo_elem(iface, &fifo_descs[i], 1);
+        if (status != UCS_OK) {
+            ucs_error("Failed to allocate a descriptor for MM");
+            uct_mm_iface_free_rx_descs(iface, fifo_descs, i);
+            return status;
+        }
+    }
+
+    return UCS_OK;
+}
+
 static ucs_status_t uct_mm_iface_create_signal_fd(uct_mm_iface_t *iface)
 {
     ucs_status_t status;
@@ -447,12 +1053,18 @@ err:
     return status;
 }
 
+static ucs_mpool_ops_t uct_mm_iface_zcopy_mpool_ops = {
+    .chunk_alloc   = ucs_mpool_chunk_malloc,
+    .chunk_release = ucs_mpool_chunk_free,
+    .obj_init      = NULL,
+    .obj_cleanup   = NULL
+};
+
 static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
                            const uct_iface_params_t *params,
                            const uct_iface_config_t *tl_config)
 {
     uct_mm_iface_config_t *mm_config = ucs_derived_of(tl_config, uct_mm_iface_config_t);
-    uct_mm_fifo_element_t* fifo_elem_p;
     ucs_status_t status;
     unsigned i;
 
@@ -491,6 +1103,26 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
         goto err;
     }
 
+    if (mm_config->rx_max_poll == 0) {
+        ucs_error("The MM RX_MAX_POLL parameter must be positive.");
+        status = UCS_ERR_INVALID_PARAM;
+        goto err;
+    }
+
+    if (mm_config->sender_rings > UCT_MM_MAX_SENDER_RINGS) {
+        ucs_error("The MM SENDER_RINGS parameter must not exceed %d.",
+                  UCT_MM_MAX_SENDER_RINGS);
+        status = UCS_ERR_INVALID_PARAM;
+        goto err;
+    }
+
+    if ((mm_config->sender_rings > 0) &&
+        ((mm_config->ring_size <= 1) || !ucs_is_pow2(mm_config->ring_size))) {
+        ucs_error("The MM sender ring size must be a power of two and bigger than 1.");
+        status = UCS_ERR_INVALID_PARAM;
+        goto err;
+    }
+
     /* check the value defining the size of the FIFO element */
     if (mm_config->super.max_short <= sizeof(uct_mm_fifo_element_t)) {
         ucs_error("The UCT_MM_MAX_SHORT parameter must be larger than the FIFO "
@@ -500,14 +1132,31 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
         goto err;
     }
 
+    if (mm_config->attach_cache_size == 0) {
+        ucs_error("The MM attach cache size must be at least 1.");
+        status = UCS_ERR_INVALID_PARAM;
+        goto err;
+    }
+
     self->config.fifo_size         = mm_config->fifo_size;
     self->config.fifo_elem_size    = mm_config->super.max_short;
     self->config.seg_size          = mm_config->super.max_bcopy;
+    self->config.rx_max_poll       = mm_config->rx_max_poll;
+    self->config.sender_rings      = mm_config->sender_rings;
+    self->config.ring_size         = mm_config->ring_size;
+    self->config.numa_policy       = mm_config->numa_policy;
+    self->config.numa_node         = uct_mm_iface_get_numa_node(mm_config->numa_policy);
+    self->recv_desc_numa_serial    = 0;
+    self->config.attach_cache_size = mm_config->attach_cache_size;
     self->fifo_release_factor_mask = UCS_MASK(ucs_ilog2(ucs_max((int)
                                      (mm_config->fifo_size * mm_config->release_fifo_factor),
                                      1)));
     self->fifo_mask                = mm_config->fifo_size - 1;
     self->fifo_shift               = ucs_count_trailing_zero_bits(mm_config->fifo_size);
+    self->ring_shift               = ucs_count_trailing_zero_bits(mm_config->ring_size);
+    self->ring_release_factor_mask = UCS_MASK(ucs_ilog2(ucs_max((int)
+                                     (mm_config->ring_size * mm_config->release_fifo_factor),
+                                     1)));
     self->rx_headroom              = (params->field_mask &
                                       UCT_IFACE_PARAM_FIELD_RX_HEADROOM) ?
                                      params->rx_headroom : 0;
@@ -521,15 +1170,25 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
         goto err;
     }
 
-    self->recv_fifo_ctl->head   = 0;
-    self->recv_fifo_ctl->tail   = 0;
-    self->read_index            = 0;
+    self->recv_fifo_ctl->head           = 0;
+    self->recv_fifo_ctl->tail           = 0;
+    self->recv_fifo_ctl->armed          = 0;
+    self->recv_fifo_ctl->fifo_size      = self->config.fifo_size;
+    self->recv_fifo_ctl->fifo_elem_size = self->config.fifo_elem_size;
+    self->recv_fifo_ctl->sender_rings   = self->config.sender_rings;
+    self->recv_fifo_ctl->ring_size      = self->config.ring_size;
+    self->read_index                    = 0;
 
-    status = uct_mm_iface_create_signal_fd(self);
+    status = uct_mm_iface_init_rings(self);
     if (status != UCS_OK) {
         goto err_free_fifo;
     }
 
+    status = uct_mm_iface_create_signal_fd(self);
+    if (status != UCS_OK) {
+        goto err_free_rings;
+    }
+
     /* create a memory pool for receive descriptors */
     status = uct_iface_mpool_init(&self->super,
                                   &self->recv_desc_mp,
@@ -546,7 +1205,8 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
         goto err_close_signal_fd;
     }
 
-    ucs_mpool_grow(&self->recv_desc_mp, mm_config->fifo_size * 2);
+    ucs_mpool_grow(&self->recv_desc_mp, mm_config->fifo_size * 2 +
+                   self->config.sender_rings * self->config.ring_size);
 
     /* set the first receive descriptor */
     self->last_recv_desc = ucs_mpool_get(&self->recv_desc_mp);
@@ -557,31 +1217,52 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
         goto destroy_recv_mpool;
     }
 
-    /* initiate the owner bit in all the FIFO elements and assign a receive descriptor
-     * per every FIFO element */
-    for (i = 0; i < mm_config->fifo_size; i++) {
-        fifo_elem_p = UCT_MM_IFACE_GET_FIFO_ELEM(self, self->recv_fifo_elements, i);
-        fifo_elem_p->flags = UCT_MM_FIFO_ELEM_FLAG_OWNER;
+    status = uct_mm_iface_init_fifo_elems(self, self->recv_fifo_elements,
+                                          self->recv_fifo_descs,
+                                          mm_config->fifo_size);
+    if (status != UCS_OK) {
+        goto destroy_last_desc;
+    }
 
-        status = uct_mm_assign_desc_to_fifo_elem(self, fifo_elem_p, 1);
+    /* the rings are initialized in advance, so a sender can write to its ring
+     * right after taking it */
+    for (i = 0; i < self->config.sender_rings; i++) {
+        status = uct_mm_iface_init_fifo_elems(self, self->rx_rings[i].elements,
+                                              self->rx_rings[i].descs,
+                                              self->config.ring_size);
         if (status != UCS_OK) {
-            ucs_error("Failed to allocate a descriptor for MM");
             goto destroy_descs;
         }
     }
 
+    status = ucs_mpool_init(&self->zcopy_mp, 0, sizeof(uct_mm_zcopy_op_t), 0, 1,
+                            128, UINT_MAX, &uct_mm_iface_zcopy_mpool_ops,
+                            "mm_zcopy_ops");
+    if (status != UCS_OK) {
+        goto destroy_descs;
+    }
+
+    ucs_list_head_init(&self->zcopy_eps);
+    kh_init_inplace(uct_mm_remote_seg, &self->remote_segs.hash);
+    ucs_list_head_init(&self->remote_segs.lru);
+    self->remote_segs.count = 0;
     ucs_arbiter_init(&self->arbiter);
 
     ucs_debug("Created an MM iface. FIFO mm id: %zu", self->fifo_mm_id);
     return UCS_OK;
 
 destroy_descs:
-    uct_mm_iface_free_rx_descs(self, i);
+    uct_mm_iface_free_rings_rx_descs(self, i);
+    uct_mm_iface_free_rx_descs(self, self->recv_fifo_descs,
+                               self->config.fifo_size);
+destroy_last_desc:
     ucs_mpool_put(self->last_recv_desc);
 destroy_recv_mpool:
     ucs_mpool_cleanup(&self->recv_desc_mp, 1);
 err_close_signal_fd:
     close(self->signal_fd);
+err_free_rings:
+    ucs_free(self->rx_rings);
 err_free_fifo:
     uct_mm_md_mapper_ops(md)->free(self->shared_mem, self->fifo_mm_id,
                                    UCT_MM_GET_FIFO_SIZE(self), self->path);
@@ -599,10 +1280,15 @@ static UCS_CLASS_CLEANUP_FUNC(uct_mm_iface_t)
 
     /* return all the descriptors that are now 'assigned' to the FIFO,
      * to their mpool */
-    uct_mm_iface_free_rx_descs(self, self->config.fifo_size);
+    uct_mm_iface_free_rx_descs(self, self->recv_fifo_descs,
+                               self->config.fifo_size);
+    uct_mm_iface_free_rings_rx_descs(self, self->config.sender_rings);
+    ucs_free(self->rx_rings);
 
     ucs_mpool_put(self->last_recv_desc);
     ucs_mpool_cleanup(&self->recv_desc_mp, 1);
+    ucs_mpool_cleanup(&self->zcopy_mp, 1);
+    uct_mm_iface_detach_all_remote_segs(self);
     close(self->signal_fd);
 
     size_to_free = UCT_MM_GET_FIFO_SIZE(self);
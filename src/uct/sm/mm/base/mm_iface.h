@@ -14,7 +14,9 @@
 #include <uct/base/uct_iface.h>
 #include <ucs/arch/cpu.h>
 #include <ucs/debug/memtrack.h>
+#include <ucs/memory/numa.h>
 #include <ucs/datastruct/arbiter.h>
+#include <ucs/datastruct/khash.h>
 #include <ucs/sys/compiler.h>
 #include <ucs/sys/sys.h>
 #include <sys/shm.h>
@@ -24,18 +26,49 @@
 #define UCT_MM_TL_NAME "mm"
 #define UCT_MM_FIFO_CTL_SIZE_ALIGNED  ucs_align_up(sizeof(uct_mm_fifo_ctl_t),UCS_SYS_CACHE_LINE_SIZE)
 
-#define UCT_MM_GET_FIFO_SIZE(iface)  (UCS_SYS_CACHE_LINE_SIZE - 1 +  \
-                                      UCT_MM_FIFO_CTL_SIZE_ALIGNED + \
-                                     ((iface)->config.fifo_size *    \
-                                     (iface)->config.fifo_elem_size))
+/* Size of the elements of a FIFO, followed by their receive descriptors */
+#define UCT_MM_GET_FIFO_ELEMS_SIZE(iface, fifo_size) \
+    (ucs_align_up((fifo_size) * (iface)->config.fifo_elem_size, \
+                  UCS_SYS_CACHE_LINE_SIZE) + \
+     ucs_align_up((fifo_size) * sizeof(uct_mm_fifo_desc_t), \
+                  UCS_SYS_CACHE_LINE_SIZE))
+
+/* Offset of the sender rings from the FIFO control struct. The rings follow
+ * the elements of the shared FIFO */
+#define UCT_MM_GET_RINGS_OFFSET(iface) \
+    (UCT_MM_FIFO_CTL_SIZE_ALIGNED + \
+     UCT_MM_GET_FIFO_ELEMS_SIZE(iface, (iface)->config.fifo_size))
+
+/* Size of the control structs and the elements of all sender rings */
+#define UCT_MM_GET_RINGS_SIZE(iface) \
+    ((iface)->config.sender_rings * \
+     (sizeof(uct_mm_ring_ctl_t) + \
+      UCT_MM_GET_FIFO_ELEMS_SIZE(iface, (iface)->config.ring_size)))
+
+#define UCT_MM_GET_FIFO_SIZE(iface)  (UCS_SYS_CACHE_LINE_SIZE - 1 +   \
+                                      UCT_MM_GET_RINGS_OFFSET(iface) + \
+                                      UCT_MM_GET_RINGS_SIZE(iface))
+
+/* Maximal number of sender rings, limited by the size of the doorbell bitmap */
+#define UCT_MM_MAX_SENDER_RINGS      64
 
 
 typedef struct uct_mm_iface_config {
     uct_iface_config_t       super;
     unsigned                 fifo_size;            /* Size of the receive FIFO */
     double                   release_fifo_factor;
+    unsigned                 rx_max_poll;          /* Maximal number of FIFO */
+                                                   /* elements to read in one */
+                                                   /* progress call */
+    unsigned                 sender_rings;         /* Number of single-producer */
+                                                   /* rings in the receive FIFO */
+    unsigned                 ring_size;            /* Size of each sender ring */
     ucs_ternary_value_t      hugetlb_mode;         /* Enable using huge pages for */
                                                    /* shared memory buffers */
+    ucs_numa_policy_t        numa_policy;          /* NUMA policy of the receive */
+                                                   /* FIFO and descriptors */
+    unsigned                 attach_cache_size;    /* Maximal number of attached */
+                                                   /* remote segments */
     uct_iface_mpool_config_t mp;
 } uct_mm_iface_config_t;
 
@@ -45,13 +78,66 @@ struct uct_mm_fifo_ctl {
     volatile uint64_t  head;       /* where to write next */
     socklen_t          signal_addrlen;   /* address length of signaling socket */
     struct sockaddr_un signal_sockaddr;  /* address of signaling socket */
-    UCS_CACHELINE_PADDING(uint64_t, socklen_t, struct sockaddr_un);
+    uint32_t           fifo_size;        /* layout of the FIFO and the sender */
+    uint32_t           fifo_elem_size;   /* rings, which the senders compute */
+    uint32_t           sender_rings;     /* from their own configuration */
+    uint32_t           ring_size;
+    UCS_CACHELINE_PADDING(uint64_t, socklen_t, struct sockaddr_un, uint32_t,
+                          uint32_t, uint32_t, uint32_t);
 
     /* 2nd cacheline */
     volatile uint64_t  tail;       /* how much was read */
+    UCS_CACHELINE_PADDING(uint64_t);
+
+    /* 3rd cacheline */
+    volatile uint64_t  ring_doorbell; /* bitmap of sender rings which may have */
+                                      /* new elements */
+    UCS_CACHELINE_PADDING(uint64_t);
+
+    /* 4th cacheline */
+    volatile uint64_t  armed;      /* set by the receiver when it waits for a */
+                                   /* signal, cleared by the sender which */
+                                   /* signals it */
+} UCS_S_PACKED UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE);
+
+
+/* Control struct of a single-producer ring. A sender which owns a ring writes
+ * to it without atomic operations, so the senders don't contend on the head
+ * of the shared FIFO */
+struct uct_mm_ring_ctl {
+    /* 1st cacheline - written by the sender */
+    volatile uint64_t  head;       /* where to write next */
+    volatile uint64_t  owner;      /* id of the sender process, made of its pid */
+                                   /* and start time, or 0 if the ring is free */
+    volatile uint64_t  owner_pid_ns; /* PID namespace of the sender, or 0 if */
+                                     /* it is not known yet */
+    UCS_CACHELINE_PADDING(uint64_t, uint64_t, uint64_t);
+
+    /* 2nd cacheline - written by the receiver */
+    volatile uint64_t  tail;       /* how much was read */
+    UCS_CACHELINE_PADDING(uint64_t);
 } UCS_S_PACKED UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE);
 
 
+/* Receiver's state of a sender ring */
+typedef struct uct_mm_rx_ring {
+    uct_mm_ring_ctl_t       *ctl;
+    void                    *elements;        /* the first element of the ring */
+    uct_mm_fifo_desc_t      *descs;           /* receive descriptors of the ring */
+    uint64_t                read_index;       /* actual reading location */
+} uct_mm_rx_ring_t;
+
+
+/* Attached remote segments are found by the owner process and the mmid, since
+ * the mmids of different processes may be the same */
+typedef struct {
+    uint64_t        owner;          /* pid of the process the chunk belongs to */
+    uct_mm_id_t     mmid;
+} uct_mm_remote_seg_key_t;
+
+__KHASH_TYPE(uct_mm_remote_seg, uct_mm_remote_seg_key_t, uct_mm_remote_seg_t*)
+
+
 struct uct_mm_iface {
     uct_base_iface_t        super;
 
@@ -68,6 +154,8 @@ struct uct_mm_iface {
                                               /* shared_mem starts */
     void                    *recv_fifo_elements; /* pointer to the first fifo element */
                                                  /* in the receive fifo */
+    uct_mm_fifo_desc_t      *recv_fifo_descs;    /* receive descriptors of the fifo */
+                                                 /* elements */
     uint64_t                read_index;          /* actual reading location */
 
     uint8_t                 fifo_shift;          /* = log2(fifo_size) */
@@ -76,6 +164,9 @@ struct uct_mm_iface {
 
     ucs_mpool_t             recv_desc_mp;
     uct_mm_recv_desc_t      *last_recv_desc;    /* next receive descriptor to use */
+    uint64_t                recv_desc_numa_serial; /* serial of the last receive */
+                                                   /* descriptors chunk which was */
+                                                   /* bound to the NUMA node */
 
     int                     signal_fd;        /* Unix socket for receiving remote signal */
 
@@ -84,10 +175,38 @@ struct uct_mm_iface {
     const char              *path;            /* path to the backing file (for 'posix') */
     uct_recv_desc_t         release_desc;
 
+    ucs_mpool_t             zcopy_mp;         /* zcopy operations waiting for */
+                                              /* the receiver to read the data */
+    ucs_list_link_t         zcopy_eps;        /* endpoints with outstanding */
+                                              /* zcopy operations */
+
+    /* Memory chunks of remote processes which are attached by this interface
+     * and its endpoints: receive descriptors of the peers for bcopy, and
+     * memory of the senders for zcopy. The least recently used chunk is
+     * detached when the cache is full. */
+    struct {
+        khash_t(uct_mm_remote_seg) hash;      /* (owner, mmid) -> attached segment */
+        ucs_list_link_t     lru;              /* most recently used first */
+        unsigned            count;            /* number of attached segments */
+    } remote_segs;
+
+    /* Sender rings */
+    uct_mm_rx_ring_t        *rx_rings;
+    unsigned                next_ring;        /* ring to start polling from */
+    uint8_t                 ring_shift;       /* = log2(ring_size) */
+    uint64_t                ring_release_factor_mask;
+
     struct {
         unsigned fifo_size;
         unsigned fifo_elem_size;
         unsigned seg_size;                    /* size of the receive descriptor (for payload)*/
+        unsigned rx_max_poll;                 /* max. FIFO elements to read per progress */
+        unsigned sender_rings;
+        unsigned ring_size;
+        ucs_numa_policy_t   numa_policy;
+        int                 numa_node;        /* node to bind the receive memory to,
+                                                 or -1 to keep the default policy */
+        unsigned            attach_cache_size; /* max. attached remote segments */
     } config;
 };
 
@@ -96,21 +215,42 @@ struct uct_mm_fifo_element {
     uint8_t         flags;
     uint8_t         am_id;          /* active message id */
     uint16_t        length;         /* length of actual data */
+    /* the data follows here (in case of inline messaging) */
+} UCS_S_PACKED;
 
-    /* bcopy parameters */
-    size_t          desc_mpool_size;
-    uct_mm_id_t     desc_mmid;      /* the mmid of the the memory chunk that
-                                     * the desc (that this fifo_elem points to)
-                                     * belongs to */
-    size_t          desc_offset;    /* the offset of the desc (its data location for bcopy)
+
+/* The receive descriptor which is assigned to a FIFO element, for bcopy
+ * messages. These are kept in an array after the FIFO elements, so a short
+ * message and its header share the cache line of the element */
+struct uct_mm_fifo_desc {
+    size_t          mpool_size;
+    uct_mm_id_t     mmid;           /* the mmid of the the memory chunk that
+                                     * the desc belongs to */
+    uint64_t        serial;         /* serial number of the memory chunk */
+    size_t          offset;         /* the offset of the desc (its data location for bcopy)
                                      * within the memory chunk it belongs to */
-    void            *desc_chunk_base_addr;
-    /* the data follows here (in case of inline messaging) */
+    void            *chunk_base_addr;
+    uint64_t        failed_index;   /* FIFO index of the last zcopy message in
+                                     * this element which the receiver could
+                                     * not read, or UINT64_MAX */
+} UCS_S_PACKED;
+
+
+/* Written to the inline data of a FIFO element for zcopy messages, followed by
+ * the active message header */
+struct uct_mm_zcopy_desc {
+    uct_mm_id_t     mmid;           /* the mmid of the sender's memory chunk */
+    uint64_t        serial;         /* chunk serial number in the sender */
+    uintptr_t       seg_address;    /* chunk address in the sender's process */
+    size_t          seg_length;     /* chunk length */
+    size_t          offset;         /* data offset within the chunk */
+    size_t          length;         /* data length */
 } UCS_S_PACKED;
 
 
 struct uct_mm_recv_desc {
     uct_mm_id_t         key;
+    uint64_t            serial;
     void                *base_address;
     size_t              mpool_length;
     uct_recv_desc_t     recv;   /* has to be in the end */
@@ -157,12 +297,39 @@ static inline void uct_mm_set_fifo_elems_ptr(void *mem_region, void **fifo_elems
    fifo_ctl = uct_mm_set_fifo_ctl(mem_region);
 
    /* initiate the pointer to the beginning of the first FIFO element */
-   *fifo_elems = (void*) fifo_ctl + UCT_MM_FIFO_CTL_SIZE_ALIGNED;
+   *fifo_elems = UCS_PTR_BYTE_OFFSET(fifo_ctl, UCT_MM_FIFO_CTL_SIZE_ALIGNED);
+}
+
+/**
+ * Get the control struct and the elements of a sender ring.
+ *
+ * @param [in]  iface     the interface whose configuration defines the layout.
+ * @param [in]  fifo_ctl  the FIFO control struct, local or attached.
+ * @param [in]  index     index of the ring.
+ * @param [out] ring_elems pointer to the first element of the ring.
+ */
+static inline uct_mm_ring_ctl_t *
+uct_mm_iface_get_ring(uct_mm_iface_t *iface, uct_mm_fifo_ctl_t *fifo_ctl,
+                      unsigned index, void **ring_elems)
+{
+    void *rings = UCS_PTR_BYTE_OFFSET(fifo_ctl, UCT_MM_GET_RINGS_OFFSET(iface));
+
+    *ring_elems = UCS_PTR_BYTE_OFFSET(rings,
+                                      (iface->config.sender_rings *
+                                       sizeof(uct_mm_ring_ctl_t)) +
+                                      (index * UCT_MM_GET_FIFO_ELEMS_SIZE(
+                                                   iface, iface->config.ring_size)));
+    return (uct_mm_ring_ctl_t*)rings + index;
 }
 
 void uct_mm_iface_release_desc(uct_recv_desc_t *self, void *desc);
 ucs_status_t uct_mm_flush();
 
+ucs_status_t uct_mm_iface_attach_remote_seg(uct_mm_iface_t *iface,
+                                            uct_mm_id_t mmid, uint64_t serial,
+                                            size_t length, void *address,
+                                            void **address_p);
+
 unsigned uct_mm_iface_progress(void *arg);
 
 extern uct_tl_component_t uct_mm_tl;
@@ -7,6 +7,22 @@
 
 #include "mm_md.h"
 
+#include <ucs/arch/atomic.h>
+#include <ucm/api/ucm.h>
+
+
+/* Serial number of the last allocated or registered segment */
+static uint64_t uct_mm_seg_serial = 0;
+
+
+/* The serial number holds the pid of the process, so segments of different
+ * processes which got the same mmid don't have the same serial number */
+static uint64_t uct_mm_seg_next_serial()
+{
+    return ((uint64_t)getpid() << UCT_MM_SEG_SERIAL_OWNER_SHIFT) |
+           (uint32_t)(ucs_atomic_fadd64(&uct_mm_seg_serial, 1) + 1);
+}
+
 ucs_config_field_t uct_mm_md_config_table[] = {
   {"", "", NULL,
    ucs_offsetof(uct_mm_md_config_t, super), UCS_CONFIG_TYPE_TABLE(uct_md_config_table)},
@@ -19,6 +35,14 @@ ucs_config_field_t uct_mm_md_config_table[] = {
    " try - Try to allocate memory using huge pages and if it fails, allocate regular pages.\n",
    ucs_offsetof(uct_mm_md_config_t, hugetlb_mode), UCS_CONFIG_TYPE_TERNARY},
 
+  {"RCACHE", "try", "Enable using memory registration cache, if the memory\n"
+   "domain supports registration of user memory",
+   ucs_offsetof(uct_mm_md_config_t, rcache_enable), UCS_CONFIG_TYPE_TERNARY},
+
+  {"", "", NULL,
+   ucs_offsetof(uct_mm_md_config_t, rcache),
+   UCS_CONFIG_TYPE_TABLE(uct_md_config_rcache_table)},
+
   {NULL}
 };
 
@@ -35,7 +59,6 @@ ucs_status_t uct_mm_mem_alloc(uct_md_h md, size_t *length_p, void **address_p,
         return UCS_ERR_NO_MEMORY;
     }
 
-
     status = uct_mm_md_mapper_ops(md)->alloc(md, length_p, UCS_TRY, flags,
                                              alloc_name, address_p, &seg->mmid,
                                              &seg->path);
@@ -44,6 +67,7 @@ ucs_status_t uct_mm_mem_alloc(uct_md_h md, size_t *length_p, void **address_p,
         return status;
     }
 
+    seg->serial  = uct_mm_seg_next_serial();
     seg->length  = *length_p;
     seg->address = *address_p;
     *memh_p      = seg;
@@ -68,6 +92,25 @@ ucs_status_t uct_mm_mem_free(uct_md_h md, uct_mem_h memh)
     return UCS_OK;
 }
 
+static ucs_status_t uct_mm_seg_reg(uct_md_h md, void *address, size_t length,
+                                   uct_mm_seg_t *seg)
+{
+    ucs_status_t status;
+
+    status = uct_mm_md_mapper_ops(md)->reg(address, length, &seg->mmid);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    seg->serial  = uct_mm_seg_next_serial();
+    seg->length  = length;
+    seg->address = address;
+
+    ucs_debug("mm registered address %p length %zu mmid %"PRIu64,
+              address, length, seg->mmid);
+    return UCS_OK;
+}
+
 ucs_status_t uct_mm_mem_reg(uct_md_h md, void *address, size_t length,
                             unsigned flags, uct_mem_h *memh_p)
 {
@@ -80,19 +123,13 @@ ucs_status_t uct_mm_mem_reg(uct_md_h md, void *address, size_t length,
         return UCS_ERR_NO_MEMORY;
     }
 
-    status = uct_mm_md_mapper_ops(md)->reg(address, length, 
-                                           &seg->mmid);
+    status = uct_mm_seg_reg(md, address, length, seg);
     if (status != UCS_OK) {
         ucs_free(seg);
         return status;
     }
 
-    seg->length  = length;
-    seg->address = address;
-    *memh_p      = seg;
-
-    ucs_debug("mm registered address %p length %zu mmid %"PRIu64,
-              address, length, seg->mmid);
+    *memh_p = seg;
     return UCS_OK;
 }
 
@@ -110,8 +147,40 @@ ucs_status_t uct_mm_mem_dereg(uct_md_h md, uct_mem_h memh)
     return UCS_OK;
 }
 
+static ucs_status_t uct_mm_mem_rcache_reg(uct_md_h md, void *address,
+                                          size_t length, unsigned flags,
+                                          uct_mem_h *memh_p)
+{
+    uct_mm_md_t *mm_md = ucs_derived_of(md, uct_mm_md_t);
+    ucs_rcache_region_t *rregion;
+    ucs_status_t status;
+
+    status = ucs_rcache_get(mm_md->rcache, address, length,
+                            PROT_READ|PROT_WRITE, &flags, &rregion);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    ucs_assert(rregion->refcount > 0);
+    *memh_p = &ucs_derived_of(rregion, uct_mm_rcache_region_t)->seg;
+    return UCS_OK;
+}
+
+static ucs_status_t uct_mm_mem_rcache_dereg(uct_md_h md, uct_mem_h memh)
+{
+    uct_mm_md_t *mm_md             = ucs_derived_of(md, uct_mm_md_t);
+    uct_mm_rcache_region_t *region = ucs_container_of(memh,
+                                                      uct_mm_rcache_region_t,
+                                                      seg);
+
+    ucs_rcache_region_put(mm_md->rcache, &region->super);
+    return UCS_OK;
+}
+
 ucs_status_t uct_mm_md_query(uct_md_h md, uct_md_attr_t *md_attr)
 {
+    uct_mm_md_t *mm_md = ucs_derived_of(md, uct_mm_md_t);
+
     md_attr->cap.flags     = 0;
     if (uct_mm_md_mapper_ops(md)->alloc != NULL) {
         md_attr->cap.flags |= UCT_MD_FLAG_ALLOC;
@@ -121,8 +190,13 @@ ucs_status_t uct_mm_md_query(uct_md_h md, uct_md_attr_t *md_attr)
     }
     if (uct_mm_md_mapper_ops(md)->reg != NULL) {
         md_attr->cap.flags |= UCT_MD_FLAG_REG;
-        md_attr->reg_cost.overhead = 1000.0e-9;
-        md_attr->reg_cost.growth   = 0.007e-9;
+        if (mm_md->rcache != NULL) {
+            md_attr->reg_cost.overhead = mm_md->config->rcache.overhead;
+            md_attr->reg_cost.growth   = 0; /* It's close enough to 0 */
+        } else {
+            md_attr->reg_cost.overhead = 1000.0e-9;
+            md_attr->reg_cost.growth   = 0.007e-9;
+        }
     }
     md_attr->cap.flags        |= UCT_MD_FLAG_NEED_RKEY;
     md_attr->cap.reg_mem_types = UCS_BIT(UCT_MD_MEM_TYPE_HOST);
@@ -172,7 +246,7 @@ ucs_status_t uct_mm_rkey_unpack(uct_md_component_t *mdc, const void *rkey_buffer
     }
 
     status = uct_mm_mdc_mapper_ops(mdc)->attach(rkey->mmid, rkey->length,
-                                                (void *)rkey->owner_ptr, 
+                                                (void *)rkey->owner_ptr,
                                                 &mm_desc->address,
                                                 &mm_desc->cookie,
                                                 rkey->path);
@@ -218,6 +292,9 @@ static void uct_mm_md_close(uct_md_h md)
 {
     uct_mm_md_t *mm_md = ucs_derived_of(md, uct_mm_md_t);
 
+    if (mm_md->rcache != NULL) {
+        ucs_rcache_destroy(mm_md->rcache);
+    }
     ucs_config_parser_release_opts(mm_md->config, md->component->md_config_table);
     ucs_free(mm_md->config);
     ucs_free(mm_md);
@@ -234,6 +311,85 @@ uct_md_ops_t uct_mm_md_ops = {
     .is_mem_type_owned = (void *)ucs_empty_function_return_zero,
 };
 
+static uct_md_ops_t uct_mm_md_rcache_ops = {
+    .close        = uct_mm_md_close,
+    .query        = uct_mm_md_query,
+    .mem_alloc    = uct_mm_mem_alloc,
+    .mem_free     = uct_mm_mem_free,
+    .mem_reg      = uct_mm_mem_rcache_reg,
+    .mem_dereg    = uct_mm_mem_rcache_dereg,
+    .mkey_pack    = uct_mm_mkey_pack,
+    .is_mem_type_owned = (void *)ucs_empty_function_return_zero,
+};
+
+static ucs_status_t uct_mm_rcache_mem_reg_cb(void *context, ucs_rcache_t *rcache,
+                                             void *arg, ucs_rcache_region_t *rregion,
+                                             uint16_t rcache_mem_reg_flags)
+{
+    uct_mm_rcache_region_t *region = ucs_derived_of(rregion, uct_mm_rcache_region_t);
+    uct_mm_md_t *mm_md             = context;
+
+    return uct_mm_seg_reg(&mm_md->super, (void*)region->super.super.start,
+                          region->super.super.end - region->super.super.start,
+                          &region->seg);
+}
+
+static void uct_mm_rcache_mem_dereg_cb(void *context, ucs_rcache_t *rcache,
+                                       ucs_rcache_region_t *rregion)
+{
+    uct_mm_rcache_region_t *region = ucs_derived_of(rregion, uct_mm_rcache_region_t);
+    uct_mm_md_t *mm_md             = context;
+
+    uct_mm_md_mapper_ops(&mm_md->super)->dereg(region->seg.mmid);
+}
+
+static void uct_mm_rcache_dump_region_cb(void *context, ucs_rcache_t *rcache,
+                                         ucs_rcache_region_t *rregion, char *buf,
+                                         size_t max)
+{
+    uct_mm_rcache_region_t *region = ucs_derived_of(rregion, uct_mm_rcache_region_t);
+
+    snprintf(buf, max, "mmid %"PRIu64" serial 0x%"PRIx64, region->seg.mmid,
+             region->seg.serial);
+}
+
+static ucs_rcache_ops_t uct_mm_rcache_ops = {
+    .mem_reg     = uct_mm_rcache_mem_reg_cb,
+    .mem_dereg   = uct_mm_rcache_mem_dereg_cb,
+    .dump_region = uct_mm_rcache_dump_region_cb
+};
+
+static ucs_status_t uct_mm_md_rcache_create(uct_mm_md_t *mm_md)
+{
+    ucs_rcache_params_t rcache_params;
+    ucs_status_t status;
+
+    rcache_params.region_struct_size = sizeof(uct_mm_rcache_region_t);
+    rcache_params.alignment          = mm_md->config->rcache.alignment;
+    rcache_params.max_alignment      = ucs_get_page_size();
+    rcache_params.ucm_events         = UCM_EVENT_VM_UNMAPPED;
+    rcache_params.ucm_event_priority = mm_md->config->rcache.event_prio;
+    rcache_params.context            = mm_md;
+    rcache_params.ops                = &uct_mm_rcache_ops;
+    status = ucs_rcache_create(&rcache_params, mm_md->super.component->name,
+                               ucs_stats_get_root(), &mm_md->rcache);
+    if (status == UCS_OK) {
+        mm_md->super.ops = &uct_mm_md_rcache_ops;
+        return UCS_OK;
+    }
+
+    ucs_assert(mm_md->rcache == NULL);
+    if (mm_md->config->rcache_enable == UCS_YES) {
+        ucs_error("Failed to create registration cache: %s",
+                  ucs_status_string(status));
+        return status;
+    }
+
+    ucs_debug("Could not create registration cache: %s",
+              ucs_status_string(status));
+    return UCS_OK;
+}
+
 ucs_status_t uct_mm_md_open(const char *md_name, const uct_md_config_t *md_config,
                             uct_md_h *md_p, uct_md_component_t *mdc)
 {
@@ -265,10 +421,23 @@ ucs_status_t uct_mm_md_open(const char *md_name, const uct_md_config_t *md_confi
 
     mm_md->super.ops = &uct_mm_md_ops;
     mm_md->super.component = mdc;
+    mm_md->rcache    = NULL;
+
+    /* the registration cache keeps the segment of a user buffer, so the
+     * receiver can reuse its attached mapping */
+    if ((uct_mm_mdc_mapper_ops(mdc)->reg != NULL) &&
+        (mm_md->config->rcache_enable != UCS_NO)) {
+        status = uct_mm_md_rcache_create(mm_md);
+        if (status != UCS_OK) {
+            goto err_release_config;
+        }
+    }
 
     *md_p = &mm_md->super;
     return UCS_OK;
 
+err_release_config:
+    ucs_config_parser_release_opts(mm_md->config, mdc->md_config_table);
 err_free_mm_md_config:
     ucs_free(mm_md->config);
 err_free_mm_md:
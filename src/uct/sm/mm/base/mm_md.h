@@ -12,24 +12,34 @@
 
 #include <uct/base/uct_md.h>
 #include <ucs/config/types.h>
+#include <ucs/datastruct/list.h>
 #include <ucs/debug/memtrack.h>
+#include <ucs/memory/rcache.h>
 #include <ucs/type/status.h>
 
 
 /* Shared memory ID */
 typedef uint64_t uct_mm_id_t;
 
+/* The serial number of a segment holds the pid of its owner process in the
+ * upper bits */
+#define UCT_MM_SEG_SERIAL_OWNER_SHIFT    32
+#define UCT_MM_SEG_SERIAL_OWNER(_serial) ((_serial) >> UCT_MM_SEG_SERIAL_OWNER_SHIFT)
+
 extern ucs_config_field_t uct_mm_md_config_table[];
 
 /*
  * Descriptor of the mapped memory
  */
 struct uct_mm_remote_seg {
-    uct_mm_remote_seg_t *next;
+    ucs_list_link_t     list;        /**< element in the LRU list of attached segments */
     uct_mm_id_t mmid;        /**< mmid of the remote memory chunk */
+    uint64_t    serial;      /**< serial number of the chunk in its owner process */
     void        *address;    /**< local memory address */
     uint64_t    cookie;      /**< cookie for mmap, xpmem, etc. */
     size_t      length;      /**< size of the memory */
+    unsigned    pin_count;   /**< data of the segment is passed to the user, so
+                                  it must not be detached */
 };
 
 /*
@@ -115,6 +125,8 @@ typedef struct uct_mm_mapper_ops {
  */
 typedef struct uct_mm_seg {
     uct_mm_id_t      mmid;      /* Shared memory ID */
+    uint64_t         serial;    /* Distinguishes segments which got the same
+                                   mmid after one of them was released */
     void             *address;  /* Virtual address */
     size_t           length;    /* Size of the memory */
     const char      *path;      /* path to the backing file when using posix */
@@ -138,9 +150,19 @@ typedef struct uct_mm_packed_rkey {
 typedef struct uct_mm_md {
     uct_md_t           super;
     uct_mm_md_config_t *config;
+    ucs_rcache_t       *rcache;  /* Registration cache (can be NULL) */
 } uct_mm_md_t;
 
 
+/**
+ * MM memory region in the registration cache.
+ */
+typedef struct uct_mm_rcache_region {
+    ucs_rcache_region_t super;
+    uct_mm_seg_t        seg;     /* exposed to the user as the memh */
+} uct_mm_rcache_region_t;
+
+
 ucs_status_t uct_mm_mem_alloc(uct_md_h md, size_t *length_p, void **address_p,
                               unsigned flags, const char *alloc_name,
                               uct_mem_h *memh_p);
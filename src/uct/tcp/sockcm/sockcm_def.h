@@ -0,0 +1,51 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2019.  ALL RIGHTS RESERVED.
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCT_SOCKCM_H
+#define UCT_SOCKCM_H
+
+#include <uct/api/uct.h>
+#include <uct/api/uct_def.h>
+#include <uct/base/uct_iface.h>
+#include <uct/base/uct_md.h>
+#include <ucs/type/class.h>
+#include <ucs/async/async.h>
+#include <ucs/sys/string.h>
+#include <sys/poll.h>
+#include <netinet/in.h>
+
+#define UCT_SOCKCM_TL_NAME              "sockcm"
+#define UCT_SOCKCM_PRIV_DATA_LEN        1024
+
+typedef struct uct_sockcm_iface   uct_sockcm_iface_t;
+typedef struct uct_sockcm_ep      uct_sockcm_ep_t;
+
+/**
+ * Header which precedes the user's private data on the wire. The client sends
+ * it with the connection request, and the server replies with a header only,
+ * which carries the accept/reject status.
+ */
+typedef struct uct_sockcm_priv_data_hdr {
+    uint32_t length;    /* length of the private data */
+    int8_t   status;
+} UCS_S_PACKED uct_sockcm_priv_data_hdr_t;
+
+typedef struct uct_sockcm_conn_param {
+    uct_sockcm_priv_data_hdr_t hdr;
+    char                       priv_data[UCT_SOCKCM_PRIV_DATA_LEN];
+} UCS_S_PACKED uct_sockcm_conn_param_t;
+
+/**
+ * Server-side connection request, passed to the user as uct_conn_request_h.
+ */
+typedef struct uct_sockcm_ctx {
+    int                        fd;
+    uct_sockcm_iface_t         *iface;
+    size_t                     offset;   /* received bytes so far */
+    ucs_list_link_t            list;     /* for list of pending requests */
+    uct_sockcm_conn_param_t    conn_param;
+} uct_sockcm_ctx_t;
+
+#endif /* UCT_SOCKCM_H */
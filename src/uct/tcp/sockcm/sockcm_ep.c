@@ -0,0 +1,412 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2019.  ALL RIGHTS RESERVED.
+ * See file LICENSE for terms.
+ */
+
+#include "sockcm_ep.h"
+#include <uct/base/uct_worker.h>
+#include <ucs/sys/sys.h>
+#include <ifaddrs.h>
+
+
+#define UCT_SOCKCM_CB_FLAGS_CHECK(_flags) \
+    do { \
+        UCT_CB_FLAGS_CHECK(_flags); \
+        if (!((_flags) & UCT_CB_FLAG_ASYNC)) { \
+            return UCS_ERR_UNSUPPORTED; \
+        } \
+    } while (0)
+
+
+static size_t uct_sockcm_sockaddr_len(const struct sockaddr *addr)
+{
+    return (addr->sa_family == AF_INET6) ? sizeof(struct sockaddr_in6) :
+                                           sizeof(struct sockaddr_in);
+}
+
+static int uct_sockcm_sockaddr_is_equal(const struct sockaddr *addr1,
+                                        const struct sockaddr *addr2)
+{
+    if (addr1->sa_family != addr2->sa_family) {
+        return 0;
+    }
+
+    if (addr1->sa_family == AF_INET) {
+        return ((const struct sockaddr_in*)addr1)->sin_addr.s_addr ==
+               ((const struct sockaddr_in*)addr2)->sin_addr.s_addr;
+    }
+
+    return !memcmp(&((const struct sockaddr_in6*)addr1)->sin6_addr,
+                   &((const struct sockaddr_in6*)addr2)->sin6_addr,
+                   sizeof(struct in6_addr));
+}
+
+/**
+ * Find the name of the network interface which the connected socket is bound
+ * to, to let the user choose matching auxiliary transports.
+ */
+static void uct_sockcm_ep_get_dev_name(uct_sockcm_ep_t *ep, char *dev_name)
+{
+    struct sockaddr_storage local_addr;
+    socklen_t addrlen = sizeof(local_addr);
+    struct ifaddrs *ifaddrs, *ifa;
+
+    ucs_strncpy_zero(dev_name, UCT_SOCKCM_TL_NAME, UCT_DEVICE_NAME_MAX);
+
+    if (getsockname(ep->fd, (struct sockaddr*)&local_addr, &addrlen) < 0) {
+        ucs_debug("getsockname(fd=%d) failed: %m", ep->fd);
+        return;
+    }
+
+    if (getifaddrs(&ifaddrs) < 0) {
+        ucs_debug("getifaddrs() failed: %m");
+        return;
+    }
+
+    for (ifa = ifaddrs; ifa != NULL; ifa = ifa->ifa_next) {
+        if ((ifa->ifa_addr != NULL) &&
+            uct_sockcm_sockaddr_is_equal(ifa->ifa_addr,
+                                         (struct sockaddr*)&local_addr)) {
+            ucs_strncpy_zero(dev_name, ifa->ifa_name, UCT_DEVICE_NAME_MAX);
+            break;
+        }
+    }
+
+    freeifaddrs(ifaddrs);
+}
+
+static unsigned uct_sockcm_client_err_handle_progress(void *arg);
+
+/**
+ * Must be called with the async context locked
+ */
+static void uct_sockcm_ep_invoke_completions(uct_sockcm_ep_t *ep,
+                                             ucs_status_t status)
+{
+    uct_sockcm_ep_op_t *op;
+
+    ucs_queue_for_each_extract(op, &ep->ops, queue_elem, 1) {
+        uct_invoke_completion(op->user_comp, status);
+        ucs_free(op);
+    }
+}
+
+/**
+ * Complete the connection establishment flow. Called from the ep's own async
+ * handler, so the handler is removed asynchronously, and the error handling
+ * flow (which destroys the ep) is always invoked from the main thread.
+ */
+static void uct_sockcm_ep_conn_complete(uct_sockcm_ep_t *ep, ucs_status_t status)
+{
+    uct_sockcm_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                               uct_sockcm_iface_t);
+
+    ucs_async_remove_handler(ep->fd, 0);
+    ep->conn_state = UCT_SOCKCM_EP_CONN_STATE_CLOSED;
+    ep->status     = status;
+    uct_sockcm_ep_invoke_completions(ep, status);
+
+    if (status != UCS_OK) {
+        uct_worker_progress_register_safe(&iface->super.worker->super,
+                                          uct_sockcm_client_err_handle_progress,
+                                          ep, UCS_CALLBACKQ_FLAG_ONESHOT,
+                                          &ep->slow_prog_id);
+    }
+}
+
+static ucs_status_t uct_sockcm_ep_pack_conn_param(uct_sockcm_ep_t *ep)
+{
+    char dev_name[UCT_DEVICE_NAME_MAX];
+    ssize_t priv_data_ret;
+    int error;
+    socklen_t optlen;
+
+    optlen = sizeof(error);
+    if (getsockopt(ep->fd, SOL_SOCKET, SO_ERROR, &error, &optlen) < 0) {
+        ucs_error("getsockopt(fd=%d, SO_ERROR) failed: %m", ep->fd);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    if (error != 0) {
+        ucs_error("sockcm connect(fd=%d) failed: %s", ep->fd, strerror(error));
+        return UCS_ERR_UNREACHABLE;
+    }
+
+    uct_sockcm_ep_get_dev_name(ep, dev_name);
+
+    /* The ep was created with UCT_CB_FLAG_ASYNC, so the callback may be
+     * invoked from the async thread */
+    ucs_assert(ep->pack_cb_flags & UCT_CB_FLAG_ASYNC);
+    if (ep->pack_cb == NULL) {
+        priv_data_ret = 0;
+    } else {
+        priv_data_ret = ep->pack_cb(ep->pack_cb_arg, dev_name,
+                                    ep->conn_param.priv_data);
+    }
+
+    if (priv_data_ret < 0) {
+        ucs_trace("sockcm client (ep=%p fd=%d) failed to fill private data. "
+                  "status: %s", ep, ep->fd, ucs_status_string(priv_data_ret));
+        return (ucs_status_t)priv_data_ret;
+    }
+
+    ucs_assert(priv_data_ret <= UCT_SOCKCM_PRIV_DATA_LEN);
+    ep->conn_param.hdr.length = priv_data_ret;
+    ep->conn_param.hdr.status = UCS_OK;
+    ep->offset                = 0;
+    ep->length                = sizeof(ep->conn_param.hdr) + priv_data_ret;
+    return UCS_OK;
+}
+
+/**
+ * Transfer the remaining part of the request (or the reply).
+ *
+ * @return UCS_OK if the transfer is done, UCS_INPROGRESS if should wait for
+ *         the next event, or an error.
+ */
+static ucs_status_t uct_sockcm_ep_progress_io(uct_sockcm_ep_t *ep, int is_send)
+{
+    void *buffer;
+    ssize_t ret;
+
+    while (ep->offset < ep->length) {
+        buffer = UCS_PTR_BYTE_OFFSET(&ep->conn_param, ep->offset);
+        if (is_send) {
+            ret = send(ep->fd, buffer, ep->length - ep->offset, MSG_NOSIGNAL);
+        } else {
+            ret = recv(ep->fd, buffer, ep->length - ep->offset, 0);
+        }
+
+        if (ret < 0) {
+            if ((errno == EAGAIN) || (errno == EINTR)) {
+                return UCS_INPROGRESS;
+            }
+            ucs_debug("%s(fd=%d) failed: %m", is_send ? "send" : "recv", ep->fd);
+            return UCS_ERR_UNREACHABLE;
+        } else if ((ret == 0) && !is_send) {
+            ucs_debug("fd %d closed by the server", ep->fd);
+            return UCS_ERR_UNREACHABLE;
+        }
+
+        ep->offset += ret;
+    }
+
+    return UCS_OK;
+}
+
+static void uct_sockcm_ep_event_handler(int fd, void *arg)
+{
+    uct_sockcm_ep_t *ep = arg;
+    char ip_port_str[UCS_SOCKADDR_STRING_LEN];
+    ucs_status_t status;
+
+    ucs_trace("sockcm ep %p fd %d event, state %d", ep, fd, ep->conn_state);
+
+    switch (ep->conn_state) {
+    case UCT_SOCKCM_EP_CONN_STATE_CONNECTING:
+        /* Client - connection is established, send a connection request
+         * with the user's private data */
+        status = uct_sockcm_ep_pack_conn_param(ep);
+        if (status != UCS_OK) {
+            break;
+        }
+
+        ep->conn_state = UCT_SOCKCM_EP_CONN_STATE_SENDING;
+        /* Fall through */
+    case UCT_SOCKCM_EP_CONN_STATE_SENDING:
+        status = uct_sockcm_ep_progress_io(ep, 1);
+        if (status != UCS_OK) {
+            break;
+        }
+
+        /* Wait for the server to accept or reject the request */
+        ep->conn_state = UCT_SOCKCM_EP_CONN_STATE_WAIT_REPLY;
+        ep->offset     = 0;
+        ep->length     = sizeof(ep->conn_param.hdr);
+        status         = ucs_async_modify_handler(fd, POLLIN);
+        if (status == UCS_OK) {
+            status = UCS_INPROGRESS;
+        }
+        break;
+    case UCT_SOCKCM_EP_CONN_STATE_WAIT_REPLY:
+        status = uct_sockcm_ep_progress_io(ep, 0);
+        if (status != UCS_OK) {
+            break;
+        }
+
+        status = (ucs_status_t)ep->conn_param.hdr.status;
+        if (status == UCS_ERR_REJECTED) {
+            ucs_debug("sockcm connection request to %s rejected, fd %d",
+                      ucs_sockaddr_str((struct sockaddr*)&ep->remote_addr,
+                                       ip_port_str, UCS_SOCKADDR_STRING_LEN),
+                      fd);
+        }
+        break;
+    default:
+        /* Events which were already in flight when the handler was removed */
+        return;
+    }
+
+    if (status != UCS_INPROGRESS) {
+        uct_sockcm_ep_conn_complete(ep, status);
+    }
+}
+
+static UCS_CLASS_INIT_FUNC(uct_sockcm_ep_t, const uct_ep_params_t *params)
+{
+    uct_sockcm_iface_t *iface       = ucs_derived_of(params->iface,
+                                                     uct_sockcm_iface_t);
+    const ucs_sock_addr_t *sockaddr = params->sockaddr;
+    char ip_port_str[UCS_SOCKADDR_STRING_LEN];
+    ucs_status_t status;
+    int ret;
+
+    UCS_CLASS_CALL_SUPER_INIT(uct_base_ep_t, &iface->super);
+
+    /* A server interface can connect to other servers as well, since every
+     * client endpoint has its own socket and async handler */
+    if (!(params->field_mask & UCT_EP_PARAM_FIELD_SOCKADDR)) {
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    UCT_SOCKCM_CB_FLAGS_CHECK((params->field_mask &
+                               UCT_EP_PARAM_FIELD_SOCKADDR_CB_FLAGS) ?
+                              params->sockaddr_cb_flags : 0);
+
+    self->pack_cb       = (params->field_mask &
+                           UCT_EP_PARAM_FIELD_SOCKADDR_PACK_CB) ?
+                          params->sockaddr_pack_cb : NULL;
+    self->pack_cb_arg   = (params->field_mask &
+                           UCT_EP_PARAM_FIELD_USER_DATA) ?
+                          params->user_data : NULL;
+    self->pack_cb_flags = (params->field_mask &
+                           UCT_EP_PARAM_FIELD_SOCKADDR_CB_FLAGS) ?
+                          params->sockaddr_cb_flags : 0;
+    self->slow_prog_id  = UCS_CALLBACKQ_ID_NULL;
+    self->conn_state    = UCT_SOCKCM_EP_CONN_STATE_CONNECTING;
+    self->status        = UCS_INPROGRESS;
+    ucs_queue_head_init(&self->ops);
+
+    /* Save the remote address */
+    if ((sockaddr->addr->sa_family != AF_INET) &&
+        (sockaddr->addr->sa_family != AF_INET6)) {
+        ucs_error("sockcm ep: unknown remote sa_family=%d",
+                  sockaddr->addr->sa_family);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    memcpy(&self->remote_addr, sockaddr->addr,
+           uct_sockcm_sockaddr_len(sockaddr->addr));
+
+    self->fd = socket(sockaddr->addr->sa_family, SOCK_STREAM, 0);
+    if (self->fd < 0) {
+        ucs_error("socket() failed: %m");
+        return UCS_ERR_IO_ERROR;
+    }
+
+    status = ucs_sys_fcntl_modfl(self->fd, O_NONBLOCK, 0);
+    if (status != UCS_OK) {
+        goto err_close;
+    }
+
+    /* The connection establishment flow continues from the async thread,
+     * when the socket becomes writable */
+    ret = connect(self->fd, (struct sockaddr*)&self->remote_addr,
+                  uct_sockcm_sockaddr_len(sockaddr->addr));
+    if ((ret < 0) && (errno != EINPROGRESS)) {
+        ucs_error("connect(fd=%d, addr=%s) failed: %m", self->fd,
+                  ucs_sockaddr_str(sockaddr->addr, ip_port_str,
+                                   UCS_SOCKADDR_STRING_LEN));
+        status = UCS_ERR_UNREACHABLE;
+        goto err_close;
+    }
+
+    status = ucs_async_set_event_handler(iface->super.worker->async->mode,
+                                         self->fd, POLLOUT,
+                                         uct_sockcm_ep_event_handler, self,
+                                         iface->super.worker->async);
+    if (status != UCS_OK) {
+        goto err_close;
+    }
+
+    ucs_debug("created a SOCKCM endpoint on iface %p, fd %d, remote addr: %s",
+              iface, self->fd,
+              ucs_sockaddr_str(sockaddr->addr, ip_port_str,
+                               UCS_SOCKADDR_STRING_LEN));
+    return UCS_OK;
+
+err_close:
+    close(self->fd);
+    return status;
+}
+
+static UCS_CLASS_CLEANUP_FUNC(uct_sockcm_ep_t)
+{
+    uct_sockcm_iface_t *iface = ucs_derived_of(self->super.super.iface,
+                                               uct_sockcm_iface_t);
+
+    ucs_debug("sockcm_ep %p: destroying", self);
+
+    /* The handler is already removed if the connection flow was completed */
+    ucs_async_remove_handler(self->fd, 1);
+
+    UCS_ASYNC_BLOCK(iface->super.worker->async);
+
+    /* remove the slow progress function in case it was placed on the slow
+     * progress chain but wasn't invoked yet */
+    uct_worker_progress_unregister_safe(&iface->super.worker->super,
+                                        &self->slow_prog_id);
+
+    if (!ucs_queue_is_empty(&self->ops)) {
+        ucs_warn("destroying endpoint %p with not completed operations", self);
+    }
+
+    UCS_ASYNC_UNBLOCK(iface->super.worker->async);
+
+    close(self->fd);
+}
+
+UCS_CLASS_DEFINE(uct_sockcm_ep_t, uct_base_ep_t)
+UCS_CLASS_DEFINE_NEW_FUNC(uct_sockcm_ep_t, uct_ep_t, const uct_ep_params_t *);
+UCS_CLASS_DEFINE_DELETE_FUNC(uct_sockcm_ep_t, uct_ep_t);
+
+static unsigned uct_sockcm_client_err_handle_progress(void *arg)
+{
+    uct_sockcm_ep_t *sockcm_ep = arg;
+    uct_sockcm_iface_t *iface  = ucs_derived_of(sockcm_ep->super.super.iface,
+                                                uct_sockcm_iface_t);
+
+    ucs_trace_func("err_handle ep=%p", sockcm_ep);
+    UCS_ASYNC_BLOCK(iface->super.worker->async);
+
+    sockcm_ep->slow_prog_id = UCS_CALLBACKQ_ID_NULL;
+    uct_set_ep_failed(&UCS_CLASS_NAME(uct_sockcm_ep_t), &sockcm_ep->super.super,
+                      sockcm_ep->super.super.iface, sockcm_ep->status);
+
+    UCS_ASYNC_UNBLOCK(iface->super.worker->async);
+    return 0;
+}
+
+ucs_status_t uct_sockcm_ep_flush(uct_ep_h tl_ep, unsigned flags,
+                                 uct_completion_t *comp)
+{
+    uct_sockcm_ep_t    *ep    = ucs_derived_of(tl_ep, uct_sockcm_ep_t);
+    uct_sockcm_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_sockcm_iface_t);
+    ucs_status_t       status;
+    uct_sockcm_ep_op_t *op;
+
+    UCS_ASYNC_BLOCK(iface->super.worker->async);
+    status = ep->status;
+    if ((status == UCS_INPROGRESS) && (comp != NULL)) {
+        op = ucs_malloc(sizeof(*op), "uct_sockcm_ep_flush op");
+        if (op != NULL) {
+            op->user_comp = comp;
+            ucs_queue_push(&ep->ops, &op->queue_elem);
+        } else {
+            status = UCS_ERR_NO_MEMORY;
+        }
+    }
+    UCS_ASYNC_UNBLOCK(iface->super.worker->async);
+
+    return status;
+}
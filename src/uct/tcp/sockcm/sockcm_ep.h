@@ -0,0 +1,57 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2019.  ALL RIGHTS RESERVED.
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCT_SOCKCM_EP_H
+#define UCT_SOCKCM_EP_H
+
+#include "sockcm_iface.h"
+
+
+typedef struct uct_sockcm_ep_op uct_sockcm_ep_op_t;
+
+struct uct_sockcm_ep_op {
+    ucs_queue_elem_t    queue_elem;
+    uct_completion_t    *user_comp;
+};
+
+
+/**
+ * Client endpoint connection state.
+ */
+typedef enum uct_sockcm_ep_conn_state {
+    UCT_SOCKCM_EP_CONN_STATE_CONNECTING,  /* waiting for connect() to complete */
+    UCT_SOCKCM_EP_CONN_STATE_SENDING,     /* sending the connection request */
+    UCT_SOCKCM_EP_CONN_STATE_WAIT_REPLY,  /* waiting for accept/reject reply */
+    UCT_SOCKCM_EP_CONN_STATE_CLOSED       /* done, successfully or not */
+} uct_sockcm_ep_conn_state_t;
+
+
+struct uct_sockcm_ep {
+    uct_base_ep_t                      super;
+    uct_sockaddr_priv_pack_callback_t  pack_cb;
+    void                               *pack_cb_arg;
+    uint32_t                           pack_cb_flags;
+
+    int                                fd;
+    uct_sockcm_ep_conn_state_t         conn_state;
+    ucs_queue_head_t                   ops;        /* guarded by async lock */
+    ucs_status_t                       status;     /* client EP status */
+
+    struct sockaddr_storage            remote_addr;
+    uct_worker_cb_id_t                 slow_prog_id;
+
+    /* connection request, or reply, being transferred */
+    size_t                             offset;
+    size_t                             length;
+    uct_sockcm_conn_param_t            conn_param;
+};
+
+UCS_CLASS_DECLARE_NEW_FUNC(uct_sockcm_ep_t, uct_ep_t, const uct_ep_params_t *);
+UCS_CLASS_DECLARE_DELETE_FUNC(uct_sockcm_ep_t, uct_ep_t);
+
+ucs_status_t uct_sockcm_ep_flush(uct_ep_h tl_ep, unsigned flags,
+                                 uct_completion_t *comp);
+
+#endif
@@ -0,0 +1,428 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2019.  ALL RIGHTS RESERVED.
+ * See file LICENSE for terms.
+ */
+
+#include "sockcm_iface.h"
+#include "sockcm_ep.h"
+#include <ucs/sys/sys.h>
+
+
+static ucs_config_field_t uct_sockcm_iface_config_table[] = {
+    {"", "", NULL,
+     ucs_offsetof(uct_sockcm_iface_config_t, super),
+     UCS_CONFIG_TYPE_TABLE(uct_iface_config_table)},
+
+    {"BACKLOG", "1024",
+     "Maximum number of pending connections for a listening socket.",
+     ucs_offsetof(uct_sockcm_iface_config_t, backlog), UCS_CONFIG_TYPE_UINT},
+
+    {NULL}
+};
+
+static UCS_CLASS_DECLARE_DELETE_FUNC(uct_sockcm_iface_t, uct_iface_t);
+
+static ucs_status_t uct_sockcm_iface_query(uct_iface_h tl_iface,
+                                           uct_iface_attr_t *iface_attr)
+{
+    memset(iface_attr, 0, sizeof(uct_iface_attr_t));
+
+    iface_attr->iface_addr_len  = sizeof(ucs_sock_addr_t);
+    iface_attr->device_addr_len = 0;
+    iface_attr->cap.flags       = UCT_IFACE_FLAG_CONNECT_TO_SOCKADDR |
+                                  UCT_IFACE_FLAG_CB_ASYNC            |
+                                  UCT_IFACE_FLAG_ERRHANDLE_PEER_FAILURE;
+    iface_attr->max_conn_priv   = UCT_SOCKCM_MAX_CONN_PRIV;
+
+    return UCS_OK;
+}
+
+static int uct_sockcm_iface_is_reachable(const uct_iface_h tl_iface,
+                                         const uct_device_addr_t *dev_addr,
+                                         const uct_iface_addr_t *iface_addr)
+{
+    /* Reachability can be checked with the uct_md_is_sockaddr_accessible API call */
+    return 1;
+}
+
+static ucs_status_t uct_sockcm_iface_get_address(uct_iface_h tl_iface,
+                                                 uct_iface_addr_t *iface_addr)
+{
+    ucs_sock_addr_t *sockcm_addr = (ucs_sock_addr_t *)iface_addr;
+
+    sockcm_addr->addr    = NULL;
+    sockcm_addr->addrlen = 0;
+    return UCS_OK;
+}
+
+/**
+ * Release a connection request. Should be called from the main thread, after
+ * the request was delivered to the user.
+ */
+static void uct_sockcm_iface_release_ctx(uct_sockcm_iface_t *iface,
+                                         uct_sockcm_ctx_t *ctx)
+{
+    UCS_ASYNC_BLOCK(iface->super.worker->async);
+    ucs_list_del(&ctx->list);
+    UCS_ASYNC_UNBLOCK(iface->super.worker->async);
+
+    close(ctx->fd);
+    ucs_free(ctx);
+}
+
+static ucs_status_t uct_sockcm_iface_send_reply(uct_sockcm_ctx_t *ctx,
+                                                ucs_status_t reply_status)
+{
+    uct_sockcm_priv_data_hdr_t hdr = {
+        .length = 0,
+        .status = reply_status
+    };
+    ssize_t ret;
+
+    /* The reply is a few bytes on an otherwise idle socket, so it always fits
+     * into the send buffer */
+    ret = send(ctx->fd, &hdr, sizeof(hdr), MSG_NOSIGNAL);
+    if (ret != sizeof(hdr)) {
+        ucs_debug("send(fd=%d) of connection reply failed: %m", ctx->fd);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    return UCS_OK;
+}
+
+static ucs_status_t uct_sockcm_iface_accept(uct_iface_h tl_iface,
+                                            uct_conn_request_h conn_request)
+{
+    uct_sockcm_iface_t *iface = ucs_derived_of(tl_iface, uct_sockcm_iface_t);
+    uct_sockcm_ctx_t   *ctx   = conn_request;
+    ucs_status_t       status;
+
+    ucs_trace("accepting connection request %p on fd %d", ctx, ctx->fd);
+    status = uct_sockcm_iface_send_reply(ctx, UCS_OK);
+    uct_sockcm_iface_release_ctx(iface, ctx);
+    return status;
+}
+
+static ucs_status_t uct_sockcm_iface_reject(uct_iface_h tl_iface,
+                                            uct_conn_request_h conn_request)
+{
+    uct_sockcm_iface_t *iface = ucs_derived_of(tl_iface, uct_sockcm_iface_t);
+    uct_sockcm_ctx_t   *ctx   = conn_request;
+    ucs_status_t       status;
+
+    ucs_trace("rejecting connection request %p on fd %d", ctx, ctx->fd);
+    status = uct_sockcm_iface_send_reply(ctx, UCS_ERR_REJECTED);
+    if (status != UCS_OK) {
+        ucs_warn("failed to reject connection request on fd %d", ctx->fd);
+    }
+
+    uct_sockcm_iface_release_ctx(iface, ctx);
+    return status;
+}
+
+static uct_iface_ops_t uct_sockcm_iface_ops = {
+    .ep_create                = UCS_CLASS_NEW_FUNC_NAME(uct_sockcm_ep_t),
+    .ep_destroy               = UCS_CLASS_DELETE_FUNC_NAME(uct_sockcm_ep_t),
+    .ep_flush                 = uct_sockcm_ep_flush,
+    .ep_fence                 = uct_base_ep_fence,
+    .ep_pending_purge         = ucs_empty_function,
+    .iface_accept             = uct_sockcm_iface_accept,
+    .iface_reject             = uct_sockcm_iface_reject,
+    .iface_progress_enable    = (void*)ucs_empty_function_return_success,
+    .iface_progress_disable   = (void*)ucs_empty_function_return_success,
+    .iface_progress           = ucs_empty_function_return_zero,
+    .iface_flush              = uct_base_iface_flush,
+    .iface_fence              = uct_base_iface_fence,
+    .iface_close              = UCS_CLASS_DELETE_FUNC_NAME(uct_sockcm_iface_t),
+    .iface_query              = uct_sockcm_iface_query,
+    .iface_is_reachable       = uct_sockcm_iface_is_reachable,
+    .iface_get_device_address = (void*)ucs_empty_function_return_success,
+    .iface_get_address        = uct_sockcm_iface_get_address
+};
+
+/**
+ * Free a connection request which was not delivered to the user. Called from
+ * the request's own async handler, so the handler is removed asynchronously.
+ */
+static void uct_sockcm_iface_discard_ctx(uct_sockcm_ctx_t *ctx)
+{
+    ucs_async_remove_handler(ctx->fd, 0);
+    ucs_list_del(&ctx->list);
+    close(ctx->fd);
+    ucs_free(ctx);
+}
+
+static void uct_sockcm_iface_conn_req_handler(int fd, void *arg)
+{
+    uct_sockcm_ctx_t           *ctx   = arg;
+    uct_sockcm_iface_t         *iface = ctx->iface;
+    uct_sockcm_priv_data_hdr_t *hdr   = &ctx->conn_param.hdr;
+    size_t total;
+    ssize_t ret;
+
+    /* Receive the header first, and then the private data which follows it */
+    for (;;) {
+        total = sizeof(*hdr);
+        if (ctx->offset >= sizeof(*hdr)) {
+            if (hdr->length > UCT_SOCKCM_PRIV_DATA_LEN) {
+                ucs_error("sockcm: invalid private data length %u on fd %d",
+                          hdr->length, fd);
+                uct_sockcm_iface_discard_ctx(ctx);
+                return;
+            }
+
+            total += hdr->length;
+            if (ctx->offset == total) {
+                break;
+            }
+        }
+
+        ret = recv(fd, UCS_PTR_BYTE_OFFSET(&ctx->conn_param, ctx->offset),
+                   total - ctx->offset, 0);
+        if (ret < 0) {
+            if ((errno == EAGAIN) || (errno == EINTR)) {
+                return;
+            }
+            ucs_debug("recv(fd=%d) of connection request failed: %m", fd);
+            uct_sockcm_iface_discard_ctx(ctx);
+            return;
+        } else if (ret == 0) {
+            ucs_debug("fd %d closed before sending a connection request", fd);
+            uct_sockcm_iface_discard_ctx(ctx);
+            return;
+        }
+
+        ctx->offset += ret;
+    }
+
+    /* The request is complete - no more events are expected on this socket
+     * until the user accepts or rejects it */
+    ucs_async_remove_handler(fd, 0);
+    ucs_assert(hdr->status == UCS_OK);
+
+    ucs_trace("sockcm connection request %p on fd %d, priv data length %u",
+              ctx, fd, hdr->length);
+
+    /* The iface was opened with UCT_CB_FLAG_ASYNC, so the callback may be
+     * invoked from the async thread */
+    ucs_assert(iface->cb_flags & UCT_CB_FLAG_ASYNC);
+    iface->conn_request_cb(&iface->super.super, iface->conn_request_arg,
+                           /* connection request */
+                           ctx,
+                           /* private data */
+                           ctx->conn_param.priv_data,
+                           /* length */
+                           hdr->length);
+}
+
+static void uct_sockcm_iface_accept_handler(int fd, void *arg)
+{
+    uct_sockcm_iface_t *iface = arg;
+    uct_sockcm_ctx_t *ctx;
+    ucs_status_t status;
+    int conn_fd;
+
+    for (;;) {
+        conn_fd = accept(fd, NULL, NULL);
+        if (conn_fd < 0) {
+            if ((errno != EAGAIN) && (errno != EINTR)) {
+                ucs_error("accept(fd=%d) failed: %m", fd);
+            }
+            return;
+        }
+
+        status = ucs_sys_fcntl_modfl(conn_fd, O_NONBLOCK, 0);
+        if (status != UCS_OK) {
+            goto err_close;
+        }
+
+        ctx = ucs_malloc(sizeof(*ctx), "sockcm conn request");
+        if (ctx == NULL) {
+            ucs_error("failed to allocate sockcm connection request");
+            goto err_close;
+        }
+
+        ctx->fd     = conn_fd;
+        ctx->iface  = iface;
+        ctx->offset = 0;
+        ucs_list_add_tail(&iface->used_ctx_list, &ctx->list);
+
+        status = ucs_async_set_event_handler(iface->super.worker->async->mode,
+                                             conn_fd, POLLIN,
+                                             uct_sockcm_iface_conn_req_handler,
+                                             ctx, iface->super.worker->async);
+        if (status != UCS_OK) {
+            ucs_list_del(&ctx->list);
+            ucs_free(ctx);
+            goto err_close;
+        }
+
+        ucs_debug("sockcm iface %p accepted connection on fd %d", iface, conn_fd);
+        continue;
+
+err_close:
+        close(conn_fd);
+    }
+}
+
+static UCS_CLASS_INIT_FUNC(uct_sockcm_iface_t, uct_md_h md, uct_worker_h worker,
+                           const uct_iface_params_t *params,
+                           const uct_iface_config_t *tl_config)
+{
+    uct_sockcm_iface_config_t *config = ucs_derived_of(tl_config,
+                                                       uct_sockcm_iface_config_t);
+    char ip_port_str[UCS_SOCKADDR_STRING_LEN];
+    const struct sockaddr *listen_addr;
+    ucs_status_t status;
+    int optval;
+
+    UCT_CHECK_PARAM(params->field_mask & UCT_IFACE_PARAM_FIELD_OPEN_MODE,
+                    "UCT_IFACE_PARAM_FIELD_OPEN_MODE is not defined");
+
+    UCT_CHECK_PARAM((params->open_mode & UCT_IFACE_OPEN_MODE_SOCKADDR_SERVER) ||
+                    (params->open_mode & UCT_IFACE_OPEN_MODE_SOCKADDR_CLIENT),
+                    "Invalid open mode %zu", params->open_mode);
+
+    UCT_CHECK_PARAM(!(params->open_mode & UCT_IFACE_OPEN_MODE_SOCKADDR_SERVER) ||
+                    (params->field_mask & UCT_IFACE_PARAM_FIELD_SOCKADDR),
+                    "UCT_IFACE_PARAM_FIELD_SOCKADDR is not defined for UCT_IFACE_OPEN_MODE_SOCKADDR_SERVER");
+
+    UCS_CLASS_CALL_SUPER_INIT(uct_base_iface_t, &uct_sockcm_iface_ops, md, worker,
+                              params, tl_config
+                              UCS_STATS_ARG((params->field_mask &
+                                             UCT_IFACE_PARAM_FIELD_STATS_ROOT) ?
+                                            params->stats_root : NULL)
+                              UCS_STATS_ARG(UCT_SOCKCM_TL_NAME));
+
+    if (self->super.worker->async == NULL) {
+        ucs_error("sockcm must have async != NULL");
+        return UCS_ERR_INVALID_PARAM;
+    }
+    if (self->super.worker->async->mode == UCS_ASYNC_MODE_SIGNAL) {
+        ucs_warn("sockcm does not support SIGIO");
+    }
+
+    ucs_list_head_init(&self->used_ctx_list);
+
+    if (!(params->open_mode & UCT_IFACE_OPEN_MODE_SOCKADDR_SERVER)) {
+        self->listen_fd = -1;
+        self->is_server = 0;
+        goto out;
+    }
+
+    listen_addr = params->mode.sockaddr.listen_sockaddr.addr;
+
+    if (!(params->mode.sockaddr.cb_flags & UCT_CB_FLAG_ASYNC)) {
+        ucs_error("sockcm supports only asynchronous connection request "
+                  "callbacks");
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    self->listen_fd = socket(listen_addr->sa_family, SOCK_STREAM, 0);
+    if (self->listen_fd < 0) {
+        ucs_error("socket() failed: %m");
+        status = UCS_ERR_IO_ERROR;
+        goto err;
+    }
+
+    optval = 1;
+    if (setsockopt(self->listen_fd, SOL_SOCKET, SO_REUSEADDR, &optval,
+                   sizeof(optval)) < 0) {
+        ucs_error("setsockopt(SO_REUSEADDR) failed: %m");
+        status = UCS_ERR_IO_ERROR;
+        goto err_close_sock;
+    }
+
+    if (bind(self->listen_fd, listen_addr,
+             params->mode.sockaddr.listen_sockaddr.addrlen) < 0) {
+        ucs_error("bind(addr=%s) failed: %m",
+                  ucs_sockaddr_str(listen_addr, ip_port_str,
+                                   UCS_SOCKADDR_STRING_LEN));
+        status = (errno == EADDRINUSE) ? UCS_ERR_BUSY : UCS_ERR_IO_ERROR;
+        goto err_close_sock;
+    }
+
+    if (listen(self->listen_fd, config->backlog) < 0) {
+        ucs_error("listen(fd=%d addr=%s) failed: %m", self->listen_fd,
+                  ucs_sockaddr_str(listen_addr, ip_port_str,
+                                   UCS_SOCKADDR_STRING_LEN));
+        status = UCS_ERR_IO_ERROR;
+        goto err_close_sock;
+    }
+
+    status = ucs_sys_fcntl_modfl(self->listen_fd, O_NONBLOCK, 0);
+    if (status != UCS_OK) {
+        goto err_close_sock;
+    }
+
+    self->cb_flags         = params->mode.sockaddr.cb_flags;
+    self->conn_request_cb  = params->mode.sockaddr.conn_request_cb;
+    self->conn_request_arg = params->mode.sockaddr.conn_request_arg;
+    self->is_server        = 1;
+
+    /* The server accepts connections from the async thread, and then waits
+     * for the private data of each one */
+    status = ucs_async_set_event_handler(self->super.worker->async->mode,
+                                         self->listen_fd, POLLIN,
+                                         uct_sockcm_iface_accept_handler,
+                                         self, self->super.worker->async);
+    if (status != UCS_OK) {
+        ucs_error("failed to set event handler");
+        goto err_close_sock;
+    }
+
+    ucs_debug("sockcm iface %p listening on %s, fd %d", self,
+              ucs_sockaddr_str(listen_addr, ip_port_str, UCS_SOCKADDR_STRING_LEN),
+              self->listen_fd);
+
+out:
+    ucs_debug("created a SOCKCM iface %p. listen fd: %d", self, self->listen_fd);
+    return UCS_OK;
+
+err_close_sock:
+    close(self->listen_fd);
+err:
+    return status;
+}
+
+static UCS_CLASS_CLEANUP_FUNC(uct_sockcm_iface_t)
+{
+    uct_sockcm_ctx_t *ctx;
+
+    if (self->is_server) {
+        ucs_async_remove_handler(self->listen_fd, 1);
+        close(self->listen_fd);
+    }
+
+    /* Connection requests which were not accepted or rejected by the user */
+    while (!ucs_list_is_empty(&self->used_ctx_list)) {
+        ctx = ucs_list_head(&self->used_ctx_list, uct_sockcm_ctx_t, list);
+        ucs_async_remove_handler(ctx->fd, 1);
+        uct_sockcm_iface_release_ctx(self, ctx);
+    }
+}
+
+UCS_CLASS_DEFINE(uct_sockcm_iface_t, uct_base_iface_t);
+static UCS_CLASS_DEFINE_NEW_FUNC(uct_sockcm_iface_t, uct_iface_t, uct_md_h,
+                                 uct_worker_h, const uct_iface_params_t *,
+                                 const uct_iface_config_t *);
+static UCS_CLASS_DEFINE_DELETE_FUNC(uct_sockcm_iface_t, uct_iface_t);
+
+static ucs_status_t uct_sockcm_query_tl_resources(uct_md_h md,
+                                                  uct_tl_resource_desc_t **resource_p,
+                                                  unsigned *num_resources_p)
+{
+    *num_resources_p = 0;
+    *resource_p      = NULL;
+    return UCS_OK;
+}
+
+UCT_TL_COMPONENT_DEFINE(uct_sockcm_tl,
+                        uct_sockcm_query_tl_resources,
+                        uct_sockcm_iface_t,
+                        UCT_SOCKCM_TL_NAME,
+                        "SOCKCM_",
+                        uct_sockcm_iface_config_table,
+                        uct_sockcm_iface_config_t);
+UCT_MD_REGISTER_TL(&uct_sockcm_mdc, &uct_sockcm_tl);
+
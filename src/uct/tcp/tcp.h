@@ -7,8 +7,11 @@
 #define UCT_TCP_MD_H
 
 #include <uct/base/uct_md.h>
+#include <ucs/datastruct/khash.h>
 #include <ucs/sys/sys.h>
+#include <ucs/type/spinlock.h>
 #include <net/if.h>
+#include <sys/un.h>
 
 #define UCT_TCP_NAME "tcp"
 
@@ -17,26 +20,300 @@
 #define UCT_TCP_MAX_EVENTS        32
 
 
+/** How many recently active endpoints are polled without epoll_wait */
+#define UCT_TCP_MAX_ACTIVE_EPS    4
+
+
+/** Maximal number of send vector entries, including the AM header */
+#define UCT_TCP_MAX_IOV           16
+
+
+/* Zero-copy socket sends are supported since Linux 4.14 */
+#ifndef SO_ZEROCOPY
+#  define SO_ZEROCOPY             60
+#endif
+#ifndef MSG_ZEROCOPY
+#  define MSG_ZEROCOPY            0x4000000
+#endif
+#ifndef MFD_CLOEXEC
+#  define MFD_CLOEXEC             0x0001U
+#endif
+
+
+/**
+ * Active message identifiers used internally by the transport, beyond the
+ * range of user-defined active messages
+ */
+enum {
+    UCT_TCP_AM_PUT = UCT_AM_ID_MAX,   /* Write data to remote memory */
+    UCT_TCP_AM_GET_REQ,               /* Request to read remote memory */
+    UCT_TCP_AM_GET_RESP,              /* Data of a get request */
+    UCT_TCP_AM_CONN_GROUP,            /* First message on a connection of a
+                                         striped endpoint */
+    UCT_TCP_AM_SHM_ATTACH,            /* Peer on the same host passed a shared
+                                         memory buffer for the connection */
+    UCT_TCP_AM_SHM_ACK                /* Shared memory buffer is attached */
+};
+
+
+/** Active message identifier flag: the data is in the shared memory buffer */
+#define UCT_TCP_AM_FLAG_SHM       UCS_BIT(7)
+
+
+/**
+ * TCP endpoint flags
+ */
+enum {
+    UCT_TCP_EP_FLAG_CONNECTED   = UCS_BIT(0), /* Created by the user, not by
+                                                 accepting a connection */
+    UCT_TCP_EP_FLAG_PUT_UNACKED = UCS_BIT(1), /* Put operations were sent after
+                                                 the last remote flush */
+    UCT_TCP_EP_FLAG_FAILED      = UCS_BIT(2), /* Connection to the peer is lost */
+    UCT_TCP_EP_FLAG_RX_BLOCKED  = UCS_BIT(3), /* Next received message must wait
+                                                 for messages on other connections
+                                                 of the group */
+    UCT_TCP_EP_FLAG_RX_ACTIVE   = UCS_BIT(4), /* Endpoint is on the list of
+                                                 recently active endpoints */
+    UCT_TCP_EP_FLAG_TX_COALESCE = UCS_BIT(5), /* Send buffer has messages which
+                                                 were not passed to the socket */
+    UCT_TCP_EP_FLAG_SHM         = UCS_BIT(6), /* Peer attached the shared memory
+                                                 buffer, so data may be sent
+                                                 through it */
+    UCT_TCP_EP_FLAG_TX_SN       = UCS_BIT(7)  /* Sent messages are numbered, since
+                                                 the connection is one of several
+                                                 connections of the endpoint */
+};
+
+
+/**
+ * TCP device address
+ */
+typedef struct uct_tcp_device_addr {
+    struct in_addr                in_addr;   /* Interface IPv4 address */
+    uint64_t                      host_id;   /* Identifies the host */
+} UCS_S_PACKED uct_tcp_device_addr_t;
+
+
 /**
  * TCP active message header
  */
 typedef struct uct_tcp_am_hdr {
     uint8_t                       am_id;
-    uint16_t                      length;
+    uint32_t                      length;    /* Data length after the header */
 } UCS_S_PACKED uct_tcp_am_hdr_t;
 
 
+/**
+ * Sequence number on the endpoint, which precedes the active message header on
+ * the connections of a connection group
+ */
+typedef struct uct_tcp_am_sn {
+    uint32_t                      sn;
+} UCS_S_PACKED uct_tcp_am_sn_t;
+
+
+/**
+ * Header of a put operation, followed by the data
+ */
+typedef struct uct_tcp_put_hdr {
+    uint64_t                      address;   /* Remote address to write to */
+    uint64_t                      key_id;    /* Remote memory registration */
+} UCS_S_PACKED uct_tcp_put_hdr_t;
+
+
+/**
+ * Get request, the response carries the data without additional header
+ */
+typedef struct uct_tcp_get_req_hdr {
+    uint64_t                      address;   /* Remote address to read from */
+    uint32_t                      length;    /* How much data to read */
+    uint64_t                      key_id;    /* Remote memory registration */
+} UCS_S_PACKED uct_tcp_get_req_hdr_t;
+
+
+/**
+ * Data of a message which was sent through the shared memory buffer
+ */
+typedef struct uct_tcp_shm_desc {
+    uint64_t                      offset;    /* Data offset in the buffer */
+    uint64_t                      length;    /* Data length */
+    uint64_t                      end;       /* Buffer position to release after
+                                                handling the message */
+} UCS_S_PACKED uct_tcp_shm_desc_t;
+
+
+/**
+ * Shared memory attach message, identifies the buffer passed over the unix
+ * domain socket
+ */
+typedef struct uct_tcp_shm_attach_hdr {
+    uint64_t                      id;        /* Buffer identifier */
+} UCS_S_PACKED uct_tcp_shm_attach_hdr_t;
+
+
+/**
+ * Control area at the beginning of the shared memory buffer of a connection,
+ * followed by the data ring
+ */
+typedef struct uct_tcp_shm_ctl {
+    volatile uint64_t             tail;      /* Position released by the receiver */
+} uct_tcp_shm_ctl_t;
+
+
+/**
+ * Shared memory buffer passed by a peer, and not attached to a connection yet
+ */
+typedef struct uct_tcp_shm_fd {
+    uint64_t                      id;        /* Buffer identifier */
+    int                           fd;        /* Memory file descriptor */
+    ucs_list_link_t               list;      /* Element in the interface list */
+} uct_tcp_shm_fd_t;
+
+
+/**
+ * Connection group message, identifies the sending endpoint
+ */
+typedef struct uct_tcp_conn_group_hdr {
+    uint64_t                      id;        /* Unique endpoint identifier */
+} UCS_S_PACKED uct_tcp_conn_group_hdr_t;
+
+
+/**
+ * Outstanding get operation. On the initiator it waits for the response, on
+ * the target it waits for the endpoint to send the response.
+ */
+typedef struct uct_tcp_get_op {
+    ucs_queue_elem_t              queue;     /* Element in endpoint get queue */
+    struct iovec                  iov[UCT_TCP_MAX_IOV]; /* Local data buffers */
+    size_t                        iov_cnt;   /* Number of entries in iov */
+    size_t                        length;    /* Total data length */
+    uct_unpack_callback_t         unpack_cb; /* Unpack callback for bcopy, or NULL */
+    void                          *arg;      /* Unpack callback argument */
+    uct_completion_t              *comp;     /* User completion */
+} uct_tcp_get_op_t;
+
+
+/**
+ * Zero-copy send whose data may still be referenced by the kernel, or a flush
+ * waiting for such sends
+ */
+typedef struct uct_tcp_zcopy_op {
+    ucs_queue_elem_t              queue;     /* Element in endpoint zcopy queue */
+    uint32_t                      sn;        /* Last MSG_ZEROCOPY send to wait for */
+    uct_completion_t              *comp;     /* User completion */
+} uct_tcp_zcopy_op_t;
+
+
+/**
+ * TCP remote key, describing registered memory region
+ */
+typedef struct uct_tcp_key {
+    uint64_t                      address;   /* Base address */
+    uint64_t                      length;    /* Region length */
+    uint64_t                      id;        /* Registration identifier, which
+                                                the target uses to validate
+                                                remote accesses */
+} uct_tcp_key_t;
+
+
+__KHASH_TYPE(uct_tcp_md_keys, uint64_t, uct_tcp_key_t*)
+
+
+/**
+ * TCP memory domain
+ */
+typedef struct uct_tcp_md {
+    uct_md_t                      super;
+    khash_t(uct_tcp_md_keys)      keys;      /* Registered regions by id */
+    ucs_spinlock_t                lock;      /* Protects the registered regions */
+    uint64_t                      next_id;   /* Identifier of next registration */
+} uct_tcp_md_t;
+
+
+/**
+ * TCP receive descriptor. The received data follows the descriptor, after
+ * space reserved for the user-defined receive headroom.
+ */
+typedef struct uct_tcp_rx_desc {
+    uct_recv_desc_t               release;   /* Used when the user keeps the data */
+} uct_tcp_rx_desc_t;
+
+
+/**
+ * Accepted connections of the same remote striped endpoint. Messages are
+ * handled in the order of their sequence numbers, regardless of the connection
+ * they arrived on.
+ */
+typedef struct uct_tcp_rx_group {
+    uint64_t                      id;        /* Remote endpoint identifier */
+    uint32_t                      sn;        /* Next message to handle */
+    ucs_list_link_t               conns;     /* Connections in the group */
+    ucs_list_link_t               list;      /* Element in the interface list */
+} uct_tcp_rx_group_t;
+
+
 /**
  * TCP endpoint
  */
 typedef struct uct_tcp_ep {
     uct_base_ep_t                 super;
     int                           fd;        /* Socket file descriptor */
+    uint8_t                       flags;     /* Endpoint flags */
     uint32_t                      events;    /* Current notifications */
     ucs_queue_head_t              pending_q; /* Pending operations */
-    void                          *buf;      /* Partial send/recv data */
+    void                          *buf;      /* Partial send data */
     size_t                        length;    /* How much data in the buffer */
-    size_t                        offset;    /* Next offset to send/recv */
+    size_t                        offset;    /* Next offset to send */
+    struct iovec                  iov[UCT_TCP_MAX_IOV]; /* Zcopy send vector */
+    size_t                        iov_cnt;   /* Number of entries in iov, 0 if
+                                                the data is in the buffer */
+    size_t                        iov_index; /* Next iov entry to send */
+    uct_completion_t              *comp;     /* Zcopy send completion */
+    ucs_queue_head_t              get_q;     /* Gets waiting for response, kept
+                                                by the first connection */
+    ucs_queue_head_t              get_resp_q; /* Get responses to send */
+    struct {
+        ucs_queue_head_t          queue;     /* Operations waiting for the kernel
+                                                to release their data */
+        uct_tcp_zcopy_op_t        *op;       /* Operation of the message being
+                                                sent with MSG_ZEROCOPY, or NULL */
+        uint32_t                  sn;        /* Number of MSG_ZEROCOPY sends */
+    } zcopy;
+    struct {
+        uct_tcp_rx_desc_t         *desc;     /* Receive descriptor, or NULL */
+        void                      *buf;      /* Receive buffer in the descriptor */
+        size_t                    length;    /* How much data in the buffer */
+        size_t                    offset;    /* Next message to parse */
+        struct {
+            void                  *buffer;   /* Receive put/get data here */
+            size_t                buf_length; /* How much space is left in
+                                                 the buffer */
+            size_t                length;    /* How much data is left */
+            uct_tcp_get_op_t      *op;       /* Get operation to complete */
+            size_t                iov_index; /* Next buffer of the get */
+        } rma;
+        uct_tcp_rx_group_t        *group;    /* Reorder group, or NULL */
+        ucs_list_link_t           group_list; /* Element in the group */
+    } rx;
+    struct {
+        struct uct_tcp_ep         *lead;     /* Endpoint which owns the connection */
+        struct uct_tcp_ep         **conns;   /* Connections to send on */
+        unsigned                  count;     /* Number of connections */
+        unsigned                  next;      /* Next connection to try */
+        uint32_t                  sn;        /* Sequence number of next message */
+    } tx;
+    struct {
+        uct_tcp_shm_ctl_t         *ctl;      /* Shared buffer mapping, or NULL */
+        void                      *data;     /* Data ring in the shared buffer */
+        size_t                    size;      /* Data ring size */
+        uint64_t                  head;      /* Position of next data to send */
+    } shm;
+    uct_worker_cb_id_t            slow_prog_id; /* Reports a failure to the user */
+    ucs_status_t                  fail_status; /* Failure to report */
+    ucs_list_link_t               active_list; /* Element in the active list */
+    ucs_list_link_t               coalesce_list; /* Element in the list of
+                                                    endpoints with coalesced
+                                                    messages */
     ucs_list_link_t               list;
 } uct_tcp_ep_t;
 
@@ -48,26 +325,77 @@ typedef struct uct_tcp_iface {
     uct_base_iface_t              super;             /* Parent class */
     int                           listen_fd;         /* Server socket */
     ucs_list_link_t               ep_list;           /* List of endpoints */
+    ucs_list_link_t               rx_groups;         /* Striped remote endpoints */
+    ucs_list_link_t               tx_coalesced;      /* Endpoints with coalesced
+                                                        messages to send */
     char                          if_name[IFNAMSIZ]; /* Network interface name */
     int                           epfd;              /* Event poll set of sockets */
     size_t                        outstanding;       /* How much data in the EP send buffers */
+    ucs_mpool_t                   rx_mpool;          /* Receive descriptors */
+    ucs_mpool_t                   get_mpool;         /* Get operations */
+    ucs_mpool_t                   zcopy_mpool;       /* MSG_ZEROCOPY operations */
+
+    struct {
+        int                       listen_fd;         /* Unix domain socket which
+                                                        receives shared buffers
+                                                        of same-host peers */
+        ucs_list_link_t           fds;               /* Received buffers */
+    } shm;
+
+    struct {
+        ucs_list_link_t           active;            /* Recently active endpoints,
+                                                        most recent first */
+        unsigned                  active_count;      /* Length of the active list */
+        ucs_list_link_t           *next;             /* Next element of an ongoing
+                                                        walk over the active list */
+        unsigned                  direct;            /* Progress calls since the
+                                                        last epoll_wait */
+    } poll;
 
     struct {
         struct sockaddr_in        ifaddr;            /* Network address */
         struct sockaddr_in        netmask;           /* Network address mask */
         size_t                    buf_size;          /* Maximal bcopy size */
         size_t                    short_size;        /* Maximal short size */
+        size_t                    rx_headroom;       /* User receive headroom */
+        size_t                    rx_offset;         /* Data offset in rx descriptor */
+        struct {
+            size_t                max_hdr;           /* Maximal zcopy AM header */
+            size_t                max_iov;           /* Maximal zcopy iov count */
+            size_t                thresh;            /* Minimal zcopy size to send
+                                                        with MSG_ZEROCOPY */
+        } zcopy;
+        struct {
+            size_t                max_short;         /* Maximal put short size */
+            size_t                max_bcopy;         /* Maximal put/get bcopy size */
+            size_t                max_zcopy;         /* Maximal put/get zcopy size */
+        } rma;
         int                       prefer_default;    /* Prefer default gateway */
         unsigned                  max_poll;          /* Number of events to poll per socket*/
+        unsigned                  conns_per_ep;      /* Connections of each endpoint */
+        unsigned                  direct_poll;       /* Progress calls to skip
+                                                        epoll_wait */
+        size_t                    coalesce_size;     /* Send threshold of
+                                                        coalesced messages */
+        size_t                    shm_size;          /* Shared buffer size of a
+                                                        same-host connection */
+        uint64_t                  host_id;           /* Identifies this host */
     } config;
 
     struct {
         int                       nodelay;           /* TCP_NODELAY */
         int                       sndbuf;            /* SO_SNDBUF */
+        int                       busy_poll;         /* SO_BUSY_POLL */
     } sockopt;
 } uct_tcp_iface_t;
 
 
+/* A partial message is completed in place, so the receive buffer must be able
+ * to hold a message which starts right before the end of a full receive */
+#define UCT_TCP_IFACE_RX_BUF_SIZE(_iface) \
+    ((2 * (_iface)->config.buf_size) + sizeof(uct_tcp_am_sn_t))
+
+
 /**
  * TCP interface configuration
  */
@@ -76,14 +404,24 @@ typedef struct uct_tcp_iface_config {
     int                           prefer_default;
     unsigned                      backlog;
     unsigned                      max_poll;
+    unsigned                      conns_per_ep;
+    unsigned                      direct_poll;
     int                           sockopt_nodelay;
     size_t                        sockopt_sndbuf;
+    unsigned                      sockopt_busy_poll;
+    size_t                        zerocopy_thresh;
+    size_t                        coalesce_size;
+    size_t                        shm_size;
+    uct_iface_mpool_config_t      rx_mpool;
 } uct_tcp_iface_config_t;
 
 
 extern uct_md_component_t uct_tcp_md;
 extern const char *uct_tcp_address_type_names[];
 
+ucs_status_t uct_tcp_md_check_access(uct_tcp_md_t *md, uint64_t key_id,
+                                     uint64_t address, size_t length);
+
 ucs_status_t uct_tcp_socket_connect(int fd, const struct sockaddr_in *dest_addr);
 
 ucs_status_t uct_tcp_netif_caps(const char *if_name, double *latency_p,
@@ -96,10 +434,29 @@ ucs_status_t uct_tcp_netif_is_default(const char *if_name, int *result_p);
 
 ucs_status_t uct_tcp_send(int fd, const void *data, size_t *length_p);
 
+ucs_status_t uct_tcp_sendv(int fd, const struct iovec *iov, size_t iov_cnt,
+                           int flags, size_t *length_p);
+
+ucs_status_t uct_tcp_recv_zerocopy_done(int fd, uint32_t *sn_p);
+
 ucs_status_t uct_tcp_recv(int fd, void *data, size_t *length_p);
 
+ucs_status_t uct_tcp_unix_listen(const struct sockaddr_in *inaddr, int *fd_p);
+
+ucs_status_t uct_tcp_unix_send_fd(const struct sockaddr_in *inaddr, uint64_t id,
+                                  int fd);
+
+ucs_status_t uct_tcp_unix_recv_fd(int listen_fd, uint64_t *id_p, int *fd_p);
+
+int uct_tcp_iface_shm_fd_get(uct_tcp_iface_t *iface, uint64_t id);
+
 ucs_status_t uct_tcp_iface_set_sockopt(uct_tcp_iface_t *iface, int fd);
 
+void uct_tcp_iface_ep_inactive(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep);
+
+int uct_tcp_iface_is_same_host(uct_tcp_iface_t *iface,
+                                const uct_device_addr_t *dev_addr);
+
 ucs_status_t uct_tcp_ep_create(uct_tcp_iface_t *iface, int fd,
                                const struct sockaddr_in *dest_addr,
                                uct_tcp_ep_t **ep_p);
@@ -113,6 +470,10 @@ unsigned uct_tcp_ep_progress_tx(uct_tcp_ep_t *ep);
 
 unsigned uct_tcp_ep_progress_rx(uct_tcp_ep_t *ep);
 
+unsigned uct_tcp_ep_progress_zcopy(uct_tcp_ep_t *ep);
+
+void uct_tcp_ep_tx_push(uct_tcp_ep_t *ep);
+
 void uct_tcp_ep_mod_events(uct_tcp_ep_t *ep, uint32_t add, uint32_t remove);
 
 ucs_status_t uct_tcp_ep_am_short(uct_ep_h uct_ep, uint8_t am_id, uint64_t header,
@@ -122,6 +483,30 @@ ssize_t uct_tcp_ep_am_bcopy(uct_ep_h uct_ep, uint8_t am_id,
                             uct_pack_callback_t pack_cb, void *arg,
                             unsigned flags);
 
+ucs_status_t uct_tcp_ep_am_zcopy(uct_ep_h uct_ep, uint8_t am_id,
+                                 const void *header, unsigned header_length,
+                                 const uct_iov_t *iov, size_t iovcnt,
+                                 unsigned flags, uct_completion_t *comp);
+
+ucs_status_t uct_tcp_ep_put_short(uct_ep_h uct_ep, const void *buffer,
+                                  unsigned length, uint64_t remote_addr,
+                                  uct_rkey_t rkey);
+
+ssize_t uct_tcp_ep_put_bcopy(uct_ep_h uct_ep, uct_pack_callback_t pack_cb,
+                             void *arg, uint64_t remote_addr, uct_rkey_t rkey);
+
+ucs_status_t uct_tcp_ep_put_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
+                                  size_t iovcnt, uint64_t remote_addr,
+                                  uct_rkey_t rkey, uct_completion_t *comp);
+
+ucs_status_t uct_tcp_ep_get_bcopy(uct_ep_h uct_ep, uct_unpack_callback_t unpack_cb,
+                                  void *arg, size_t length, uint64_t remote_addr,
+                                  uct_rkey_t rkey, uct_completion_t *comp);
+
+ucs_status_t uct_tcp_ep_get_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
+                                  size_t iovcnt, uint64_t remote_addr,
+                                  uct_rkey_t rkey, uct_completion_t *comp);
+
 ucs_status_t uct_tcp_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *req,
                                     unsigned flags);
 
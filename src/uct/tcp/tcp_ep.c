@@ -5,7 +5,11 @@
 
 #include "tcp.h"
 
+#include <uct/base/uct_worker.h>
 #include <ucs/async/async.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 
 #define UCT_TCP_AM_SHORT_PACK_DATA(_pack_f, _target_buf, _target_length, \
@@ -21,17 +25,21 @@
                                    _am_arg, ...) \
     _target_length = _pack_f(_target_buf, _am_arg)
 
-#define UCT_TCP_AM_PREPARE(_ep, _id, _len_thr, _hdr, \
-                           _pack_f, _am_payload, _payload_length, \
-                           _am_header, _method, _name)	  \
+#define UCT_TCP_AM_CONN_GET(_ep, _conn, _id) \
     do { \
         UCT_CHECK_AM_ID(_id); \
         \
-        if (!uct_tcp_ep_can_send(_ep)) { \
+        (_conn) = uct_tcp_ep_tx_conn(_ep, 1); \
+        if ((_conn) == NULL) { \
             return UCS_ERR_NO_RESOURCE; \
         } \
-        \
-        (_hdr)        = (_ep)->buf; \
+    } while (0)
+
+#define UCT_TCP_AM_PREPARE(_ep, _conn, _id, _len_thr, _hdr, \
+                           _pack_f, _am_payload, _payload_length, \
+                           _am_header, _method, _name)	  \
+    do { \
+        (_hdr)        = uct_tcp_ep_tx_hdr(_conn); \
         (_hdr)->am_id = _id; \
         \
         UCT_TCP_AM_ ## _method ## _PACK_DATA(_pack_f, (_hdr) + 1, (_hdr)->length, \
@@ -60,13 +68,114 @@ static void uct_tcp_ep_epoll_ctl(uct_tcp_ep_t *ep, int op)
     }
 }
 
+/* Messages on the connections of a connection group are preceded by their
+ * sequence number, so the peer can restore their order. Other connections
+ * keep the order by themselves, and send only the header. */
+static inline size_t uct_tcp_ep_tx_sn_size(uct_tcp_ep_t *ep)
+{
+    return (ep->flags & UCT_TCP_EP_FLAG_TX_SN) ? sizeof(uct_tcp_am_sn_t) : 0;
+}
+
+static inline size_t uct_tcp_ep_rx_sn_size(uct_tcp_ep_t *ep)
+{
+    return (ep->rx.group != NULL) ? sizeof(uct_tcp_am_sn_t) : 0;
+}
+
+static inline uct_tcp_am_sn_t *uct_tcp_am_hdr_sn(uct_tcp_am_hdr_t *hdr)
+{
+    return (uct_tcp_am_sn_t*)hdr - 1;
+}
+
+/* Length of the send buffer data up to the end of the message */
+static inline size_t uct_tcp_ep_tx_msg_end(uct_tcp_ep_t *ep,
+                                           const uct_tcp_am_hdr_t *hdr)
+{
+    return (uintptr_t)(hdr + 1) - (uintptr_t)ep->buf + hdr->length;
+}
+
+/* Header of the next message in the send buffer */
+static inline uct_tcp_am_hdr_t *uct_tcp_ep_tx_hdr(uct_tcp_ep_t *ep)
+{
+    return UCS_PTR_BYTE_OFFSET(ep->buf,
+                               ep->length + uct_tcp_ep_tx_sn_size(ep));
+}
+
 static inline int uct_tcp_ep_can_send(uct_tcp_ep_t *ep)
 {
     ucs_assert(ep->offset <= ep->length);
-    /* TODO optimize to allow partial sends/message coalescing */
     return ep->length == 0;
 }
 
+/* An active message may be appended to coalesced messages. Other operations
+ * need the whole buffer, so the coalesced messages are sent first. */
+static inline int uct_tcp_ep_tx_avail(uct_tcp_ep_t *ep, int coalesce)
+{
+    if (ep->flags & UCT_TCP_EP_FLAG_TX_COALESCE) {
+        if (coalesce) {
+            return 1;
+        }
+        uct_tcp_ep_tx_push(ep);
+    }
+
+    return uct_tcp_ep_can_send(ep);
+}
+
+/* Select a connection of the endpoint which is ready to send, in round-robin
+ * order, or return NULL if all connections are busy */
+static inline uct_tcp_ep_t *uct_tcp_ep_tx_conn(uct_tcp_ep_t *ep, int coalesce)
+{
+    unsigned i, index;
+
+    if (ucs_likely(ep->tx.count == 1)) {
+        return uct_tcp_ep_tx_avail(ep, coalesce) ? ep : NULL;
+    }
+
+    for (i = 0, index = ep->tx.next; i < ep->tx.count; ++i) {
+        if (uct_tcp_ep_tx_avail(ep->tx.conns[index], coalesce)) {
+            ep->tx.next = (index + 1) % ep->tx.count;
+            return ep->tx.conns[index];
+        }
+        index = (index + 1) % ep->tx.count;
+    }
+
+    return NULL;
+}
+
+static inline int uct_tcp_ep_tx_ready(uct_tcp_ep_t *ep)
+{
+    unsigned i;
+
+    for (i = 0; i < ep->tx.count; ++i) {
+        if (uct_tcp_ep_can_send(ep->tx.conns[i]) ||
+            (ep->tx.conns[i]->flags & UCT_TCP_EP_FLAG_TX_COALESCE)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static inline int uct_tcp_ep_tx_idle(uct_tcp_ep_t *ep)
+{
+    unsigned i;
+
+    for (i = 0; i < ep->tx.count; ++i) {
+        if (!uct_tcp_ep_can_send(ep->tx.conns[i])) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static inline void uct_tcp_ep_tx_uncoalesce(uct_tcp_ep_t *ep)
+{
+    if (ep->flags & UCT_TCP_EP_FLAG_TX_COALESCE) {
+        ucs_list_del(&ep->coalesce_list);
+        ep->flags &= ~UCT_TCP_EP_FLAG_TX_COALESCE;
+    }
+}
+
 static UCS_CLASS_INIT_FUNC(uct_tcp_ep_t, uct_tcp_iface_t *iface,
                            int fd, const struct sockaddr_in *dest_addr)
 {
@@ -74,16 +183,51 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_ep_t, uct_tcp_iface_t *iface,
 
     UCS_CLASS_CALL_SUPER_INIT(uct_base_ep_t, &iface->super)
 
+    /* Coalesced messages are sent when they reach the threshold, so the buffer
+     * has room for one more message after them */
     self->buf = ucs_malloc(ucs_max(iface->config.buf_size,
-                                   iface->config.short_size), "tcp_buf");
+                                   iface->config.short_size) +
+                           iface->config.coalesce_size +
+                           sizeof(uct_tcp_am_sn_t), "tcp_buf");
     if (self->buf == NULL) {
         return UCS_ERR_NO_MEMORY;
     }
 
-    self->events = 0;
-    self->offset = 0;
-    self->length = 0;
+    self->events    = 0;
+    self->flags     = 0;
+    self->offset    = 0;
+    self->length    = 0;
+    self->iov_cnt   = 0;
+    self->iov_index = 0;
+    self->comp      = NULL;
+    self->rx.desc   = NULL;
+    self->rx.buf    = NULL;
+    self->rx.length = 0;
+    self->rx.offset = 0;
+    self->rx.rma.buffer     = NULL;
+    self->rx.rma.buf_length = 0;
+    self->rx.rma.length     = 0;
+    self->rx.rma.op         = NULL;
+    self->rx.rma.iov_index  = 0;
+    self->rx.group      = NULL;
+    self->slow_prog_id  = UCS_CALLBACKQ_ID_NULL;
+    self->fail_status   = UCS_OK;
+    /* Until more connections are added, the endpoint sends on its own */
+    self->tx.lead       = self;
+    self->tx.conns      = &self->tx.lead;
+    self->tx.count      = 1;
+    self->tx.next       = 0;
+    self->tx.sn         = 0;
     ucs_queue_head_init(&self->pending_q);
+    ucs_queue_head_init(&self->get_q);
+    ucs_queue_head_init(&self->get_resp_q);
+    ucs_queue_head_init(&self->zcopy.queue);
+    self->zcopy.op      = NULL;
+    self->zcopy.sn      = 0;
+    self->shm.ctl       = NULL;
+    self->shm.data      = NULL;
+    self->shm.size      = 0;
+    self->shm.head      = 0;
 
     if (fd == -1) {
         status = ucs_tcpip_socket_create(&self->fd);
@@ -123,17 +267,77 @@ err:
     return status;
 }
 
+static void uct_tcp_ep_get_q_purge(ucs_queue_head_t *queue)
+{
+    uct_tcp_get_op_t *op;
+
+    ucs_queue_for_each_extract(op, queue, queue, 1) {
+        ucs_mpool_put(op);
+    }
+}
+
+static void uct_tcp_ep_zcopy_q_purge(ucs_queue_head_t *queue)
+{
+    uct_tcp_zcopy_op_t *op;
+
+    ucs_queue_for_each_extract(op, queue, queue, 1) {
+        ucs_mpool_put(op);
+    }
+}
+
+static void uct_tcp_ep_rx_group_leave(uct_tcp_ep_t *ep)
+{
+    uct_tcp_rx_group_t *group = ep->rx.group;
+
+    if (group == NULL) {
+        return;
+    }
+
+    ucs_list_del(&ep->rx.group_list);
+    if (ucs_list_is_empty(&group->conns)) {
+        ucs_list_del(&group->list);
+        ucs_free(group);
+    }
+}
+
 static UCS_CLASS_CLEANUP_FUNC(uct_tcp_ep_t)
 {
     uct_tcp_iface_t *iface = ucs_derived_of(self->super.super.iface,
                                             uct_tcp_iface_t);
+    unsigned i;
 
     ucs_debug("tcp_ep %p: destroying", self);
 
+    for (i = 1; i < self->tx.count; ++i) {
+        uct_tcp_ep_destroy(&self->tx.conns[i]->super.super);
+    }
+    if (self->tx.conns != &self->tx.lead) {
+        ucs_free(self->tx.conns);
+    }
+
+    uct_tcp_ep_rx_group_leave(self);
+    uct_tcp_iface_ep_inactive(iface, self);
+    uct_tcp_ep_tx_uncoalesce(self);
+
     UCS_ASYNC_BLOCK(iface->super.worker->async);
     ucs_list_del(&self->list);
     UCS_ASYNC_UNBLOCK(iface->super.worker->async);
 
+    uct_worker_progress_unregister_safe(&iface->super.worker->super,
+                                        &self->slow_prog_id);
+
+    if (self->rx.desc != NULL) {
+        ucs_mpool_put(self->rx.desc);
+    }
+
+    uct_tcp_ep_get_q_purge(&self->get_q);
+    uct_tcp_ep_get_q_purge(&self->get_resp_q);
+    uct_tcp_ep_zcopy_q_purge(&self->zcopy.queue);
+
+    if (self->shm.ctl != NULL) {
+        munmap(self->shm.ctl, UCS_SYS_CACHE_LINE_SIZE + self->shm.size);
+    }
+
     ucs_free(self->buf);
     close(self->fd);
 }
@@ -145,34 +349,209 @@ UCS_CLASS_DEFINE_NAMED_NEW_FUNC(uct_tcp_ep_create, uct_tcp_ep_t, uct_tcp_ep_t,
                                 const struct sockaddr_in*)
 UCS_CLASS_DEFINE_NAMED_DELETE_FUNC(uct_tcp_ep_destroy, uct_tcp_ep_t, uct_ep_t)
 
+static inline void uct_tcp_ep_tx_post(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                                      const uct_tcp_am_hdr_t *hdr);
+
+static inline int uct_tcp_ep_shm_map(uct_tcp_ep_t *ep, int fd, size_t size)
+{
+    void *ptr;
+
+    ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+        ucs_error("tcp_ep %p: mmap(fd=%d, length=%zu) failed: %m", ep, fd,
+                  size);
+        return 0;
+    }
+
+    ep->shm.ctl  = ptr;
+    ep->shm.data = UCS_PTR_BYTE_OFFSET(ptr, UCS_SYS_CACHE_LINE_SIZE);
+    ep->shm.size = size - UCS_SYS_CACHE_LINE_SIZE;
+    return 1;
+}
+
+/* Create a shared buffer for the connection to a peer on the same host, and
+ * pass it to the peer. The data is sent through the buffer after the peer
+ * acknowledges that it has attached it. */
+static void uct_tcp_ep_shm_connect(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                                   const struct sockaddr_in *dest_addr)
+{
+    size_t size = UCS_SYS_CACHE_LINE_SIZE + iface->config.shm_size;
+    uct_tcp_shm_attach_hdr_t *attach_hdr;
+    uct_tcp_am_hdr_t *hdr;
+    ucs_status_t status;
+    uint64_t id;
+    int fd;
+
+#ifdef SYS_memfd_create
+    fd = syscall(SYS_memfd_create, "ucx_tcp_shm", MFD_CLOEXEC);
+#else
+    fd    = -1;
+    errno = ENOSYS;
+#endif
+    if (fd < 0) {
+        ucs_debug("tcp_ep %p: memfd_create() failed: %m", ep);
+        return;
+    }
+
+    if (ftruncate(fd, size) < 0) {
+        ucs_error("tcp_ep %p: ftruncate(fd=%d, length=%zu) failed: %m", ep, fd,
+                  size);
+        goto out_close;
+    }
+
+    if (!uct_tcp_ep_shm_map(ep, fd, size)) {
+        goto out_close;
+    }
+
+    id     = ucs_generate_uuid((uintptr_t)ep);
+    status = uct_tcp_unix_send_fd(dest_addr, id, fd);
+    if (status != UCS_OK) {
+        ucs_debug("tcp_ep %p: peer did not accept the shared buffer", ep);
+        munmap(ep->shm.ctl, size);
+        ep->shm.ctl  = NULL;
+        ep->shm.data = NULL;
+        ep->shm.size = 0;
+        goto out_close;
+    }
+
+    /* This is the first message on the connection, so it is not numbered */
+    hdr            = ep->buf;
+    hdr->am_id     = UCT_TCP_AM_SHM_ATTACH;
+    hdr->length    = sizeof(*attach_hdr);
+    attach_hdr     = (uct_tcp_shm_attach_hdr_t*)(hdr + 1);
+    attach_hdr->id = id;
+    uct_tcp_ep_tx_post(iface, ep, hdr);
+
+    ucs_debug("tcp_ep %p: passed shared buffer 0x%"PRIx64" of %zu bytes", ep,
+              id, ep->shm.size);
+
+out_close:
+    close(fd);
+}
+
+static ucs_status_t uct_tcp_ep_connect(uct_tcp_iface_t *iface,
+                                       const struct sockaddr_in *dest_addr,
+                                       int same_host, uct_tcp_ep_t **ep_p)
+{
+    uct_tcp_ep_t *ep = NULL;
+    ucs_status_t status;
+
+    status = uct_tcp_ep_create(iface, -1, dest_addr, &ep);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    if (same_host && (iface->config.shm_size > 0)) {
+        uct_tcp_ep_shm_connect(iface, ep, dest_addr);
+    }
+
+    ep->flags |= UCT_TCP_EP_FLAG_CONNECTED;
+    /* Get responses arrive on the same connection, and reading it also
+     * detects when the peer goes away */
+    uct_tcp_ep_mod_events(ep, EPOLLIN, 0);
+    ucs_debug("tcp_ep %p: connected to %s:%d", ep,
+              inet_ntoa(dest_addr->sin_addr), ntohs(dest_addr->sin_port));
+    *ep_p = ep;
+    return UCS_OK;
+}
+
+/* Open the additional connections of a striped endpoint, and tell the peer
+ * on each one of them which endpoint it belongs to */
+static ucs_status_t uct_tcp_ep_conns_init(uct_tcp_iface_t *iface,
+                                          uct_tcp_ep_t *ep,
+                                          const struct sockaddr_in *dest_addr,
+                                          int same_host)
+{
+    uct_tcp_conn_group_hdr_t *group_hdr;
+    uct_tcp_am_hdr_t *hdr;
+    ucs_status_t status;
+    uct_tcp_ep_t *conn;
+    uint64_t id;
+    unsigned i;
+
+    ep->tx.conns = ucs_calloc(iface->config.conns_per_ep,
+                              sizeof(*ep->tx.conns), "tcp_ep_conns");
+    if (ep->tx.conns == NULL) {
+        ep->tx.conns = &ep->tx.lead;
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    ep->tx.conns[0] = ep;
+    while (ep->tx.count < iface->config.conns_per_ep) {
+        status = uct_tcp_ep_connect(iface, dest_addr, same_host, &conn);
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        conn->tx.lead                = ep;
+        conn->tx.conns               = NULL;
+        conn->tx.count               = 0;
+        ep->tx.conns[ep->tx.count++] = conn;
+    }
+
+    id = ucs_generate_uuid((uintptr_t)ep);
+    for (i = 0; i < ep->tx.count; ++i) {
+        conn          = ep->tx.conns[i];
+        ucs_assert(uct_tcp_ep_can_send(conn));
+        hdr           = conn->buf;
+        hdr->am_id    = UCT_TCP_AM_CONN_GROUP;
+        hdr->length   = sizeof(*group_hdr);
+        group_hdr     = (uct_tcp_conn_group_hdr_t*)(hdr + 1);
+        group_hdr->id = id;
+        uct_tcp_ep_tx_post(iface, conn, hdr);
+        conn->flags  |= UCT_TCP_EP_FLAG_TX_SN;
+    }
+
+    ucs_debug("tcp_ep %p: using %u connections, id 0x%"PRIx64, ep,
+              ep->tx.count, id);
+    return UCS_OK;
+}
+
 ucs_status_t uct_tcp_ep_create_connected(const uct_ep_params_t *params,
                                          uct_ep_h *ep_p)
 {
     uct_tcp_iface_t *iface = ucs_derived_of(params->iface, uct_tcp_iface_t);
-    uct_tcp_ep_t *tcp_ep = NULL;
+    uct_tcp_ep_t *tcp_ep;
     struct sockaddr_in dest_addr;
     ucs_status_t status;
+    int same_host;
 
     UCT_EP_PARAMS_CHECK_DEV_IFACE_ADDRS(params);
     memset(&dest_addr, 0, sizeof(dest_addr));
     dest_addr.sin_family = AF_INET;
     dest_addr.sin_port   = *(in_port_t*)params->iface_addr;
-    dest_addr.sin_addr   = *(struct in_addr*)params->dev_addr;
+    dest_addr.sin_addr   = ((uct_tcp_device_addr_t*)params->dev_addr)->in_addr;
+    same_host            = uct_tcp_iface_is_same_host(iface, params->dev_addr);
 
     /* TODO try to reuse existing connection */
-    status = uct_tcp_ep_create(iface, -1, &dest_addr, &tcp_ep);
-    if (status == UCS_OK) {
-        ucs_debug("tcp_ep %p: connected to %s:%d", tcp_ep,
-                  inet_ntoa(dest_addr.sin_addr), ntohs(dest_addr.sin_port));
-        *ep_p = &tcp_ep->super.super;
+    status = uct_tcp_ep_connect(iface, &dest_addr, same_host, &tcp_ep);
+    if (status != UCS_OK) {
+        return status;
     }
-    return status;
+
+    if (iface->config.conns_per_ep > 1) {
+        status = uct_tcp_ep_conns_init(iface, tcp_ep, &dest_addr, same_host);
+        if (status != UCS_OK) {
+            uct_tcp_ep_destroy(&tcp_ep->super.super);
+            return status;
+        }
+    }
+
+    *ep_p = &tcp_ep->super.super;
+    return UCS_OK;
 }
 
 void uct_tcp_ep_mod_events(uct_tcp_ep_t *ep, uint32_t add, uint32_t remove)
 {
     int old_events = ep->events;
-    int new_events = (ep->events | add) & ~remove;
+    int new_events;
+
+    if (ep->flags & UCT_TCP_EP_FLAG_FAILED) {
+        /* No more events are expected on a failed connection */
+        add = 0;
+    }
+
+    new_events = (ep->events | add) & ~remove;
 
     if (new_events != ep->events) {
         ep->events = new_events;
@@ -189,17 +568,158 @@ void uct_tcp_ep_mod_events(uct_tcp_ep_t *ep, uint32_t add, uint32_t remove)
     }
 }
 
+static void uct_tcp_ep_conn_abort(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                                  ucs_status_t status)
+{
+    uct_tcp_zcopy_op_t *op;
+    uct_completion_t *comp;
+
+    /* Unsent data will never leave the send buffer */
+    uct_tcp_ep_tx_uncoalesce(ep);
+    iface->outstanding -= ep->length - ep->offset;
+    ep->offset          = 0;
+    ep->length          = 0;
+
+    /* Operations which were started will never complete */
+    if (ep->comp != NULL) {
+        comp     = ep->comp;
+        ep->comp = NULL;
+        uct_invoke_completion(comp, status);
+    }
+
+    ep->zcopy.op = NULL;
+    ucs_queue_for_each_extract(op, &ep->zcopy.queue, queue, 1) {
+        if (op->comp != NULL) {
+            uct_invoke_completion(op->comp, status);
+        }
+        ucs_mpool_put(op);
+    }
+
+    ep->rx.rma.op = NULL;
+}
+
+static unsigned uct_tcp_ep_failed_progress(void *arg)
+{
+    uct_tcp_ep_t *ep       = arg;
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+    ucs_status_t status    = ep->fail_status;
+    uct_tcp_get_op_t *op;
+    unsigned i;
+
+    ucs_trace_func("ep=%p", ep);
+    ep->slow_prog_id = UCS_CALLBACKQ_ID_NULL;
+
+    for (i = 0; i < ep->tx.count; ++i) {
+        uct_tcp_ep_conn_abort(iface, ep->tx.conns[i], status);
+    }
+
+    ucs_queue_for_each(op, &ep->get_q, queue) {
+        if (op->comp != NULL) {
+            uct_invoke_completion(op->comp, status);
+        }
+    }
+
+    uct_set_ep_failed(&UCS_CLASS_NAME(uct_tcp_ep_t), &ep->super.super,
+                      &iface->super.super, status);
+    return 1;
+}
+
+/*
+ * The error handling flow destroys the endpoint, so it is invoked from the
+ * progress context rather than from the failed operation. A failure of any
+ * connection of a striped endpoint fails all of them.
+ */
+static void uct_tcp_ep_set_failed(uct_tcp_ep_t *conn, ucs_status_t status)
+{
+    uct_tcp_ep_t *ep       = conn->tx.lead;
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+    unsigned i;
+
+    if (ep->flags & UCT_TCP_EP_FLAG_FAILED) {
+        return;
+    }
+
+    ucs_debug("tcp_ep %p: connection on fd %d failed: %s", ep, conn->fd,
+              ucs_status_string(status));
+    ep->fail_status = status;
+    for (i = 0; i < ep->tx.count; ++i) {
+        conn = ep->tx.conns[i];
+        uct_tcp_ep_mod_events(conn, 0, conn->events);
+        conn->flags |= UCT_TCP_EP_FLAG_FAILED;
+    }
+
+    uct_worker_progress_register_safe(&iface->super.worker->super,
+                                      uct_tcp_ep_failed_progress, ep,
+                                      UCS_CALLBACKQ_FLAG_ONESHOT,
+                                      &ep->slow_prog_id);
+}
+
+static void uct_tcp_ep_iov_advance(uct_tcp_ep_t *ep, size_t length)
+{
+    struct iovec *iov;
+
+    while (length > 0) {
+        ucs_assert(ep->iov_index < ep->iov_cnt);
+        iov = &ep->iov[ep->iov_index];
+        if (length < iov->iov_len) {
+            iov->iov_base = UCS_PTR_BYTE_OFFSET(iov->iov_base, length);
+            iov->iov_len -= length;
+            return;
+        }
+
+        length -= iov->iov_len;
+        ++ep->iov_index;
+    }
+}
+
+/*
+ * With MSG_ZEROCOPY the kernel keeps referencing the data pages after sendmsg()
+ * returns. The first entry is in the endpoint buffer, which is reused by the
+ * next message, so it is copied to the socket by a separate call.
+ */
+static ucs_status_t uct_tcp_ep_sendv(uct_tcp_ep_t *ep, size_t *length_p)
+{
+    ucs_status_t status;
+
+    if (ep->zcopy.op == NULL) {
+        return uct_tcp_sendv(ep->fd, ep->iov + ep->iov_index,
+                             ep->iov_cnt - ep->iov_index, 0, length_p);
+    } else if (ep->iov_index == 0) {
+        *length_p = ep->iov[0].iov_len;
+        return uct_tcp_sendv(ep->fd, ep->iov, 1, MSG_MORE, length_p);
+    }
+
+    status = uct_tcp_sendv(ep->fd, ep->iov + ep->iov_index,
+                           ep->iov_cnt - ep->iov_index, MSG_ZEROCOPY,
+                           length_p);
+    if ((status == UCS_OK) && (*length_p > 0)) {
+        /* The kernel numbers the sends which returned some data */
+        ++ep->zcopy.sn;
+    }
+
+    return status;
+}
+
 static unsigned uct_tcp_ep_send(uct_tcp_ep_t *ep)
 {
     uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface, uct_tcp_iface_t);
+    size_t iov_index       = ep->iov_index;
+    uct_completion_t *comp;
     size_t send_length;
     ucs_status_t status;
 
     send_length = ep->length - ep->offset;
     ucs_assert(send_length > 0);
 
-    status = uct_tcp_send(ep->fd, ep->buf + ep->offset, &send_length);
+    if (ep->iov_cnt > 0) {
+        status = uct_tcp_ep_sendv(ep, &send_length);
+    } else {
+        status = uct_tcp_send(ep->fd, ep->buf + ep->offset, &send_length);
+    }
     if (status < 0) {
+        uct_tcp_ep_set_failed(ep, UCS_ERR_ENDPOINT_TIMEOUT);
         return 0;
     }
 
@@ -207,148 +727,1411 @@ static unsigned uct_tcp_ep_send(uct_tcp_ep_t *ep)
 
     iface->outstanding -= send_length;
     ep->offset         += send_length;
-    if (ep->offset == ep->length) {
-        ep->offset = 0;
-        ep->length = 0;
+    if (ep->offset < ep->length) {
+        if (ep->iov_cnt > 0) {
+            uct_tcp_ep_iov_advance(ep, send_length);
+            if ((ep->zcopy.op != NULL) && (iov_index == 0) &&
+                (ep->iov_index > 0)) {
+                /* The copied header is sent, continue with the user data */
+                return uct_tcp_ep_send(ep);
+            }
+        }
+        return send_length > 0;
+    }
+
+    ep->offset    = 0;
+    ep->length    = 0;
+    ep->iov_cnt   = 0;
+    ep->iov_index = 0;
+
+    if (ep->zcopy.op != NULL) {
+        /* The user data is released when the kernel completes the last send */
+        ep->zcopy.op->sn = ep->zcopy.sn - 1;
+        ep->zcopy.op     = NULL;
+    } else if (ep->comp != NULL) {
+        /* The kernel has taken all user data, so zcopy buffers may be reused */
+        comp     = ep->comp;
+        ep->comp = NULL;
+        uct_invoke_completion(comp, UCS_OK);
     }
 
-    return send_length > 0;
+    return 1;
 }
 
+static void uct_tcp_ep_get_resp_send(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                                     void *buffer, size_t length);
+
 unsigned uct_tcp_ep_progress_tx(uct_tcp_ep_t *ep)
 {
+    uct_tcp_iface_t              *iface = ucs_derived_of(ep->super.super.iface,
+                                                         uct_tcp_iface_t);
     unsigned                     count = 0;
     uct_pending_req_priv_queue_t *priv;
+    uct_tcp_get_op_t             *op;
 
     ucs_trace_func("ep=%p", ep);
 
     if (ep->length > 0) {
+        uct_tcp_ep_tx_uncoalesce(ep);
         count += uct_tcp_ep_send(ep);
     }
 
-    uct_pending_queue_dispatch(priv, &ep->pending_q, uct_tcp_ep_can_send(ep));
+    /* Get responses are sent before user operations, since the peer may be
+     * waiting for them */
+    while (uct_tcp_ep_can_send(ep) && !ucs_queue_is_empty(&ep->get_resp_q)) {
+        op = ucs_queue_pull_elem_non_empty(&ep->get_resp_q, uct_tcp_get_op_t,
+                                           queue);
+        uct_tcp_ep_get_resp_send(iface, ep, op->iov[0].iov_base,
+                                 op->length);
+        ucs_mpool_put(op);
+        ++count;
+    }
+
+    /* Pending operations of a striped endpoint may use any connection */
+    uct_pending_queue_dispatch(priv, &ep->tx.lead->pending_q,
+                               uct_tcp_ep_tx_ready(ep->tx.lead));
 
     if (uct_tcp_ep_can_send(ep)) {
-        ucs_assert(ucs_queue_is_empty(&ep->pending_q));
+        ucs_assert(ucs_queue_is_empty(&ep->tx.lead->pending_q));
         uct_tcp_ep_mod_events(ep, 0, EPOLLOUT);
     }
 
     return count;
 }
 
-unsigned uct_tcp_ep_progress_rx(uct_tcp_ep_t *ep)
+/* Header of the next received message */
+static inline uct_tcp_am_hdr_t *uct_tcp_ep_rx_hdr(uct_tcp_ep_t *ep)
 {
-    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
-                                            uct_tcp_iface_t);
-    uct_tcp_am_hdr_t *hdr;
-    ucs_status_t status;
-    size_t recv_length;
-    ssize_t remainder;
-
-    ucs_trace_func("ep=%p", ep);
+    return UCS_PTR_BYTE_OFFSET(ep->rx.buf,
+                               ep->rx.offset + uct_tcp_ep_rx_sn_size(ep));
+}
 
-    /* Receive next chunk of data */
-    recv_length = iface->config.buf_size - ep->length;
-    ucs_assertv(recv_length > 0, "ep=%p", ep);
+static size_t uct_tcp_ep_rx_length(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep)
+{
+    size_t remainder = ep->rx.length - ep->rx.offset;
+    size_t hdr_end   = uct_tcp_ep_rx_sn_size(ep) + sizeof(uct_tcp_am_hdr_t);
+    uct_tcp_am_hdr_t *hdr;
 
-    status = uct_tcp_recv(ep->fd, ep->buf + ep->length, &recv_length);
-    if (status != UCS_OK) {
-        if (status == UCS_ERR_CANCELED) {
-            ucs_debug("tcp_ep %p: remote disconnected", ep);
-            uct_tcp_ep_mod_events(ep, 0, EPOLLIN);
-            uct_tcp_ep_destroy(&ep->super.super);
-        }
-        return 0;
+    if (remainder == 0) {
+        /* Start a new batch of messages from the beginning of the buffer */
+        ucs_assert(ep->rx.length == 0);
+        return iface->config.buf_size;
+    } else if (remainder < hdr_end) {
+        return hdr_end - remainder;
     }
 
-    ep->length += recv_length;
-    ucs_trace_data("tcp_ep %p: recvd %zu bytes", ep, recv_length);
-
-    /* Parse received active messages */
-    while ((remainder = ep->length - ep->offset) >= sizeof(*hdr)) {
-        hdr = ep->buf + ep->offset;
-        ucs_assert(hdr->length <= (iface->config.buf_size - sizeof(uct_tcp_am_hdr_t)));
+    /* Receive only the rest of the partial message. It started within the
+     * first half of the buffer, so it can be completed in place, unless it is
+     * put or get data which is received directly to the destination. */
+    hdr = uct_tcp_ep_rx_hdr(ep);
+    ucs_assert(ep->rx.offset < iface->config.buf_size);
+    return ucs_min(hdr_end + hdr->length - remainder,
+                   UCT_TCP_IFACE_RX_BUF_SIZE(iface) - ep->rx.length);
+}
 
-        if (remainder < sizeof(*hdr) + hdr->length) {
-            break;
-        }
+static inline int uct_tcp_ep_rx_hdr_only(uct_tcp_ep_t *ep)
+{
+    size_t hdr_end = uct_tcp_ep_rx_sn_size(ep) + sizeof(uct_tcp_am_hdr_t);
 
-        /* Full message was received */
-        ep->offset += sizeof(*hdr) + hdr->length;
+    return ((ep->rx.length - ep->rx.offset) == hdr_end) &&
+           (uct_tcp_ep_rx_hdr(ep)->length > 0);
+}
 
-        if (hdr->am_id >= UCT_AM_ID_MAX) {
-            ucs_error("invalid am id: %d", hdr->am_id);
-            continue;
-        }
+static void uct_tcp_ep_rx_disconnected(uct_tcp_ep_t *ep, ucs_status_t status)
+{
+    ucs_debug("tcp_ep %p: remote disconnected", ep);
 
-        uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_RECV, hdr->am_id,
-                           hdr + 1, hdr->length, "RECV fd %d", ep->fd);
-        uct_iface_invoke_am(&iface->super, hdr->am_id, hdr + 1,
-                            hdr->length, 0);
+    /* Endpoints created by the user are destroyed only by the user, and
+     * accepted connections are closed by the peer only when its interface
+     * goes away */
+    if (ep->flags & UCT_TCP_EP_FLAG_CONNECTED) {
+        uct_tcp_ep_set_failed(ep, status);
+    } else {
+        uct_tcp_ep_mod_events(ep, 0, EPOLLIN);
+        uct_tcp_ep_destroy(&ep->super.super);
     }
-
-    /* Move the remaining data to the beginning of the buffer
-     * TODO avoid extra copy on partial receive
-     */
-    ucs_assert(remainder >= 0);
-    memmove(ep->buf, ep->buf + ep->offset, remainder);
-    ep->offset = 0;
-    ep->length = remainder;
-
-    return recv_length > 0;
 }
 
-
-static inline void uct_tcp_ep_am_send(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
-                                      const uct_tcp_am_hdr_t *hdr)
+static void uct_tcp_ep_get_op_complete(uct_tcp_get_op_t *op)
 {
-    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, hdr->am_id,
-                       hdr + 1, hdr->length, "SEND fd %d", ep->fd);
-
-    ep->length         = sizeof(*hdr) + hdr->length;
-    iface->outstanding += ep->length;
-
-    uct_tcp_ep_send(ep);
-    if (ep->length > 0) {
-        uct_tcp_ep_mod_events(ep, EPOLLOUT, 0);
+    if (op->comp != NULL) {
+        uct_invoke_completion(op->comp, UCS_OK);
     }
+    ucs_mpool_put(op);
 }
 
-ucs_status_t uct_tcp_ep_am_short(uct_ep_h uct_ep, uint8_t am_id, uint64_t header,
-                                 const void *payload, unsigned length)
+/* Remote peers may access only the memory registered on this side, so a
+ * request to access other memory means the peer is faulty */
+static ucs_status_t uct_tcp_ep_rx_check_access(uct_tcp_iface_t *iface,
+                                               uct_tcp_ep_t *ep,
+                                               uint64_t key_id,
+                                               uint64_t address, size_t length)
 {
-    uct_tcp_ep_t *ep       = ucs_derived_of(uct_ep, uct_tcp_ep_t);
-    uct_tcp_iface_t *iface = ucs_derived_of(uct_ep->iface, uct_tcp_iface_t);
-    uct_tcp_am_hdr_t *hdr;
+    uct_tcp_md_t *md = ucs_derived_of(iface->super.md, uct_tcp_md_t);
+    ucs_status_t status;
 
-    UCT_TCP_AM_PREPARE(ep, am_id, iface->config.short_size - sizeof(*hdr),
-                       hdr, memcpy, payload, length, header, SHORT, "am_short");
+    status = uct_tcp_md_check_access(md, key_id, address, length);
+    if (status != UCS_OK) {
+        ucs_error("tcp_ep %p: remote access to 0x%"PRIx64" length %zu is out "
+                  "of registered region %"PRIu64, ep, address, length, key_id);
+    }
 
-    uct_tcp_ep_am_send(iface, ep, hdr);
-    return UCS_OK;
+    return status;
 }
 
-ssize_t uct_tcp_ep_am_bcopy(uct_ep_h uct_ep, uint8_t am_id,
-                            uct_pack_callback_t pack_cb, void *arg,
+static ucs_status_t uct_tcp_ep_rx_put(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                                      uct_tcp_put_hdr_t *put_hdr, size_t length)
+{
+    ucs_status_t status;
+
+    status = uct_tcp_ep_rx_check_access(iface, ep, put_hdr->key_id,
+                                        put_hdr->address, length);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    memcpy((void*)(uintptr_t)put_hdr->address, put_hdr + 1, length);
+    return UCS_OK;
+}
+
+static ucs_status_t uct_tcp_ep_rx_get_req(uct_tcp_iface_t *iface,
+                                          uct_tcp_ep_t *ep,
+                                          uct_tcp_am_hdr_t *hdr)
+{
+    uct_tcp_get_req_hdr_t *get_req = (uct_tcp_get_req_hdr_t*)(hdr + 1);
+    uct_tcp_get_op_t *op;
+    ucs_status_t status;
+
+    status = uct_tcp_ep_rx_check_access(iface, ep, get_req->key_id,
+                                        get_req->address, get_req->length);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    if (ep->rx.group != NULL) {
+        /* Responses to a striped endpoint go over a single connection, so
+         * they arrive in the order of the requests */
+        ep = ucs_list_head(&ep->rx.group->conns, uct_tcp_ep_t, rx.group_list);
+    }
+
+    if (uct_tcp_ep_can_send(ep) && ucs_queue_is_empty(&ep->get_resp_q)) {
+        uct_tcp_ep_get_resp_send(iface, ep, (void*)(uintptr_t)get_req->address,
+                                 get_req->length);
+        return UCS_OK;
+    }
+
+    /* The response is sent when the endpoint is ready */
+    op = ucs_mpool_get_inline(&iface->get_mpool);
+    if (op == NULL) {
+        ucs_error("tcp_ep %p: failed to allocate get response", ep);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    op->iov[0].iov_base = (void*)(uintptr_t)get_req->address;
+    op->iov[0].iov_len  = get_req->length;
+    op->iov_cnt         = 1;
+    op->length          = get_req->length;
+    op->unpack_cb       = NULL;
+    op->comp            = NULL;
+    ucs_queue_push(&ep->get_resp_q, &op->queue);
+    return UCS_OK;
+}
+
+/* Move the receive position of put or get data, and continue with the next
+ * buffer of the get operation when the current one is full */
+static void uct_tcp_ep_rx_rma_advance(uct_tcp_ep_t *ep, size_t length)
+{
+    const struct iovec *iov;
+
+    ep->rx.rma.buffer      = UCS_PTR_BYTE_OFFSET(ep->rx.rma.buffer, length);
+    ep->rx.rma.buf_length -= length;
+    ep->rx.rma.length     -= length;
+    if ((ep->rx.rma.buf_length > 0) || (ep->rx.rma.length == 0)) {
+        return;
+    }
+
+    ucs_assert(ep->rx.rma.op != NULL);
+    ucs_assert(ep->rx.rma.iov_index < ep->rx.rma.op->iov_cnt);
+    iov                   = &ep->rx.rma.op->iov[ep->rx.rma.iov_index++];
+    ep->rx.rma.buffer     = iov->iov_base;
+    ep->rx.rma.buf_length = iov->iov_len;
+}
+
+static void uct_tcp_ep_rx_rma_copy(uct_tcp_ep_t *ep, const void *data,
+                                   size_t length)
+{
+    size_t copy_length;
+
+    while (length > 0) {
+        copy_length = ucs_min(length, ep->rx.rma.buf_length);
+        memcpy(ep->rx.rma.buffer, data, copy_length);
+        uct_tcp_ep_rx_rma_advance(ep, copy_length);
+        data    = UCS_PTR_BYTE_OFFSET(data, copy_length);
+        length -= copy_length;
+    }
+}
+
+static void uct_tcp_ep_rx_get_resp(uct_tcp_ep_t *ep, uct_tcp_am_hdr_t *hdr)
+{
+    ucs_queue_head_t *get_q = &ep->tx.lead->get_q;
+    uct_tcp_get_op_t *op;
+    size_t iov_it;
+    void *data;
+
+    if (ucs_queue_is_empty(get_q)) {
+        ucs_error("tcp_ep %p: unexpected get response", ep);
+        return;
+    }
+
+    op = ucs_queue_pull_elem_non_empty(get_q, uct_tcp_get_op_t, queue);
+    ucs_assert(hdr->length == op->length);
+    if (op->unpack_cb != NULL) {
+        op->unpack_cb(op->arg, hdr + 1, hdr->length);
+    } else {
+        data = hdr + 1;
+        for (iov_it = 0; iov_it < op->iov_cnt; ++iov_it) {
+            memcpy(op->iov[iov_it].iov_base, data, op->iov[iov_it].iov_len);
+            data = UCS_PTR_BYTE_OFFSET(data, op->iov[iov_it].iov_len);
+        }
+    }
+    uct_tcp_ep_get_op_complete(op);
+}
+
+/* Start receiving the rest of a partial put or get response directly to the
+ * destination buffer */
+static ucs_status_t uct_tcp_ep_rx_rma_start(uct_tcp_iface_t *iface,
+                                            uct_tcp_ep_t *ep,
+                                            uct_tcp_am_hdr_t *hdr,
+                                            size_t remainder)
+{
+    ucs_queue_head_t *get_q = &ep->tx.lead->get_q;
+    size_t hdr_length       = sizeof(*hdr);
+    uct_tcp_put_hdr_t *put_hdr;
+    uct_tcp_get_op_t *op;
+    ucs_status_t status;
+
+    if (hdr->am_id == UCT_TCP_AM_PUT) {
+        hdr_length += sizeof(*put_hdr);
+        if (remainder < hdr_length) {
+            return UCS_OK;
+        }
+
+        put_hdr = (uct_tcp_put_hdr_t*)(hdr + 1);
+        status  = uct_tcp_ep_rx_check_access(iface, ep, put_hdr->key_id,
+                                             put_hdr->address,
+                                             hdr->length - sizeof(*put_hdr));
+        if (status != UCS_OK) {
+            return status;
+        }
+
+
+        ep->rx.rma.buffer     = (void*)(uintptr_t)put_hdr->address;
+        ep->rx.rma.buf_length = hdr->length - sizeof(*put_hdr);
+        op                    = NULL;
+    } else if ((hdr->am_id == UCT_TCP_AM_GET_RESP) &&
+               !ucs_queue_is_empty(get_q)) {
+        op = ucs_queue_head_elem_non_empty(get_q, uct_tcp_get_op_t, queue);
+        if (op->unpack_cb != NULL) {
+            return UCS_OK;
+        }
+
+        /* The operation stays in the queue until all data is received, so
+         * a flush waits for it */
+        ep->rx.rma.buffer     = NULL;
+        ep->rx.rma.buf_length = 0;
+    } else {
+        return UCS_OK;
+    }
+
+    ep->rx.rma.length    = sizeof(*hdr) + hdr->length - hdr_length;
+    ep->rx.rma.op        = op;
+    ep->rx.rma.iov_index = 0;
+    ep->rx.offset        = ep->rx.length;
+
+    /* Get data starts at the first buffer of the operation */
+    uct_tcp_ep_rx_rma_advance(ep, 0);
+    uct_tcp_ep_rx_rma_copy(ep, UCS_PTR_BYTE_OFFSET(hdr, hdr_length),
+                           remainder - hdr_length);
+    return UCS_OK;
+}
+
+static void uct_tcp_ep_rx_group_progress(uct_tcp_iface_t *iface,
+                                         uct_tcp_rx_group_t *group);
+
+static unsigned uct_tcp_ep_rx_rma(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep)
+{
+    size_t recv_length = ep->rx.rma.buf_length;
+    ucs_status_t status;
+
+    status = uct_tcp_recv(ep->fd, ep->rx.rma.buffer, &recv_length);
+    if (status != UCS_OK) {
+        uct_tcp_ep_rx_disconnected(ep, UCS_ERR_ENDPOINT_TIMEOUT);
+        return 0;
+    }
+
+    ucs_trace_data("tcp_ep %p: recvd %zu bytes of rma data", ep, recv_length);
+
+    uct_tcp_ep_rx_rma_advance(ep, recv_length);
+    if (ep->rx.rma.length > 0) {
+        return recv_length > 0;
+    }
+
+    if (ep->rx.rma.op != NULL) {
+        ucs_assert(ucs_queue_head_elem_non_empty(&ep->tx.lead->get_q,
+                                                 uct_tcp_get_op_t, queue) ==
+                   ep->rx.rma.op);
+        ucs_queue_pull_non_empty(&ep->tx.lead->get_q);
+        uct_tcp_ep_get_op_complete(ep->rx.rma.op);
+        ep->rx.rma.op = NULL;
+    }
+
+    if (ep->rx.group != NULL) {
+        ++ep->rx.group->sn;
+        uct_tcp_ep_rx_group_progress(iface, ep->rx.group);
+    }
+
+    return recv_length > 0;
+}
+
+static inline void uct_tcp_ep_rx_invoke_am(uct_tcp_iface_t *iface,
+                                           uct_tcp_ep_t *ep,
+                                           uct_tcp_am_hdr_t *hdr)
+{
+    ucs_status_t status;
+
+    if (ep->rx.offset < ep->rx.length) {
+        /* More data follows in the same buffer, so it can't be given away */
+        uct_iface_invoke_am(&iface->super, hdr->am_id, hdr + 1, hdr->length, 0);
+        return;
+    }
+
+    status = uct_iface_invoke_am(&iface->super, hdr->am_id, hdr + 1,
+                                 hdr->length, UCT_CB_PARAM_FLAG_DESC);
+    if (status == UCS_INPROGRESS) {
+        /* The user keeps the buffer, so the next data is received to a new
+         * descriptor */
+        uct_recv_desc(UCS_PTR_BYTE_OFFSET(hdr + 1, -iface->config.rx_headroom)) =
+                &ep->rx.desc->release;
+        ep->rx.desc = NULL;
+    }
+}
+
+static void uct_tcp_ep_rx_conn_group(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                                     uct_tcp_am_hdr_t *hdr)
+{
+    uct_tcp_conn_group_hdr_t *group_hdr = (uct_tcp_conn_group_hdr_t*)(hdr + 1);
+    uct_tcp_rx_group_t *group;
+
+    if (ep->rx.group != NULL) {
+        ucs_error("tcp_ep %p: already in connection group 0x%"PRIx64, ep,
+                  ep->rx.group->id);
+        return;
+    }
+
+    ucs_list_for_each(group, &iface->rx_groups, list) {
+        if (group->id == group_hdr->id) {
+            goto out;
+        }
+    }
+
+    group = ucs_malloc(sizeof(*group), "tcp_rx_group");
+    if (group == NULL) {
+        ucs_error("tcp_ep %p: failed to allocate connection group", ep);
+        return;
+    }
+
+    group->id = group_hdr->id;
+    group->sn = 0;
+    ucs_list_head_init(&group->conns);
+    ucs_list_add_tail(&iface->rx_groups, &group->list);
+
+out:
+    ucs_trace("tcp_ep %p: joined connection group 0x%"PRIx64, ep, group->id);
+    ucs_list_add_tail(&group->conns, &ep->rx.group_list);
+    ep->rx.group = group;
+}
+
+/* Map the shared buffer which the connecting peer passed over the unix domain
+ * socket, and let the peer start using it */
+static void uct_tcp_ep_rx_shm_attach(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                                     uct_tcp_am_hdr_t *hdr)
+{
+    uct_tcp_shm_attach_hdr_t *attach_hdr = (uct_tcp_shm_attach_hdr_t*)(hdr + 1);
+    struct stat st;
+    int fd;
+
+    fd = uct_tcp_iface_shm_fd_get(iface, attach_hdr->id);
+    if (fd < 0) {
+        ucs_debug("tcp_ep %p: shared buffer 0x%"PRIx64" was not received", ep,
+                  attach_hdr->id);
+        return;
+    }
+
+    if (fstat(fd, &st) < 0) {
+        ucs_error("tcp_ep %p: fstat(fd=%d) failed: %m", ep, fd);
+        goto out_close;
+    }
+
+    if ((ep->shm.ctl != NULL) || !uct_tcp_ep_can_send(ep) ||
+        (st.st_size <= UCS_SYS_CACHE_LINE_SIZE)) {
+        ucs_error("tcp_ep %p: cannot attach shared buffer 0x%"PRIx64, ep,
+                  attach_hdr->id);
+        goto out_close;
+    }
+
+    if (!uct_tcp_ep_shm_map(ep, fd, st.st_size)) {
+        goto out_close;
+    }
+
+    ucs_debug("tcp_ep %p: attached shared buffer 0x%"PRIx64" of %zu bytes", ep,
+              attach_hdr->id, ep->shm.size);
+
+    hdr         = ep->buf;
+    hdr->am_id  = UCT_TCP_AM_SHM_ACK;
+    hdr->length = 0;
+    uct_tcp_ep_tx_post(iface, ep, hdr);
+
+out_close:
+    close(fd);
+}
+
+/* Check the length of the data of a received message. The lengths are sent by
+ * the peer, so they are checked before they are used. Only put and get data
+ * may be larger than the receive buffer, since they are received directly to
+ * the destination */
+static int uct_tcp_ep_rx_length_is_valid(uct_tcp_iface_t *iface,
+                                         uct_tcp_ep_t *ep, uint8_t am_id,
+                                         uint64_t length)
+{
+    int valid;
+
+    switch (am_id) {
+    case UCT_TCP_AM_PUT:
+        valid = (length >= sizeof(uct_tcp_put_hdr_t));
+        break;
+    case UCT_TCP_AM_GET_RESP:
+        valid = 1;
+        break;
+    default:
+        valid = (length <= (iface->config.buf_size - sizeof(uct_tcp_am_hdr_t)));
+        break;
+    }
+
+    if (!valid) {
+        ucs_error("tcp_ep %p: invalid length %"PRIu64" of message %d", ep,
+                  length, am_id);
+    }
+    return valid;
+}
+
+/* Handle a message whose data is in the shared buffer, and release the data
+ * space to the sender */
+static ucs_status_t uct_tcp_ep_rx_shm(uct_tcp_iface_t *iface,
+                                      uct_tcp_ep_t *ep, uct_tcp_am_hdr_t *hdr)
+{
+    uct_tcp_shm_desc_t *desc = (uct_tcp_shm_desc_t*)(hdr + 1);
+    uint8_t am_id            = hdr->am_id & ~UCT_TCP_AM_FLAG_SHM;
+    ucs_status_t status;
+    void *data;
+
+    if ((ep->shm.ctl == NULL) || (hdr->length != sizeof(*desc)) ||
+        (desc->offset > ep->shm.size) ||
+        (desc->length > ep->shm.size - desc->offset)) {
+        ucs_error("tcp_ep %p: invalid shared data offset %"PRIu64" length %"
+                  PRIu64, ep, desc->offset, desc->length);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    if ((am_id == UCT_TCP_AM_GET_RESP) ||
+        !uct_tcp_ep_rx_length_is_valid(iface, ep, am_id, desc->length)) {
+        return UCS_ERR_IO_ERROR;
+    }
+
+    data = UCS_PTR_BYTE_OFFSET(ep->shm.data, desc->offset);
+    if (am_id == UCT_TCP_AM_PUT) {
+        status = uct_tcp_ep_rx_put(iface, ep, data,
+                                   desc->length - sizeof(uct_tcp_put_hdr_t));
+        if (status != UCS_OK) {
+            return status;
+        }
+    } else if (am_id < UCT_AM_ID_MAX) {
+        uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_RECV, am_id, data,
+                           desc->length, "RECV fd %d shm", ep->fd);
+        /* The data space is released after the callback, so the user can't
+         * keep it */
+        uct_iface_invoke_am(&iface->super, am_id, data, desc->length, 0);
+    } else {
+        ucs_error("invalid am id: %d", am_id);
+    }
+
+    ucs_memory_cpu_store_fence();
+    ep->shm.ctl->tail = desc->end;
+    return UCS_OK;
+}
+
+/* Handle received messages, until reaching a message which is incomplete or
+ * out of order. If a message is invalid, the connection is closed and an
+ * error is returned, so the endpoint must not be used anymore. */
+static ucs_status_t uct_tcp_ep_rx_parse(uct_tcp_iface_t *iface,
+                                        uct_tcp_ep_t *ep)
+{
+    ucs_status_t status = UCS_OK;
+    uct_tcp_am_hdr_t *hdr;
+    size_t remainder;
+    size_t sn_size;
+
+    for (;;) {
+        /* The connection joins a group by its first message */
+        sn_size   = uct_tcp_ep_rx_sn_size(ep);
+        remainder = ep->rx.length - ep->rx.offset;
+        if (remainder < (sn_size + sizeof(*hdr))) {
+            break;
+        }
+
+        hdr        = uct_tcp_ep_rx_hdr(ep);
+        remainder -= sn_size;
+        if (ucs_unlikely(!uct_tcp_ep_rx_length_is_valid(iface, ep, hdr->am_id,
+                                                        hdr->length))) {
+            status = UCS_ERR_IO_ERROR;
+            break;
+        }
+
+        if ((ep->rx.group != NULL) &&
+            (uct_tcp_am_hdr_sn(hdr)->sn != ep->rx.group->sn)) {
+            /* Wait for the previous messages on other connections */
+            ucs_trace_data("tcp_ep %p: message sn %u is blocked by sn %u", ep,
+                           uct_tcp_am_hdr_sn(hdr)->sn, ep->rx.group->sn);
+            ep->flags |= UCT_TCP_EP_FLAG_RX_BLOCKED;
+            uct_tcp_ep_mod_events(ep, 0, EPOLLIN);
+            return UCS_OK;
+        }
+
+        if (remainder < sizeof(*hdr) + hdr->length) {
+            status = uct_tcp_ep_rx_rma_start(iface, ep, hdr, remainder);
+            break;
+        }
+
+        /* Full message was received */
+        ep->rx.offset += sn_size + sizeof(*hdr) + hdr->length;
+        if (ep->rx.group != NULL) {
+            ++ep->rx.group->sn;
+        }
+
+        if (hdr->am_id & UCT_TCP_AM_FLAG_SHM) {
+            status = uct_tcp_ep_rx_shm(iface, ep, hdr);
+            if (status != UCS_OK) {
+                break;
+            }
+            continue;
+        }
+
+        switch (hdr->am_id) {
+        case UCT_TCP_AM_PUT:
+            status = uct_tcp_ep_rx_put(iface, ep,
+                                       (uct_tcp_put_hdr_t*)(hdr + 1),
+                                       hdr->length - sizeof(uct_tcp_put_hdr_t));
+            break;
+        case UCT_TCP_AM_GET_REQ:
+            status = uct_tcp_ep_rx_get_req(iface, ep, hdr);
+            break;
+        case UCT_TCP_AM_GET_RESP:
+            uct_tcp_ep_rx_get_resp(ep, hdr);
+            break;
+        case UCT_TCP_AM_CONN_GROUP:
+            uct_tcp_ep_rx_conn_group(iface, ep, hdr);
+            break;
+        case UCT_TCP_AM_SHM_ATTACH:
+            uct_tcp_ep_rx_shm_attach(iface, ep, hdr);
+            break;
+        case UCT_TCP_AM_SHM_ACK:
+            if (ep->shm.ctl != NULL) {
+                ep->flags |= UCT_TCP_EP_FLAG_SHM;
+            }
+            break;
+        default:
+            if (hdr->am_id >= UCT_AM_ID_MAX) {
+                ucs_error("invalid am id: %d", hdr->am_id);
+                break;
+            }
+
+            uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_RECV, hdr->am_id,
+                               hdr + 1, hdr->length, "RECV fd %d", ep->fd);
+            uct_tcp_ep_rx_invoke_am(iface, ep, hdr);
+            break;
+        }
+
+        if (status != UCS_OK) {
+            break;
+        }
+    }
+
+    if (status != UCS_OK) {
+        uct_tcp_ep_rx_disconnected(ep, status);
+        return status;
+    }
+
+    /* Partial message is left at its place, and completed by next receive */
+    if (ep->rx.offset == ep->rx.length) {
+        ep->rx.offset = 0;
+        ep->rx.length = 0;
+    }
+
+    return UCS_OK;
+}
+
+/* Resume the connections whose next message is now in order */
+static void uct_tcp_ep_rx_group_progress(uct_tcp_iface_t *iface,
+                                         uct_tcp_rx_group_t *group)
+{
+    uct_tcp_am_hdr_t *hdr;
+    uct_tcp_ep_t *ep;
+    int found;
+
+    do {
+        found = 0;
+        ucs_list_for_each(ep, &group->conns, rx.group_list) {
+            if (!(ep->flags & UCT_TCP_EP_FLAG_RX_BLOCKED)) {
+                continue;
+            }
+
+            hdr = uct_tcp_ep_rx_hdr(ep);
+            if (uct_tcp_am_hdr_sn(hdr)->sn == group->sn) {
+                ep->flags &= ~UCT_TCP_EP_FLAG_RX_BLOCKED;
+                uct_tcp_ep_mod_events(ep, EPOLLIN, 0);
+                if (uct_tcp_ep_rx_parse(iface, ep) != UCS_OK) {
+                    return;
+                }
+
+                found = 1;
+                break;
+            }
+        }
+    } while (found);
+}
+
+static unsigned uct_tcp_ep_rx_recv(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep)
+{
+    ucs_status_t status;
+    size_t recv_length;
+
+    if (ep->rx.rma.length > 0) {
+        return uct_tcp_ep_rx_rma(iface, ep);
+    }
+
+    if (ucs_unlikely(ep->rx.desc == NULL)) {
+        UCT_TL_IFACE_GET_RX_DESC(&iface->super, &iface->rx_mpool, ep->rx.desc,
+                                 return 0);
+        ep->rx.buf = UCS_PTR_BYTE_OFFSET(ep->rx.desc, iface->config.rx_offset);
+        ucs_assert(ep->rx.length == 0);
+    }
+
+    /* Receive next chunk of data. If only a header was received, try to get
+     * the payload right away. */
+    do {
+        recv_length = uct_tcp_ep_rx_length(iface, ep);
+        ucs_assertv(recv_length > 0, "ep=%p", ep);
+
+        status = uct_tcp_recv(ep->fd, ep->rx.buf + ep->rx.length, &recv_length);
+        if (status != UCS_OK) {
+            uct_tcp_ep_rx_disconnected(ep, UCS_ERR_ENDPOINT_TIMEOUT);
+            return 0;
+        }
+
+        ep->rx.length += recv_length;
+        ucs_trace_data("tcp_ep %p: recvd %zu bytes", ep, recv_length);
+    } while ((recv_length > 0) && uct_tcp_ep_rx_hdr_only(ep));
+
+    if (uct_tcp_ep_rx_parse(iface, ep) != UCS_OK) {
+        /* The endpoint may be destroyed */
+        return 0;
+    }
+
+    if (ep->rx.group != NULL) {
+        uct_tcp_ep_rx_group_progress(iface, ep->rx.group);
+    }
+
+    return recv_length > 0;
+}
+
+unsigned uct_tcp_ep_progress_rx(uct_tcp_ep_t *ep)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+
+    ucs_trace_func("ep=%p", ep);
+
+    if (ep->flags & UCT_TCP_EP_FLAG_RX_BLOCKED) {
+        return 0;
+    }
+
+    return uct_tcp_ep_rx_recv(iface, ep);
+}
+
+
+static inline void uct_tcp_ep_tx_kick(uct_tcp_ep_t *ep)
+{
+    uct_tcp_ep_send(ep);
+    if (ep->length > 0) {
+        uct_tcp_ep_mod_events(ep, EPOLLOUT, 0);
+    }
+}
+
+static inline void uct_tcp_ep_tx_post(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                                      const uct_tcp_am_hdr_t *hdr)
+{
+    ep->length         = uct_tcp_ep_tx_msg_end(ep, hdr);
+    iface->outstanding += ep->length;
+    uct_tcp_ep_tx_kick(ep);
+}
+
+void uct_tcp_ep_tx_push(uct_tcp_ep_t *ep)
+{
+    ucs_trace_data("tcp_ep %p: push %zu bytes of coalesced messages", ep,
+                   ep->length);
+    uct_tcp_ep_tx_uncoalesce(ep);
+    uct_tcp_ep_tx_kick(ep);
+}
+
+/* Messages are numbered across all connections of the endpoint, so the peer
+ * can restore their order */
+static inline void uct_tcp_ep_tx_number(uct_tcp_ep_t *ep, uct_tcp_am_hdr_t *hdr)
+{
+    if (ep->flags & UCT_TCP_EP_FLAG_TX_SN) {
+        uct_tcp_am_hdr_sn(hdr)->sn = ep->tx.lead->tx.sn++;
+    }
+}
+
+/* Append the message to the send buffer, and send the buffer only when it
+ * has enough data. Otherwise it is sent by the next progress call or flush. */
+static inline void uct_tcp_ep_tx_coalesce(uct_tcp_iface_t *iface,
+                                          uct_tcp_ep_t *ep,
+                                          uct_tcp_am_hdr_t *hdr)
+{
+    size_t length = uct_tcp_ep_tx_msg_end(ep, hdr) - ep->length;
+
+    uct_tcp_ep_tx_number(ep, hdr);
+    ep->length         += length;
+    iface->outstanding += length;
+
+    if (ep->length >= iface->config.coalesce_size) {
+        uct_tcp_ep_tx_push(ep);
+    } else if (!(ep->flags & UCT_TCP_EP_FLAG_TX_COALESCE)) {
+        ep->flags |= UCT_TCP_EP_FLAG_TX_COALESCE;
+        ucs_list_add_tail(&iface->tx_coalesced, &ep->coalesce_list);
+    }
+}
+
+static inline void uct_tcp_ep_tx_start(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                                       uct_tcp_am_hdr_t *hdr)
+{
+    uct_tcp_ep_tx_number(ep, hdr);
+    uct_tcp_ep_tx_post(iface, ep, hdr);
+}
+
+static inline void uct_tcp_ep_am_tx(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                                    uct_tcp_am_hdr_t *hdr)
+{
+    if (iface->config.coalesce_size > 0) {
+        uct_tcp_ep_tx_coalesce(iface, ep, hdr);
+    } else {
+        uct_tcp_ep_tx_start(iface, ep, hdr);
+    }
+}
+
+static inline void uct_tcp_ep_am_send(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                                      uct_tcp_am_hdr_t *hdr)
+{
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, hdr->am_id,
+                       hdr + 1, hdr->length, "SEND fd %d", ep->fd);
+    uct_tcp_ep_am_tx(iface, ep, hdr);
+}
+
+/* Reserve contiguous space for message data in the shared buffer of a
+ * same-host connection. Returns NULL if the connection does not use a shared
+ * buffer, or if the receiver did not release enough space yet. */
+static inline void *uct_tcp_ep_shm_reserve(uct_tcp_ep_t *ep, size_t length,
+                                           uint64_t *start_p)
+{
+    uint64_t start = ep->shm.head;
+    size_t offset;
+
+    if (!(ep->flags & UCT_TCP_EP_FLAG_SHM) || (length > ep->shm.size)) {
+        return NULL;
+    }
+
+    offset = start % ep->shm.size;
+    if (offset + length > ep->shm.size) {
+        /* Skip the space at the end of the ring, which is too small */
+        start += ep->shm.size - offset;
+        offset = 0;
+    }
+
+    if (start + length - ep->shm.ctl->tail > ep->shm.size) {
+        return NULL;
+    }
+
+    ucs_memory_cpu_load_fence();
+    *start_p = start;
+    return UCS_PTR_BYTE_OFFSET(ep->shm.data, offset);
+}
+
+/* Make the message refer to the data written to the shared buffer */
+static inline void uct_tcp_ep_shm_desc_init(uct_tcp_ep_t *ep,
+                                            uct_tcp_am_hdr_t *hdr,
+                                            uint8_t am_id, uint64_t start,
+                                            size_t length)
+{
+    uct_tcp_shm_desc_t *desc = (uct_tcp_shm_desc_t*)(hdr + 1);
+
+    hdr->am_id   = am_id | UCT_TCP_AM_FLAG_SHM;
+    hdr->length  = sizeof(*desc);
+    desc->offset = start % ep->shm.size;
+    desc->length = length;
+    desc->end    = start + length;
+    ep->shm.head = desc->end;
+}
+
+static inline void *uct_tcp_ep_shm_copy_iov(void *dest, const uct_iov_t *iov,
+                                            size_t iovcnt)
+{
+    size_t iov_length;
+    size_t iov_it;
+
+    for (iov_it = 0; iov_it < iovcnt; ++iov_it) {
+        iov_length = uct_iov_get_length(&iov[iov_it]);
+        memcpy(dest, iov[iov_it].buffer, iov_length);
+        dest = UCS_PTR_BYTE_OFFSET(dest, iov_length);
+    }
+
+    return dest;
+}
+
+ucs_status_t uct_tcp_ep_am_short(uct_ep_h uct_ep, uint8_t am_id, uint64_t header,
+                                 const void *payload, unsigned length)
+{
+    uct_tcp_ep_t *ep       = ucs_derived_of(uct_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(uct_ep->iface, uct_tcp_iface_t);
+    uct_tcp_am_hdr_t *hdr;
+    uct_tcp_ep_t *conn;
+
+    UCT_TCP_AM_CONN_GET(ep, conn, am_id);
+    UCT_TCP_AM_PREPARE(ep, conn, am_id, iface->config.short_size - sizeof(*hdr),
+                       hdr, memcpy, payload, length, header, SHORT, "am_short");
+
+    uct_tcp_ep_am_send(iface, conn, hdr);
+    return UCS_OK;
+}
+
+ssize_t uct_tcp_ep_am_bcopy(uct_ep_h uct_ep, uint8_t am_id,
+                            uct_pack_callback_t pack_cb, void *arg,
                             unsigned flags)
 {
     uct_tcp_ep_t *ep = ucs_derived_of(uct_ep, uct_tcp_ep_t);
     uct_tcp_iface_t *iface = ucs_derived_of(uct_ep->iface, uct_tcp_iface_t);
     uct_tcp_am_hdr_t *hdr;
+    uct_tcp_ep_t *conn;
+    uint64_t shm_start;
+    size_t length;
+    void *data;
+
+    UCT_TCP_AM_CONN_GET(ep, conn, am_id);
+
+    data = uct_tcp_ep_shm_reserve(conn, iface->config.buf_size - sizeof(*hdr),
+                                  &shm_start);
+    if (data != NULL) {
+        length = pack_cb(data, arg);
+        UCT_CHECK_LENGTH(length, 0, iface->config.buf_size - sizeof(*hdr),
+                         "am_bcopy");
+        UCT_TL_EP_STAT_OP(&ep->super, AM, BCOPY, length);
+        uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, am_id, data,
+                           length, "SEND fd %d shm", conn->fd);
+
+        hdr = uct_tcp_ep_tx_hdr(conn);
+        uct_tcp_ep_shm_desc_init(conn, hdr, am_id, shm_start, length);
+        uct_tcp_ep_am_tx(iface, conn, hdr);
+        return length;
+    }
 
-    UCT_TCP_AM_PREPARE(ep, am_id, iface->config.buf_size - sizeof(*hdr),
+    UCT_TCP_AM_PREPARE(ep, conn, am_id, iface->config.buf_size - sizeof(*hdr),
                        hdr, pack_cb, arg, NULL, NULL, BCOPY, "am_bcopy");
 
-    uct_tcp_ep_am_send(iface, ep, hdr);
+    uct_tcp_ep_am_send(iface, conn, hdr);
     return hdr->length;
 }
 
+/* The data after the TCP header in the endpoint buffer is sent first, and the
+ * rest is sent directly from the user memory. Returns the user data length. */
+static size_t uct_tcp_ep_zcopy_iov_init(uct_tcp_ep_t *ep, uct_tcp_am_hdr_t *hdr,
+                                        const uct_iov_t *iov, size_t iovcnt)
+{
+    size_t zcopy_length = 0;
+    size_t iov_length;
+    size_t iov_it;
+
+    ucs_assert(ep->length == 0);
+    ep->iov[0].iov_base = ep->buf;
+    ep->iov[0].iov_len  = uct_tcp_ep_tx_msg_end(ep, hdr);
+    ep->iov_cnt         = 1;
+    ep->iov_index       = 0;
+
+    for (iov_it = 0; iov_it < iovcnt; ++iov_it) {
+        iov_length = uct_iov_get_length(&iov[iov_it]);
+        if (iov_length == 0) {
+            continue;
+        }
+
+        ep->iov[ep->iov_cnt].iov_base = iov[iov_it].buffer;
+        ep->iov[ep->iov_cnt].iov_len  = iov_length;
+        hdr->length                  += iov_length;
+        zcopy_length                 += iov_length;
+        ++ep->iov_cnt;
+    }
+
+    return zcopy_length;
+}
+
+static inline ucs_status_t uct_tcp_ep_zcopy_send(uct_tcp_iface_t *iface,
+                                                 uct_tcp_ep_t *ep,
+                                                 uct_tcp_am_hdr_t *hdr,
+                                                 size_t zcopy_length,
+                                                 uct_completion_t *comp)
+{
+    uct_tcp_zcopy_op_t *op;
+
+    if ((zcopy_length == 0) || (zcopy_length < iface->config.zcopy.thresh)) {
+        uct_tcp_ep_tx_start(iface, ep, hdr);
+        if (ep->length == 0) {
+            return UCS_OK;
+        }
+
+        ep->comp = comp;
+        return UCS_INPROGRESS;
+    }
+
+    op = ucs_mpool_get_inline(&iface->zcopy_mpool);
+    if (ucs_unlikely(op == NULL)) {
+        ucs_error("tcp_ep %p: failed to allocate zcopy operation", ep);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    /* The operation completes when the kernel releases the data, even if the
+     * message is sent right away */
+    op->comp     = comp;
+    ep->zcopy.op = op;
+    ucs_queue_push(&ep->zcopy.queue, &op->queue);
+    uct_tcp_ep_tx_start(iface, ep, hdr);
+    return UCS_INPROGRESS;
+}
+
+unsigned uct_tcp_ep_progress_zcopy(uct_tcp_ep_t *ep)
+{
+    unsigned count = 0;
+    uct_tcp_zcopy_op_t *op;
+    uint32_t sn;
+
+    if (ucs_queue_is_empty(&ep->zcopy.queue)) {
+        return 0;
+    }
+
+    while (uct_tcp_recv_zerocopy_done(ep->fd, &sn) == UCS_OK) {
+        ucs_queue_for_each_extract(op, &ep->zcopy.queue, queue,
+                                   (op != ep->zcopy.op) &&
+                                   UCS_CIRCULAR_COMPARE32(op->sn, <=, sn)) {
+            if (op->comp != NULL) {
+                uct_invoke_completion(op->comp, UCS_OK);
+            }
+            ucs_mpool_put(op);
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+/* A flush completes after the kernel releases the data of all zcopy sends
+ * which were started before it */
+static ucs_status_t uct_tcp_ep_zcopy_flush(uct_tcp_iface_t *iface,
+                                           uct_tcp_ep_t *ep,
+                                           uct_completion_t *comp,
+                                           int comp_used)
+{
+    uct_tcp_zcopy_op_t *op;
+    uct_tcp_ep_t *conn;
+    unsigned i;
+
+    for (i = 0; i < ep->tx.count; ++i) {
+        conn = ep->tx.conns[i];
+        if (ucs_queue_is_empty(&conn->zcopy.queue)) {
+            continue;
+        }
+
+        op = ucs_mpool_get_inline(&iface->zcopy_mpool);
+        if (ucs_unlikely(op == NULL)) {
+            ucs_error("tcp_ep %p: failed to allocate zcopy operation", conn);
+            return UCS_ERR_NO_MEMORY;
+        }
+
+        /* Waits behind the message which is being sent, if any */
+        op->sn   = conn->zcopy.sn - 1;
+        op->comp = comp;
+        if (comp_used) {
+            ++comp->count;
+        }
+        comp_used = 1;
+        ucs_queue_push(&conn->zcopy.queue, &op->queue);
+    }
+
+    return UCS_OK;
+}
+
+static int uct_tcp_ep_zcopy_idle(uct_tcp_ep_t *ep)
+{
+    unsigned i;
+
+    for (i = 0; i < ep->tx.count; ++i) {
+        if (!ucs_queue_is_empty(&ep->tx.conns[i]->zcopy.queue)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+ucs_status_t uct_tcp_ep_am_zcopy(uct_ep_h uct_ep, uint8_t am_id,
+                                 const void *header, unsigned header_length,
+                                 const uct_iov_t *iov, size_t iovcnt,
+                                 unsigned flags, uct_completion_t *comp)
+{
+    uct_tcp_ep_t *ep       = ucs_derived_of(uct_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(uct_ep->iface, uct_tcp_iface_t);
+    size_t length          = header_length + uct_iov_total_length(iov, iovcnt);
+    uct_tcp_am_hdr_t *hdr;
+    uct_tcp_ep_t *conn;
+    size_t zcopy_length;
+    uint64_t shm_start;
+    void *data;
+
+    UCT_CHECK_AM_ID(am_id);
+    UCT_CHECK_IOV_SIZE(iovcnt, iface->config.zcopy.max_iov,
+                       "uct_tcp_ep_am_zcopy");
+    UCT_CHECK_LENGTH(header_length, 0, iface->config.zcopy.max_hdr,
+                     "am_zcopy header");
+    UCT_CHECK_LENGTH(length, 0, iface->config.buf_size - sizeof(*hdr),
+                     "am_zcopy");
+
+    /* Data copied to the shared buffer does not need the whole send buffer */
+    conn = uct_tcp_ep_tx_conn(ep, 1);
+    if (conn == NULL) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    data = uct_tcp_ep_shm_reserve(conn, length, &shm_start);
+    if (data != NULL) {
+        memcpy(data, header, header_length);
+        uct_tcp_ep_shm_copy_iov(UCS_PTR_BYTE_OFFSET(data, header_length), iov,
+                                iovcnt);
+        UCT_TL_EP_STAT_OP(&ep->super, AM, ZCOPY, length);
+        uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, am_id, data,
+                           header_length, "SEND fd %d shm", conn->fd);
+
+        hdr = uct_tcp_ep_tx_hdr(conn);
+        uct_tcp_ep_shm_desc_init(conn, hdr, am_id, shm_start, length);
+        uct_tcp_ep_am_tx(iface, conn, hdr);
+        return UCS_OK;
+    }
+
+    if (!uct_tcp_ep_tx_avail(conn, 0)) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    hdr         = uct_tcp_ep_tx_hdr(conn);
+    hdr->am_id  = am_id;
+    hdr->length = header_length;
+    memcpy(hdr + 1, header, header_length);
+    zcopy_length = uct_tcp_ep_zcopy_iov_init(conn, hdr, iov, iovcnt);
+
+    UCT_TL_EP_STAT_OP(&ep->super, AM, ZCOPY, hdr->length);
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, am_id,
+                       hdr + 1, header_length, "SEND fd %d", conn->fd);
+
+    return uct_tcp_ep_zcopy_send(iface, conn, hdr, zcopy_length, comp);
+}
+
+static void uct_tcp_ep_get_resp_send(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                                     void *buffer, size_t length)
+{
+    uct_tcp_am_hdr_t *hdr = uct_tcp_ep_tx_hdr(ep);
+    uct_iov_t iov;
+
+    iov.buffer = buffer;
+    iov.length = length;
+    iov.memh   = UCT_MEM_HANDLE_NULL;
+    iov.stride = 0;
+    iov.count  = 1;
+
+    hdr->am_id  = UCT_TCP_AM_GET_RESP;
+    hdr->length = 0;
+    uct_tcp_ep_zcopy_iov_init(ep, hdr, &iov, 1);
+
+    ucs_trace_data("tcp_ep %p: get response %zu bytes from %p", ep, length,
+                   buffer);
+    uct_tcp_ep_tx_start(iface, ep, hdr);
+}
+
+static ucs_status_t uct_tcp_ep_get_req_send(uct_tcp_iface_t *iface,
+                                            uct_tcp_ep_t *ep,
+                                            uct_tcp_ep_t *conn,
+                                            const uct_iov_t *iov, size_t iovcnt,
+                                            size_t length,
+                                            uct_unpack_callback_t unpack_cb,
+                                            void *arg, uint64_t remote_addr,
+                                            uint64_t key_id,
+                                            uct_completion_t *comp)
+{
+    uct_tcp_get_req_hdr_t *get_req;
+    uct_tcp_am_hdr_t *hdr;
+    uct_tcp_get_op_t *op;
+    size_t iov_length;
+    size_t iov_it;
+
+    ucs_assert(uct_tcp_ep_can_send(conn));
+
+    op = ucs_mpool_get_inline(&iface->get_mpool);
+    if (op == NULL) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    op->iov_cnt = 0;
+    for (iov_it = 0; iov_it < iovcnt; ++iov_it) {
+        iov_length = uct_iov_get_length(&iov[iov_it]);
+        if (iov_length == 0) {
+            continue;
+        }
+
+        op->iov[op->iov_cnt].iov_base = iov[iov_it].buffer;
+        op->iov[op->iov_cnt].iov_len  = iov_length;
+        ++op->iov_cnt;
+    }
+
+    op->length    = length;
+    op->unpack_cb = unpack_cb;
+    op->arg       = arg;
+    op->comp      = comp;
+    ucs_queue_push(&ep->get_q, &op->queue);
+
+    hdr              = uct_tcp_ep_tx_hdr(conn);
+    hdr->am_id       = UCT_TCP_AM_GET_REQ;
+    hdr->length      = sizeof(*get_req);
+    get_req          = (uct_tcp_get_req_hdr_t*)(hdr + 1);
+    get_req->address = remote_addr;
+    get_req->length  = length;
+    get_req->key_id  = key_id;
+
+    ucs_trace_data("tcp_ep %p: get request %zu bytes from 0x%"PRIx64, ep,
+                   length, remote_addr);
+
+    uct_tcp_ep_tx_start(iface, conn, hdr);
+    return UCS_INPROGRESS;
+}
+
+static inline uint64_t uct_tcp_ep_rkey_id(uct_rkey_t rkey, size_t length)
+{
+    /* Empty operations may be posted without a remote key */
+    return (length == 0) ? 0 : ((const uct_tcp_key_t*)rkey)->id;
+}
+
+static inline uct_tcp_am_hdr_t *uct_tcp_ep_put_hdr_init(uct_tcp_ep_t *ep,
+                                                        uint64_t remote_addr,
+                                                        uint64_t key_id)
+{
+    uct_tcp_am_hdr_t *hdr = uct_tcp_ep_tx_hdr(ep);
+    uct_tcp_put_hdr_t *put_hdr;
+
+    hdr->am_id       = UCT_TCP_AM_PUT;
+    hdr->length      = sizeof(*put_hdr);
+    put_hdr          = (uct_tcp_put_hdr_t*)(hdr + 1);
+    put_hdr->address = remote_addr;
+    put_hdr->key_id  = key_id;
+    return hdr;
+}
+
+static inline void uct_tcp_ep_put_trace(uct_tcp_ep_t *ep,
+                                        const uct_tcp_put_hdr_t *put_hdr,
+                                        size_t length)
+{
+    ucs_trace_data("tcp_ep %p: put %zu bytes to 0x%"PRIx64, ep, length,
+                   put_hdr->address);
+
+    /* Remote completion is confirmed by the next flush */
+    ep->tx.lead->flags |= UCT_TCP_EP_FLAG_PUT_UNACKED;
+}
+
+ucs_status_t uct_tcp_ep_put_short(uct_ep_h uct_ep, const void *buffer,
+                                  unsigned length, uint64_t remote_addr,
+                                  uct_rkey_t rkey)
+{
+    uct_tcp_ep_t *ep       = ucs_derived_of(uct_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(uct_ep->iface, uct_tcp_iface_t);
+    uct_tcp_am_hdr_t *hdr;
+    uct_tcp_ep_t *conn;
+
+    UCT_CHECK_LENGTH(length, 0, iface->config.rma.max_short, "put_short");
+
+    conn = uct_tcp_ep_tx_conn(ep, 0);
+    if (conn == NULL) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    hdr = uct_tcp_ep_put_hdr_init(conn, remote_addr,
+                                  uct_tcp_ep_rkey_id(rkey, length));
+    memcpy(UCS_PTR_BYTE_OFFSET(hdr + 1, hdr->length), buffer, length);
+    hdr->length += length;
+
+    UCT_TL_EP_STAT_OP(&ep->super, PUT, SHORT, length);
+    uct_tcp_ep_put_trace(conn, (uct_tcp_put_hdr_t*)(hdr + 1), length);
+    uct_tcp_ep_tx_start(iface, conn, hdr);
+    return UCS_OK;
+}
+
+ssize_t uct_tcp_ep_put_bcopy(uct_ep_h uct_ep, uct_pack_callback_t pack_cb,
+                             void *arg, uint64_t remote_addr, uct_rkey_t rkey)
+{
+    uct_tcp_ep_t *ep       = ucs_derived_of(uct_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(uct_ep->iface, uct_tcp_iface_t);
+    uct_tcp_put_hdr_t *put_hdr;
+    uct_tcp_am_hdr_t *hdr;
+    uct_tcp_ep_t *conn;
+    uint64_t shm_start;
+    size_t length;
+
+    conn = uct_tcp_ep_tx_conn(ep, 0);
+    if (conn == NULL) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    hdr     = uct_tcp_ep_put_hdr_init(conn, remote_addr, 0);
+    put_hdr = uct_tcp_ep_shm_reserve(conn, sizeof(*put_hdr) +
+                                     iface->config.rma.max_bcopy, &shm_start);
+    if (put_hdr != NULL) {
+        length = pack_cb(put_hdr + 1, arg);
+        UCT_CHECK_LENGTH(length, 0, iface->config.rma.max_bcopy, "put_bcopy");
+        put_hdr->address = remote_addr;
+        uct_tcp_ep_shm_desc_init(conn, hdr, UCT_TCP_AM_PUT, shm_start,
+                                 sizeof(*put_hdr) + length);
+    } else {
+        put_hdr = (uct_tcp_put_hdr_t*)(hdr + 1);
+        length  = pack_cb(put_hdr + 1, arg);
+        UCT_CHECK_LENGTH(length, 0, iface->config.rma.max_bcopy, "put_bcopy");
+        hdr->length += length;
+    }
+    put_hdr->key_id = uct_tcp_ep_rkey_id(rkey, length);
+
+    UCT_TL_EP_STAT_OP(&ep->super, PUT, BCOPY, length);
+    uct_tcp_ep_put_trace(conn, put_hdr, length);
+    uct_tcp_ep_tx_start(iface, conn, hdr);
+    return length;
+}
+
+ucs_status_t uct_tcp_ep_put_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
+                                  size_t iovcnt, uint64_t remote_addr,
+                                  uct_rkey_t rkey, uct_completion_t *comp)
+{
+    uct_tcp_ep_t *ep       = ucs_derived_of(uct_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(uct_ep->iface, uct_tcp_iface_t);
+    size_t length          = uct_iov_total_length(iov, iovcnt);
+    uct_tcp_put_hdr_t *put_hdr;
+    uct_tcp_am_hdr_t *hdr;
+    uct_tcp_ep_t *conn;
+    size_t zcopy_length;
+    uint64_t shm_start;
+
+    UCT_CHECK_IOV_SIZE(iovcnt, iface->config.zcopy.max_iov,
+                       "uct_tcp_ep_put_zcopy");
+    UCT_CHECK_LENGTH(length, 0, iface->config.rma.max_zcopy, "put_zcopy");
+
+    conn = uct_tcp_ep_tx_conn(ep, 0);
+    if (conn == NULL) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    hdr     = uct_tcp_ep_put_hdr_init(conn, remote_addr,
+                                      uct_tcp_ep_rkey_id(rkey, length));
+    put_hdr = uct_tcp_ep_shm_reserve(conn, sizeof(*put_hdr) + length,
+                                     &shm_start);
+    if (put_hdr != NULL) {
+        *put_hdr = *(uct_tcp_put_hdr_t*)(hdr + 1);
+        uct_tcp_ep_shm_copy_iov(put_hdr + 1, iov, iovcnt);
+        uct_tcp_ep_shm_desc_init(conn, hdr, UCT_TCP_AM_PUT, shm_start,
+                                 sizeof(*put_hdr) + length);
+
+        UCT_TL_EP_STAT_OP(&ep->super, PUT, ZCOPY, length);
+        uct_tcp_ep_put_trace(conn, put_hdr, length);
+        uct_tcp_ep_tx_start(iface, conn, hdr);
+        return UCS_OK;
+    }
+
+    zcopy_length = uct_tcp_ep_zcopy_iov_init(conn, hdr, iov, iovcnt);
+
+    UCT_TL_EP_STAT_OP(&ep->super, PUT, ZCOPY, zcopy_length);
+    uct_tcp_ep_put_trace(conn, (uct_tcp_put_hdr_t*)(hdr + 1), zcopy_length);
+    return uct_tcp_ep_zcopy_send(iface, conn, hdr, zcopy_length, comp);
+}
+
+ucs_status_t uct_tcp_ep_get_bcopy(uct_ep_h uct_ep, uct_unpack_callback_t unpack_cb,
+                                  void *arg, size_t length, uint64_t remote_addr,
+                                  uct_rkey_t rkey, uct_completion_t *comp)
+{
+    uct_tcp_ep_t *ep       = ucs_derived_of(uct_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(uct_ep->iface, uct_tcp_iface_t);
+    ucs_status_t status;
+    uct_tcp_ep_t *conn;
+
+    UCT_CHECK_LENGTH(length, 0, iface->config.rma.max_bcopy, "get_bcopy");
+
+    conn = uct_tcp_ep_tx_conn(ep, 0);
+    if (conn == NULL) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    status = uct_tcp_ep_get_req_send(iface, ep, conn, NULL, 0, length,
+                                     unpack_cb, arg, remote_addr,
+                                     uct_tcp_ep_rkey_id(rkey, length), comp);
+    UCT_TL_EP_STAT_OP_IF_SUCCESS(status, &ep->super, GET, BCOPY, length);
+    return status;
+}
+
+ucs_status_t uct_tcp_ep_get_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
+                                  size_t iovcnt, uint64_t remote_addr,
+                                  uct_rkey_t rkey, uct_completion_t *comp)
+{
+    uct_tcp_ep_t *ep       = ucs_derived_of(uct_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(uct_ep->iface, uct_tcp_iface_t);
+    size_t length          = uct_iov_total_length(iov, iovcnt);
+    ucs_status_t status;
+    uct_tcp_ep_t *conn;
+
+    UCT_CHECK_IOV_SIZE(iovcnt, iface->config.zcopy.max_iov,
+                       "uct_tcp_ep_get_zcopy");
+    UCT_CHECK_LENGTH(length, 0, iface->config.rma.max_zcopy, "get_zcopy");
+
+    conn = uct_tcp_ep_tx_conn(ep, 0);
+    if (conn == NULL) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    status = uct_tcp_ep_get_req_send(iface, ep, conn, iov, iovcnt, length,
+                                     NULL, NULL, remote_addr,
+                                     uct_tcp_ep_rkey_id(rkey, length), comp);
+    UCT_TL_EP_STAT_OP_IF_SUCCESS(status, &ep->super, GET, ZCOPY, length);
+    return status;
+}
+
 ucs_status_t uct_tcp_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *req,
                                     unsigned flags)
 {
     uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
 
-    if (uct_tcp_ep_can_send(ep)) {
+    if (uct_tcp_ep_tx_ready(ep)) {
         return UCS_ERR_BUSY;
     }
 
@@ -366,16 +2149,59 @@ void uct_tcp_ep_pending_purge(uct_ep_h tl_ep, uct_pending_purge_callback_t cb,
     uct_pending_queue_purge(priv, &ep->pending_q, 1, cb, arg);
 }
 
+static void uct_tcp_ep_pending_cancel_cb(uct_pending_req_t *req, void *arg)
+{
+    ucs_debug("tcp_ep %p: cancelling pending request %p", arg, req);
+}
+
 ucs_status_t uct_tcp_ep_flush(uct_ep_h tl_ep, unsigned flags,
                               uct_completion_t *comp)
 {
-    uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+    uct_tcp_ep_t *ep       = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_tcp_iface_t);
+    int comp_used          = 0;
+    ucs_status_t status;
+    uct_tcp_ep_t *conn;
+
+    if (ucs_unlikely(flags & UCT_FLUSH_FLAG_CANCEL)) {
+        /* Data already passed to the socket can't be taken back, so only the
+         * operations which were not started are dropped */
+        uct_tcp_ep_pending_purge(tl_ep, uct_tcp_ep_pending_cancel_cb, ep);
+        return UCS_OK;
+    }
+
+    if ((ep->flags & UCT_TCP_EP_FLAG_PUT_UNACKED) ||
+        ((comp != NULL) && !ucs_queue_is_empty(&ep->get_q))) {
+        conn = uct_tcp_ep_tx_conn(ep, 0);
+        if (conn == NULL) {
+            return UCS_ERR_NO_RESOURCE;
+        }
+
+        /* The peer handles requests in order, also across the connections of
+         * the endpoint, so the response to an empty get means that all
+         * previous operations were completed */
+        status = uct_tcp_ep_get_req_send(iface, ep, conn, NULL, 0, 0, NULL,
+                                         NULL, 0, 0, comp);
+        if (status != UCS_INPROGRESS) {
+            return status;
+        }
 
-    if (!uct_tcp_ep_can_send(ep)) {
+        ep->flags &= ~UCT_TCP_EP_FLAG_PUT_UNACKED;
+        comp_used  = 1;
+    } else if (!uct_tcp_ep_tx_idle(ep)) {
         return UCS_ERR_NO_RESOURCE;
+    } else if (ucs_queue_is_empty(&ep->get_q) && uct_tcp_ep_zcopy_idle(ep)) {
+        UCT_TL_EP_STAT_FLUSH(&ep->super);
+        return UCS_OK;
     }
 
-    UCT_TL_EP_STAT_FLUSH(&ep->super);
-    return UCS_OK;
-}
+    if (comp != NULL) {
+        status = uct_tcp_ep_zcopy_flush(iface, ep, comp, comp_used);
+        if (status != UCS_OK) {
+            return status;
+        }
+    }
 
+    UCT_TL_EP_STAT_FLUSH_WAIT(&ep->super);
+    return UCS_INPROGRESS;
+}
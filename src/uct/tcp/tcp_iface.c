@@ -31,6 +31,20 @@ static ucs_config_field_t uct_tcp_iface_config_table[] = {
    "Number of times to poll on a ready socket. 0 - no polling, -1 - until drained",
    ucs_offsetof(uct_tcp_iface_config_t, max_poll), UCS_CONFIG_TYPE_UINT},
 
+  {"CONNS_PER_EP", "1",
+   "Number of TCP connections opened by each endpoint. Operations are spread\n"
+   "over the connections, and the receiver handles them in the original order.\n"
+   "Using several connections allows a single endpoint to exceed the bandwidth\n"
+   "of one TCP flow.",
+   ucs_offsetof(uct_tcp_iface_config_t, conns_per_ep), UCS_CONFIG_TYPE_UINT},
+
+  {"DIRECT_POLL", "0",
+   "Number of progress calls which receive directly from the recently active\n"
+   "endpoints, before checking all sockets with epoll_wait. This saves a system\n"
+   "call per message when the traffic goes over a few endpoints. 0 - always\n"
+   "use epoll_wait.",
+   ucs_offsetof(uct_tcp_iface_config_t, direct_poll), UCS_CONFIG_TYPE_UINT},
+
   {"NODELAY", "y",
    "Set TCP_NODELAY socket option to disable Nagle algorithm. Setting this\n"
    "option usually provides better performance",
@@ -40,6 +54,38 @@ static ucs_config_field_t uct_tcp_iface_config_table[] = {
    "Socket send buffer size.",
    ucs_offsetof(uct_tcp_iface_config_t, sockopt_sndbuf), UCS_CONFIG_TYPE_MEMUNITS},
 
+  {"BUSY_POLL", "0",
+   "Set SO_BUSY_POLL socket option to the given number of microseconds, to let\n"
+   "the kernel busy poll the device queue when a socket has no data. Increasing\n"
+   "it above net.core.busy_read requires CAP_NET_ADMIN. 0 - do not set.",
+   ucs_offsetof(uct_tcp_iface_config_t, sockopt_busy_poll), UCS_CONFIG_TYPE_UINT},
+
+  {"ZEROCOPY_THRESH", "inf",
+   "Minimal size of a zcopy operation to send with MSG_ZEROCOPY, so the kernel\n"
+   "transmits the data from the user pages without copying them to the socket.\n"
+   "Such operation completes only when the kernel reports that it released the\n"
+   "pages, which is costly for small messages. \"inf\" - never use MSG_ZEROCOPY.",
+   ucs_offsetof(uct_tcp_iface_config_t, zerocopy_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
+  {"COALESCE_SIZE", "0",
+   "Aggregate consecutive short and bcopy active messages on an endpoint, and\n"
+   "send them to the socket together when their total size reaches this value,\n"
+   "on the next progress call, or on flush. This saves a system call per small\n"
+   "message without the delay of the kernel Nagle algorithm. 0 - send each\n"
+   "message immediately.",
+   ucs_offsetof(uct_tcp_iface_config_t, coalesce_size), UCS_CONFIG_TYPE_MEMUNITS},
+
+  {"SHM_SIZE", "0",
+   "Size of a shared memory buffer to create for each connection to a peer on\n"
+   "the same host. The bulk data of active messages and put operations is\n"
+   "passed through the buffer, and the TCP connection carries only the control\n"
+   "messages. The buffer is used only if the peer enabled this option as well.\n"
+   "0 - send all data over the TCP connection.",
+   ucs_offsetof(uct_tcp_iface_config_t, shm_size), UCS_CONFIG_TYPE_MEMUNITS},
+
+  UCT_IFACE_MPOOL_CONFIG_FIELDS("RX_", -1, 0, "receive",
+                                ucs_offsetof(uct_tcp_iface_config_t, rx_mpool), ""),
+
   {NULL}
 };
 
@@ -48,9 +94,11 @@ static UCS_CLASS_DEFINE_DELETE_FUNC(uct_tcp_iface_t, uct_iface_t);
 static ucs_status_t uct_tcp_iface_get_device_address(uct_iface_h tl_iface,
                                                      uct_device_addr_t *addr)
 {
-    uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+    uct_tcp_iface_t *iface             = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+    uct_tcp_device_addr_t *device_addr = (uct_tcp_device_addr_t*)addr;
 
-    *(struct in_addr*)addr = iface->config.ifaddr.sin_addr;
+    device_addr->in_addr = iface->config.ifaddr.sin_addr;
+    device_addr->host_id = iface->config.host_id;
     return UCS_OK;
 }
 
@@ -67,13 +115,23 @@ static int uct_tcp_iface_is_reachable(const uct_iface_h tl_iface,
                                       const uct_iface_addr_t *iface_addr)
 {
     uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
-    const in_addr_t *remote_inaddr = (const in_addr_t*)dev_addr;
+    const uct_tcp_device_addr_t *device_addr = (const uct_tcp_device_addr_t*)
+                                               dev_addr;
     in_addr_t netmask = iface->config.netmask.sin_addr.s_addr;
 
-    return (*remote_inaddr & netmask) ==
+    /* The host identifier only selects the shared memory path, so peers on the
+     * same host must still be on the same subnet */
+    return (device_addr->in_addr.s_addr & netmask) ==
            (iface->config.ifaddr.sin_addr.s_addr & netmask);
 }
 
+int uct_tcp_iface_is_same_host(uct_tcp_iface_t *iface,
+                               const uct_device_addr_t *dev_addr)
+{
+    return ((const uct_tcp_device_addr_t*)dev_addr)->host_id ==
+           iface->config.host_id;
+}
+
 static ucs_status_t uct_tcp_iface_query(uct_iface_h tl_iface, uct_iface_attr_t *attr)
 {
     uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
@@ -82,17 +140,42 @@ static ucs_status_t uct_tcp_iface_query(uct_iface_h tl_iface, uct_iface_attr_t *
 
     memset(attr, 0, sizeof(*attr));
     attr->iface_addr_len   = sizeof(in_port_t);
-    attr->device_addr_len  = sizeof(struct in_addr);
-    attr->cap.flags        = UCT_IFACE_FLAG_CONNECT_TO_IFACE |
-                             UCT_IFACE_FLAG_AM_SHORT         |
-                             UCT_IFACE_FLAG_AM_BCOPY         |
-                             UCT_IFACE_FLAG_PENDING          |
-                             UCT_IFACE_FLAG_CB_SYNC          |
-                             UCT_IFACE_FLAG_EVENT_SEND_COMP  |
+    attr->device_addr_len  = sizeof(uct_tcp_device_addr_t);
+    attr->cap.flags        = UCT_IFACE_FLAG_CONNECT_TO_IFACE       |
+                             UCT_IFACE_FLAG_AM_SHORT               |
+                             UCT_IFACE_FLAG_AM_BCOPY               |
+                             UCT_IFACE_FLAG_AM_ZCOPY               |
+                             UCT_IFACE_FLAG_PUT_SHORT              |
+                             UCT_IFACE_FLAG_PUT_BCOPY              |
+                             UCT_IFACE_FLAG_PUT_ZCOPY              |
+                             UCT_IFACE_FLAG_GET_BCOPY              |
+                             UCT_IFACE_FLAG_GET_ZCOPY              |
+                             UCT_IFACE_FLAG_PENDING                |
+                             UCT_IFACE_FLAG_CB_SYNC                |
+                             UCT_IFACE_FLAG_ERRHANDLE_PEER_FAILURE |
+                             UCT_IFACE_FLAG_EVENT_SEND_COMP        |
                              UCT_IFACE_FLAG_EVENT_RECV;
 
     attr->cap.am.max_bcopy = iface->config.buf_size - sizeof(uct_tcp_am_hdr_t);
     attr->cap.am.max_short = iface->config.short_size - sizeof(uct_tcp_am_hdr_t);
+    attr->cap.am.max_zcopy = iface->config.buf_size - sizeof(uct_tcp_am_hdr_t);
+    attr->cap.am.max_hdr   = iface->config.zcopy.max_hdr;
+    attr->cap.am.max_iov   = iface->config.zcopy.max_iov;
+    attr->cap.am.opt_zcopy_align = 1;
+    attr->cap.am.align_mtu       = 1;
+
+    attr->cap.put.max_short       = iface->config.rma.max_short;
+    attr->cap.put.max_bcopy       = iface->config.rma.max_bcopy;
+    attr->cap.put.max_zcopy       = iface->config.rma.max_zcopy;
+    attr->cap.put.max_iov         = iface->config.zcopy.max_iov;
+    attr->cap.put.opt_zcopy_align = 1;
+    attr->cap.put.align_mtu       = 1;
+
+    attr->cap.get.max_bcopy       = iface->config.rma.max_bcopy;
+    attr->cap.get.max_zcopy       = iface->config.rma.max_zcopy;
+    attr->cap.get.max_iov         = iface->config.zcopy.max_iov;
+    attr->cap.get.opt_zcopy_align = 1;
+    attr->cap.get.align_mtu       = 1;
 
     status = uct_tcp_netif_caps(iface->if_name, &attr->latency.overhead,
                                 &attr->bandwidth);
@@ -125,34 +208,119 @@ static ucs_status_t uct_tcp_iface_event_fd_get(uct_iface_h tl_iface, int *fd_p)
     return UCS_OK;
 }
 
+/* Remove the endpoint from the active list, and move the cursor of an ongoing
+ * walk over the list past it */
+static void uct_tcp_iface_active_del(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep)
+{
+    if (iface->poll.next == &ep->active_list) {
+        iface->poll.next = ep->active_list.next;
+    }
+    ucs_list_del(&ep->active_list);
+}
+
+/* Move the endpoint to the head of the active list */
+static void uct_tcp_iface_ep_active(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep)
+{
+    uct_tcp_ep_t *last;
+
+    if (ep->flags & UCT_TCP_EP_FLAG_RX_ACTIVE) {
+        uct_tcp_iface_active_del(iface, ep);
+    } else if (iface->poll.active_count == UCT_TCP_MAX_ACTIVE_EPS) {
+        last = ucs_list_tail(&iface->poll.active, uct_tcp_ep_t, active_list);
+        uct_tcp_iface_ep_inactive(iface, last);
+        ++iface->poll.active_count;
+        ep->flags |= UCT_TCP_EP_FLAG_RX_ACTIVE;
+    } else {
+        ++iface->poll.active_count;
+        ep->flags |= UCT_TCP_EP_FLAG_RX_ACTIVE;
+    }
+
+    ucs_list_add_head(&iface->poll.active, &ep->active_list);
+}
+
+void uct_tcp_iface_ep_inactive(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep)
+{
+    if (ep->flags & UCT_TCP_EP_FLAG_RX_ACTIVE) {
+        uct_tcp_iface_active_del(iface, ep);
+        --iface->poll.active_count;
+        ep->flags &= ~UCT_TCP_EP_FLAG_RX_ACTIVE;
+    }
+}
+
+/* Receive from the recently active endpoints without waiting for events */
+static unsigned uct_tcp_iface_poll_active(uct_tcp_iface_t *iface)
+{
+    unsigned count = 0;
+    ucs_list_link_t *elem;
+    uct_tcp_ep_t *ep;
+
+    /* Receiving may destroy any endpoint, including the next one in the list,
+     * so the next element is kept on the iface and updated on removal */
+    for (elem = iface->poll.active.next; elem != &iface->poll.active;
+         elem = iface->poll.next) {
+        ep               = ucs_container_of(elem, uct_tcp_ep_t, active_list);
+        iface->poll.next = elem->next;
+        /* Blocked and failed connections are not read until they are ready */
+        if (ep->events & EPOLLIN) {
+            count += uct_tcp_ep_progress_rx(ep);
+        }
+    }
+
+    iface->poll.next = NULL;
+    return count;
+}
+
 unsigned uct_tcp_iface_progress(uct_iface_h tl_iface)
 {
     uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
     struct epoll_event events[UCT_TCP_MAX_EVENTS];
-    uct_tcp_ep_t *ep;
-    unsigned count;
+    uct_tcp_ep_t *ep, *tmp;
+    unsigned count, rx_count;
     int i, nevents;
     int max_events;
 
     ucs_trace_poll("iface=%p", iface);
 
-    max_events = ucs_min(UCT_TCP_MAX_EVENTS, iface->config.max_poll);
+    count = 0;
+    ucs_list_for_each_safe(ep, tmp, &iface->tx_coalesced, coalesce_list) {
+        uct_tcp_ep_tx_push(ep);
+        ++count;
+    }
+
+    /* Other sockets, and send completions, are checked every few calls */
+    if ((iface->poll.direct < iface->config.direct_poll) &&
+        !ucs_list_is_empty(&iface->poll.active)) {
+        ++iface->poll.direct;
+        return count + uct_tcp_iface_poll_active(iface);
+    }
+
+    iface->poll.direct = 0;
+    max_events         = ucs_min(UCT_TCP_MAX_EVENTS, iface->config.max_poll);
     nevents = epoll_wait(iface->epfd, events, max_events, 0);
     if ((nevents < 0) && (errno != EINTR)) {
         ucs_error("epoll_wait(epfd=%d max=%d) failed: %m", iface->epfd,
                   max_events);
-        return 0;
+        return count;
     }
 
-    count = 0;
     for (i = 0; i < nevents; ++i) {
         ep = events[i].data.ptr;
-        if (events[i].events & EPOLLIN) {
-            count += uct_tcp_ep_progress_rx(ep);
+        /* MSG_ZEROCOPY completions are reported on the socket error queue */
+        if (events[i].events & EPOLLERR) {
+            count += uct_tcp_ep_progress_zcopy(ep);
         }
+        /* Send first, since receive may destroy the endpoint on disconnect */
         if (events[i].events & EPOLLOUT) {
             count += uct_tcp_ep_progress_tx(ep);
         }
+        if (events[i].events & EPOLLIN) {
+            rx_count = uct_tcp_ep_progress_rx(ep);
+            /* The endpoint was not destroyed if it received some data */
+            if ((rx_count > 0) && (iface->config.direct_poll > 0)) {
+                uct_tcp_iface_ep_active(iface, ep);
+            }
+            count += rx_count;
+        }
     }
     return count;
 }
@@ -161,6 +329,8 @@ static ucs_status_t uct_tcp_iface_flush(uct_iface_h tl_iface, unsigned flags,
                                         uct_completion_t *comp)
 {
     uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+    ucs_status_t status    = UCS_OK;
+    uct_tcp_ep_t *ep;
 
     if (comp != NULL) {
         return UCS_ERR_UNSUPPORTED;
@@ -171,10 +341,87 @@ static ucs_status_t uct_tcp_iface_flush(uct_iface_h tl_iface, unsigned flags,
         return UCS_INPROGRESS;
     }
 
+    /* Wait for remote completion of put and get operations */
+    UCS_ASYNC_BLOCK(iface->super.worker->async);
+    ucs_list_for_each(ep, &iface->ep_list, list) {
+        /* Additional connections are flushed by their endpoint */
+        if (ep->tx.lead != ep) {
+            continue;
+        }
+
+        if (uct_tcp_ep_flush(&ep->super.super, 0, NULL) != UCS_OK) {
+            status = UCS_INPROGRESS;
+        }
+    }
+    UCS_ASYNC_UNBLOCK(iface->super.worker->async);
+
+    if (status != UCS_OK) {
+        UCT_TL_IFACE_STAT_FLUSH_WAIT(&iface->super);
+        return status;
+    }
+
     UCT_TL_IFACE_STAT_FLUSH(&iface->super);
     return UCS_OK;
 }
 
+/* Find the shared buffer which a same-host peer passed with the given
+ * identifier, and receive the buffers which arrived since the last call.
+ * Returns the buffer file descriptor, or -1 if it was not received. */
+int uct_tcp_iface_shm_fd_get(uct_tcp_iface_t *iface, uint64_t id)
+{
+    uct_tcp_shm_fd_t *shm_fd;
+    ucs_status_t status;
+    uint64_t fd_id;
+    int fd;
+
+    if (iface->shm.listen_fd == -1) {
+        return -1;
+    }
+
+    for (;;) {
+        ucs_list_for_each(shm_fd, &iface->shm.fds, list) {
+            if (shm_fd->id == id) {
+                fd = shm_fd->fd;
+                ucs_list_del(&shm_fd->list);
+                ucs_free(shm_fd);
+                return fd;
+            }
+        }
+
+        status = uct_tcp_unix_recv_fd(iface->shm.listen_fd, &fd_id, &fd);
+        if (status == UCS_ERR_NO_PROGRESS) {
+            return -1;
+        } else if (status != UCS_OK) {
+            continue;
+        }
+
+        shm_fd = ucs_malloc(sizeof(*shm_fd), "tcp_shm_fd");
+        if (shm_fd == NULL) {
+            ucs_error("failed to allocate shared buffer descriptor");
+            close(fd);
+            return -1;
+        }
+
+        shm_fd->id = fd_id;
+        shm_fd->fd = fd;
+        ucs_list_add_tail(&iface->shm.fds, &shm_fd->list);
+    }
+}
+
+static void uct_tcp_iface_shm_cleanup(uct_tcp_iface_t *iface)
+{
+    uct_tcp_shm_fd_t *shm_fd, *tmp;
+
+    ucs_list_for_each_safe(shm_fd, tmp, &iface->shm.fds, list) {
+        close(shm_fd->fd);
+        ucs_free(shm_fd);
+    }
+
+    if (iface->shm.listen_fd != -1) {
+        close(iface->shm.listen_fd);
+    }
+}
+
 static void uct_tcp_iface_listen_close(uct_tcp_iface_t *iface)
 {
     if (iface->listen_fd != -1) {
@@ -218,6 +465,7 @@ static void uct_tcp_iface_connect_handler(int listen_fd, void *arg)
 
 ucs_status_t uct_tcp_iface_set_sockopt(uct_tcp_iface_t *iface, int fd)
 {
+    int optval;
     int ret;
 
     ret = setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (void*)&iface->sockopt.nodelay,
@@ -234,12 +482,38 @@ ucs_status_t uct_tcp_iface_set_sockopt(uct_tcp_iface_t *iface, int fd)
         return UCS_ERR_IO_ERROR;
     }
 
+    if (iface->config.zcopy.thresh != UCS_CONFIG_MEMUNITS_INF) {
+        optval = 1;
+        ret    = setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, (void*)&optval,
+                            sizeof(optval));
+        if (ret < 0) {
+            ucs_warn("Failed to set SO_ZEROCOPY on fd %d, disabling "
+                     "MSG_ZEROCOPY: %m", fd);
+            iface->config.zcopy.thresh = UCS_CONFIG_MEMUNITS_INF;
+        }
+    }
+
+    if (iface->sockopt.busy_poll > 0) {
+        ret = setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL,
+                         (void*)&iface->sockopt.busy_poll, sizeof(int));
+        if (ret < 0) {
+            /* Not fatal, the socket is still usable without busy polling */
+            ucs_warn("Failed to set SO_BUSY_POLL on fd %d: %m", fd);
+        }
+    }
+
     return UCS_OK;
 }
 
 static uct_iface_ops_t uct_tcp_iface_ops = {
     .ep_am_short              = uct_tcp_ep_am_short,
     .ep_am_bcopy              = uct_tcp_ep_am_bcopy,
+    .ep_am_zcopy              = uct_tcp_ep_am_zcopy,
+    .ep_put_short             = uct_tcp_ep_put_short,
+    .ep_put_bcopy             = uct_tcp_ep_put_bcopy,
+    .ep_put_zcopy             = uct_tcp_ep_put_zcopy,
+    .ep_get_bcopy             = uct_tcp_ep_get_bcopy,
+    .ep_get_zcopy             = uct_tcp_ep_get_zcopy,
     .ep_pending_add           = uct_tcp_ep_pending_add,
     .ep_pending_purge         = uct_tcp_ep_pending_purge,
     .ep_flush                 = uct_tcp_ep_flush,
@@ -260,6 +534,26 @@ static uct_iface_ops_t uct_tcp_iface_ops = {
     .iface_is_reachable       = uct_tcp_iface_is_reachable
 };
 
+static void uct_tcp_iface_release_rx_desc(uct_recv_desc_t *self, void *desc)
+{
+    ucs_mpool_put(ucs_container_of(self, uct_tcp_rx_desc_t, release));
+}
+
+static void uct_tcp_iface_rx_desc_init(uct_iface_h tl_iface, void *obj,
+                                       uct_mem_h memh)
+{
+    uct_tcp_rx_desc_t *desc = obj;
+
+    desc->release.cb = uct_tcp_iface_release_rx_desc;
+}
+
+static ucs_mpool_ops_t uct_tcp_op_mpool_ops = {
+    .chunk_alloc   = ucs_mpool_chunk_malloc,
+    .chunk_release = ucs_mpool_chunk_free,
+    .obj_init      = NULL,
+    .obj_cleanup   = NULL
+};
+
 static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
                            const uct_iface_params_t *params,
                            const uct_iface_config_t *tl_config)
@@ -289,13 +583,71 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
     self->outstanding           = 0;
     self->config.buf_size       = config->super.max_bcopy +
                                   sizeof(uct_tcp_am_hdr_t);
-    self->config.short_size     = config->super.max_short +
+    /* Short messages are also copied to the endpoint buffer */
+    self->config.short_size     = ucs_min(config->super.max_short +
+                                          sizeof(uct_tcp_am_hdr_t),
+                                          self->config.buf_size);
+    self->config.zcopy.max_hdr  = self->config.buf_size -
                                   sizeof(uct_tcp_am_hdr_t);
+    self->config.zcopy.max_iov  = ucs_min(UCT_TCP_MAX_IOV,
+                                          ucs_get_max_iov()) - 1;
+    self->config.zcopy.thresh   = config->zerocopy_thresh;
+    self->config.rma.max_short  = self->config.short_size -
+                                  sizeof(uct_tcp_am_hdr_t) -
+                                  sizeof(uct_tcp_put_hdr_t);
+    self->config.rma.max_bcopy  = self->config.buf_size -
+                                  sizeof(uct_tcp_am_hdr_t) -
+                                  sizeof(uct_tcp_put_hdr_t);
+    /* Zero-copy data is sent from the user buffer and received directly to
+     * the destination, so it is limited only by the message length field */
+    self->config.rma.max_zcopy  = UINT32_MAX - sizeof(uct_tcp_put_hdr_t);
+    self->config.rx_headroom    = (params->field_mask &
+                                   UCT_IFACE_PARAM_FIELD_RX_HEADROOM) ?
+                                  params->rx_headroom : 0;
+    /* Leave room for the release descriptor pointer before the headroom */
+    self->config.rx_offset      = sizeof(uct_tcp_rx_desc_t) +
+                                  sizeof(uct_recv_desc_t*) +
+                                  self->config.rx_headroom;
     self->config.prefer_default = config->prefer_default;
     self->config.max_poll       = config->max_poll;
+    self->config.conns_per_ep   = config->conns_per_ep;
+    self->config.direct_poll    = config->direct_poll;
+    self->config.coalesce_size  = config->coalesce_size;
+    self->config.shm_size       = config->shm_size;
+    self->config.host_id        = ucs_machine_guid();
     self->sockopt.nodelay       = config->sockopt_nodelay;
     self->sockopt.sndbuf        = config->sockopt_sndbuf;
+    self->sockopt.busy_poll     = config->sockopt_busy_poll;
+    self->poll.active_count     = 0;
+    self->poll.direct           = 0;
     ucs_list_head_init(&self->ep_list);
+    ucs_list_head_init(&self->rx_groups);
+    ucs_list_head_init(&self->tx_coalesced);
+    ucs_list_head_init(&self->shm.fds);
+    self->shm.listen_fd         = -1;
+    ucs_list_head_init(&self->poll.active);
+    self->poll.next             = NULL;
+
+    if (config->super.max_bcopy > UINT32_MAX - sizeof(uct_tcp_am_hdr_t)) {
+        ucs_error("TCP maximal bcopy size %zu is too large",
+                  config->super.max_bcopy);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    if (config->coalesce_size == UCS_CONFIG_MEMUNITS_INF) {
+        ucs_error("TCP coalescing size must be finite");
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    if (config->shm_size == UCS_CONFIG_MEMUNITS_INF) {
+        ucs_error("TCP shared memory size must be finite");
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    if (self->config.conns_per_ep == 0) {
+        ucs_error("number of connections per endpoint must be positive");
+        return UCS_ERR_INVALID_PARAM;
+    }
 
     if (ucs_derived_of(worker, uct_priv_worker_t)->thread_mode == UCS_THREAD_MODE_MULTI) {
         ucs_error("TCP transport does not support multi-threaded worker");
@@ -308,10 +660,36 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
         goto err;
     }
 
+    status = uct_iface_mpool_init(&self->super, &self->rx_mpool,
+                                  self->config.rx_offset +
+                                  UCT_TCP_IFACE_RX_BUF_SIZE(self),
+                                  self->config.rx_offset,
+                                  UCS_SYS_CACHE_LINE_SIZE, &config->rx_mpool,
+                                  16, uct_tcp_iface_rx_desc_init,
+                                  "tcp_recv_desc");
+    if (status != UCS_OK) {
+        goto err;
+    }
+
+    status = ucs_mpool_init(&self->get_mpool, 0, sizeof(uct_tcp_get_op_t), 0,
+                            1, 128, UINT_MAX, &uct_tcp_op_mpool_ops,
+                            "tcp_get_ops");
+    if (status != UCS_OK) {
+        goto err_cleanup_rx_mpool;
+    }
+
+    status = ucs_mpool_init(&self->zcopy_mpool, 0, sizeof(uct_tcp_zcopy_op_t),
+                            0, 1, 128, UINT_MAX, &uct_tcp_op_mpool_ops,
+                            "tcp_zcopy_ops");
+    if (status != UCS_OK) {
+        goto err_cleanup_get_mpool;
+    }
+
     self->epfd = epoll_create(1);
     if (self->epfd < 0) {
         ucs_error("epoll_create() failed: %m");
-        goto err;
+        status = UCS_ERR_IO_ERROR;
+        goto err_cleanup_zcopy_mpool;
     }
 
     /* Create the server socket for accepting incoming connections */
@@ -355,6 +733,16 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
     ucs_debug("tcp_iface %p: listening for connections on %s:%d", self,
               inet_ntoa(bind_addr.sin_addr), ntohs(bind_addr.sin_port));
 
+    /* Same-host peers pass their shared buffers to a unix domain socket, which
+     * is read when they tell about the buffer on the TCP connection */
+    if (self->config.shm_size > 0) {
+        status = uct_tcp_unix_listen(&self->config.ifaddr,
+                                     &self->shm.listen_fd);
+        if (status != UCS_OK) {
+            goto err_close_sock;
+        }
+    }
+
     /* Register event handler for incoming connections */
     status = ucs_async_set_event_handler(self->super.worker->async->mode,
                                          self->listen_fd, POLLIN|POLLERR,
@@ -367,17 +755,24 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
     return UCS_OK;
 
 err_close_sock:
+    uct_tcp_iface_shm_cleanup(self);
     close(self->listen_fd);
 err_close_epfd:
     close(self->epfd);
+err_cleanup_zcopy_mpool:
+    ucs_mpool_cleanup(&self->zcopy_mpool, 1);
+err_cleanup_get_mpool:
+    ucs_mpool_cleanup(&self->get_mpool, 1);
+err_cleanup_rx_mpool:
+    ucs_mpool_cleanup(&self->rx_mpool, 1);
 err:
     return status;
 }
 
 static UCS_CLASS_CLEANUP_FUNC(uct_tcp_iface_t)
 {
-    uct_tcp_ep_t *ep, *tmp;
     ucs_status_t status;
+    uct_tcp_ep_t *ep;
 
     ucs_debug("tcp_iface %p: destroying", self);
 
@@ -389,12 +784,19 @@ static UCS_CLASS_CLEANUP_FUNC(uct_tcp_iface_t)
         ucs_warn("failed to remove handler for server socket fd=%d", self->listen_fd);
     }
 
-    ucs_list_for_each_safe(ep, tmp, &self->ep_list, list) {
-        uct_tcp_ep_destroy(&ep->super.super);
+    /* Destroying an endpoint also removes its additional connections */
+    while (!ucs_list_is_empty(&self->ep_list)) {
+        ep = ucs_list_head(&self->ep_list, uct_tcp_ep_t, list);
+        uct_tcp_ep_destroy(&ep->tx.lead->super.super);
     }
+    ucs_assert(ucs_list_is_empty(&self->rx_groups));
 
     uct_tcp_iface_listen_close(self);
+    uct_tcp_iface_shm_cleanup(self);
     close(self->epfd);
+    ucs_mpool_cleanup(&self->zcopy_mpool, 1);
+    ucs_mpool_cleanup(&self->get_mpool, 1);
+    ucs_mpool_cleanup(&self->rx_mpool, 1);
 }
 
 UCS_CLASS_DEFINE(uct_tcp_iface_t, uct_base_iface_t);
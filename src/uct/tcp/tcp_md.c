@@ -6,48 +6,201 @@
 #include "tcp.h"
 
 
+__KHASH_IMPL(uct_tcp_md_keys, static UCS_F_MAYBE_UNUSED inline, uint64_t,
+             uct_tcp_key_t*, 1, kh_int64_hash_func, kh_int64_hash_equal)
+
+
 static ucs_status_t uct_tcp_md_query(uct_md_h md, uct_md_attr_t *attr)
 {
-    attr->cap.flags         = 0;
+    /* Memory registration only records the region, to provide remote keys */
+    attr->cap.flags         = UCT_MD_FLAG_REG | UCT_MD_FLAG_NEED_RKEY;
     attr->cap.max_alloc     = 0;
-    attr->cap.reg_mem_types = 0;
-    attr->cap.mem_type      = 0;
-    attr->cap.max_reg       = 0;
-    attr->rkey_packed_size  = 0;
-    attr->reg_cost.overhead = 0;
+    attr->cap.reg_mem_types = UCS_BIT(UCT_MD_MEM_TYPE_HOST);
+    attr->cap.mem_type      = UCT_MD_MEM_TYPE_HOST;
+    attr->cap.max_reg       = ULONG_MAX;
+    attr->rkey_packed_size  = sizeof(uct_tcp_key_t);
+    attr->reg_cost.overhead = 9e-9;
     attr->reg_cost.growth   = 0;
     memset(&attr->local_cpus, 0xff, sizeof(attr->local_cpus));
     return UCS_OK;
 }
 
+static ucs_status_t uct_tcp_mem_reg(uct_md_h uct_md, void *address,
+                                    size_t length, unsigned flags,
+                                    uct_mem_h *memh_p)
+{
+    uct_tcp_md_t *md = ucs_derived_of(uct_md, uct_tcp_md_t);
+    uct_tcp_key_t *key;
+    khiter_t iter;
+    int ret;
+
+    key = ucs_malloc(sizeof(*key), "uct_tcp_key_t");
+    if (key == NULL) {
+        ucs_error("failed to allocate memory for uct_tcp_key_t");
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    key->address = (uintptr_t)address;
+    key->length  = length;
+
+    ucs_spin_lock(&md->lock);
+    key->id = md->next_id++;
+    iter    = kh_put(uct_tcp_md_keys, &md->keys, key->id, &ret);
+    if (ret == -1) {
+        ucs_spin_unlock(&md->lock);
+        ucs_error("failed to add memory registration to the hash");
+        ucs_free(key);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    ucs_assert(ret != 0);
+    kh_value(&md->keys, iter) = key;
+    ucs_spin_unlock(&md->lock);
+
+    *memh_p = key;
+    return UCS_OK;
+}
+
+static ucs_status_t uct_tcp_mem_dereg(uct_md_h uct_md, uct_mem_h memh)
+{
+    uct_tcp_md_t *md   = ucs_derived_of(uct_md, uct_tcp_md_t);
+    uct_tcp_key_t *key = memh;
+    khiter_t iter;
+
+    ucs_spin_lock(&md->lock);
+    iter = kh_get(uct_tcp_md_keys, &md->keys, key->id);
+    ucs_assert(iter != kh_end(&md->keys));
+    kh_del(uct_tcp_md_keys, &md->keys, iter);
+    ucs_spin_unlock(&md->lock);
+
+    ucs_free(key);
+    return UCS_OK;
+}
+
+/* Remote peers may access only the memory which was registered */
+ucs_status_t uct_tcp_md_check_access(uct_tcp_md_t *md, uint64_t key_id,
+                                     uint64_t address, size_t length)
+{
+    ucs_status_t status = UCS_ERR_INVALID_ADDR;
+    uct_tcp_key_t *key;
+    khiter_t iter;
+
+    if (length == 0) {
+        return UCS_OK;
+    }
+
+    ucs_spin_lock(&md->lock);
+    iter = kh_get(uct_tcp_md_keys, &md->keys, key_id);
+    if (iter != kh_end(&md->keys)) {
+        key = kh_value(&md->keys, iter);
+        if ((address >= key->address) &&
+            (length <= key->length) &&
+            (address - key->address <= key->length - length)) {
+            status = UCS_OK;
+        }
+    }
+    ucs_spin_unlock(&md->lock);
+
+    return status;
+}
+
+static ucs_status_t uct_tcp_rkey_pack(uct_md_h md, uct_mem_h memh,
+                                      void *rkey_buffer)
+{
+    uct_tcp_key_t *packed = rkey_buffer;
+    uct_tcp_key_t *key    = memh;
+
+    *packed = *key;
+    ucs_trace("packed rkey: address 0x%"PRIx64" length %"PRIu64" id %"PRIu64,
+              key->address, key->length, key->id);
+    return UCS_OK;
+}
+
+static ucs_status_t uct_tcp_rkey_unpack(uct_md_component_t *mdc,
+                                        const void *rkey_buffer,
+                                        uct_rkey_t *rkey_p, void **handle_p)
+{
+    const uct_tcp_key_t *packed = rkey_buffer;
+    uct_tcp_key_t *key;
+
+    key = ucs_malloc(sizeof(*key), "uct_tcp_key_t");
+    if (key == NULL) {
+        ucs_error("failed to allocate memory for uct_tcp_key_t");
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    *key      = *packed;
+    *handle_p = NULL;
+    *rkey_p   = (uintptr_t)key;
+    ucs_trace("unpacked rkey: key %p address 0x%"PRIx64" length %"PRIu64,
+              key, key->address, key->length);
+    return UCS_OK;
+}
+
+static ucs_status_t uct_tcp_rkey_release(uct_md_component_t *mdc,
+                                         uct_rkey_t rkey, void *handle)
+{
+    ucs_assert(handle == NULL);
+    ucs_free((void*)rkey);
+    return UCS_OK;
+}
+
 static ucs_status_t uct_tcp_query_md_resources(uct_md_resource_desc_t **resources_p,
                                                 unsigned *num_resources_p)
 {
     return uct_single_md_resource(&uct_tcp_md, resources_p, num_resources_p);
 }
 
+static void uct_tcp_md_close(uct_md_h uct_md)
+{
+    uct_tcp_md_t *md = ucs_derived_of(uct_md, uct_tcp_md_t);
+
+    if (kh_size(&md->keys) != 0) {
+        ucs_debug("tcp md %p: %u memory registrations were not released", md,
+                  kh_size(&md->keys));
+    }
+
+    kh_destroy_inplace(uct_tcp_md_keys, &md->keys);
+    ucs_spinlock_destroy(&md->lock);
+    ucs_free(md);
+}
+
 static ucs_status_t uct_tcp_md_open(const char *md_name, const uct_md_config_t *md_config,
                                     uct_md_h *md_p)
 {
     static uct_md_ops_t md_ops = {
-        .close        = ucs_empty_function,
+        .close        = uct_tcp_md_close,
         .query        = uct_tcp_md_query,
-        .mkey_pack    = ucs_empty_function_return_unsupported,
-        .mem_reg      = ucs_empty_function_return_unsupported,
-        .mem_dereg    = ucs_empty_function_return_unsupported,
+        .mkey_pack    = uct_tcp_rkey_pack,
+        .mem_reg      = uct_tcp_mem_reg,
+        .mem_dereg    = uct_tcp_mem_dereg,
         .is_mem_type_owned = (void *)ucs_empty_function_return_zero,
     };
-    static uct_md_t md = {
-        .ops          = &md_ops,
-        .component    = &uct_tcp_md
-    };
+    uct_tcp_md_t *md;
+    ucs_status_t status;
+
+    md = ucs_malloc(sizeof(*md), "uct_tcp_md_t");
+    if (md == NULL) {
+        ucs_error("failed to allocate memory for uct_tcp_md_t");
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    status = ucs_spinlock_init(&md->lock);
+    if (status != UCS_OK) {
+        ucs_free(md);
+        return status;
+    }
+
+    md->super.ops       = &md_ops;
+    md->super.component = &uct_tcp_md;
+    md->next_id         = 1;
+    kh_init_inplace(uct_tcp_md_keys, &md->keys);
 
-    *md_p = &md;
+    *md_p = &md->super;
     return UCS_OK;
 }
 
 UCT_MD_COMPONENT_DEFINE(uct_tcp_md, UCT_TCP_NAME,
                         uct_tcp_query_md_resources, uct_tcp_md_open, NULL,
-                        ucs_empty_function_return_unsupported,
-                        ucs_empty_function_return_success, "TCP_",
+                        uct_tcp_rkey_unpack, uct_tcp_rkey_release, "TCP_",
                         uct_md_config_table, uct_md_config_t);
@@ -18,6 +18,7 @@
 #include <linux/types.h>
 #include <linux/ethtool.h>
 #include <linux/if_ether.h>
+#include <linux/errqueue.h>
 #include <sys/ioctl.h>
 #include <net/if_arp.h>
 #include <net/if.h>
@@ -184,13 +185,9 @@ ucs_status_t uct_tcp_netif_is_default(const char *if_name, int *result_p)
     return UCS_OK;
 }
 
-static ucs_status_t uct_tcp_do_io(int fd, void *data, size_t *length_p,
-                                  uct_tcp_io_func_t io_func, const char *name)
+static ucs_status_t uct_tcp_io_status(int fd, ssize_t ret, size_t *length_p,
+                                      const char *name)
 {
-    ssize_t ret;
-
-    ucs_assert(*length_p > 0);
-    ret = io_func(fd, data, *length_p, MSG_NOSIGNAL);
     if (ret == 0) {
         ucs_trace("fd %d is closed", fd);
         return UCS_ERR_CANCELED; /* Connection closed */
@@ -199,8 +196,7 @@ static ucs_status_t uct_tcp_do_io(int fd, void *data, size_t *length_p,
             *length_p = 0;
             return UCS_OK;
         } else {
-            ucs_error("%s(fd=%d data=%p length=%zu) failed: %m",
-                      name, fd, data, *length_p);
+            ucs_error("%s(fd=%d length=%zu) failed: %m", name, fd, *length_p);
             return UCS_ERR_IO_ERROR;
         }
     } else {
@@ -209,13 +205,248 @@ static ucs_status_t uct_tcp_do_io(int fd, void *data, size_t *length_p,
     }
 }
 
+static ucs_status_t uct_tcp_do_io(int fd, void *data, size_t *length_p,
+                                  uct_tcp_io_func_t io_func, const char *name)
+{
+    ssize_t ret;
+
+    ucs_assert(*length_p > 0);
+    ret = io_func(fd, data, *length_p, MSG_NOSIGNAL);
+    return uct_tcp_io_status(fd, ret, length_p, name);
+}
+
 ucs_status_t uct_tcp_send(int fd, const void *data, size_t *length_p)
 {
     return uct_tcp_do_io(fd, (void*)data, length_p, (uct_tcp_io_func_t)send,
                          "send");
 }
 
+ucs_status_t uct_tcp_sendv(int fd, const struct iovec *iov, size_t iov_cnt,
+                           int flags, size_t *length_p)
+{
+    struct msghdr msg;
+    ssize_t ret;
+
+    ucs_assert(*length_p > 0);
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov    = (struct iovec*)iov;
+    msg.msg_iovlen = iov_cnt;
+
+    ret = sendmsg(fd, &msg, MSG_NOSIGNAL | flags);
+    if ((ret < 0) && (errno == ENOBUFS) && (flags & MSG_ZEROCOPY)) {
+        /* Too many zero-copy sends wait for completion, retry later */
+        *length_p = 0;
+        return UCS_OK;
+    }
+
+    return uct_tcp_io_status(fd, ret, length_p, "sendmsg");
+}
+
+/* Read the socket error queue until a MSG_ZEROCOPY completion is found, and
+ * return the last send it completes */
+ucs_status_t uct_tcp_recv_zerocopy_done(int fd, uint32_t *sn_p)
+{
+    char control[CMSG_SPACE(sizeof(struct sock_extended_err) +
+                            sizeof(struct sockaddr_in6))];
+    struct sock_extended_err *serr;
+    struct cmsghdr *cmsg;
+    struct msghdr msg;
+    ssize_t ret;
+
+    for (;;) {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof(control);
+
+        ret = recvmsg(fd, &msg, MSG_ERRQUEUE);
+        if (ret < 0) {
+            if ((errno == EINTR) || (errno == EAGAIN)) {
+                return UCS_ERR_NO_PROGRESS;
+            }
+
+            ucs_error("recvmsg(fd=%d, MSG_ERRQUEUE) failed: %m", fd);
+            return UCS_ERR_IO_ERROR;
+        }
+
+        cmsg = CMSG_FIRSTHDR(&msg);
+        if (cmsg == NULL) {
+            continue;
+        }
+
+        serr = (struct sock_extended_err*)CMSG_DATA(cmsg);
+        if ((serr->ee_errno != 0) ||
+            (serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)) {
+            ucs_debug("fd %d: ignoring error queue message origin %d errno %d",
+                      fd, serr->ee_origin, serr->ee_errno);
+            continue;
+        }
+
+        ucs_trace_data("fd %d: zero-copy sends %u..%u completed%s", fd,
+                       serr->ee_info, serr->ee_data,
+                       (serr->ee_code == SO_EE_CODE_ZEROCOPY_COPIED) ?
+                       " by copy" : "");
+        *sn_p = serr->ee_data;
+        return UCS_OK;
+    }
+}
+
 ucs_status_t uct_tcp_recv(int fd, void *data, size_t *length_p)
 {
     return uct_tcp_do_io(fd, data, length_p, recv, "recv");
 }
+
+/* Abstract unix socket name of the interface listening on the given address.
+ * Abstract names are visible only in the same network namespace, so a peer
+ * which can connect to it is on the same host. */
+static void uct_tcp_unix_sockaddr(const struct sockaddr_in *inaddr,
+                                  struct sockaddr_un *addr,
+                                  socklen_t *addrlen_p)
+{
+    int len;
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    len = snprintf(addr->sun_path + 1, sizeof(addr->sun_path) - 1,
+                   "ucx-tcp-%s:%d", inet_ntoa(inaddr->sin_addr),
+                   ntohs(inaddr->sin_port));
+    *addrlen_p = offsetof(struct sockaddr_un, sun_path) + 1 + len;
+}
+
+ucs_status_t uct_tcp_unix_listen(const struct sockaddr_in *inaddr, int *fd_p)
+{
+    struct sockaddr_un addr;
+    socklen_t addrlen;
+    int fd, ret;
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        ucs_error("socket(AF_UNIX) failed: %m");
+        return UCS_ERR_IO_ERROR;
+    }
+
+    uct_tcp_unix_sockaddr(inaddr, &addr, &addrlen);
+    ret = bind(fd, (struct sockaddr*)&addr, addrlen);
+    if (ret < 0) {
+        ucs_error("bind(fd=%d, @%s) failed: %m", fd, addr.sun_path + 1);
+        goto err_close;
+    }
+
+    ret = listen(fd, SOMAXCONN);
+    if (ret < 0) {
+        ucs_error("listen(fd=%d) failed: %m", fd);
+        goto err_close;
+    }
+
+    *fd_p = fd;
+    return UCS_OK;
+
+err_close:
+    close(fd);
+    return UCS_ERR_IO_ERROR;
+}
+
+/* Pass the file descriptor to the interface listening on the given address.
+ * Fails without blocking if the peer does not listen, or is not ready. */
+ucs_status_t uct_tcp_unix_send_fd(const struct sockaddr_in *inaddr, uint64_t id,
+                                  int fd)
+{
+    char control[CMSG_SPACE(sizeof(int))];
+    struct sockaddr_un addr;
+    struct cmsghdr *cmsg;
+    struct msghdr msg;
+    struct iovec iov;
+    socklen_t addrlen;
+    ucs_status_t status;
+    int unix_fd, ret;
+
+    unix_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (unix_fd < 0) {
+        ucs_error("socket(AF_UNIX) failed: %m");
+        return UCS_ERR_IO_ERROR;
+    }
+
+    uct_tcp_unix_sockaddr(inaddr, &addr, &addrlen);
+    ret = connect(unix_fd, (struct sockaddr*)&addr, addrlen);
+    if (ret < 0) {
+        ucs_debug("connect(fd=%d, @%s) failed: %m", unix_fd, addr.sun_path + 1);
+        status = UCS_ERR_UNREACHABLE;
+        goto out;
+    }
+
+    memset(&msg, 0, sizeof(msg));
+    memset(control, 0, sizeof(control));
+    iov.iov_base       = &id;
+    iov.iov_len        = sizeof(id);
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+
+    cmsg             = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type  = SCM_RIGHTS;
+    cmsg->cmsg_len   = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    ret = sendmsg(unix_fd, &msg, MSG_NOSIGNAL);
+    if (ret != sizeof(id)) {
+        ucs_debug("sendmsg(fd=%d, SCM_RIGHTS) failed: %m", unix_fd);
+        status = UCS_ERR_IO_ERROR;
+        goto out;
+    }
+
+    status = UCS_OK;
+
+out:
+    close(unix_fd);
+    return status;
+}
+
+/* Accept the next connection on the unix domain socket, and receive the file
+ * descriptor which the peer passed on it */
+ucs_status_t uct_tcp_unix_recv_fd(int listen_fd, uint64_t *id_p, int *fd_p)
+{
+    char control[CMSG_SPACE(sizeof(int))];
+    struct cmsghdr *cmsg;
+    struct msghdr msg;
+    struct iovec iov;
+    ucs_status_t status;
+    int unix_fd;
+    ssize_t ret;
+
+    unix_fd = accept(listen_fd, NULL, NULL);
+    if (unix_fd < 0) {
+        if ((errno != EAGAIN) && (errno != EINTR)) {
+            ucs_error("accept(fd=%d) failed: %m", listen_fd);
+            return UCS_ERR_IO_ERROR;
+        }
+        return UCS_ERR_NO_PROGRESS;
+    }
+
+    memset(&msg, 0, sizeof(msg));
+    iov.iov_base       = id_p;
+    iov.iov_len        = sizeof(*id_p);
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+
+    /* The peer sends the message right after connecting, before it tells about
+     * the buffer on the TCP connection */
+    ret  = recvmsg(unix_fd, &msg, MSG_CMSG_CLOEXEC);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    if ((ret != sizeof(*id_p)) || (cmsg == NULL) ||
+        (cmsg->cmsg_level != SOL_SOCKET) || (cmsg->cmsg_type != SCM_RIGHTS)) {
+        ucs_error("recvmsg(fd=%d) returned %zd without file descriptor: %m",
+                  unix_fd, ret);
+        status = UCS_ERR_IO_ERROR;
+        goto out;
+    }
+
+    memcpy(fd_p, CMSG_DATA(cmsg), sizeof(int));
+    status = UCS_OK;
+
+out:
+    close(unix_fd);
+    return status;
+}
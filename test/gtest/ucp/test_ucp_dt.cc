@@ -46,3 +46,93 @@ UCS_TEST_F(test_ucp_dt_iov, seek)
         }
     }
 }
+
+class test_ucp_dt_strided : public ucs::test {
+protected:
+    /* offset of the packed byte in the strided buffer */
+    static size_t strided_offset(ucp_datatype_t dt, size_t offset) {
+        return ((offset / ucp_dt_strided_elem_size(dt)) *
+                ucp_dt_strided_stride(dt)) +
+               (offset % ucp_dt_strided_elem_size(dt));
+    }
+};
+
+UCS_TEST_F(test_ucp_dt_strided, gather_scatter)
+{
+    static const size_t elem_sizes[] = {1, 4, 8, 12, 16, 32, 100};
+
+    for (size_t i = 0; i < ucs_static_array_size(elem_sizes); ++i) {
+        size_t elem_size  = elem_sizes[i];
+        size_t stride     = elem_size + (ucs::rand() % 64);
+        size_t count      = (ucs::rand() % 100) + 1;
+        ucp_datatype_t dt;
+
+        ASSERT_UCS_OK(ucp_dt_make_strided(elem_size, stride, count, &dt));
+        size_t length = ucp_dt_strided_length(dt, 2);
+
+        ASSERT_EQ(elem_size, ucp_dt_strided_elem_size(dt));
+        ASSERT_EQ(stride,    ucp_dt_strided_stride(dt));
+        ASSERT_EQ(count,     ucp_dt_strided_count(dt));
+        ASSERT_EQ(2 * count * elem_size, length);
+
+        std::vector<char> strided(ucp_dt_strided_span(dt, length), 0);
+        std::vector<char> packed(length);
+        std::vector<char> unpacked(strided.size(), 0);
+        ucs::fill_random(strided);
+
+        /* pack and unpack in fragments which are not aligned to blocks */
+        size_t offset = 0;
+        while (offset < length) {
+            size_t frag = ucs_min((ucs::rand() % (3 * elem_size)) + 1,
+                                  length - offset);
+            ucp_dt_strided_gather(&packed[offset], &strided[0], dt, offset,
+                                  frag);
+            ucp_dt_strided_scatter(&unpacked[0], dt, &packed[offset], offset,
+                                   frag);
+            offset += frag;
+        }
+
+        for (offset = 0; offset < length; ++offset) {
+            size_t strided_offs = strided_offset(dt, offset);
+            ASSERT_EQ(strided[strided_offs], packed[offset])
+                << "elem_size=" << elem_size << " offset=" << offset;
+            ASSERT_EQ(strided[strided_offs], unpacked[strided_offs])
+                << "elem_size=" << elem_size << " offset=" << offset;
+        }
+
+        /* the gaps between the blocks are not touched */
+        for (size_t j = 0; j < unpacked.size(); ++j) {
+            if ((j % stride) >= elem_size) {
+                ASSERT_EQ(0, unpacked[j]) << "elem_size=" << elem_size
+                                          << " j=" << j;
+            }
+        }
+
+        EXPECT_EQ(count * 2, ucp_dt_strided_block_count(dt, 0, length));
+        EXPECT_EQ(2u, ucp_dt_strided_block_count(dt, elem_size - 1, 2));
+    }
+}
+
+UCS_TEST_F(test_ucp_dt_strided, make_invalid)
+{
+    ucp_datatype_t dt = 0;
+    scoped_log_handler slh(hide_errors_logger);
+
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM, ucp_dt_make_strided(0, 8, 1, &dt));
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM, ucp_dt_make_strided(8, 4, 1, &dt));
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM, ucp_dt_make_strided(8, 8, 0, &dt));
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM,
+              ucp_dt_make_strided(UCS_BIT(UCP_DT_STRIDED_ELEM_SIZE_BITS),
+                                  UCS_BIT(UCP_DT_STRIDED_ELEM_SIZE_BITS), 1,
+                                  &dt));
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM,
+              ucp_dt_make_strided(8, UCS_BIT(UCP_DT_STRIDED_STRIDE_BITS), 1,
+                                  &dt));
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM,
+              ucp_dt_make_strided(8, 8, UCS_BIT(UCP_DT_STRIDED_COUNT_BITS),
+                                  &dt));
+    EXPECT_EQ(0ul, dt);
+
+    ASSERT_UCS_OK(ucp_dt_make_strided(8, 8, 1, &dt));
+    EXPECT_EQ(8ul, ucp_dt_strided_length(dt, 1));
+}
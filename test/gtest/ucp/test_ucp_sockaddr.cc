@@ -83,6 +83,12 @@ public:
         return UCS_LOG_FUNC_RC_CONTINUE;
     }
 
+    /* sockcm can listen on any IP interface, including loopback */
+    bool is_sockcm_enabled() const {
+        std::vector<std::string>::const_iterator end = GetParam().transports.end();
+        return std::find(GetParam().transports.begin(), end, "tcp") != end;
+    }
+
     void get_listen_addr(struct sockaddr_in *listen_addr) {
         struct ifaddrs* ifaddrs;
         int ret = getifaddrs(&ifaddrs);
@@ -91,7 +97,7 @@ public:
         for (struct ifaddrs *ifa = ifaddrs; ifa != NULL; ifa = ifa->ifa_next) {
             if (ucs_netif_is_active(ifa->ifa_name) &&
                 ucs::is_inet_addr(ifa->ifa_addr)   &&
-                ucs::is_rdmacm_netdev(ifa->ifa_name))
+                (ucs::is_rdmacm_netdev(ifa->ifa_name) || is_sockcm_enabled()))
             {
                 *listen_addr = *(struct sockaddr_in*)(void*)ifa->ifa_addr;
                 listen_addr->sin_port = ucs::get_port();
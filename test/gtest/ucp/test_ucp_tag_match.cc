@@ -9,6 +9,12 @@
 
 #include <common/test_helpers.h>
 
+extern "C" {
+#include <ucp/core/ucp_worker.h>
+#include <ucp/core/ucp_ep.inl>
+#include <ucp/tag/tag_match.h>
+}
+
 using namespace ucs; /* For vector<char> serialization */
 
 
@@ -78,6 +84,26 @@ UCS_TEST_P(test_ucp_tag_match, send_recv_unexp) {
     EXPECT_EQ(send_data, recv_data);
 }
 
+UCS_TEST_P(test_ucp_tag_match, unexp_release_on_destroy) {
+    ucp_tag_recv_info_t info;
+    ucp_tag_message_h   message;
+
+    uint64_t send_data = 0xdeadbeefdeadbeef;
+
+    send_b(&send_data, sizeof(send_data), DATATYPE, 0x111337);
+
+    /* Leave the message unexpected. The worker must release its descriptor
+     * when destroyed, otherwise the memory pool cleanup warns about a leak */
+    do {
+        progress();
+        message = ucp_tag_probe_nb(receiver().worker(), 0x1337, 0xffff, 0,
+                                   &info);
+    } while (message == NULL);
+
+    EXPECT_EQ(sizeof(send_data),   info.length);
+    EXPECT_EQ((ucp_tag_t)0x111337, info.sender_tag);
+}
+
 UCS_TEST_P(test_ucp_tag_match, send_recv_unexp_rqfree) {
     if (GetParam().variant == RECV_REQ_EXTERNAL) {
         UCS_TEST_SKIP_R("request free cannot be used for external requests");
@@ -513,6 +539,46 @@ UCS_TEST_P(test_ucp_tag_match, rndv_req_exp, "RNDV_THRESH=1048576") {
     request_release(my_recv_req);
 }
 
+UCS_TEST_P(test_ucp_tag_match, rndv_rkey_ptr, "RNDV_THRESH=1048576",
+           "RNDV_SCHEME=get_zcopy", "RNDV_RKEY_PTR=y", "RNDV_COPY_THREADS=4",
+           "RNDV_COPY_THREAD_SIZE=64k") {
+    static const size_t size = 1148576;
+    request *my_send_req, *my_recv_req;
+
+    std::vector<char> sendbuf(size, 0);
+    std::vector<char> recvbuf(size, 0);
+
+    skip_loopback();
+
+    if (!ucp_ep_config(sender().ep())->tag.rndv.rkey_ptr_md_map) {
+        UCS_TEST_SKIP_R("no memory domain can map the send buffer");
+    }
+
+    /* the receiver copies with the helper threads of its worker */
+    ASSERT_TRUE(receiver().worker()->rndv_copy_pool != NULL);
+
+    for (int i = 0; i < 3; ++i) {
+        ucs::fill_random(sendbuf);
+
+        /* receiver - the RTS is matched to an expected request, and the data
+         * is copied from the mapped send buffer */
+        my_recv_req = recv_nb(&recvbuf[0], recvbuf.size(), DATATYPE, 0x1337,
+                              0xffff);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(my_recv_req));
+
+        my_send_req = send_nb(&sendbuf[0], sendbuf.size(), DATATYPE, 0x111337);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(my_send_req));
+
+        wait(my_recv_req);
+        EXPECT_EQ(sendbuf.size(),      my_recv_req->info.length);
+        EXPECT_EQ((ucp_tag_t)0x111337, my_recv_req->info.sender_tag);
+        EXPECT_EQ(sendbuf, recvbuf);
+
+        wait_and_validate(my_send_req);
+        request_release(my_recv_req);
+    }
+}
+
 UCS_TEST_P(test_ucp_tag_match, rndv_rts_unexp, "RNDV_THRESH=1048576") {
     static const size_t size = 1148576;
     request             *my_send_req;
@@ -640,4 +706,138 @@ UCS_TEST_P(test_ucp_tag_match, rndv_exp_huge_mix) {
     }
 }
 
+UCS_TEST_P(test_ucp_tag_match, many_tags_exp_unexp) {
+    /* enough distinct tags to resize the tag hash tables a few times */
+    const size_t num_tags = 5000 / ucs::test_time_multiplier();
+    std::vector<uint64_t> recvbuf(num_tags, 0);
+    std::vector<request*> rreqs(num_tags);
+    ucp_tag_recv_info_t info;
+    ucs_status_t status;
+    uint64_t sendbuf;
+
+    /* expected - messages arrive in reverse order of posting the receives */
+    for (size_t i = 0; i < num_tags; ++i) {
+        rreqs[i] = recv_nb(&recvbuf[i], sizeof(recvbuf[i]), DATATYPE, i,
+                           UCP_TAG_MASK_FULL);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(rreqs[i]));
+    }
+
+    for (size_t i = num_tags; i > 0; --i) {
+        sendbuf = i - 1;
+        send_b(&sendbuf, sizeof(sendbuf), DATATYPE, i - 1);
+    }
+
+    for (size_t i = 0; i < num_tags; ++i) {
+        wait(rreqs[i]);
+        EXPECT_EQ((ucp_tag_t)i, rreqs[i]->info.sender_tag);
+        EXPECT_EQ(i, recvbuf[i]);
+        request_release(rreqs[i]);
+    }
+
+    /* unexpected - receive in reverse order of arrival */
+    for (size_t i = 0; i < num_tags; ++i) {
+        sendbuf = i;
+        send_b(&sendbuf, sizeof(sendbuf), DATATYPE, i);
+    }
+    short_progress_loop();
+
+    for (size_t i = num_tags; i > 0; --i) {
+        uint64_t value = 0;
+        status = recv_b(&value, sizeof(value), DATATYPE, i - 1,
+                        UCP_TAG_MASK_FULL, &info);
+        ASSERT_UCS_OK(status);
+        EXPECT_EQ(i - 1, info.sender_tag);
+        EXPECT_EQ(i - 1, value);
+    }
+}
+
+UCS_TEST_P(test_ucp_tag_match, many_unexp_wildcard) {
+    const size_t num_msgs = 3000 / ucs::test_time_multiplier();
+    const ucp_tag_t mask  = 0xfull;
+    ucp_tag_recv_info_t info;
+    ucs_status_t status;
+    uint64_t sendbuf, value;
+
+    /* tag of message i is (i << 4) | (i % 16) */
+    for (size_t i = 0; i < num_msgs; ++i) {
+        sendbuf = i;
+        send_b(&sendbuf, sizeof(sendbuf), DATATYPE, (i << 4) | (i % 16));
+    }
+    short_progress_loop();
+
+    /* receive every third message by its full tag, to leave holes */
+    for (size_t i = 0; i < num_msgs; i += 3) {
+        status = recv_b(&value, sizeof(value), DATATYPE, (i << 4) | (i % 16),
+                        UCP_TAG_MASK_FULL, &info);
+        ASSERT_UCS_OK(status);
+        EXPECT_EQ(i, value);
+    }
+
+    /* receive the rest by the low bits of the tag, which should match the
+     * messages in the order of arrival */
+    for (unsigned low = 0; low < 16; ++low) {
+        for (size_t i = low; i < num_msgs; i += 16) {
+            if ((i % 3) == 0) {
+                continue;
+            }
+
+            status = recv_b(&value, sizeof(value), DATATYPE, low, mask, &info);
+            ASSERT_UCS_OK(status);
+            EXPECT_EQ((i << 4) | low, info.sender_tag);
+            EXPECT_EQ(i, value);
+        }
+    }
+
+    EXPECT_TRUE(ucp_tag_unexp_is_empty(&receiver().worker()->tm));
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_match)
+
+
+class test_ucp_tag_match_src : public test_ucp_tag_match {
+public:
+    static ucp_params_t get_ctx_params()
+    {
+        ucp_params_t params    = test_ucp_tag_match::get_ctx_params();
+        params.field_mask     |= UCP_PARAM_FIELD_TAG_SENDER_MASK;
+        params.tag_sender_mask = TAG_SENDER;
+        return params;
+    }
+
+protected:
+    static const ucp_tag_t TAG_SENDER = 0xffff0000ul;
+};
+
+UCS_TEST_P(test_ucp_tag_match_src, exp_order_src_wildcard) {
+    static const size_t num_reqs = 4;
+    const ucp_tag_t src1         = 0x10000ul;
+    const ucp_tag_t src2         = 0x20000ul;
+    /* receives with full tag, any tag of a sender, and any tag of any sender */
+    const ucp_tag_t recv_tags[]  = { src1 | 5, src1, 0, src1 | 5 };
+    const ucp_tag_t recv_masks[] = { UCP_TAG_MASK_FULL, TAG_SENDER, 0,
+                                     UCP_TAG_MASK_FULL };
+    /* every message should match the earliest posted receive which fits it */
+    const ucp_tag_t send_tags[]  = { src1 | 5, src1 | 5, src2 | 7, src1 | 5 };
+    std::vector<uint64_t> recvbuf(num_reqs, 0);
+    request *rreqs[num_reqs];
+
+    for (size_t i = 0; i < num_reqs; ++i) {
+        rreqs[i] = recv_nb(&recvbuf[i], sizeof(recvbuf[i]), DATATYPE,
+                           recv_tags[i], recv_masks[i]);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(rreqs[i]));
+    }
+
+    for (size_t i = 0; i < num_reqs; ++i) {
+        uint64_t sendbuf = i + 1;
+        send_b(&sendbuf, sizeof(sendbuf), DATATYPE, send_tags[i]);
+    }
+
+    for (size_t i = 0; i < num_reqs; ++i) {
+        wait(rreqs[i]);
+        EXPECT_EQ(send_tags[i], rreqs[i]->info.sender_tag);
+        EXPECT_EQ(i + 1, recvbuf[i]);
+        request_release(rreqs[i]);
+    }
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_match_src)
@@ -88,6 +88,11 @@ public:
     void test_xfer_contig(size_t size, bool expected, bool sync, bool truncated);
     void test_xfer_generic(size_t size, bool expected, bool sync, bool truncated);
     void test_xfer_iov(size_t size, bool expected, bool sync, bool truncated);
+    void test_xfer_iov_contig(size_t size, bool expected, bool sync,
+                              bool truncated);
+    void test_xfer_strided(size_t size, bool expected, bool sync, bool truncated);
+    void test_xfer_strided_large(size_t size, bool expected, bool sync,
+                                 bool truncated);
     void test_xfer_generic_err(size_t size, bool expected, bool sync, bool truncated);
 
 protected:
@@ -98,6 +103,11 @@ protected:
                    ucp_datatype_t send_dt, ucp_datatype_t recv_dt,
                    bool expected, bool sync, bool truncated);
 
+    size_t do_xfer(const void *sendbuf, void *recvbuf, size_t send_count,
+                   size_t recv_count, ucp_datatype_t send_dt,
+                   ucp_datatype_t recv_dt, bool expected, bool sync,
+                   bool truncated);
+
     void test_xfer(xfer_func_t func, bool expected, bool sync, bool truncated);
     void test_run_xfer(bool send_contig, bool recv_contig,
                        bool expected, bool sync, bool truncated);
@@ -110,6 +120,9 @@ protected:
 
     void test_xfer_len_offset();
 
+    void test_xfer_strided_dt(size_t size, bool expected, bool sync,
+                              bool truncated, size_t elem_size, size_t stride);
+
 private:
     request* do_send(const void *sendbuf, size_t count, ucp_datatype_t dt, bool sync);
 
@@ -391,6 +404,79 @@ void test_ucp_tag_xfer::test_xfer_iov(size_t size, bool expected, bool sync,
                                "IOV"));
 }
 
+void test_ucp_tag_xfer::test_xfer_iov_contig(size_t size, bool expected,
+                                             bool sync, bool truncated)
+{
+    const size_t iovcnt = 20;
+    std::vector<char> sendbuf(size, 0);
+    std::vector<char> recvbuf(size, 0);
+
+    ucs::fill_random(sendbuf);
+
+    ucp::data_type_desc_t send_dt_desc(DATATYPE_IOV, sendbuf.data(),
+                                       sendbuf.size(), iovcnt);
+
+    size_t recvd = do_xfer(send_dt_desc.buf(), recvbuf.data(),
+                           send_dt_desc.count(), recvbuf.size(), DATATYPE_IOV,
+                           DATATYPE, expected, sync, truncated);
+    if (!truncated) {
+        ASSERT_EQ(sendbuf.size(), recvd);
+    }
+    EXPECT_TRUE(!check_buffers(sendbuf, recvbuf, recvd, send_dt_desc.count(),
+                               1, size, expected, sync, "IOV-contig"));
+}
+
+void test_ucp_tag_xfer::test_xfer_strided_dt(size_t size, bool expected,
+                                             bool sync, bool truncated,
+                                             size_t elem_size, size_t stride)
+{
+    /* the receiver uses a different stride, so the layouts don't match */
+    const size_t recv_stride = stride + 8;
+    size_t count             = size / elem_size;
+
+    /* if count is zero, truncation has no effect */
+    if ((truncated) && (!count)) {
+        truncated = false;
+    }
+
+    std::vector<char> sendbuf(count * stride, 0);
+    std::vector<char> recvbuf(count * recv_stride, 0);
+    ucp_datatype_t send_dt, recv_dt;
+
+    ASSERT_UCS_OK(ucp_dt_make_strided(elem_size, stride, 1, &send_dt));
+    ASSERT_UCS_OK(ucp_dt_make_strided(elem_size, recv_stride, 1, &recv_dt));
+    ucs::fill_random(sendbuf);
+
+    size_t recvd = do_xfer(sendbuf.data(), recvbuf.data(), count, send_dt,
+                           recv_dt, expected, sync, truncated);
+    if (truncated) {
+        return;
+    }
+
+    ASSERT_EQ(count * elem_size, recvd);
+    for (size_t i = 0; i < count; ++i) {
+        if (memcmp(&sendbuf[i * stride], &recvbuf[i * recv_stride],
+                   elem_size)) {
+            ADD_FAILURE() << "strided: block " << i << " differs, size="
+                          << size << " expected=" << expected << " sync="
+                          << sync;
+            break;
+        }
+    }
+}
+
+void test_ucp_tag_xfer::test_xfer_strided(size_t size, bool expected,
+                                          bool sync, bool truncated)
+{
+    test_xfer_strided_dt(size, expected, sync, truncated, 12, 20);
+}
+
+void test_ucp_tag_xfer::test_xfer_strided_large(size_t size, bool expected,
+                                                bool sync, bool truncated)
+{
+    test_xfer_strided_dt(size, expected, sync, truncated, 1000, 1024);
+}
+
 void test_ucp_tag_xfer::test_xfer_generic_err(size_t size, bool expected,
                                               bool sync, bool truncated)
 {
@@ -450,10 +536,19 @@ size_t test_ucp_tag_xfer::do_xfer(const void *sendbuf, void *recvbuf,
                                   size_t count, ucp_datatype_t send_dt,
                                   ucp_datatype_t recv_dt, bool expected,
                                   bool sync, bool truncated)
+{
+    return do_xfer(sendbuf, recvbuf, count, count, send_dt, recv_dt, expected,
+                   sync, truncated);
+}
+
+size_t test_ucp_tag_xfer::do_xfer(const void *sendbuf, void *recvbuf,
+                                  size_t count, size_t recv_count,
+                                  ucp_datatype_t send_dt,
+                                  ucp_datatype_t recv_dt, bool expected,
+                                  bool sync, bool truncated)
 {
     request *rreq, *sreq;
     size_t recvd = 0;
-    size_t recv_count = count;
 
     if (truncated) {
         recv_count /= 2;
@@ -583,6 +678,42 @@ UCS_TEST_P(test_ucp_tag_xfer, iov_unexp) {
     test_xfer(&test_ucp_tag_xfer::test_xfer_iov, false, false, false);
 }
 
+UCS_TEST_P(test_ucp_tag_xfer, iov_contig_exp) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_iov_contig, true, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, iov_contig_exp_truncated) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_iov_contig, true, false, true);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, iov_contig_unexp) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_iov_contig, false, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, iov_contig_unexp_rndv, "RNDV_THRESH=1000") {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_iov_contig, false, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_exp) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, true, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_exp_truncated) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, true, false, true);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_unexp) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, false, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_exp_zcopy, "ZCOPY_THRESH=1000") {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided_large, true, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_unexp_zcopy, "ZCOPY_THRESH=1000") {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided_large, false, false, false);
+}
+
 UCS_TEST_P(test_ucp_tag_xfer, generic_err_exp) {
     test_xfer(&test_ucp_tag_xfer::test_xfer_generic_err, true, false, false);
 }
@@ -645,6 +776,17 @@ UCS_TEST_P(test_ucp_tag_xfer, iov_unexp_sync) {
     test_xfer(&test_ucp_tag_xfer::test_xfer_iov, false, true, false);
 }
 
+UCS_TEST_P(test_ucp_tag_xfer, strided_exp_sync) {
+    /* because ucp_tag_send_req return status (instead request) if send operation
+     * completed immediately */
+    skip_loopback();
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, true, true, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_unexp_sync) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, false, true, false);
+}
+
 /* send_contig_recv_contig */
 
 UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_contig_exp, "RNDV_THRESH=1248576") {
@@ -678,6 +820,32 @@ UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_generic_unexp, "RNDV_THRESH=12485
     test_run_xfer(true, false, false, false, false);
 }
 
+/* eager zcopy in many fragments - the transport may complete some of them
+ * immediately and the others later, and the send completes once after all */
+
+UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_generic_exp_zcopy,
+           "RNDV_THRESH=1248576", "ZCOPY_THRESH=1000") {
+    test_run_xfer(true, false, true, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_generic_unexp_zcopy,
+           "RNDV_THRESH=1248576", "ZCOPY_THRESH=1000") {
+    test_run_xfer(true, false, false, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_generic_exp_sync_zcopy,
+           "RNDV_THRESH=1248576", "ZCOPY_THRESH=1000") {
+    /* because ucp_tag_send_req return status (instead request) if send operation
+     * completed immediately */
+    skip_loopback();
+    test_run_xfer(true, false, true, true, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_generic_unexp_sync_zcopy,
+           "RNDV_THRESH=1248576", "ZCOPY_THRESH=1000") {
+    test_run_xfer(true, false, false, true, false);
+}
+
 /* send_generic_recv_contig */
 
 UCS_TEST_P(test_ucp_tag_xfer, send_generic_recv_contig_exp, "RNDV_THRESH=1248576") {
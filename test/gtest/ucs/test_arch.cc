@@ -0,0 +1,83 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2019.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#include <common/test.h>
+extern "C" {
+#include <ucs/arch/cpu.h>
+}
+
+#include <vector>
+
+class test_arch : public ucs::test {
+protected:
+    void test_memcpy(void (*memcpy_func)(void*, const void*, size_t)) {
+        static const size_t max_length = 3 * UCS_MBYTE;
+        std::vector<char> src(max_length + 64), dst(max_length + 64);
+
+        for (size_t i = 0; i < src.size(); ++i) {
+            src[i] = (char)i;
+        }
+
+        for (size_t length = 0; length < max_length; length = length * 3 + 1) {
+            for (size_t offset = 0; offset < 64; offset += 17) {
+                std::fill(dst.begin(), dst.end(), 0xff);
+                memcpy_func(&dst[offset], &src[1], length);
+
+                ASSERT_EQ(0, memcmp(&dst[offset], &src[1], length))
+                    << "length " << length << " offset " << offset;
+                for (size_t i = 0; i < offset; ++i) {
+                    ASSERT_EQ((char)0xff, dst[i]);
+                }
+                ASSERT_EQ((char)0xff, dst[offset + length]);
+            }
+        }
+    }
+};
+
+UCS_TEST_F(test_arch, memcpy_nt) {
+    test_memcpy(ucs_arch_memcpy_nt);
+}
+
+UCS_TEST_F(test_arch, memcpy_relaxed) {
+    size_t orig_thresh = ucs_memcpy_nt_thresh;
+
+    ucs_memcpy_nt_thresh = 4096;
+    test_memcpy(ucs_memcpy_relaxed);
+    ucs_memcpy_nt_thresh = orig_thresh;
+}
+
+UCS_TEST_F(test_arch, search_u64_masked) {
+    static const size_t max_length = 70;
+    const uint64_t value           = (5ull << 32) | 7;
+    std::vector<uint64_t> array(max_length);
+
+    /* all elements have the same low half as the value */
+    for (size_t i = 0; i < max_length; ++i) {
+        array[i] = ((uint64_t)(i + 100) << 32) | 7;
+    }
+
+    for (size_t length = 0; length <= max_length; ++length) {
+        /* no match with a full mask, every element with the low half mask */
+        EXPECT_EQ(length, ucs_arch_search_u64_masked(&array[0], length, value,
+                                                     UINT64_MAX));
+        EXPECT_EQ(0ul, ucs_arch_search_u64_masked(&array[0], length, value,
+                                                  0xffffffffull) * !!length);
+
+        for (size_t match = 0; match < length; ++match) {
+            uint64_t orig = array[match];
+
+            array[match] = value;
+            EXPECT_EQ(match, ucs_arch_search_u64_masked(&array[0], length,
+                                                        value, UINT64_MAX))
+                << "length " << length;
+            array[match] = value | 0xff00;
+            EXPECT_EQ(match, ucs_arch_search_u64_masked(&array[0], length,
+                                                        value, ~0xff00ull))
+                << "length " << length;
+            array[match] = orig;
+        }
+    }
+}
@@ -14,6 +14,7 @@ extern "C" {
 
 #include <sys/mman.h>
 #include <set>
+#include <vector>
 
 class test_sys : public ucs::test {
 protected:
@@ -27,6 +28,22 @@ protected:
         ucs_memunits_to_str(size, buf, sizeof(buf));
         EXPECT_EQ(std::string(expected), buf);
     }
+
+    static void parallel_part(void *arg, unsigned index) {
+        std::vector<pthread_t> *threads = (std::vector<pthread_t>*)arg;
+
+        (*threads)[index] = pthread_self();
+        usleep(1000); /* let the other threads take parts as well */
+    }
+
+    /* run 'count' parts, and return the threads which ran them */
+    static std::vector<pthread_t> run_parts(ucs_sys_thread_pool_t *pool,
+                                            unsigned count) {
+        std::vector<pthread_t> threads(count);
+
+        ucs_sys_thread_pool_run(pool, parallel_part, &threads, count);
+        return threads;
+    }
 };
 
 UCS_TEST_F(test_sys, uuid) {
@@ -135,3 +152,35 @@ UCS_TEST_F(test_sys, memunits_to_str) {
     test_memunits(UCS_TBYTE, "1T");
     test_memunits(UCS_TBYTE * 1024, "1024T");
 }
+
+UCS_TEST_F(test_sys, thread_pool) {
+    static const unsigned num_threads = 3;
+    std::set<pthread_t> distinct;
+    std::vector<pthread_t> threads;
+    ucs_sys_thread_pool_t *pool;
+    ucs_status_t status;
+
+    status = ucs_sys_thread_pool_create(num_threads, "test", &pool);
+    ASSERT_UCS_OK(status);
+
+    /* the same threads run the parts of every operation, and the calling
+     * thread takes parts as well */
+    for (unsigned i = 0; i < 20; ++i) {
+        threads = run_parts(pool, (num_threads + 1) * 2);
+        distinct.insert(threads.begin(), threads.end());
+    }
+    EXPECT_LE(distinct.size(), num_threads + 1);
+    EXPECT_GT(distinct.size(), 1ul);
+
+    /* a single part runs on the calling thread */
+    threads = run_parts(pool, 1);
+    EXPECT_TRUE(pthread_equal(pthread_self(), threads[0]));
+
+    ucs_sys_thread_pool_destroy(pool);
+
+    /* without a pool, all parts run on the calling thread */
+    threads = run_parts(NULL, 4);
+    for (unsigned i = 0; i < threads.size(); ++i) {
+        EXPECT_TRUE(pthread_equal(pthread_self(), threads[i]));
+    }
+}
@@ -8,6 +8,11 @@
 
 extern "C" {
 #include <ucs/arch/atomic.h>
+#include <uct/sm/mm/base/mm_iface.h>
+#include <uct/sm/mm/base/mm_ep.h>
+#if HAVE_NUMA
+#include <numaif.h>
+#endif
 }
 
 class test_many2one_am : public uct_test {
@@ -68,6 +73,8 @@ public:
         }
     }
 
+    void test_am_bcopy();
+
     static const size_t NUM_SENDERS = 10;
 
 protected:
@@ -76,7 +83,7 @@ protected:
 };
 
 
-UCS_TEST_P(test_many2one_am, am_bcopy, "MAX_BCOPY=16384")
+void test_many2one_am::test_am_bcopy()
 {
     const unsigned num_sends = 1000 / ucs::test_time_multiplier();
     ucs_status_t status;
@@ -88,12 +95,14 @@ UCS_TEST_P(test_many2one_am, am_bcopy, "MAX_BCOPY=16384")
     check_caps(UCT_IFACE_FLAG_CB_SYNC);
 
     ucs::ptr_vector<mapped_buffer> buffers;
+    std::vector<entity*> senders;
     for (unsigned i = 0; i < NUM_SENDERS; ++i) {
         entity *sender = create_entity(0);
         mapped_buffer *buffer = new mapped_buffer(
                             sender->iface_attr().cap.am.max_bcopy, 0, *sender);
         sender->connect(0, *receiver, i);
         m_entities.push_back(sender);
+        senders.push_back(sender);
         buffers.push_back(buffer);
     }
 
@@ -111,7 +120,7 @@ UCS_TEST_P(test_many2one_am, am_bcopy, "MAX_BCOPY=16384")
 
         ssize_t packed_len;
         for (;;) {
-            const entity& sender = ent(sender_num + 1);
+            const entity& sender = *senders[sender_num];
             packed_len = uct_ep_am_bcopy(sender.ep(0), AM_ID, mapped_buffer::pack,
                                          (void*)&buffer, 0);
             if (packed_len != UCS_ERR_NO_RESOURCE) {
@@ -135,10 +144,398 @@ UCS_TEST_P(test_many2one_am, am_bcopy, "MAX_BCOPY=16384")
     check_backlog();
 
     for (unsigned i = 0; i < NUM_SENDERS; ++i) {
-        ent(i + 1).flush();
+        senders[i]->flush();
     }
 
     buffers.clear();
 }
 
+UCS_TEST_P(test_many2one_am, am_bcopy, "MAX_BCOPY=16384")
+{
+    test_am_bcopy();
+}
+
 UCT_INSTANTIATE_NO_SELF_TEST_CASE(test_many2one_am)
+
+
+/* Checks of the mm receive path with several senders */
+class test_many2one_mm : public test_many2one_am {
+public:
+    test_many2one_mm() : m_receiver(NULL), m_rx_count(0) {
+    }
+
+    virtual void init() {
+        test_many2one_am::init();
+        m_receiver = create_entity(0);
+        m_entities.push_back(m_receiver);
+        uct_iface_set_am_handler(m_receiver->iface(), AM_ID, count_handler,
+                                 (void*)&m_rx_count, 0);
+    }
+
+    static ucs_status_t count_handler(void *arg, void *data, size_t length,
+                                      unsigned flags) {
+        ++(*(unsigned*)arg);
+        return UCS_OK;
+    }
+
+    static uct_mm_iface_t *mm_iface(const entity *e) {
+        return ucs_derived_of(e->iface(), uct_mm_iface_t);
+    }
+
+    static uct_mm_ep_t *mm_ep(const entity *e, unsigned index = 0) {
+        return ucs_derived_of(e->ep(index), uct_mm_ep_t);
+    }
+
+    entity *add_sender() {
+        entity *sender = create_entity(0);
+        m_entities.push_back(sender);
+        sender->connect(0, *m_receiver, m_senders.size());
+        m_senders.push_back(sender);
+        return sender;
+    }
+
+    void send_short(const entity *sender, unsigned index = 0) {
+        ASSERT_UCS_OK(uct_ep_am_short(sender->ep(index), AM_ID, 0, NULL, 0));
+    }
+
+    static size_t empty_pack(void *dest, void *arg) {
+        return 0;
+    }
+
+    void send_signaled(const entity *sender, unsigned index = 0) {
+        ASSERT_EQ(0, uct_ep_am_bcopy(sender->ep(index), AM_ID, empty_pack, NULL,
+                                     UCT_SEND_FLAG_SIGNALED));
+    }
+
+    void send_bcopy(const entity *sender, unsigned index = 0) {
+        ASSERT_EQ(0, uct_ep_am_bcopy(sender->ep(index), AM_ID, empty_pack, NULL,
+                                     0));
+    }
+
+    /* the most recently used segment attached by the interface */
+    static uct_mm_remote_seg_t *mru_remote_seg(const entity *e) {
+        uct_mm_iface_t *iface = mm_iface(e);
+
+        if (ucs_list_is_empty(&iface->remote_segs.lru)) {
+            return NULL;
+        }
+        return ucs_list_head(&iface->remote_segs.lru, uct_mm_remote_seg_t,
+                             list);
+    }
+
+    /* progress only the receive interface, and return the number of
+     * messages it handled */
+    unsigned rx_progress() {
+        unsigned prev_count = m_rx_count;
+
+        uct_iface_progress(m_receiver->iface());
+        return m_rx_count - prev_count;
+    }
+
+    /* read the pending wakeup signals of the receive interface */
+    unsigned num_signals() {
+        unsigned count = 0;
+        char dummy;
+
+        while (recvfrom(mm_iface(m_receiver)->signal_fd, &dummy, sizeof(dummy),
+                        MSG_DONTWAIT, NULL, 0) > 0) {
+            ++count;
+        }
+        return count;
+    }
+
+#if HAVE_NUMA
+    /* check the memory at the address is bound to the node, and resides there */
+    static void check_numa_node(const void *address, int numa_node) {
+        unsigned long nodemask = 0;
+        int policy, node;
+
+        ASSERT_EQ(0, get_mempolicy(&policy, &nodemask, sizeof(nodemask) * 8,
+                                   (void*)address, MPOL_F_ADDR));
+        EXPECT_EQ(MPOL_BIND, policy) << address;
+        EXPECT_EQ(UCS_BIT(numa_node), nodemask) << address;
+
+        ASSERT_EQ(0, get_mempolicy(&node, NULL, 0, (void*)address,
+                                   MPOL_F_NODE | MPOL_F_ADDR));
+        EXPECT_EQ(numa_node, node) << address;
+    }
+#endif
+
+    void test_rx_max_poll(unsigned num_senders, unsigned num_sends) {
+        unsigned max_poll = mm_iface(m_receiver)->config.rx_max_poll;
+        unsigned count;
+
+        for (unsigned i = 0; i < num_senders; ++i) {
+            add_sender();
+        }
+
+        for (unsigned i = 0; i < num_sends; ++i) {
+            send_short(m_senders[i % num_senders]);
+        }
+
+        /* every progress call drains up to rx_max_poll elements */
+        for (unsigned total = 0; total < num_sends; total += count) {
+            count = rx_progress();
+            EXPECT_EQ(std::min(max_poll, num_sends - total), count);
+            if (count == 0) {
+                break;
+            }
+        }
+        EXPECT_EQ(num_sends, m_rx_count);
+        EXPECT_EQ(0u, rx_progress());
+    }
+
+protected:
+    entity                *m_receiver;
+    std::vector<entity*>  m_senders;
+    volatile unsigned     m_rx_count;
+};
+
+UCS_TEST_P(test_many2one_mm, rx_max_poll, "RX_MAX_POLL=4")
+{
+    test_rx_max_poll(NUM_SENDERS, 18);
+}
+
+UCS_TEST_P(test_many2one_mm, rx_max_poll_single, "RX_MAX_POLL=1")
+{
+    test_rx_max_poll(2, 5);
+}
+
+UCS_TEST_P(test_many2one_mm, am_bcopy_single_poll, "MAX_BCOPY=16384",
+           "RX_MAX_POLL=1")
+{
+    test_am_bcopy();
+}
+
+UCS_TEST_P(test_many2one_mm, rx_max_poll_sender_rings, "RX_MAX_POLL=4",
+           "SENDER_RINGS=4")
+{
+    /* the limit covers the shared FIFO and the sender rings together */
+    test_rx_max_poll(6, 18);
+}
+
+UCS_TEST_P(test_many2one_mm, sender_ring_doorbell, "SENDER_RINGS=2")
+{
+    volatile uint64_t *doorbell = &mm_iface(m_receiver)->recv_fifo_ctl->ring_doorbell;
+
+    /* the first senders take the rings, the next one uses the shared FIFO */
+    entity *ring_sender1 = add_sender();
+    entity *ring_sender2 = add_sender();
+    entity *fifo_sender  = add_sender();
+
+    ASSERT_TRUE(mm_ep(ring_sender1)->ring_ctl != NULL);
+    ASSERT_TRUE(mm_ep(ring_sender2)->ring_ctl != NULL);
+    EXPECT_NE(mm_ep(ring_sender1)->ring_ctl, mm_ep(ring_sender2)->ring_ctl);
+    EXPECT_TRUE(mm_ep(fifo_sender)->ring_ctl == NULL);
+
+    uint64_t bit1 = mm_ep(ring_sender1)->ring_bit;
+    uint64_t bit2 = mm_ep(ring_sender2)->ring_bit;
+    EXPECT_TRUE(ucs_is_pow2(bit1));
+    EXPECT_TRUE(ucs_is_pow2(bit2));
+    EXPECT_NE(bit1, bit2);
+    EXPECT_EQ(0ul, *doorbell);
+
+    /* a ring sender rings its own bit, the shared FIFO doesn't use the
+     * doorbell */
+    send_short(ring_sender1);
+    EXPECT_EQ(bit1, *doorbell);
+    send_short(ring_sender1);
+    send_short(ring_sender2);
+    EXPECT_EQ(bit1 | bit2, *doorbell);
+    send_short(fifo_sender);
+    EXPECT_EQ(bit1 | bit2, *doorbell);
+
+    /* the receiver doesn't sleep while a doorbell is set */
+    EXPECT_EQ(UCS_ERR_BUSY, uct_iface_event_arm(m_receiver->iface(),
+                                                UCT_EVENT_RECV));
+
+    /* reading the rings clears the doorbell */
+    EXPECT_EQ(4u, rx_progress());
+    EXPECT_EQ(0ul, *doorbell);
+    EXPECT_EQ(UCS_OK, uct_iface_event_arm(m_receiver->iface(), UCT_EVENT_RECV));
+}
+
+/* a ring with more elements than the poll limit keeps its doorbell, so the
+ * next progress call reads the rest */
+UCS_TEST_P(test_many2one_mm, sender_ring_doorbell_partial, "SENDER_RINGS=1",
+           "RX_MAX_POLL=2")
+{
+    volatile uint64_t *doorbell = &mm_iface(m_receiver)->recv_fifo_ctl->ring_doorbell;
+    entity *sender              = add_sender();
+    uint64_t bit                = mm_ep(sender)->ring_bit;
+
+    ASSERT_TRUE(mm_ep(sender)->ring_ctl != NULL);
+    for (unsigned i = 0; i < 3; ++i) {
+        send_short(sender);
+    }
+
+    EXPECT_EQ(2u, rx_progress());
+    EXPECT_EQ(bit, *doorbell);
+    EXPECT_EQ(1u, rx_progress());
+    EXPECT_EQ(0ul, *doorbell);
+}
+
+UCS_TEST_P(test_many2one_mm, am_bcopy_sender_rings, "MAX_BCOPY=16384",
+           "SENDER_RINGS=16")
+{
+    test_am_bcopy();
+}
+
+/* some of the senders don't get a ring and use the shared FIFO */
+UCS_TEST_P(test_many2one_mm, am_bcopy_few_sender_rings, "MAX_BCOPY=16384",
+           "SENDER_RINGS=4", "RX_MAX_POLL=2")
+{
+    test_am_bcopy();
+}
+
+UCS_TEST_P(test_many2one_mm, armed_signal)
+{
+    volatile uint64_t *armed = &mm_iface(m_receiver)->recv_fifo_ctl->armed;
+    entity *sender1          = add_sender();
+    entity *sender2          = add_sender();
+
+    /* the senders don't signal a receiver which is not armed */
+    send_signaled(sender1);
+    EXPECT_EQ(0u, num_signals());
+    EXPECT_EQ(1u, rx_progress());
+
+    ASSERT_UCS_OK(uct_iface_event_arm(m_receiver->iface(), UCT_EVENT_RECV));
+    EXPECT_EQ(1ul, *armed);
+
+    /* only the first sender signals, and clears the armed flag */
+    send_signaled(sender1);
+    EXPECT_EQ(0ul, *armed);
+    send_signaled(sender2);
+    send_signaled(sender1);
+    EXPECT_EQ(1u, num_signals());
+    EXPECT_EQ(3u, rx_progress());
+
+    /* arming with pending elements leaves the flag clear */
+    send_short(sender2);
+    EXPECT_EQ(UCS_ERR_BUSY, uct_iface_event_arm(m_receiver->iface(),
+                                                UCT_EVENT_RECV));
+    EXPECT_EQ(0ul, *armed);
+    EXPECT_EQ(1u, rx_progress());
+}
+
+UCS_TEST_P(test_many2one_mm, numa_policy_default, "NUMA_POLICY=default")
+{
+    EXPECT_EQ(UCS_NUMA_POLICY_DEFAULT, mm_iface(m_receiver)->config.numa_policy);
+    EXPECT_EQ(-1, mm_iface(m_receiver)->config.numa_node);
+}
+
+UCS_TEST_P(test_many2one_mm, numa_policy_bind, "NUMA_POLICY=bind")
+{
+#if HAVE_NUMA
+    uct_mm_iface_t *iface = mm_iface(m_receiver);
+    int numa_node         = iface->config.numa_node;
+    entity *sender;
+
+    EXPECT_EQ(UCS_NUMA_POLICY_BIND, iface->config.numa_policy);
+    if (numa_node < 0) {
+        UCS_TEST_SKIP_R("receive memory is not bound to a NUMA node");
+    }
+
+    /* the senders write the receive memory, so check it after they did */
+    sender = add_sender();
+    send_short(sender);
+    EXPECT_EQ(1u, rx_progress());
+
+    check_numa_node(iface->recv_fifo_ctl, numa_node);
+    check_numa_node(iface->recv_fifo_elements, numa_node);
+    check_numa_node(iface->last_recv_desc, numa_node);
+#else
+    UCS_TEST_SKIP_R("NUMA support is disabled");
+#endif
+}
+
+UCS_TEST_P(test_many2one_mm, am_bcopy_numa_bind, "MAX_BCOPY=16384",
+           "NUMA_POLICY=bind")
+{
+    test_am_bcopy();
+}
+
+UCS_TEST_P(test_many2one_mm, attach_cache_evict, "ATTACH_CACHE_SIZE=1")
+{
+    entity *receiver2 = create_entity(0);
+    entity *sender    = create_entity(0);
+    uct_mm_remote_seg_t *remote_seg;
+    uct_mm_id_t mmid1;
+
+    m_entities.push_back(receiver2);
+    m_entities.push_back(sender);
+    uct_iface_set_am_handler(receiver2->iface(), AM_ID, count_handler,
+                             (void*)&m_rx_count, 0);
+    sender->connect(0, *m_receiver, 0);
+    sender->connect(1, *receiver2, 0);
+    EXPECT_EQ(0u, mm_iface(sender)->remote_segs.count);
+
+    /* bcopy attaches the receive descriptors of the receiver */
+    send_bcopy(sender, 0);
+    remote_seg = mru_remote_seg(sender);
+    ASSERT_TRUE(remote_seg != NULL);
+    mmid1 = remote_seg->mmid;
+    EXPECT_EQ(1u, mm_iface(sender)->remote_segs.count);
+
+    /* the attached segment is reused */
+    send_bcopy(sender, 0);
+    EXPECT_EQ(remote_seg, mru_remote_seg(sender));
+    EXPECT_EQ(1u, mm_iface(sender)->remote_segs.count);
+    EXPECT_EQ(2u, rx_progress());
+
+    /* another receiver evicts it */
+    send_bcopy(sender, 1);
+    ASSERT_TRUE(mru_remote_seg(sender) != NULL);
+    EXPECT_NE(mmid1, mru_remote_seg(sender)->mmid);
+    EXPECT_EQ(1u, mm_iface(sender)->remote_segs.count);
+    receiver2->progress();
+
+    /* and the first receiver is attached again */
+    send_bcopy(sender, 0);
+    ASSERT_TRUE(mru_remote_seg(sender) != NULL);
+    EXPECT_EQ(mmid1, mru_remote_seg(sender)->mmid);
+    EXPECT_EQ(1u, mm_iface(sender)->remote_segs.count);
+    EXPECT_EQ(1u, rx_progress());
+    EXPECT_EQ(4u, m_rx_count);
+}
+
+UCS_TEST_P(test_many2one_mm, attach_cache_hit, "ATTACH_CACHE_SIZE=2")
+{
+    entity *receiver2 = create_entity(0);
+    entity *sender    = create_entity(0);
+    uct_mm_remote_seg_t *remote_seg1, *remote_seg2;
+
+    m_entities.push_back(receiver2);
+    m_entities.push_back(sender);
+    uct_iface_set_am_handler(receiver2->iface(), AM_ID, count_handler,
+                             (void*)&m_rx_count, 0);
+    sender->connect(0, *m_receiver, 0);
+    sender->connect(1, *receiver2, 0);
+
+    send_bcopy(sender, 0);
+    remote_seg1 = mru_remote_seg(sender);
+    send_bcopy(sender, 1);
+    remote_seg2 = mru_remote_seg(sender);
+    ASSERT_TRUE(remote_seg1 != NULL);
+    ASSERT_TRUE(remote_seg2 != NULL);
+    EXPECT_NE(remote_seg1, remote_seg2);
+
+    /* both receivers stay attached, and the used one moves to the head */
+    for (unsigned i = 0; i < 4; ++i) {
+        send_bcopy(sender, i % 2);
+        EXPECT_EQ((i % 2) ? remote_seg2 : remote_seg1, mru_remote_seg(sender));
+        EXPECT_EQ(2u, mm_iface(sender)->remote_segs.count);
+    }
+
+    EXPECT_EQ(3u, rx_progress());
+    receiver2->progress();
+    EXPECT_EQ(6u, m_rx_count);
+}
+
+UCS_TEST_P(test_many2one_mm, am_bcopy_attach_evict, "MAX_BCOPY=16384",
+           "RX_BUFS_GROW=8", "ATTACH_CACHE_SIZE=1")
+{
+    test_am_bcopy();
+}
+
+_UCT_INSTANTIATE_TEST_CASE(test_many2one_mm, mm)
@@ -6,8 +6,10 @@
 
 extern "C" {
 #include <uct/api/uct.h>
+#include <uct/sm/mm/base/mm_ep.h>
 #include <ucs/time/time.h>
 }
+#include <sys/wait.h>
 #include "uct_p2p_test.h"
 #include <common/test.h>
 #include "uct_test.h"
@@ -15,13 +17,13 @@ extern "C" {
 class test_uct_mm : public uct_test {
 public:
 
-    void initialize() {
+    void initialize(uct_error_handler_t err_handler = NULL) {
         if (GetParam()->dev_name == "posix") {
             set_config("USE_SHM_OPEN=no");
         }
         uct_test::init();
 
-        m_e1 = uct_test::create_entity(0);
+        m_e1 = uct_test::create_entity(0, err_handler);
         m_entities.push_back(m_e1);
 
         m_e2 = uct_test::create_entity(0);
@@ -55,8 +57,109 @@ public:
         uct_test::cleanup();
     }
 
+    typedef struct {
+        uct_completion_t uct;
+        volatile int     done;
+        ucs_status_t     status;
+    } zcopy_comp_t;
+
+    static void zcopy_completion_cb(uct_completion_t *self, ucs_status_t status) {
+        zcopy_comp_t *comp = ucs_container_of(self, zcopy_comp_t, uct);
+        comp->status = status;
+        comp->done   = 1;
+    }
+
+    static ucs_status_t ep_failed_cb(void *arg, uct_ep_h ep,
+                                     ucs_status_t status) {
+        EXPECT_EQ(UCS_ERR_IO_ERROR, status);
+        ++static_cast<test_uct_mm*>(reinterpret_cast<uct_test*>(arg))->
+            m_ep_failures;
+        return UCS_OK;
+    }
+
+    static ucs_status_t zcopy_am_handler(void *arg, void *data, size_t length,
+                                         unsigned flags) {
+        test_uct_mm *self = reinterpret_cast<test_uct_mm*>(arg);
+
+        if (self->m_send_in_handler) {
+            /* attach a new remote segment while the data is still in use */
+            ssize_t packed = uct_ep_am_bcopy(self->m_e2->ep(0), 1, pack_cb,
+                                             &self->m_bcopy_data, 0);
+            EXPECT_EQ((ssize_t)sizeof(self->m_bcopy_data), packed);
+        }
+
+        self->m_recv_data.assign((char*)data, (char*)data + length);
+        ++self->m_am_count;
+        return UCS_OK;
+    }
+
+    static ucs_status_t count_am_handler(void *arg, void *data, size_t length,
+                                         unsigned flags) {
+        ++(*reinterpret_cast<volatile unsigned*>(arg));
+        return UCS_OK;
+    }
+
+    static size_t pack_cb(void *dest, void *arg) {
+        memcpy(dest, arg, sizeof(uint64_t));
+        return sizeof(uint64_t);
+    }
+
+    void test_am_zcopy(const void *header, unsigned header_length,
+                       void *buffer, size_t length, uct_mem_h memh) {
+        zcopy_comp_t comp;
+        uct_iov_t iov;
+        ucs_status_t status;
+
+        m_am_count    = 0;
+        iov.buffer    = buffer;
+        iov.length    = length;
+        iov.memh      = memh;
+        iov.stride    = 0;
+        iov.count     = 1;
+        comp.uct.func  = zcopy_completion_cb;
+        comp.uct.count = 1;
+        comp.done      = 0;
+
+        status = uct_ep_am_zcopy(m_e1->ep(0), 0, header, header_length, &iov, 1,
+                                 0, &comp.uct);
+        ASSERT_UCS_OK_OR_INPROGRESS(status);
+
+        wait_for_flag(&m_am_count);
+        ASSERT_EQ(1u, m_am_count);
+        if (status == UCS_INPROGRESS) {
+            wait_for_flag(&comp.done);
+            EXPECT_TRUE(comp.done);
+            EXPECT_UCS_OK(comp.status);
+        }
+
+        ASSERT_EQ(header_length + length, m_recv_data.size());
+        EXPECT_EQ(0, memcmp(&m_recv_data[0], header, header_length));
+        EXPECT_EQ(0, memcmp(&m_recv_data[header_length], buffer, length));
+    }
+
+    uct_mm_ep_t *mm_ep(unsigned index) {
+        return ucs_derived_of(m_e1->ep(index), uct_mm_ep_t);
+    }
+
+    void check_ring_send(unsigned index) {
+        volatile unsigned am_count = 0;
+        ucs_status_t status;
+
+        uct_iface_set_am_handler(m_e2->iface(), 0, count_am_handler,
+                                 (void*)&am_count, 0);
+        status = uct_ep_am_short(m_e1->ep(index), 0, 0xbeef, NULL, 0);
+        ASSERT_UCS_OK(status);
+        wait_for_flag(&am_count);
+        EXPECT_EQ(1u, am_count);
+    }
+
 protected:
-    entity *m_e1, *m_e2;
+    entity            *m_e1, *m_e2;
+    volatile unsigned m_am_count;
+    volatile unsigned m_ep_failures;
+    bool              m_send_in_handler;
+    uint64_t          m_bcopy_data;
+    std::vector<char> m_recv_data;
 };
 
 UCS_TEST_P(test_uct_mm, open_for_posix) {
@@ -99,4 +202,296 @@ UCS_TEST_P(test_uct_mm, open_for_posix) {
     }
 }
 
+UCS_TEST_P(test_uct_mm, am_zcopy_unregistered) {
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_ZCOPY);
+
+    uint64_t header = 0xbeef;
+    size_t length   = ucs_min(m_e1->iface_attr().cap.am.max_zcopy -
+                              sizeof(header), 4096ul);
+    std::vector<char> buffer(length);
+
+    for (size_t i = 0; i < length; ++i) {
+        buffer[i] = i;
+    }
+
+    m_send_in_handler = false;
+    uct_iface_set_am_handler(m_e2->iface(), 0, zcopy_am_handler, this, 0);
+
+    /* the data is copied to the FIFO since the receiver can't map it */
+    test_am_zcopy(&header, sizeof(header), &buffer[0], length,
+                  UCT_MEM_HANDLE_NULL);
+}
+
+UCS_TEST_P(test_uct_mm, am_zcopy_registered, "ATTACH_CACHE_SIZE=1") {
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_ZCOPY | UCT_IFACE_FLAG_AM_BCOPY);
+
+    size_t length = ucs_min(m_e1->iface_attr().cap.am.max_zcopy, 4096ul);
+    volatile unsigned bcopy_count = 0;
+    mapped_buffer buffer(length, 0, *m_e1);
+
+    if (buffer.memh() == UCT_MEM_HANDLE_NULL) {
+        UCS_TEST_SKIP_R("memory is not allocated by the mm md");
+    }
+
+    /* the header precedes the data, so the receiver gets both of them in the
+     * sender's memory. sending from the callback attaches another segment,
+     * which must not detach the one passed to the callback */
+    m_send_in_handler = true;
+    m_bcopy_data      = 0xdeadbeef;
+    uct_iface_set_am_handler(m_e2->iface(), 0, zcopy_am_handler, this, 0);
+    uct_iface_set_am_handler(m_e1->iface(), 1, count_am_handler,
+                             (void*)&bcopy_count, 0);
+
+    test_am_zcopy(buffer.ptr(), sizeof(uint64_t),
+                  (char*)buffer.ptr() + sizeof(uint64_t),
+                  length - sizeof(uint64_t), buffer.memh());
+
+    wait_for_flag(&bcopy_count);
+    EXPECT_EQ(1u, bcopy_count);
+}
+
+UCS_TEST_P(test_uct_mm, am_zcopy_attach_failure) {
+    initialize(ep_failed_cb);
+    check_caps(UCT_IFACE_FLAG_AM_ZCOPY);
+
+    size_t length = ucs_min(m_e1->iface_attr().cap.am.max_zcopy, 4096ul);
+    mapped_buffer buffer(length, 0, *m_e1);
+    uint64_t header = 0xbeef;
+    zcopy_comp_t comp;
+    uct_mm_seg_t seg;
+    ucs_status_t status;
+    uct_iov_t iov;
+
+    if (buffer.memh() == UCT_MEM_HANDLE_NULL) {
+        UCS_TEST_SKIP_R("memory is not allocated by the mm md");
+    }
+
+    /* describe the buffer by the id of a released segment, which the receiver
+     * can't attach */
+    {
+        mapped_buffer released(length, 0, *m_e1);
+        seg = *(uct_mm_seg_t*)buffer.memh();
+        seg.mmid   = ((uct_mm_seg_t*)released.memh())->mmid;
+        seg.serial = ((uct_mm_seg_t*)released.memh())->serial;
+    }
+
+    m_am_count    = 0;
+    m_ep_failures = 0;
+    uct_iface_set_am_handler(m_e2->iface(), 0, zcopy_am_handler, this, 0);
+
+    iov.buffer     = buffer.ptr();
+    iov.length     = length;
+    iov.memh       = &seg;
+    iov.stride     = 0;
+    iov.count      = 1;
+    comp.uct.func  = zcopy_completion_cb;
+    comp.uct.count = 1;
+    comp.done      = 0;
+    comp.status    = UCS_OK;
+
+    status = uct_ep_am_zcopy(m_e1->ep(0), 0, &header, sizeof(header), &iov, 1,
+                             0, &comp.uct);
+    ASSERT_EQ(UCS_INPROGRESS, status);
+
+    /* the receiver drops the message, and the sender fails the operation and
+     * the endpoint */
+    {
+        scoped_log_handler slh(hide_errors_logger);
+        wait_for_flag(&comp.done);
+        wait_for_flag(&m_ep_failures);
+    }
+
+    EXPECT_TRUE(comp.done);
+    EXPECT_EQ(UCS_ERR_IO_ERROR, comp.status);
+    EXPECT_EQ(1u, m_ep_failures);
+    EXPECT_EQ(0u, m_am_count);
+    EXPECT_EQ(UCS_ERR_ENDPOINT_TIMEOUT,
+              uct_ep_am_short(m_e1->ep(0), 0, header, NULL, 0));
+}
+
+UCS_TEST_P(test_uct_mm, rkey_registration_cache) {
+    initialize();
+
+    /* only registered memory is kept in the registration cache */
+    if (!ucs_test_all_flags(m_e1->md_attr().cap.flags,
+                            UCT_MD_FLAG_RKEY_PTR | UCT_MD_FLAG_REG)) {
+        UCS_TEST_SKIP_R("rkey_ptr of registered memory is not supported");
+    }
+
+    size_t length = 4096;
+    std::vector<char> buffer(length);
+    std::vector<char> rkey_buffer1(m_e1->md_attr().rkey_packed_size);
+    std::vector<char> rkey_buffer2(m_e1->md_attr().rkey_packed_size);
+    uct_mem_h memh1, memh2;
+    uct_rkey_bundle_t rkey1, rkey2;
+    void *ptr;
+
+    ASSERT_UCS_OK(uct_md_mem_reg(m_e1->md(), &buffer[0], length, 0, &memh1));
+    ASSERT_UCS_OK(uct_md_mem_reg(m_e1->md(), &buffer[0], length, 0, &memh2));
+    ASSERT_UCS_OK(uct_md_mkey_pack(m_e1->md(), memh1, &rkey_buffer1[0]));
+    ASSERT_UCS_OK(uct_md_mkey_pack(m_e1->md(), memh2, &rkey_buffer2[0]));
+
+    /* a buffer which is registered again keeps its segment */
+    EXPECT_EQ(((uct_mm_packed_rkey_t*)&rkey_buffer1[0])->mmid,
+              ((uct_mm_packed_rkey_t*)&rkey_buffer2[0])->mmid);
+
+    /* every unpacked key has its own mapping, which stays valid after the
+     * other one is released */
+    ASSERT_UCS_OK(uct_rkey_unpack(&rkey_buffer1[0], &rkey1));
+    ASSERT_UCS_OK(uct_rkey_unpack(&rkey_buffer2[0], &rkey2));
+    ASSERT_UCS_OK(uct_rkey_release(&rkey1));
+
+    ASSERT_UCS_OK(uct_rkey_ptr(&rkey2, (uintptr_t)&buffer[0], &ptr));
+    *(uint64_t*)ptr = 0xdeadbeef;
+    EXPECT_EQ(0xdeadbeef, *(uint64_t*)&buffer[0]);
+
+    ASSERT_UCS_OK(uct_rkey_release(&rkey2));
+    ASSERT_UCS_OK(uct_md_mem_dereg(m_e1->md(), memh2));
+    ASSERT_UCS_OK(uct_md_mem_dereg(m_e1->md(), memh1));
+}
+
+UCS_TEST_P(test_uct_mm, sender_ring_release, "SENDER_RINGS=1") {
+    initialize();
+
+    ASSERT_TRUE(mm_ep(0)->ring_ctl != NULL);
+
+    /* the only ring is taken, so the next endpoint writes to the shared FIFO */
+    m_e1->connect_to_iface(1, *m_e2);
+    EXPECT_TRUE(mm_ep(1)->ring_ctl == NULL);
+    check_ring_send(1);
+
+    /* a destroyed endpoint releases its ring to the next one */
+    m_e1->destroy_ep(0);
+    m_e1->connect_to_iface(2, *m_e2);
+    EXPECT_TRUE(mm_ep(2)->ring_ctl != NULL);
+    check_ring_send(2);
+}
+
+UCS_TEST_P(test_uct_mm, sender_ring_of_exited_process, "SENDER_RINGS=1") {
+    initialize();
+
+    uct_mm_ep_t *ep = mm_ep(0);
+    ASSERT_TRUE(ep->ring_ctl != NULL);
+    check_ring_send(0);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        _exit(0);
+    }
+    ASSERT_GT(pid, 0);
+    ASSERT_EQ(pid, waitpid(pid, NULL, 0));
+
+    /* make the ring look like it belongs to a process which failed after it
+     * claimed an element, and before it posted it */
+    ep->ring_ctl->owner = (uint64_t)pid << 32;
+    ++(*ep->fifo_head);
+    ep->ring_ctl = NULL;
+
+    m_e1->connect_to_iface(1, *m_e2);
+    EXPECT_TRUE(mm_ep(1)->ring_ctl != NULL);
+    check_ring_send(1);
+}
+
+UCS_TEST_P(test_uct_mm, sender_ring_of_reused_pid, "SENDER_RINGS=1") {
+    initialize();
+
+    uct_mm_ep_t *ep = mm_ep(0);
+    ASSERT_TRUE(ep->ring_ctl != NULL);
+
+    /* the pid of the owner belongs to another process which is alive */
+    ep->ring_ctl->owner ^= 1;
+    ep->ring_ctl = NULL;
+
+    m_e1->connect_to_iface(1, *m_e2);
+    EXPECT_TRUE(mm_ep(1)->ring_ctl != NULL);
+    check_ring_send(1);
+}
+
+UCS_TEST_P(test_uct_mm, sender_ring_of_other_pid_ns, "SENDER_RINGS=1") {
+    initialize();
+
+    uct_mm_ep_t *ep = mm_ep(0);
+    ASSERT_TRUE(ep->ring_ctl != NULL);
+
+    /* the owner can't be checked in another PID namespace, so its ring is
+     * not taken over even though the pid does not match it */
+    ep->ring_ctl->owner       ^= 1;
+    ep->ring_ctl->owner_pid_ns = ~ep->ring_ctl->owner_pid_ns;
+    ep->ring_ctl               = NULL;
+
+    m_e1->connect_to_iface(1, *m_e2);
+    EXPECT_TRUE(mm_ep(1)->ring_ctl == NULL);
+    check_ring_send(1);
+}
+
+UCS_TEST_P(test_uct_mm, fifo_layout_mismatch, "SENDER_RINGS=1") {
+    initialize();
+
+    modify_config("SENDER_RINGS", "0");
+    entity *e3 = uct_test::create_entity(0);
+    m_entities.push_back(e3);
+
+    std::vector<char> dev_addr(m_e2->iface_attr().device_addr_len);
+    std::vector<char> iface_addr(m_e2->iface_attr().iface_addr_len);
+    uct_ep_params_t ep_params;
+    ucs_status_t status;
+    uct_ep_h ep;
+
+    ASSERT_UCS_OK(uct_iface_get_device_address(m_e2->iface(),
+                                               (uct_device_addr_t*)&dev_addr[0]));
+    ASSERT_UCS_OK(uct_iface_get_address(m_e2->iface(),
+                                        (uct_iface_addr_t*)&iface_addr[0]));
+
+    ep_params.field_mask = UCT_EP_PARAM_FIELD_IFACE    |
+                           UCT_EP_PARAM_FIELD_DEV_ADDR |
+                           UCT_EP_PARAM_FIELD_IFACE_ADDR;
+    ep_params.iface      = e3->iface();
+    ep_params.dev_addr   = (uct_device_addr_t*)&dev_addr[0];
+    ep_params.iface_addr = (uct_iface_addr_t*)&iface_addr[0];
+
+    {
+        scoped_log_handler slh(hide_errors_logger);
+        status = uct_ep_create(&ep_params, &ep);
+    }
+    EXPECT_EQ(UCS_ERR_UNREACHABLE, status);
+}
+
+UCS_TEST_P(test_uct_mm, am_zcopy_canceled_on_ep_destroy) {
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_ZCOPY);
+
+    size_t length = ucs_min(m_e1->iface_attr().cap.am.max_zcopy, 4096ul);
+    mapped_buffer buffer(length, 0, *m_e1);
+    uint64_t header = 0xbeef;
+    zcopy_comp_t comp;
+    ucs_status_t status;
+    uct_iov_t iov;
+
+    if (buffer.memh() == UCT_MEM_HANDLE_NULL) {
+        UCS_TEST_SKIP_R("memory is not allocated by the mm md");
+    }
+
+    iov.buffer     = buffer.ptr();
+    iov.length     = length;
+    iov.memh       = buffer.memh();
+    iov.stride     = 0;
+    iov.count      = 1;
+    comp.uct.func  = zcopy_completion_cb;
+    comp.uct.count = 1;
+    comp.done      = 0;
+    comp.status    = UCS_OK;
+
+    /* the receiver is not progressed, so the operation is outstanding */
+    status = uct_ep_am_zcopy(m_e1->ep(0), 0, &header, sizeof(header), &iov, 1,
+                             0, &comp.uct);
+    ASSERT_EQ(UCS_INPROGRESS, status);
+    EXPECT_FALSE(comp.done);
+
+    m_e1->destroy_ep(0);
+    EXPECT_TRUE(comp.done);
+    EXPECT_EQ(UCS_ERR_CANCELED, comp.status);
+}
+
 _UCT_INSTANTIATE_TEST_CASE(test_uct_mm, mm)
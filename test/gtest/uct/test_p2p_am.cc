@@ -717,3 +717,59 @@ UCS_TEST_P(uct_p2p_am_tx_bufs, am_tx_max_bufs) {
 }
 
 UCT_INSTANTIATE_TEST_CASE(uct_p2p_am_tx_bufs)
+
+
+class uct_p2p_am_tcp_test : public uct_p2p_am_test {
+};
+
+/* The TCP header length field allows messages beyond 64k */
+UCS_TEST_P(uct_p2p_am_tcp_test, am_bcopy_256k, "MAX_BCOPY=256k") {
+    check_caps(UCT_IFACE_FLAG_AM_BCOPY, UCT_IFACE_FLAG_AM_DUP);
+    EXPECT_GE(sender().iface_attr().cap.am.max_bcopy, 255 * UCS_KBYTE);
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_am_test::am_bcopy),
+                    0ul,
+                    sender().iface_attr().cap.am.max_bcopy,
+                    TEST_UCT_FLAG_DIR_SEND_TO_RECV);
+}
+
+UCS_TEST_P(uct_p2p_am_tcp_test, am_zcopy_256k, "MAX_BCOPY=256k") {
+    check_caps(UCT_IFACE_FLAG_AM_ZCOPY, UCT_IFACE_FLAG_AM_DUP);
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_am_test::am_zcopy),
+                    0ul,
+                    sender().iface_attr().cap.am.max_zcopy,
+                    TEST_UCT_FLAG_DIR_SEND_TO_RECV);
+}
+
+UCS_TEST_P(uct_p2p_am_tcp_test, am_short_coalesce, "COALESCE_SIZE=4k") {
+    check_caps(UCT_IFACE_FLAG_AM_SHORT, UCT_IFACE_FLAG_AM_DUP);
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_am_test::am_short),
+                    sizeof(uint64_t),
+                    sender().iface_attr().cap.am.max_short,
+                    TEST_UCT_FLAG_DIR_SEND_TO_RECV);
+}
+
+UCS_TEST_P(uct_p2p_am_tcp_test, am_bcopy_coalesce, "COALESCE_SIZE=4k") {
+    check_caps(UCT_IFACE_FLAG_AM_BCOPY, UCT_IFACE_FLAG_AM_DUP);
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_am_test::am_bcopy),
+                    0ul,
+                    sender().iface_attr().cap.am.max_bcopy,
+                    TEST_UCT_FLAG_DIR_SEND_TO_RECV);
+}
+
+UCS_TEST_P(uct_p2p_am_tcp_test, am_bcopy_shm, "SHM_SIZE=1m") {
+    check_caps(UCT_IFACE_FLAG_AM_BCOPY, UCT_IFACE_FLAG_AM_DUP);
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_am_test::am_bcopy),
+                    0ul,
+                    sender().iface_attr().cap.am.max_bcopy,
+                    TEST_UCT_FLAG_DIR_SEND_TO_RECV);
+}
+
+UCS_TEST_P(uct_p2p_am_tcp_test, am_zcopy_shm, "SHM_SIZE=1m") {
+    check_caps(UCT_IFACE_FLAG_AM_ZCOPY, UCT_IFACE_FLAG_AM_DUP);
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_am_test::am_zcopy),
+                    0ul,
+                    sender().iface_attr().cap.am.max_zcopy,
+                    TEST_UCT_FLAG_DIR_SEND_TO_RECV);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_am_tcp_test, tcp)
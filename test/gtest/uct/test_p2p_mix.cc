@@ -233,3 +233,39 @@ UCS_TEST_P(uct_p2p_mix_test, mix_10000) {
 }
 
 UCT_INSTANTIATE_TEST_CASE(uct_p2p_mix_test)
+
+
+/* Mixed operations with the options of the TCP transport */
+class uct_p2p_mix_test_tcp : public uct_p2p_mix_test {
+};
+
+UCS_TEST_P(uct_p2p_mix_test_tcp, mix_10000_conns, "CONNS_PER_EP=4") {
+    run(10000);
+}
+
+UCS_TEST_P(uct_p2p_mix_test_tcp, mix_10000_zerocopy, "ZEROCOPY_THRESH=0") {
+    run(10000);
+}
+
+UCS_TEST_P(uct_p2p_mix_test_tcp, mix_10000_coalesce, "COALESCE_SIZE=4k",
+           "CONNS_PER_EP=2") {
+    run(10000);
+}
+
+UCS_TEST_P(uct_p2p_mix_test_tcp, mix_10000_shm, "SHM_SIZE=1m",
+           "CONNS_PER_EP=2") {
+    run(10000);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_mix_test_tcp, tcp)
+
+
+/* Mixed operations with the options of the mm transports */
+class uct_p2p_mix_test_mm : public uct_p2p_mix_test {
+};
+
+UCS_TEST_P(uct_p2p_mix_test_mm, mix_10000_sender_rings, "SENDER_RINGS=2") {
+    run(10000);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_mix_test_mm, mm)
@@ -134,3 +134,48 @@ UCS_TEST_P(uct_p2p_rma_test, get_zcopy) {
 }
 
 UCT_INSTANTIATE_TEST_CASE(uct_p2p_rma_test)
+
+
+/* RMA operations with the options of the TCP transport */
+class uct_p2p_rma_test_tcp : public uct_p2p_rma_test {
+};
+
+UCS_TEST_P(uct_p2p_rma_test_tcp, put_zcopy_zerocopy, "ZEROCOPY_THRESH=1k") {
+    check_caps(UCT_IFACE_FLAG_PUT_ZCOPY);
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_rma_test::put_zcopy),
+                    0ul, sender().iface_attr().cap.put.max_zcopy,
+                    TEST_UCT_FLAG_SEND_ZCOPY);
+}
+
+UCS_TEST_P(uct_p2p_rma_test_tcp, put_zcopy_shm, "SHM_SIZE=1m") {
+    check_caps(UCT_IFACE_FLAG_PUT_ZCOPY);
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_rma_test::put_zcopy),
+                    0ul, sender().iface_attr().cap.put.max_zcopy,
+                    TEST_UCT_FLAG_SEND_ZCOPY);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_rma_test_tcp, tcp)
+
+
+/* RMA operations with the options of the CMA transport */
+class uct_p2p_rma_test_cma : public uct_p2p_rma_test {
+};
+
+UCS_TEST_P(uct_p2p_rma_test_cma, put_zcopy_parallel, "CMA_COPY_THREADS=4",
+           "CMA_COPY_THREAD_SIZE=4k") {
+    check_caps(UCT_IFACE_FLAG_PUT_ZCOPY);
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_rma_test::put_zcopy),
+                    0ul, sender().iface_attr().cap.put.max_zcopy,
+                    TEST_UCT_FLAG_SEND_ZCOPY);
+}
+
+UCS_TEST_P(uct_p2p_rma_test_cma, get_zcopy_parallel, "CMA_COPY_THREADS=4",
+           "CMA_COPY_THREAD_SIZE=4k") {
+    check_caps(UCT_IFACE_FLAG_GET_ZCOPY);
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_rma_test::get_zcopy),
+                    ucs_max(1ull, sender().iface_attr().cap.get.min_zcopy),
+                    sender().iface_attr().cap.get.max_zcopy,
+                    TEST_UCT_FLAG_RECV_ZCOPY);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_rma_test_cma, cma)
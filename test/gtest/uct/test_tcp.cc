@@ -0,0 +1,648 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2019.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+extern "C" {
+#include <uct/api/uct.h>
+#include <uct/tcp/tcp.h>
+}
+#include <common/test.h>
+#include "uct_test.h"
+
+#include <fstream>
+
+class test_uct_tcp : public uct_test {
+public:
+    test_uct_tcp() : m_e1(NULL), m_e2(NULL), m_am_length(0), m_am_count(0),
+                     m_err_count(0) {
+    }
+
+    void initialize(bool err_handler = false) {
+        uct_test::init();
+
+        m_e1 = uct_test::create_entity(0, err_handler ? err_cb : NULL);
+        m_entities.push_back(m_e1);
+
+        m_e2 = uct_test::create_entity(0);
+        m_entities.push_back(m_e2);
+
+        m_e1->connect(0, *m_e2, 0);
+
+        uct_iface_set_am_handler(m_e2->iface(), 0, am_handler, this, 0);
+    }
+
+    static ucs_status_t am_handler(void *arg, void *data, size_t length,
+                                   unsigned flags) {
+        test_uct_tcp *self = reinterpret_cast<test_uct_tcp*>(arg);
+
+        self->m_am_length = length;
+        self->m_am_headers.push_back(*reinterpret_cast<uint64_t*>(data));
+        ++self->m_am_count;
+        return UCS_OK;
+    }
+
+    static void completion_cb(uct_completion_t *self, ucs_status_t status) {
+        EXPECT_UCS_OK(status);
+    }
+
+    static ucs_status_t err_cb(void *arg, uct_ep_h ep, ucs_status_t status) {
+        EXPECT_EQ(UCS_ERR_ENDPOINT_TIMEOUT, status);
+        ++static_cast<test_uct_tcp*>(reinterpret_cast<uct_test*>(arg))->
+            m_err_count;
+        return UCS_OK;
+    }
+
+    void send_am_short(size_t length, uint64_t header = 0) {
+        std::vector<char> buffer(length, 'x');
+        ucs_status_t status;
+
+        do {
+            status = uct_ep_am_short(m_e1->ep(0), 0, header, &buffer[0],
+                                     buffer.size());
+            progress();
+        } while (status == UCS_ERR_NO_RESOURCE);
+        ASSERT_UCS_OK(status);
+    }
+
+    static size_t fill_pack(void *dest, void *arg) {
+        size_t length = *reinterpret_cast<size_t*>(arg);
+
+        memset(dest, 'x', length);
+        return length;
+    }
+
+    ssize_t send_am_bcopy(size_t length) {
+        ssize_t packed;
+
+        do {
+            packed = uct_ep_am_bcopy(m_e1->ep(0), 0, fill_pack, &length, 0);
+            progress();
+        } while (packed == UCS_ERR_NO_RESOURCE);
+        return packed;
+    }
+
+    uct_tcp_ep_t *tx_ep() const {
+        return ucs_derived_of(m_e1->ep(0), uct_tcp_ep_t);
+    }
+
+    uct_tcp_iface_t *rx_iface() const {
+        return ucs_derived_of(m_e2->iface(), uct_tcp_iface_t);
+    }
+
+    /* Progress only the receiver for a while, and return the number of active
+     * messages it got */
+    unsigned progress_receiver(double timeout_msec) {
+        ucs_time_t deadline = ucs_get_time() +
+                              ucs_time_from_msec(timeout_msec);
+
+        while (ucs_get_time() < deadline) {
+            m_e2->progress();
+        }
+        return m_am_count;
+    }
+
+    /* Number of shared buffers of same-host connections mapped to the
+     * process, by the sending and by the receiving side */
+    static unsigned shm_mappings_count() {
+        std::ifstream maps("/proc/self/maps");
+        std::string line;
+        unsigned count = 0;
+
+        while (std::getline(maps, line)) {
+            count += (line.find("ucx_tcp_shm") != std::string::npos);
+        }
+        return count;
+    }
+
+    void test_shm(bool expect_shm) {
+        unsigned mappings = shm_mappings_count();
+
+        initialize();
+        check_caps(UCT_IFACE_FLAG_AM_SHORT | UCT_IFACE_FLAG_AM_BCOPY);
+
+        /* The shared buffer is passed to the peer before the first message */
+        send_am_short(0, 1);
+        wait_for_flag(&m_am_count);
+        EXPECT_EQ(mappings + (expect_shm ? 2 : 0), shm_mappings_count());
+
+        mapped_buffer sendbuf(m_e1->iface_attr().cap.am.max_bcopy, 2, *m_e1);
+        ssize_t packed;
+
+        do {
+            packed = uct_ep_am_bcopy(m_e1->ep(0), 0, mapped_buffer::pack,
+                                     &sendbuf, 0);
+            progress();
+        } while (packed == UCS_ERR_NO_RESOURCE);
+        ASSERT_EQ((ssize_t)sendbuf.length(), packed);
+
+        wait_for_value(&m_am_count, 2u, true);
+        EXPECT_EQ(2u, m_am_count);
+        EXPECT_EQ(sendbuf.length(), m_am_length);
+        EXPECT_EQ(*(uint64_t*)sendbuf.ptr(), m_am_headers.back());
+    }
+
+    /* Access a target variable which is outside of the registered buffer, and
+     * expect the target to close the connection without touching it */
+    void test_access_out_of_region(bool get) {
+        initialize(true);
+        check_caps(UCT_IFACE_FLAG_PUT_SHORT | UCT_IFACE_FLAG_GET_BCOPY |
+                   UCT_IFACE_FLAG_ERRHANDLE_PEER_FAILURE);
+
+        mapped_buffer sendbuf(sizeof(uint64_t), 1, *m_e1);
+        mapped_buffer recvbuf(sizeof(uint64_t), 0, *m_e2);
+        volatile uint64_t canary = 0;
+        ucs_status_t status;
+
+        {
+            scoped_log_handler slh(wrap_errors_logger);
+
+            if (get) {
+                status = uct_ep_get_bcopy(m_e1->ep(0),
+                                          (uct_unpack_callback_t)memcpy,
+                                          sendbuf.ptr(), sizeof(canary),
+                                          (uintptr_t)&canary, recvbuf.rkey(),
+                                          NULL);
+                EXPECT_EQ(UCS_INPROGRESS, status);
+            } else {
+                status = uct_ep_put_short(m_e1->ep(0), sendbuf.ptr(),
+                                          sendbuf.length(), (uintptr_t)&canary,
+                                          recvbuf.rkey());
+                EXPECT_UCS_OK(status);
+            }
+
+            wait_for_flag(&m_err_count);
+        }
+
+        EXPECT_EQ(1u, m_err_count);
+        EXPECT_EQ(0ul, canary);
+    }
+
+    /* Write a message with an invalid data length directly to the socket of
+     * the connected endpoint, and expect the receiver to close the connection
+     * without handling it. If shm is true, the length is in the descriptor of
+     * shared buffer data */
+    void test_rx_invalid_length(uint8_t am_id, uint64_t length, bool shm) {
+        struct {
+            uct_tcp_am_hdr_t   hdr;
+            uct_tcp_shm_desc_t desc;
+        } UCS_S_PACKED msg;
+        size_t msg_length;
+        ssize_t ret;
+
+        check_caps(UCT_IFACE_FLAG_AM_SHORT |
+                   UCT_IFACE_FLAG_ERRHANDLE_PEER_FAILURE);
+
+        /* Make sure the receiver has accepted the connection, and attached
+         * the shared buffer */
+        send_am_short(0);
+        wait_for_flag(&m_am_count);
+        ASSERT_EQ(1u, m_am_count);
+        if (shm) {
+            ucs_time_t deadline = ucs_get_time() +
+                                  ucs_time_from_sec(DEFAULT_TIMEOUT_SEC);
+            while (!(tx_ep()->flags & UCT_TCP_EP_FLAG_SHM) &&
+                   (ucs_get_time() < deadline)) {
+                progress();
+            }
+            if (!(tx_ep()->flags & UCT_TCP_EP_FLAG_SHM)) {
+                UCS_TEST_SKIP_R("shared buffer is not used");
+            }
+        }
+
+        if (shm) {
+            msg.hdr.am_id   = am_id | UCT_TCP_AM_FLAG_SHM;
+            msg.hdr.length  = sizeof(msg.desc);
+            msg.desc.offset = 0;
+            msg.desc.length = length;
+            msg.desc.end    = length;
+            msg_length      = sizeof(msg);
+        } else {
+            msg.hdr.am_id   = am_id;
+            msg.hdr.length  = length;
+            msg_length      = sizeof(msg.hdr);
+        }
+
+        ret = send(tx_ep()->fd, &msg, msg_length, MSG_NOSIGNAL);
+        ASSERT_EQ((ssize_t)msg_length, ret);
+
+        {
+            scoped_log_handler slh(wrap_errors_logger);
+            wait_for_flag(&m_err_count);
+        }
+
+        EXPECT_EQ(1u, m_err_count);
+        EXPECT_EQ(1u, m_am_count);
+        ASSERT_FALSE(m_errors.empty());
+        EXPECT_NE(std::string::npos, m_errors.front().find("invalid length"));
+    }
+
+protected:
+    entity                *m_e1, *m_e2;
+    size_t                m_am_length;
+    unsigned              m_am_count;
+    unsigned              m_err_count;
+    std::vector<uint64_t> m_am_headers;
+};
+
+/* Short messages are copied to the endpoint buffer as well, so they are
+ * limited by its size regardless of MAX_SHORT */
+UCS_TEST_P(test_uct_tcp, max_short_limited_by_buffer, "MAX_SHORT=16k",
+           "MAX_BCOPY=1k") {
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_SHORT | UCT_IFACE_FLAG_PUT_SHORT);
+
+    const uct_iface_attr_t &attr = m_e1->iface_attr();
+    EXPECT_LE(attr.cap.am.max_short,  attr.cap.am.max_bcopy);
+    EXPECT_LE(attr.cap.put.max_short, attr.cap.put.max_bcopy);
+
+    send_am_short(attr.cap.am.max_short - sizeof(uint64_t));
+    wait_for_flag(&m_am_count);
+    EXPECT_EQ(1u, m_am_count);
+    EXPECT_EQ(attr.cap.am.max_short, m_am_length);
+}
+
+/* Messages of a striped endpoint carry a sequence number besides the header,
+ * and are delivered in order even when they have the maximal size */
+UCS_TEST_P(test_uct_tcp, conns_am_order, "CONNS_PER_EP=4", "MAX_SHORT=16k",
+           "MAX_BCOPY=1k") {
+    static const unsigned count = 1000;
+
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_SHORT);
+
+    const size_t max_length = m_e1->iface_attr().cap.am.max_short -
+                              sizeof(uint64_t);
+    for (unsigned i = 0; i < count; ++i) {
+        send_am_short((i % 2) ? max_length : (i % 16), i);
+    }
+
+    wait_for_value(&m_am_count, count, true);
+    ASSERT_EQ(count, m_am_headers.size());
+    for (unsigned i = 0; i < count; ++i) {
+        EXPECT_EQ(i, m_am_headers[i]);
+    }
+}
+
+/* Put operations complete remotely, so flushing the initiator endpoint
+ * completes only after the target has handled the flush request */
+UCS_TEST_P(test_uct_tcp, put_flush_waits_for_target) {
+    initialize();
+    check_caps(UCT_IFACE_FLAG_PUT_SHORT);
+
+    mapped_buffer sendbuf(sizeof(uint64_t), 1, *m_e1);
+    mapped_buffer recvbuf(sizeof(uint64_t), 0, *m_e2);
+    uct_completion_t comp;
+    ucs_status_t status;
+
+    do {
+        status = uct_ep_put_short(m_e1->ep(0), sendbuf.ptr(), sendbuf.length(),
+                                  recvbuf.addr(), recvbuf.rkey());
+        m_e1->progress();
+    } while (status == UCS_ERR_NO_RESOURCE);
+    ASSERT_UCS_OK(status);
+
+    comp.func  = completion_cb;
+    comp.count = 1;
+    do {
+        status = uct_ep_flush(m_e1->ep(0), 0, &comp);
+        m_e1->progress();
+    } while (status == UCS_ERR_NO_RESOURCE);
+    ASSERT_EQ(UCS_INPROGRESS, status);
+
+    /* Progressing the initiator alone does not complete the flush */
+    ucs_time_t deadline = ucs_get_time() + ucs_time_from_msec(100);
+    while (ucs_get_time() < deadline) {
+        m_e1->progress();
+    }
+    EXPECT_EQ(1, comp.count);
+
+    wait_for_value(&comp.count, 0, true);
+    EXPECT_EQ(0, comp.count);
+    recvbuf.pattern_check(1);
+}
+
+/* Zero-copy RMA is received directly to the destination, so it is not limited
+ * by the buffer size, and a get may scatter the data to several buffers */
+UCS_TEST_P(test_uct_tcp, rma_zcopy_larger_than_buffer, "MAX_BCOPY=1k") {
+    initialize();
+    check_caps(UCT_IFACE_FLAG_PUT_ZCOPY | UCT_IFACE_FLAG_GET_ZCOPY);
+
+    const uct_iface_attr_t &attr = m_e1->iface_attr();
+    EXPECT_GT(attr.cap.put.max_zcopy, attr.cap.put.max_bcopy);
+    EXPECT_GT(attr.cap.get.max_zcopy, attr.cap.get.max_bcopy);
+    ASSERT_GE(attr.cap.get.max_iov, 3ul);
+
+    const size_t length = 64 * attr.cap.put.max_bcopy;
+    mapped_buffer sendbuf(length, 1, *m_e1);
+    mapped_buffer remotebuf(length, 0, *m_e2);
+    mapped_buffer recvbuf(length, 0, *m_e1);
+    uct_completion_t comp;
+    ucs_status_t status;
+
+    comp.func = completion_cb;
+
+    {
+        UCS_TEST_GET_BUFFER_IOV(iov, iovcnt, sendbuf.ptr(), length,
+                                sendbuf.memh(), 1);
+        comp.count = 1;
+        status     = uct_ep_put_zcopy(m_e1->ep(0), iov, iovcnt,
+                                      remotebuf.addr(), remotebuf.rkey(),
+                                      &comp);
+        ASSERT_UCS_OK_OR_INPROGRESS(status);
+        if (status == UCS_OK) {
+            comp.count = 0;
+        }
+        wait_for_value(&comp.count, 0, true);
+        flush();
+        remotebuf.pattern_check(1);
+    }
+
+    {
+        UCS_TEST_GET_BUFFER_IOV(iov, iovcnt, recvbuf.ptr(), length,
+                                recvbuf.memh(), 3);
+        comp.count = 1;
+        status     = uct_ep_get_zcopy(m_e1->ep(0), iov, iovcnt,
+                                      remotebuf.addr(), remotebuf.rkey(),
+                                      &comp);
+        ASSERT_EQ(UCS_INPROGRESS, status);
+        wait_for_value(&comp.count, 0, true);
+        EXPECT_EQ(0, comp.count);
+        recvbuf.pattern_check(1);
+    }
+}
+
+/* Peers on the same host pass bulk data through a shared buffer only when it
+ * is enabled, since it takes a memory file and a unix socket per connection */
+UCS_TEST_P(test_uct_tcp, shm_disabled_by_default) {
+    test_shm(false);
+}
+
+UCS_TEST_P(test_uct_tcp, shm_same_host, "SHM_SIZE=64k") {
+    test_shm(true);
+}
+
+/* The host identifier selects the shared memory path, but does not make a
+ * peer on another subnet reachable */
+UCS_TEST_P(test_uct_tcp, same_host_other_subnet_unreachable) {
+    initialize();
+
+    const uct_iface_attr_t &attr = m_e2->iface_attr();
+    std::vector<char> dev_addr(attr.device_addr_len);
+    std::vector<char> iface_addr(attr.iface_addr_len);
+    uct_tcp_device_addr_t *tcp_addr;
+
+    ASSERT_UCS_OK(uct_iface_get_device_address(m_e2->iface(),
+                                               (uct_device_addr_t*)&dev_addr[0]));
+    ASSERT_UCS_OK(uct_iface_get_address(m_e2->iface(),
+                                        (uct_iface_addr_t*)&iface_addr[0]));
+    EXPECT_TRUE(uct_iface_is_reachable(m_e1->iface(),
+                                       (uct_device_addr_t*)&dev_addr[0],
+                                       (uct_iface_addr_t*)&iface_addr[0]));
+
+    /* Flip the highest address bit, which is always within the netmask of a
+     * subnet */
+    tcp_addr = (uct_tcp_device_addr_t*)&dev_addr[0];
+    tcp_addr->in_addr.s_addr ^= htonl(UCS_BIT(31));
+    EXPECT_FALSE(uct_iface_is_reachable(m_e1->iface(),
+                                        (uct_device_addr_t*)&dev_addr[0],
+                                        (uct_iface_addr_t*)&iface_addr[0]));
+}
+
+UCS_TEST_P(test_uct_tcp, put_out_of_region) {
+    test_access_out_of_region(false);
+}
+
+UCS_TEST_P(test_uct_tcp, get_out_of_region) {
+    test_access_out_of_region(true);
+}
+
+/* Message lengths are checked before they are used, since they come from the
+ * peer */
+UCS_TEST_P(test_uct_tcp, rx_am_length_beyond_buffer) {
+    initialize(true);
+    test_rx_invalid_length(0, m_e1->iface_attr().cap.am.max_bcopy + 1, false);
+}
+
+UCS_TEST_P(test_uct_tcp, rx_put_length_below_header) {
+    initialize(true);
+    test_rx_invalid_length(UCT_TCP_AM_PUT, sizeof(uct_tcp_put_hdr_t) - 1,
+                           false);
+}
+
+UCS_TEST_P(test_uct_tcp, rx_shm_am_length_beyond_buffer, "SHM_SIZE=64k") {
+    initialize(true);
+    test_rx_invalid_length(0, m_e1->iface_attr().cap.am.max_bcopy + 1, true);
+}
+
+UCS_TEST_P(test_uct_tcp, rx_shm_put_length_below_header, "SHM_SIZE=64k") {
+    initialize(true);
+    test_rx_invalid_length(UCT_TCP_AM_PUT, sizeof(uct_tcp_put_hdr_t) - 1,
+                           true);
+}
+
+/* An endpoint created by the user reads its connection even when it has
+ * nothing to send, so it detects that the peer went away */
+UCS_TEST_P(test_uct_tcp, peer_failure_idle_ep) {
+    initialize(true);
+    check_caps(UCT_IFACE_FLAG_AM_SHORT | UCT_IFACE_FLAG_ERRHANDLE_PEER_FAILURE);
+
+    /* Make sure the receiver has accepted the connection */
+    send_am_short(0);
+    wait_for_flag(&m_am_count);
+    EXPECT_EQ(1u, m_am_count);
+
+    m_entities.remove(m_e2);
+    m_e2 = NULL;
+
+    wait_for_flag(&m_err_count);
+    EXPECT_EQ(1u, m_err_count);
+
+    /* The endpoint is replaced by a failed one, which rejects new sends */
+    EXPECT_EQ(UCS_ERR_ENDPOINT_TIMEOUT,
+              uct_ep_am_short(m_e1->ep(0), 0, 0, NULL, 0));
+}
+
+/* The active message header holds lengths beyond 16 bits, so a large bcopy
+ * message is received with its full length */
+UCS_TEST_P(test_uct_tcp, am_bcopy_length_beyond_64k, "MAX_BCOPY=256k") {
+    static const size_t length = UCS_BIT(16) + 1000;
+
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_BCOPY);
+    ASSERT_GE(m_e1->iface_attr().cap.am.max_bcopy, length);
+
+    EXPECT_EQ((ssize_t)length, send_am_bcopy(length));
+    wait_for_flag(&m_am_count);
+    EXPECT_EQ(1u, m_am_count);
+    EXPECT_EQ(length, m_am_length);
+}
+
+/* A bcopy size which does not fit the header length field is rejected */
+UCS_TEST_P(test_uct_tcp, max_bcopy_too_large) {
+    initialize();
+
+    uct_iface_params_t params = m_e1->iface_params();
+    uct_iface_h iface;
+    ucs_status_t status;
+
+    modify_config("MAX_BCOPY", "4g");
+    {
+        scoped_log_handler slh(hide_errors_logger);
+        status = uct_iface_open(m_e1->md(), m_e1->worker(), &params,
+                                m_iface_config, &iface);
+    }
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM, status);
+    if (status == UCS_OK) {
+        uct_iface_close(iface);
+    }
+}
+
+/* Coalesced messages stay in the send buffer until the sender interface is
+ * progressed, and then arrive in order */
+UCS_TEST_P(test_uct_tcp, am_coalesce_until_progress, "COALESCE_SIZE=4k") {
+    static const unsigned count = 3;
+    const size_t msg_length     = sizeof(uct_tcp_am_hdr_t) + sizeof(uint64_t);
+
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_SHORT);
+
+    /* Let the connection be established */
+    send_am_short(0, 0);
+    wait_for_flag(&m_am_count);
+    m_e1->flush();
+    m_am_count = 0;
+    m_am_headers.clear();
+
+    for (unsigned i = 0; i < count; ++i) {
+        ASSERT_UCS_OK(uct_ep_am_short(m_e1->ep(0), 0, i, NULL, 0));
+    }
+    EXPECT_TRUE(tx_ep()->flags & UCT_TCP_EP_FLAG_TX_COALESCE);
+    EXPECT_EQ(count * msg_length, tx_ep()->length);
+    EXPECT_EQ(0u, progress_receiver(100));
+
+    m_e1->progress();
+    EXPECT_FALSE(tx_ep()->flags & UCT_TCP_EP_FLAG_TX_COALESCE);
+
+    wait_for_value(&m_am_count, count, true);
+    ASSERT_EQ(count, m_am_headers.size());
+    for (unsigned i = 0; i < count; ++i) {
+        EXPECT_EQ(i, m_am_headers[i]);
+    }
+}
+
+/* The send buffer is passed to the socket by the message which makes it reach
+ * the coalescing size, without progressing the sender */
+UCS_TEST_P(test_uct_tcp, am_coalesce_threshold, "COALESCE_SIZE=256") {
+    const size_t msg_length = sizeof(uct_tcp_am_hdr_t) + sizeof(uint64_t);
+    const unsigned count    = ucs_div_round_up(256, msg_length);
+
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_SHORT);
+
+    send_am_short(0, 0);
+    wait_for_flag(&m_am_count);
+    m_e1->flush();
+    m_am_count = 0;
+
+    for (unsigned i = 0; i < count; ++i) {
+        EXPECT_TRUE((i == 0) || (tx_ep()->flags & UCT_TCP_EP_FLAG_TX_COALESCE));
+        ASSERT_UCS_OK(uct_ep_am_short(m_e1->ep(0), 0, i, NULL, 0));
+    }
+    EXPECT_FALSE(tx_ep()->flags & UCT_TCP_EP_FLAG_TX_COALESCE);
+    EXPECT_EQ(count, progress_receiver(100));
+}
+
+/* Receiving directly from the active endpoints is disabled by default, so
+ * every progress call waits for events with epoll_wait */
+UCS_TEST_P(test_uct_tcp, direct_poll_disabled_by_default) {
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_SHORT);
+
+    send_am_short(0);
+    wait_for_flag(&m_am_count);
+    EXPECT_EQ(1u, m_am_count);
+    EXPECT_EQ(0u, rx_iface()->config.direct_poll);
+    EXPECT_TRUE(ucs_list_is_empty(&rx_iface()->poll.active));
+}
+
+/* Messages received directly from the active endpoints arrive in order */
+UCS_TEST_P(test_uct_tcp, direct_poll_am_order, "DIRECT_POLL=4") {
+    static const unsigned count = 1000;
+
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_SHORT);
+
+    for (unsigned i = 0; i < count; ++i) {
+        send_am_short(i % 64, i);
+    }
+
+    wait_for_value(&m_am_count, count, true);
+    ASSERT_EQ(count, m_am_headers.size());
+    for (unsigned i = 0; i < count; ++i) {
+        EXPECT_EQ(i, m_am_headers[i]);
+    }
+    EXPECT_FALSE(ucs_list_is_empty(&rx_iface()->poll.active));
+}
+
+/* Endpoints which are destroyed while the active list is polled, because
+ * their peers went away, are removed from it safely */
+UCS_TEST_P(test_uct_tcp, direct_poll_peer_disconnect, "DIRECT_POLL=4") {
+    static const unsigned num_senders = 3;
+    std::vector<entity*> senders;
+
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_SHORT);
+
+    for (unsigned i = 0; i < num_senders; ++i) {
+        entity *e = uct_test::create_entity(0);
+        m_entities.push_back(e);
+        e->connect(0, *m_e2, 0);
+        senders.push_back(e);
+
+        ASSERT_UCS_OK(uct_ep_am_short(e->ep(0), 0, i, NULL, 0));
+        wait_for_value(&m_am_count, i + 1, true);
+    }
+
+    EXPECT_EQ(num_senders, rx_iface()->poll.active_count);
+
+    for (unsigned i = 0; i < num_senders; ++i) {
+        m_entities.remove(senders[i]);
+    }
+
+    /* Every disconnected endpoint leaves the active list */
+    ucs_time_t deadline = ucs_get_time() + ucs_time_from_sec(DEFAULT_TIMEOUT_SEC);
+    while ((rx_iface()->poll.active_count > 0) && (ucs_get_time() < deadline)) {
+        m_e2->progress();
+    }
+    EXPECT_EQ(0u, rx_iface()->poll.active_count);
+    EXPECT_TRUE(ucs_list_is_empty(&rx_iface()->poll.active));
+}
+
+/* The busy poll time is set on the connection sockets */
+UCS_TEST_P(test_uct_tcp, busy_poll, "BUSY_POLL=50") {
+    int optval       = 0;
+    socklen_t optlen = sizeof(optval);
+
+    {
+        /* Setting the option may require CAP_NET_ADMIN */
+        scoped_log_handler slh(hide_warns_logger);
+        initialize();
+    }
+    check_caps(UCT_IFACE_FLAG_AM_SHORT);
+
+    ASSERT_EQ(0, getsockopt(tx_ep()->fd, SOL_SOCKET, SO_BUSY_POLL, &optval,
+                            &optlen));
+    if (optval != 50) {
+        UCS_TEST_SKIP_R("SO_BUSY_POLL is not permitted");
+    }
+
+    for (unsigned i = 0; i < 10; ++i) {
+        send_am_short(8, i);
+    }
+    wait_for_value(&m_am_count, 10u, true);
+    EXPECT_EQ(10u, m_am_count);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(test_uct_tcp, tcp)
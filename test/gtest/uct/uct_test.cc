@@ -417,6 +417,13 @@ uct_test::entity::entity(const resource& resource, uct_iface_config_t *iface_con
     m_iface_params = *params;
 }
 
+uct_test::entity::~entity() {
+    for (std::set<entity*>::iterator iter = m_peers.begin();
+         iter != m_peers.end(); ++iter) {
+        (*iter)->m_peers.erase(this);
+    }
+}
+
 
 void uct_test::entity::cuda_mem_alloc(size_t length, uct_allocated_memory_t *mem) const {
 #if HAVE_CUDA
@@ -788,6 +795,11 @@ void uct_test::entity::connect(unsigned index, entity& other,
                                unsigned other_index,
                                ucs_sock_addr_t *remote_addr)
 {
+    if (&other != this) {
+        m_peers.insert(&other);
+        other.m_peers.insert(this);
+    }
+
     if (iface_attr().cap.flags & UCT_IFACE_FLAG_CONNECT_TO_EP) {
         connect_to_ep(index, other, other_index);
     } else if (iface_attr().cap.flags & UCT_IFACE_FLAG_CONNECT_TO_IFACE) {
@@ -807,7 +819,13 @@ void uct_test::entity::connect(unsigned index, entity& other, unsigned other_ind
 void uct_test::entity::flush() const {
     ucs_status_t status;
     do {
+        /* Some transports complete operations only when the remote side
+         * handles them, so progress the connected entities as well */
         progress();
+        for (std::set<entity*>::const_iterator iter = m_peers.begin();
+             iter != m_peers.end(); ++iter) {
+            (*iter)->progress();
+        }
         status = uct_iface_flush(m_iface, 0, NULL);
     } while (status == UCS_INPROGRESS);
     ASSERT_UCS_OK(status);
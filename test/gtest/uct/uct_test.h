@@ -15,6 +15,7 @@
 #include <ucs/async/async.h>
 #include <common/test.h>
 #include <vector>
+#include <set>
 #if HAVE_CUDA
 #include <cuda.h>
 #include <cuda_runtime.h>
@@ -69,6 +70,8 @@ protected:
         entity(const resource& resource, uct_iface_config_t *iface_config,
                uct_iface_params_t *params, uct_md_config_t *md_config);
 
+        ~entity();
+
         void mem_alloc(size_t length, uct_allocated_memory_t *mem,
                        uct_rkey_bundle *rkey_bundle, int mem_type) const;
 
@@ -142,6 +145,7 @@ protected:
         eps_vec_t                  m_eps;
         uct_iface_attr_t           m_iface_attr;
         uct_iface_params_t         m_iface_params;
+        std::set<entity*>          m_peers;
     };
 
     class mapped_buffer {